@@ -70,8 +70,15 @@ class CalpontExecutionPlan
     TRACE_RESRCMGR = 0x1000,         /*!< Trace Resource Manager Usage */
     TRACE_TUPLE_AUTOSWITCH = 0x4000, /*!< Enable MySQL tuple-to-table auto switch */
     TRACE_TUPLE_OFF = 0x8000,        /*!< Enable MySQL table interface */
+    RESULT_CACHE = 0x10000,          /*!< ExeMgr may answer from and fill its result cache */
   };
 
+  /**
+   * The status message ExeMgr sends with code 0 instead of "NOERROR" when it
+   * answers a RESULT_CACHE plan from its result cache.
+   */
+  static constexpr const char* RESULT_CACHE_HIT = "RESULTCACHEHIT";
+
   /**
    * Constructors
    */
@@ -23,6 +23,7 @@
  ***********************************************************************/
 
 #include <iostream>
+#include <memory>
 
 #include "bytestream.h"
 #include "predicateoperator.h"
@@ -34,6 +35,13 @@ using namespace oam;
 
 using namespace std;
 
+namespace
+{
+// The last LIKE pattern analyzed by this thread.  The pattern is nearly always a constant,
+// so this saves analyzing it again for every row.
+thread_local unique_ptr<datatypes::LikePattern> lastLikePattern;
+}  // namespace
+
 namespace execplan
 {
 /**
@@ -373,8 +381,11 @@ bool PredicateOperator::getBoolVal(rowgroup::Row& row, bool& isNull, ReturnedCol
     const std::string& pattern = rop->getStrVal(row, isNull);
     if (isNull)
       return false;
-    return datatypes::Charset(cs).like(fOp == OP_NOTLIKE, utils::ConstString(subject),
-                                       utils::ConstString(pattern));
+    datatypes::Charset charset(cs);
+    if (!lastLikePattern || &lastLikePattern->getCharset() != &charset.getCharset() ||
+        lastLikePattern->pattern() != pattern)
+      lastLikePattern.reset(new datatypes::LikePattern(charset, utils::ConstString(pattern)));
+    return lastLikePattern->like(fOp == OP_NOTLIKE, utils::ConstString(subject));
   }
 
   // fOpType should have already been set on the connector during parsing
@@ -1023,6 +1023,7 @@ void BatchPrimitiveProcessorJL::createBPP(ByteStream& bs) const
   uint16_t flags = 0;
 
   ism.Command = BATCH_PRIMITIVE_CREATE;
+  ism.Flags = BPP_CREATE_FORMAT_VERSION;
 
   bs.load((uint8_t*)&ism, sizeof(ism));
   bs << (uint8_t)ot;
@@ -47,9 +47,9 @@ void CommandJL::createCommand(ByteStream& bs) const
 {
   bs << OID;
   bs << tupleKey;
-  bs << queryUuid;
-  bs << stepUuid;
   // no need to send column name to PM as of rel.2.2.5.
+  // nor the UUIDs, they would make the msgs of the same step differ from query to
+  // query and keep PrimProc from reusing its BPPs (see BPPTemplates).
 }
 
 }  // namespace joblist
@@ -387,17 +387,7 @@ void DistributedEngineComm::Listen(boost::shared_ptr<MessageQueueClient> client,
 Error:
   // @bug 488 - error condition! push 0 length bs to messagequeuemap and
   // eventually let jobstep error out.
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok;
-  sbs.reset(new ByteStream(0));
-
-  for (map_tok = fSessionMessages.begin(); map_tok != fSessionMessages.end(); ++map_tok)
-  {
-    map_tok->second->queue.clear();
-    (void)atomicops::atomicInc(&map_tok->second->unackedWork[0]);
-    map_tok->second->queue.push(sbs);
-  }
-  lk.unlock();
+  pushErrorToAll();
 
   if (fIsExeMgr)
   {
@@ -444,22 +434,49 @@ Error:
   return;
 }
 
+boost::shared_ptr<DistributedEngineComm::MQE> DistributedEngineComm::findQueue(uint32_t key)
+{
+  SessionShard& shard = sessionShard(key);
+  boost::mutex::scoped_lock lk(shard.lock);
+  MessageQueueMap::iterator map_tok = shard.queues.find(key);
+
+  if (map_tok == shard.queues.end())
+    return boost::shared_ptr<MQE>();
+
+  return map_tok->second;
+}
+
+void DistributedEngineComm::pushErrorToAll()
+{
+  SBS sbs(new ByteStream(0));
+
+  for (SessionShard& shard : fSessions)
+  {
+    boost::mutex::scoped_lock lk(shard.lock);
+
+    for (MessageQueueMap::iterator map_tok = shard.queues.begin(); map_tok != shard.queues.end(); ++map_tok)
+    {
+      map_tok->second->queue.clear();
+      (void)atomicops::atomicInc(&map_tok->second->unackedWork[0]);
+      map_tok->second->queue.push(sbs);
+    }
+  }
+}
+
 void DistributedEngineComm::addQueue(uint32_t key, bool sendACKs)
 {
   bool b;
 
-  boost::mutex* lock = new boost::mutex();
-  condition* cond = new condition();
   uint32_t firstPMInterleavedConnectionId =
       key % (fPmConnections.size() / pmCount) * fDECConnectionsPerQuery * pmCount % fPmConnections.size();
   boost::shared_ptr<MQE> mqe(new MQE(pmCount, firstPMInterleavedConnectionId));
 
-  mqe->queue = StepMsgQueue(lock, cond);
   mqe->sendACKs = sendACKs;
   mqe->throttled = false;
 
-  boost::mutex::scoped_lock lk(fMlock);
-  b = fSessionMessages.insert(pair<uint32_t, boost::shared_ptr<MQE> >(key, mqe)).second;
+  SessionShard& shard = sessionShard(key);
+  boost::mutex::scoped_lock lk(shard.lock);
+  b = shard.queues.insert(pair<uint32_t, boost::shared_ptr<MQE> >(key, mqe)).second;
 
   if (!b)
   {
@@ -471,27 +488,27 @@ void DistributedEngineComm::addQueue(uint32_t key, bool sendACKs)
 
 void DistributedEngineComm::removeQueue(uint32_t key)
 {
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  SessionShard& shard = sessionShard(key);
+  boost::mutex::scoped_lock lk(shard.lock);
+  MessageQueueMap::iterator map_tok = shard.queues.find(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (map_tok == shard.queues.end())
     return;
 
   map_tok->second->queue.shutdown();
   map_tok->second->queue.clear();
-  fSessionMessages.erase(map_tok);
+  shard.queues.erase(map_tok);
 }
 
 void DistributedEngineComm::shutdownQueue(uint32_t key)
 {
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  boost::shared_ptr<MQE> mqe = findQueue(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
     return;
 
-  map_tok->second->queue.shutdown();
-  map_tok->second->queue.clear();
+  mqe->queue.shutdown();
+  mqe->queue.clear();
 }
 
 void DistributedEngineComm::read(uint32_t key, SBS& bs)
@@ -499,10 +516,9 @@ void DistributedEngineComm::read(uint32_t key, SBS& bs)
   boost::shared_ptr<MQE> mqe;
 
   // Find the StepMsgQueueList for this session
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  mqe = findQueue(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
   {
     ostringstream os;
 
@@ -510,9 +526,6 @@ void DistributedEngineComm::read(uint32_t key, SBS& bs)
     throw runtime_error(os.str());
   }
 
-  mqe = map_tok->second;
-  lk.unlock();
-
   // this method can block: you can't hold any locks here...
   TSQSize_t queueSize = mqe->queue.pop(&bs);
 
@@ -538,10 +551,9 @@ const ByteStream DistributedEngineComm::read(uint32_t key)
   boost::shared_ptr<MQE> mqe;
 
   // Find the StepMsgQueueList for this session
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  mqe = findQueue(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
   {
     ostringstream os;
 
@@ -549,9 +561,6 @@ const ByteStream DistributedEngineComm::read(uint32_t key)
     throw runtime_error(os.str());
   }
 
-  mqe = map_tok->second;
-  lk.unlock();
-
   TSQSize_t queueSize = mqe->queue.pop(&sbs);
 
   if (sbs && mqe->sendACKs)
@@ -576,19 +585,15 @@ void DistributedEngineComm::read_all(uint32_t key, vector<SBS>& v)
 {
   boost::shared_ptr<MQE> mqe;
 
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  mqe = findQueue(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
   {
     ostringstream os;
     os << "DEC: read_all(): attempt to read from a nonexistent queue\n";
     throw runtime_error(os.str());
   }
 
-  mqe = map_tok->second;
-  lk.unlock();
-
   mqe->queue.pop_all(v);
 
   if (mqe->sendACKs)
@@ -602,10 +607,9 @@ void DistributedEngineComm::read_some(uint32_t key, uint32_t divisor, vector<SBS
 {
   boost::shared_ptr<MQE> mqe;
 
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  mqe = findQueue(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
   {
     ostringstream os;
 
@@ -613,9 +617,6 @@ void DistributedEngineComm::read_some(uint32_t key, uint32_t divisor, vector<SBS
     throw runtime_error(os.str());
   }
 
-  mqe = map_tok->second;
-  lk.unlock();
-
   TSQSize_t queueSize = mqe->queue.pop_some(divisor, v, 1);  // need to play with the min #
 
   if (flowControlOn)
@@ -886,22 +887,12 @@ void DistributedEngineComm::write(messageqcpp::ByteStream& msg, uint32_t connect
   PrimitiveHeader* pm = (PrimitiveHeader*)(ism + 1);
   uint32_t senderID = pm->UniqueID;
 
-  boost::mutex::scoped_lock lk(fMlock, boost::defer_lock_t());
-  MessageQueueMap::iterator it;
   // This keeps mqe's stats from being freed until end of function
-  boost::shared_ptr<MQE> mqe;
+  boost::shared_ptr<MQE> mqe = findQueue(senderID);
   Stats* senderStats = NULL;
 
-  lk.lock();
-  it = fSessionMessages.find(senderID);
-
-  if (it != fSessionMessages.end())
-  {
-    mqe = it->second;
+  if (mqe)
     senderStats = &(mqe->stats);
-  }
-
-  lk.unlock();
 
   newClients[connection]->write(msg, NULL, senderStats);
 }
@@ -917,12 +908,9 @@ void DistributedEngineComm::addDataToOutput(SBS sbs, uint32_t connIndex, Stats*
   ISMPacketHeader* hdr = (ISMPacketHeader*)(sbs->buf());
   PrimitiveHeader* p = (PrimitiveHeader*)(hdr + 1);
   uint32_t uniqueId = p->UniqueID;
-  boost::shared_ptr<MQE> mqe;
+  boost::shared_ptr<MQE> mqe = findQueue(uniqueId);
 
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(uniqueId);
-
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
   {
     // For debugging...
     // cerr << "DistributedEngineComm::AddDataToOutput: tried to add a message to a dead session: " <<
@@ -930,20 +918,19 @@ void DistributedEngineComm::addDataToOutput(SBS sbs, uint32_t connIndex, Stats*
     return;
   }
 
-  mqe = map_tok->second;
-  lk.unlock();
-
   if (pmCount > 0)
   {
     (void)atomicops::atomicInc(&mqe->unackedWork[connIndex % pmCount]);
   }
 
   TSQSize_t queueSize = mqe->queue.push(sbs);
+  uint64_t msgSize = sbs->lengthWithHdrOverhead();
 
-  if (mqe->sendACKs)
+  // Most messages don't change the flow control, only those that may wait on the readers' ACKs
+  if (mqe->sendACKs && !mqe->throttled &&
+      (msgSize > (targetRecvQueueSize / 2) || queueSize.size >= mqe->targetQueueSize))
   {
     boost::mutex::scoped_lock lk(ackLock);
-    uint64_t msgSize = sbs->lengthWithHdrOverhead();
 
     if (!mqe->throttled && msgSize > (targetRecvQueueSize / 2))
       doHasBigMsgs(mqe, (300 * 1024 * 1024 > 3 * msgSize ? 300 * 1024 * 1024
@@ -954,7 +941,17 @@ void DistributedEngineComm::addDataToOutput(SBS sbs, uint32_t connIndex, Stats*
   }
 
   if (stats)
+  {
     mqe->stats.dataRecvd(stats->dataRecvd());
+
+    for (uint32_t codec = 0; codec < Stats::CODECS; ++codec)
+    {
+      const Stats::CodecCount& c = stats->codecRecvd(codec);
+
+      if (c.msgs)
+        mqe->stats.codecRecvd(codec, c.msgs, c.bytes, c.wireBytes);
+    }
+  }
 }
 
 void DistributedEngineComm::doHasBigMsgs(boost::shared_ptr<MQE> mqe, uint64_t targetSize)
@@ -968,8 +965,6 @@ void DistributedEngineComm::doHasBigMsgs(boost::shared_ptr<MQE> mqe, uint64_t ta
 int DistributedEngineComm::writeToClient(size_t aPMIndex, const ByteStream& bs, uint32_t senderUniqueID,
                                          bool doInterleaving)
 {
-  boost::mutex::scoped_lock lk(fMlock, boost::defer_lock_t());
-  MessageQueueMap::iterator it;
   // Keep mqe's stats from being freed early
   boost::shared_ptr<MQE> mqe;
   Stats* senderStats = NULL;
@@ -980,18 +975,14 @@ int DistributedEngineComm::writeToClient(size_t aPMIndex, const ByteStream& bs,
   uint32_t connectionId = aPMIndex;
   if (senderUniqueID != numeric_limits<uint32_t>::max())
   {
-    lk.lock();
-    it = fSessionMessages.find(senderUniqueID);
+    mqe = findQueue(senderUniqueID);
 
-    if (it != fSessionMessages.end())
+    if (mqe)
     {
-      mqe = it->second;
       senderStats = &(mqe->stats);
       size_t pmIndex = aPMIndex % mqe->pmCount;
-      connectionId = it->second->getNextConnectionId(pmIndex, fPmConnections.size(), fDECConnectionsPerQuery);
+      connectionId = mqe->getNextConnectionId(pmIndex, fPmConnections.size(), fDECConnectionsPerQuery);
     }
-
-    lk.unlock();
   }
 
   try
@@ -1009,20 +1000,8 @@ int DistributedEngineComm::writeToClient(size_t aPMIndex, const ByteStream& bs,
   {
     // @bug 488. error out under such condition instead of re-trying other connection,
     // by pushing 0 size bytestream to messagequeue and throw exception
-    SBS sbs;
-    lk.lock();
     // std::cout << "WARNING: DEC WRITE BROKEN PIPE. PMS index = " << index << std::endl;
-    MessageQueueMap::iterator map_tok;
-    sbs.reset(new ByteStream(0));
-
-    for (map_tok = fSessionMessages.begin(); map_tok != fSessionMessages.end(); ++map_tok)
-    {
-      map_tok->second->queue.clear();
-      (void)atomicops::atomicInc(&map_tok->second->unackedWork[0]);
-      map_tok->second->queue.push(sbs);
-    }
-
-    lk.unlock();
+    pushErrorToAll();
     /*
                     // reconfig the connection array
                     ClientList tempConns;
@@ -1060,15 +1039,11 @@ int DistributedEngineComm::writeToClient(size_t aPMIndex, const ByteStream& bs,
 
 uint32_t DistributedEngineComm::size(uint32_t key)
 {
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator map_tok = fSessionMessages.find(key);
+  boost::shared_ptr<MQE> mqe = findQueue(key);
 
-  if (map_tok == fSessionMessages.end())
+  if (!mqe)
     throw runtime_error("DEC::size() attempt to get the size of a nonexistant queue!");
 
-  boost::shared_ptr<MQE> mqe = map_tok->second;
-  // TODO: should probably check that this is a valid iter...
-  lk.unlock();
   return mqe->queue.size().count;
 }
 
@@ -1093,14 +1068,11 @@ void DistributedEngineComm::removeDECEventListener(DECEventListener* l)
 
 Stats DistributedEngineComm::getNetworkStats(uint32_t uniqueID)
 {
-  boost::mutex::scoped_lock lk(fMlock);
-  MessageQueueMap::iterator it;
+  boost::shared_ptr<MQE> mqe = findQueue(uniqueID);
   Stats empty;
 
-  it = fSessionMessages.find(uniqueID);
-
-  if (it != fSessionMessages.end())
-    return it->second->stats;
+  if (mqe)
+    return mqe->stats;
 
   return empty;
 }
@@ -43,7 +43,7 @@
 
 #include "bytestream.h"
 #include "primitivemsg.h"
-#include "threadsafequeue.h"
+#include "mpscring.h"
 #include "rwlock_local.h"
 #include "resourcemanager.h"
 #include "messagequeue.h"
@@ -201,6 +201,11 @@ class DistributedEngineComm
     return fRm->getPsCount() * cpp;
   }
 
+  /** @brief The bytes the queue of uniqueID sent and got so far
+   *
+   * Includes how many of its messages went out and came in with each
+   * codec, which the sending side of each connection picks as it goes.
+   */
   messageqcpp::Stats getNetworkStats(uint32_t uniqueID);
 
   friend class ::TestDistributedEngineComm;
@@ -210,7 +215,7 @@ class DistributedEngineComm
   typedef std::vector<boost::shared_ptr<messageqcpp::MessageQueueClient> > ClientList;
 
   // A queue of ByteStreams coming in from PrimProc heading for a JobStep
-  typedef ThreadSafeQueue<messageqcpp::SBS> StepMsgQueue;
+  typedef MPSCRing<messageqcpp::SBS> StepMsgQueue;
 
   /* To keep some state associated with the connection.  These aren't copyable. */
   struct MQE : public boost::noncopyable
@@ -243,6 +248,27 @@ class DistributedEngineComm
   // The mapping of session ids to StepMsgQueueLists
   typedef std::map<unsigned, boost::shared_ptr<MQE> > MessageQueueMap;
 
+  // The session map is split by id, so that the reader threads handing
+  // out the messages of different steps don't wait on each other
+  static const uint32_t SESSION_SHARDS = 64;
+
+  struct SessionShard
+  {
+    boost::mutex lock;
+    MessageQueueMap queues;
+  };
+
+  SessionShard& sessionShard(uint32_t key)
+  {
+    return fSessions[key % SESSION_SHARDS];
+  }
+
+  // The queue of key, or none
+  boost::shared_ptr<MQE> findQueue(uint32_t key);
+
+  // Makes the readers of every queue see an error
+  void pushErrorToAll();
+
   explicit DistributedEngineComm(ResourceManager* rm, bool isExeMgr);
 
   void StartClientListener(boost::shared_ptr<messageqcpp::MessageQueueClient> cl, uint32_t connIndex);
@@ -264,9 +290,8 @@ class DistributedEngineComm
 
   ClientList fPmConnections;  // all the pm servers
   ReaderList fPmReader;       // all the reader threads for the pm servers
-  MessageQueueMap
-      fSessionMessages;  // place to put messages from the pm server to be returned by the Read method
-  boost::mutex fMlock;   // sessionMessages mutex
+  // place to put messages from the pm server to be returned by the Read method
+  SessionShard fSessions[SESSION_SHARDS];
   std::vector<boost::shared_ptr<boost::mutex> > fWlock;  // PrimProc socket write mutexes
   bool fBusy;
   volatile uint32_t pmCount;
@@ -21,12 +21,21 @@
 #include <iostream>
 //#define NDEBUG
 #include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <string>
+#include <fcntl.h>
+#include <unistd.h>
 using namespace std;
 
+#include <boost/filesystem.hpp>
 #include <boost/shared_array.hpp>
 using namespace boost;
 
+#include "bytestream.h"
+#include "configcpp.h"
+
 #include "errorids.h"
 #include "exceptclasses.h"
 using namespace logging;
@@ -57,8 +66,168 @@ using namespace ordering;
 #include "limitedorderby.h"
 #include "mcs_decimal.h"
 
+namespace
+{
+// A GROUP_CONCAT keeps its rows per group, and most groups only get a few of them.
+// So the row storage starts with one row and doubles up to this size, and a
+// DISTINCT map starts with a small allocator window instead of the default one.
+const uint64_t groupConcatMaxRowsPerRG = 128;
+const uint64_t groupConcatDistinctPoolSize = 4096;
+
+// numbers the run files of the process
+std::atomic<uint64_t> groupConcatRunId{0};
+
+std::string errorString(int errNo)
+{
+  char tmp[1024];
+  auto* buf = strerror_r(errNo, tmp, sizeof(tmp));
+  return {buf};
+}
+
+void throwFileIOError(int errNo)
+{
+  throw IDBExcept(IDBErrorInfo::instance()->errorMsg(ERR_DISKAGG_FILEIO_ERROR, errorString(errNo)),
+                  ERR_DISKAGG_FILEIO_ERROR);
+}
+
+int writeData(int fd, const char* buf, size_t sz)
+{
+  size_t written = 0;
+
+  while (written < sz)
+  {
+    ssize_t r = ::write(fd, buf + written, sz - written);
+
+    if (r < 0)
+    {
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+
+      return errno;
+    }
+
+    written += r;
+  }
+
+  return 0;
+}
+
+// reads sz bytes at off, EIO if the file ends before
+int readData(int fd, char* buf, size_t sz, off_t off)
+{
+  size_t done = 0;
+
+  while (done < sz)
+  {
+    ssize_t r = pread(fd, buf + done, sz - done, off + done);
+
+    if (r < 0)
+    {
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+
+      return errno;
+    }
+
+    if (r == 0)
+      return EIO;
+
+    done += r;
+  }
+
+  return 0;
+}
+}  // namespace
+
 namespace joblist
 {
+// GroupConcatRuns class implementation
+GroupConcatRuns::GroupConcatRuns()
+{
+}
+
+GroupConcatRuns::~GroupConcatRuns()
+{
+  for (const string& file : fFiles)
+    unlink(file.c_str());
+}
+
+void GroupConcatRuns::write(ResourceManager* rm, RowGroup& rg, vector<RGData>& rgDatas)
+{
+  string tmpDir = rm->getConfig()->getTempFileDir(config::Config::TempDirPurpose::Aggregates);
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(tmpDir, ec);
+
+  char fname[PATH_MAX];
+  snprintf(fname, sizeof(fname), "%s/GroupConcat-p%u-r%lu", tmpDir.c_str(), getpid(),
+           groupConcatRunId.fetch_add(1));
+
+  int fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0)
+    throwFileIOError(errno);
+
+  fFiles.push_back(fname);
+  fOffsets.push_back(0);
+
+  for (RGData& rgData : rgDatas)
+  {
+    messageqcpp::ByteStream bs;
+    rg.setData(&rgData);
+    rgData.serialize(bs, rg.getDataSize());
+
+    uint64_t len = bs.length();
+    int errNo;
+
+    if ((errNo = writeData(fd, (const char*)&len, sizeof(len))) != 0 ||
+        (errNo = writeData(fd, (const char*)bs.buf(), len)) != 0)
+    {
+      close(fd);
+      throwFileIOError(errNo);
+    }
+  }
+
+  close(fd);
+}
+
+bool GroupConcatRuns::read(uint64_t i, RGData& rgData)
+{
+  int fd = open(fFiles[i].c_str(), O_RDONLY);
+
+  if (fd < 0)
+    throwFileIOError(errno);
+
+  uint64_t len;
+  ssize_t r = pread(fd, &len, sizeof(len), fOffsets[i]);
+
+  if (r == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  vector<char> data(len);
+  int errNo = (r == sizeof(len)) ? readData(fd, data.data(), len, fOffsets[i] + sizeof(len))
+                                 : (r < 0 ? errno : EIO);
+  close(fd);
+
+  if (errNo != 0)
+    throwFileIOError(errNo);
+
+  fOffsets[i] += sizeof(len) + len;
+  messageqcpp::ByteStream bs(reinterpret_cast<uint8_t*>(data.data()), len);
+  rgData.deserialize(bs);
+  return true;
+}
+
+void GroupConcatRuns::take(GroupConcatRuns& other)
+{
+  fFiles.insert(fFiles.end(), other.fFiles.begin(), other.fFiles.end());
+  fOffsets.insert(fOffsets.end(), other.fOffsets.begin(), other.fOffsets.end());
+  other.fFiles.clear();
+  other.fOffsets.clear();
+}
+
 // GroupConcatInfo class implementation
 GroupConcatInfo::GroupConcatInfo()
 {
@@ -302,7 +471,9 @@ const string GroupConcatInfo::toString() const
   return oss.str();
 }
 
-GroupConcatAgUM::GroupConcatAgUM(rowgroup::SP_GroupConcat& gcc) : GroupConcatAg(gcc)
+GroupConcatAgUM::GroupConcatAgUM(rowgroup::SP_GroupConcat& gcc,
+                                 const vector<rowgroup::SP_GroupConcatAg>* groups)
+ : GroupConcatAg(gcc), fGroups(groups)
 {
   initialize();
 }
@@ -318,6 +489,7 @@ void GroupConcatAgUM::initialize()
   else
     fConcator.reset(new GroupConcatNoOrder());
 
+  fConcator->groups(fGroups);
   fConcator->initialize(fGroupConcat);
 
   fGroupConcat->fRowGroup.initRow(&fRow, true);
@@ -349,6 +521,11 @@ uint8_t* GroupConcatAgUM::getResult()
   return fConcator->getResult(fGroupConcat->fSeparator);
 }
 
+bool GroupConcatAgUM::spill()
+{
+  return fConcator->spill();
+}
+
 void GroupConcatAgUM::applyMapping(const boost::shared_array<int>& mapping, const Row& row)
 {
   // For some reason the rowgroup mapping fcns don't work right in this class.
@@ -387,7 +564,7 @@ void GroupConcatAgUM::applyMapping(const boost::shared_array<int>& mapping, cons
 }
 
 // GroupConcator class implementation
-GroupConcator::GroupConcator() : fCurrentLength(0), fGroupConcatLen(0), fConstantLen(0)
+GroupConcator::GroupConcator() : fCurrentLength(0), fGroupConcatLen(0), fConstantLen(0), fGroups(NULL)
 {
 }
 
@@ -395,6 +572,30 @@ GroupConcator::~GroupConcator()
 {
 }
 
+// Takes size bytes of the memory limit for more rows. With disk-based aggregation it doesn't
+// wait for memory to be returned, the rows of all the groups of the aggregation go to disk
+// instead. Writing out only this group would free next to nothing when the groups are many.
+bool GroupConcator::getMemory(ResourceManager* rm, const boost::shared_ptr<int64_t>& sessionLimit,
+                              uint64_t size)
+{
+  if (!rm->getAllowDiskAggregation())
+    return rm->getMemory(size, sessionLimit);
+
+  if (rm->getMemory(size, sessionLimit, false))
+    return true;
+
+  // the memory is taken either way, true if enough was freed to go on
+  if (fGroups == NULL)
+    return spill();
+
+  bool spilled = false;
+
+  for (uint64_t i = 0; i < fGroups->size(); i++)
+    spilled = (*fGroups)[i]->spill() || spilled;
+
+  return spilled;
+}
+
 void GroupConcator::initialize(const rowgroup::SP_GroupConcat& gcc)
 {
   // MCOL-901 This value comes from the Server and it is
@@ -700,7 +901,7 @@ const string GroupConcator::toString() const
 }
 
 // GroupConcatOrderBy class implementation
-GroupConcatOrderBy::GroupConcatOrderBy()
+GroupConcatOrderBy::GroupConcatOrderBy() : fEmptyLength(0)
 {
   fRule.fIdbCompare = this;
 }
@@ -712,6 +913,7 @@ GroupConcatOrderBy::~GroupConcatOrderBy()
 void GroupConcatOrderBy::initialize(const rowgroup::SP_GroupConcat& gcc)
 {
   GroupConcator::initialize(gcc);
+  fEmptyLength = fCurrentLength;
 
   fOrderByCond.resize(0);
 
@@ -719,7 +921,8 @@ void GroupConcatOrderBy::initialize(const rowgroup::SP_GroupConcat& gcc)
     fOrderByCond.push_back(IdbSortSpec(gcc->fOrderCond[i].first, gcc->fOrderCond[i].second));
 
   fDistinct = gcc->fDistinct;
-  fRowsPerRG = 128;
+  fDistinctMapPoolSize = groupConcatDistinctPoolSize;
+  fRowsPerRG = 1;
   fErrorCode = ERR_AGGREGATION_TOO_BIG;
   fRm = gcc->fRm;
   fSessionMemLimit = gcc->fSessionMemLimit;
@@ -769,11 +972,12 @@ void GroupConcatOrderBy::processRow(const rowgroup::Row& row)
     if (fRowGroup.getRowCount() >= fRowsPerRG)
     {
       fDataQueue.push(fData);
+      fRowsPerRG = min(fRowsPerRG * 2, groupConcatMaxRowsPerRG);
 
       uint64_t newSize = fRowsPerRG * fRowGroup.getRowSize();
       fMemSize += newSize;
 
-      if (!fRm->getMemory(newSize, fSessionMemLimit))
+      if (!getMemory(fRm, fSessionMemLimit, newSize))
       {
         cerr << IDBErrorInfo::instance()->errorMsg(fErrorCode) << " @" << __FILE__ << ":" << __LINE__;
         throw IDBExcept(fErrorCode);
@@ -817,6 +1021,7 @@ void GroupConcatOrderBy::processRow(const rowgroup::Row& row)
 void GroupConcatOrderBy::merge(GroupConcator* gc)
 {
   GroupConcatOrderBy* go = dynamic_cast<GroupConcatOrderBy*>(gc);
+  fRuns.take(go->fRuns);
 
   while (go->fOrderByQueue.empty() == false)
   {
@@ -868,6 +1073,9 @@ void GroupConcatOrderBy::getResult(uint8_t* buff, const string& sep)
   ostringstream oss;
   bool addSep = false;
 
+  if (!fRuns.empty())
+    mergeRuns(oss, sep);
+
   // need to reverse the order
   stack<OrderByRow> rowStack;
 
@@ -899,6 +1107,178 @@ void GroupConcatOrderBy::getResult(uint8_t* buff, const string& sep)
   strncpy((char*)fOutputString.get(), oss.str().c_str(), resultSize);
 }
 
+// Called when a group can't get the memory for more rows. Writes the rows in the queue
+// to disk as a sorted run and frees the row storage but for the RGData rows are added to,
+// so the group goes on in memory as if it had no rows. getResult() merges the runs back.
+bool GroupConcatOrderBy::spill()
+{
+  if (!fRm->getAllowDiskAggregation() || fOrderByQueue.empty())
+    return false;
+
+  uint64_t keep = fRowsPerRG * fRowGroup.getRowSize();
+
+  // the queue pops the row that goes last first
+  vector<Row::Pointer> rows;
+  rows.reserve(fOrderByQueue.size());
+
+  while (!fOrderByQueue.empty())
+  {
+    rows.push_back(fOrderByQueue.top().fData);
+    fOrderByQueue.pop();
+  }
+
+  std::reverse(rows.begin(), rows.end());
+
+  RowGroup rg = fRowGroup;
+  Row out;
+  vector<RGData> rgDatas;
+  rg.initRow(&out);
+
+  for (uint64_t i = 0; i < rows.size(); i++)
+  {
+    if (i % groupConcatMaxRowsPerRG == 0)
+    {
+      rgDatas.emplace_back(rg, groupConcatMaxRowsPerRG);
+      rg.setData(&rgDatas.back());
+      rg.resetRowGroup(0);
+      rg.getRow(0, &out);
+    }
+
+    fRow1.setData(rows[i]);
+    copyRow(fRow1, &out);
+    rg.incRowCount();
+    out.nextRow();
+  }
+
+  fRuns.write(fRm, rg, rgDatas);
+
+  while (!fDataQueue.empty())
+    fDataQueue.pop();
+
+  fRm->returnMemory(fMemSize - keep, fSessionMemLimit);
+  fMemSize = keep;
+  fCurrentLength = fEmptyLength;
+
+  if (fDistinct)
+    fDistinctMap->clear();
+
+  return true;
+}
+
+// Writes the rows of the runs on disk and of the queue to oss, least first, and
+// leaves the queue empty. A DISTINCT row may be in more than one run, so the rows
+// written are kept in the distinct map to skip them in the others.
+void GroupConcatOrderBy::mergeRuns(ostringstream& oss, const string& sep)
+{
+  vector<Row::Pointer> memRows;
+  uint64_t memPos = 0;
+  memRows.reserve(fOrderByQueue.size());
+
+  while (!fOrderByQueue.empty())
+  {
+    memRows.push_back(fOrderByQueue.top().fData);
+    fOrderByQueue.pop();
+  }
+
+  std::reverse(memRows.begin(), memRows.end());
+
+  uint64_t runCount = fRuns.size();
+  RowGroup rg = fRowGroup;
+  vector<RGData> runData(runCount);
+  vector<Row> runRow(runCount);
+  vector<uint64_t> runLeft(runCount, 0);  // rows left in runData
+
+  auto load = [&](uint64_t i)
+  {
+    while (runLeft[i] == 0 && fRuns.read(i, runData[i]))
+    {
+      rg.setData(&runData[i]);
+      runLeft[i] = rg.getRowCount();
+      rg.getRow(0, &runRow[i]);
+    }
+  };
+
+  for (uint64_t i = 0; i < runCount; i++)
+  {
+    rg.initRow(&runRow[i]);
+    load(i);
+  }
+
+  // copies of the rows written, the RGDatas of the runs don't stay
+  RowGroup keptRG = fRowGroup;
+  Row kept;
+  vector<RGData> keptData;
+  keptRG.initRow(&kept);
+
+  if (fDistinct)
+    fDistinctMap->clear();
+
+  bool addSep = false;
+
+  while ((int64_t)oss.tellp() < fGroupConcatLen)
+  {
+    // the least of the next row in memory and the next one of each run
+    uint64_t from = runCount;
+    Row::Pointer least;
+
+    if (memPos < memRows.size())
+      least = memRows[memPos];
+
+    for (uint64_t i = 0; i < runCount; i++)
+    {
+      if (runLeft[i] > 0 &&
+          ((from == runCount && memPos >= memRows.size()) || fRule.less(runRow[i].getPointer(), least)))
+      {
+        from = i;
+        least = runRow[i].getPointer();
+      }
+    }
+
+    if (from == runCount && memPos >= memRows.size())
+      break;
+
+    fRow0.setData(least);
+
+    if (!fDistinct || fDistinctMap->find(least) == fDistinctMap->end())
+    {
+      if (fDistinct)
+      {
+        if (keptData.empty() || keptRG.getRowCount() >= groupConcatMaxRowsPerRG)
+        {
+          keptData.emplace_back(keptRG, groupConcatMaxRowsPerRG);
+          keptRG.setData(&keptData.back());
+          keptRG.resetRowGroup(0);
+          keptRG.getRow(0, &kept);
+        }
+
+        copyRow(fRow0, &kept);
+        fDistinctMap->insert(kept.getPointer());
+        keptRG.incRowCount();
+        kept.nextRow();
+      }
+
+      if (addSep)
+        oss << sep;
+      else
+        addSep = true;
+
+      outputRow(oss, fRow0);
+    }
+
+    if (from == runCount)
+    {
+      memPos++;
+    }
+    else
+    {
+      runRow[from].nextRow();
+
+      if (--runLeft[from] == 0)
+        load(from);
+    }
+  }
+}
+
 uint8_t* GroupConcator::getResult(const string& sep)
 {
   getResult(fOutputString.get(), sep);
@@ -927,7 +1307,7 @@ const string GroupConcatOrderBy::toString() const
 
 // GroupConcatNoOrder class implementation
 GroupConcatNoOrder::GroupConcatNoOrder()
- : fRowsPerRG(128), fErrorCode(ERR_AGGREGATION_TOO_BIG), fMemSize(0), fRm(NULL)
+ : fRowsPerRG(1), fErrorCode(ERR_AGGREGATION_TOO_BIG), fMemSize(0), fQueueMemSize(0), fRm(NULL)
 {
 }
 
@@ -942,7 +1322,7 @@ void GroupConcatNoOrder::initialize(const rowgroup::SP_GroupConcat& gcc)
   GroupConcator::initialize(gcc);
 
   fRowGroup = gcc->fRowGroup;
-  fRowsPerRG = 128;
+  fRowsPerRG = 1;
   fErrorCode = ERR_AGGREGATION_TOO_BIG;
   fRm = gcc->fRm;
   fSessionMemLimit = gcc->fSessionMemLimit;
@@ -955,7 +1335,7 @@ void GroupConcatNoOrder::initialize(const rowgroup::SP_GroupConcat& gcc)
   uint64_t newSize = fRowsPerRG * fRowGroup.getRowSize();
   fMemSize += newSize;
 
-  if (!fRm->getMemory(newSize, fSessionMemLimit))
+  if (!getMemory(fRm, fSessionMemLimit, newSize))
   {
     cerr << IDBErrorInfo::instance()->errorMsg(fErrorCode) << " @" << __FILE__ << ":" << __LINE__;
     throw IDBExcept(fErrorCode);
@@ -984,17 +1364,19 @@ void GroupConcatNoOrder::processRow(const rowgroup::Row& row)
 
     if (fRowGroup.getRowCount() >= fRowsPerRG)
     {
+      fDataQueue.push(fData);
+      fQueueMemSize += fRowsPerRG * fRowGroup.getRowSize();
+      fRowsPerRG = min(fRowsPerRG * 2, groupConcatMaxRowsPerRG);
       uint64_t newSize = fRowsPerRG * fRowGroup.getRowSize();
 
       fMemSize += newSize;
 
-      if (!fRm->getMemory(newSize, fSessionMemLimit))
+      if (!getMemory(fRm, fSessionMemLimit, newSize))
       {
         cerr << IDBErrorInfo::instance()->errorMsg(fErrorCode) << " @" << __FILE__ << ":" << __LINE__;
         throw IDBExcept(fErrorCode);
       }
 
-      fDataQueue.push(fData);
       fData.reinit(fRowGroup, fRowsPerRG);
       fRowGroup.setData(&fData);
       fRowGroup.resetRowGroup(0);
@@ -1006,6 +1388,7 @@ void GroupConcatNoOrder::processRow(const rowgroup::Row& row)
 void GroupConcatNoOrder::merge(GroupConcator* gc)
 {
   GroupConcatNoOrder* in = dynamic_cast<GroupConcatNoOrder*>(gc);
+  fRuns.take(in->fRuns);
 
   while (in->fDataQueue.size() > 0)
   {
@@ -1015,7 +1398,31 @@ void GroupConcatNoOrder::merge(GroupConcator* gc)
 
   fDataQueue.push(in->fData);
   fMemSize += in->fMemSize;
+  fQueueMemSize += in->fMemSize;
   in->fMemSize = 0;
+  in->fQueueMemSize = 0;
+}
+
+// Called when a group can't get the memory for more rows. Writes the full RGDatas to
+// disk as a run and frees them, the rows to come go after them.
+bool GroupConcatNoOrder::spill()
+{
+  if (!fRm->getAllowDiskAggregation() || fDataQueue.empty())
+    return false;
+
+  vector<RGData> rgDatas;
+
+  while (!fDataQueue.empty())
+  {
+    rgDatas.push_back(fDataQueue.front());
+    fDataQueue.pop();
+  }
+
+  fRuns.write(fRm, fRowGroup, rgDatas);
+  fRm->returnMemory(fQueueMemSize, fSessionMemLimit);
+  fMemSize -= fQueueMemSize;
+  fQueueMemSize = 0;
+  return true;
 }
 
 void GroupConcatNoOrder::getResult(uint8_t* buff, const string& sep)
@@ -1023,11 +1430,9 @@ void GroupConcatNoOrder::getResult(uint8_t* buff, const string& sep)
   ostringstream oss;
   bool addSep = false;
 
-  fDataQueue.push(fData);
-
-  while (fDataQueue.size() > 0)
+  auto output = [&](RGData& rgData)
   {
-    fRowGroup.setData(&fDataQueue.front());
+    fRowGroup.setData(&rgData);
     fRowGroup.getRow(0, &fRow);
 
     for (uint64_t i = 0; i < fRowGroup.getRowCount(); i++)
@@ -1040,7 +1445,22 @@ void GroupConcatNoOrder::getResult(uint8_t* buff, const string& sep)
       outputRow(oss, fRow);
       fRow.nextRow();
     }
+  };
 
+  // the rows on disk came first, only read as many as fit in the result
+  for (uint64_t i = 0; i < fRuns.size(); i++)
+  {
+    RGData rgData;
+
+    while ((int64_t)oss.tellp() < fGroupConcatLen && fRuns.read(i, rgData))
+      output(rgData);
+  }
+
+  fDataQueue.push(fData);
+
+  while (fDataQueue.size() > 0)
+  {
+    output(fDataQueue.front());
     fDataQueue.pop();
   }
 
@@ -23,6 +23,8 @@
 
 #include <utility>
 #include <set>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
@@ -45,6 +47,39 @@ struct JobInfo;
 class GroupConcator;
 class ResourceManager;
 
+// The rows a GROUP_CONCAT moved to disk to stay within the memory limit. Each run
+// is a file of RGDatas in the aggregates temp dir, the rows in the order they are
+// concatenated in. The files go away with the object.
+class GroupConcatRuns
+{
+ public:
+  GroupConcatRuns();
+  ~GroupConcatRuns();
+
+  // writes the rows of rgDatas as a new run, rg is the layout of their rows
+  void write(ResourceManager* rm, rowgroup::RowGroup& rg, std::vector<rowgroup::RGData>& rgDatas);
+  // reads the next RGData of run i, false at the end of it
+  bool read(uint64_t i, rowgroup::RGData& rgData);
+  // moves the runs of another GROUP_CONCAT of the same group here
+  void take(GroupConcatRuns& other);
+
+  uint64_t size() const
+  {
+    return fFiles.size();
+  }
+  bool empty() const
+  {
+    return fFiles.empty();
+  }
+
+ private:
+  GroupConcatRuns(const GroupConcatRuns&);
+  GroupConcatRuns& operator=(const GroupConcatRuns&);
+
+  std::vector<std::string> fFiles;
+  std::vector<uint64_t> fOffsets;  // where the next read() of each run starts
+};
+
 class GroupConcatInfo
 {
  public:
@@ -76,7 +111,10 @@ class GroupConcatInfo
 class GroupConcatAgUM : public rowgroup::GroupConcatAg
 {
  public:
-  EXPORT GroupConcatAgUM(rowgroup::SP_GroupConcat&);
+  // groups are the GROUP_CONCATs of all the groups of the aggregation, they go to disk
+  // together when the memory limit is reached
+  EXPORT GroupConcatAgUM(rowgroup::SP_GroupConcat&,
+                         const std::vector<rowgroup::SP_GroupConcatAg>* groups = nullptr);
   EXPORT ~GroupConcatAgUM();
 
   using rowgroup::GroupConcatAg::merge;
@@ -91,9 +129,12 @@ class GroupConcatAgUM : public rowgroup::GroupConcatAg
   EXPORT void getResult(uint8_t*);
   EXPORT uint8_t* getResult();
 
+  bool spill() override;
+
  protected:
   void applyMapping(const boost::shared_array<int>&, const rowgroup::Row&);
 
+  const std::vector<rowgroup::SP_GroupConcatAg>* fGroups;
   boost::scoped_ptr<GroupConcator> fConcator;
   boost::scoped_array<uint8_t> fData;
   rowgroup::Row fRow;
@@ -114,9 +155,21 @@ class GroupConcator
   virtual void getResult(uint8_t* buff, const std::string& sep) = 0;
   virtual uint8_t* getResult(const std::string& sep);
 
+  // writes the rows held in memory to disk and frees their memory, false if there
+  // were none or disk-based aggregation is off
+  virtual bool spill()
+  {
+    return false;
+  }
+  void groups(const std::vector<rowgroup::SP_GroupConcatAg>* groups)
+  {
+    fGroups = groups;
+  }
+
   virtual const std::string toString() const;
 
  protected:
+  bool getMemory(ResourceManager* rm, const boost::shared_ptr<int64_t>& sessionLimit, uint64_t size);
   virtual bool concatColIsNull(const rowgroup::Row&);
   virtual void outputRow(std::ostringstream&, const rowgroup::Row&);
   virtual int64_t lengthEstimate(const rowgroup::Row&);
@@ -128,6 +181,7 @@ class GroupConcator
   int64_t fConstantLen;
   boost::scoped_array<uint8_t> fOutputString;
   long fTimeZone;
+  const std::vector<rowgroup::SP_GroupConcatAg>* fGroups;  // of the aggregation, null for this one only
 };
 
 // For GROUP_CONCAT withour distinct or orderby
@@ -143,6 +197,7 @@ class GroupConcatNoOrder : public GroupConcator
   void merge(GroupConcator*);
   using GroupConcator::getResult;
   void getResult(uint8_t* buff, const std::string& sep);
+  bool spill() override;
 
   const std::string toString() const;
 
@@ -151,9 +206,11 @@ class GroupConcatNoOrder : public GroupConcator
   rowgroup::Row fRow;
   rowgroup::RGData fData;
   std::queue<rowgroup::RGData> fDataQueue;
+  GroupConcatRuns fRuns;  // the rows before the ones in fDataQueue
   uint64_t fRowsPerRG;
   uint64_t fErrorCode;
   uint64_t fMemSize;
+  uint64_t fQueueMemSize;  // the part of fMemSize in fDataQueue
   ResourceManager* fRm;
   boost::shared_ptr<int64_t> fSessionMemLimit;
 };
@@ -174,10 +231,15 @@ class GroupConcatOrderBy : public GroupConcator, public ordering::IdbOrderBy
   void merge(GroupConcator*);
   using GroupConcator::getResult;
   void getResult(uint8_t* buff, const std::string& sep);
+  bool spill() override;
 
   const std::string toString() const;
 
  protected:
+  void mergeRuns(std::ostringstream& oss, const std::string& sep);
+
+  GroupConcatRuns fRuns;  // sorted runs of rows spilled from fOrderByQueue
+  int64_t fEmptyLength;   // fCurrentLength with no rows
 };
 
 }  // namespace joblist
@@ -0,0 +1,112 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <algorithm>
+#include <sstream>
+using namespace std;
+
+#include "jobthrottle.h"
+#include "primitivemsg.h"
+
+namespace joblist
+{
+JobThrottle::JobThrottle(uint64_t maxSendWindow)
+ : fJobSizeShift(0)
+ , fSendWindow(maxSendWindow)
+ , fMinSendWindow(max<uint64_t>(maxSendWindow >> MIN_SEND_WINDOW_SHIFT, 1))
+ , fMaxSendWindow(maxSendWindow)
+ , fJobLatency(0)
+ , fPMQueueDepth(0)
+ , fUMBacklog(false)
+ , fLatencySamples(0)
+ , fJobBlocksLow(0)
+ , fJobBlocksHigh(0)
+ , fSendWindowLow(maxSendWindow)
+ , fSendWindowHigh(maxSendWindow)
+{
+}
+
+uint32_t JobThrottle::jobBlocks(uint32_t blocksPerJob) const
+{
+  uint32_t blocks = (fJobSizeShift < 0 ? blocksPerJob >> -fJobSizeShift : blocksPerJob << fJobSizeShift);
+  return max(blocks, 1U);
+}
+
+void JobThrottle::jobSent(uint64_t msgsSent, uint32_t blocks, TimePoint when)
+{
+  fJobsOut.push_back(make_pair(msgsSent, when));
+
+  if (fJobBlocksLow == 0 || blocks < fJobBlocksLow)
+    fJobBlocksLow = blocks;
+
+  fJobBlocksHigh = max(fJobBlocksHigh, blocks);
+}
+
+void JobThrottle::responseRead(const messageqcpp::ByteStream& bs)
+{
+  // a row group comes after the headers, an error msg is only the headers or has a Status
+  if (bs.length() <= sizeof(ISMPacketHeader) + sizeof(PrimitiveHeader))
+    return;
+
+  const ISMPacketHeader* ism = reinterpret_cast<const ISMPacketHeader*>(bs.buf());
+
+  if (ism->Status == 0)
+    fPMQueueDepth = max(fPMQueueDepth, (uint32_t)ism->Size);
+}
+
+bool JobThrottle::adapt(uint64_t msgsRecvd, TimePoint now)
+{
+  while (!fJobsOut.empty() && fJobsOut.front().first <= msgsRecvd)
+  {
+    uint64_t latency = chrono::duration_cast<chrono::microseconds>(now - fJobsOut.front().second).count();
+    fJobLatency = (fJobLatency == 0 ? latency : (fJobLatency * 7 + latency) / 8);
+    fLatencySamples++;
+    fJobsOut.pop_front();
+  }
+
+  if (fLatencySamples < JOBS_PER_ADJUSTMENT)
+    return false;
+
+  bool overloaded = fUMBacklog || fPMQueueDepth > PM_QUEUE_HIGH;
+
+  if (overloaded)
+    fSendWindow = max(fSendWindow / 2, fMinSendWindow);
+  else if (fPMQueueDepth <= PM_QUEUE_LOW)
+    fSendWindow = min(fSendWindow + max<uint64_t>(fMaxSendWindow / 16, 1), fMaxSendWindow);
+
+  if (!overloaded && fJobLatency < FAST_JOB_USEC && fJobSizeShift < MAX_JOB_SIZE_SHIFT)
+    fJobSizeShift++;
+  else if (fJobLatency > SLOW_JOB_USEC && fJobSizeShift > MIN_JOB_SIZE_SHIFT)
+    fJobSizeShift--;
+
+  fSendWindowLow = min(fSendWindowLow, fSendWindow);
+  fSendWindowHigh = max(fSendWindowHigh, fSendWindow);
+
+  fPMQueueDepth = 0;
+  fUMBacklog = false;
+  fLatencySamples = 0;
+  return true;
+}
+
+string JobThrottle::miniStats() const
+{
+  ostringstream oss;
+  oss << fJobBlocksLow << "-" << fJobBlocksHigh << ":" << fSendWindowLow << "-" << fSendWindowHigh;
+  return oss.str();
+}
+
+}  // namespace joblist
@@ -0,0 +1,129 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+#include "bytestream.h"
+
+namespace joblist
+{
+/** @brief The job size and the send window of a TupleBPS scan
+ *
+ * Resizes the jobs and the send window once every JOBS_PER_ADJUSTMENT jobs.
+ *
+ * A job counts as done once msgsRecvd passes what msgsSent was right after
+ * it went out. The PMs work on several jobs at a time, so that's only close
+ * to its latency, which is enough to tell cheap jobs from expensive ones.
+ * Cheap jobs are mostly msg overhead and get twice as big, expensive ones
+ * half as big so that they spread over more PM threads and start returning
+ * sooner.
+ *
+ * More outstanding blocks than a busy PM or a backed up UM can take only
+ * wait in a queue and hold memory. Either one halves the send window, it
+ * grows back a bit at a time while the PMs have threads to spare.
+ *
+ * Not thread-safe, TupleBPS guards it with tplMutex.
+ */
+class JobThrottle
+{
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+
+  static constexpr int32_t MIN_JOB_SIZE_SHIFT = -2;  // a quarter of the default job size
+  static constexpr int32_t MAX_JOB_SIZE_SHIFT = 3;   // 8 times it
+  static constexpr uint32_t MIN_SEND_WINDOW_SHIFT = 3;
+  static constexpr uint32_t PM_QUEUE_HIGH = 4;  // jobs waiting per PM thread
+  static constexpr uint32_t PM_QUEUE_LOW = 1;
+  static constexpr uint64_t FAST_JOB_USEC = 5000;
+  static constexpr uint64_t SLOW_JOB_USEC = 200000;
+  static constexpr uint32_t JOBS_PER_ADJUSTMENT = 8;
+
+  // starts out the way it always was, the default job size and the whole window
+  explicit JobThrottle(uint64_t maxSendWindow = 1);
+
+  /** @brief blocksPerJob scaled to the current job size, at least 1 */
+  uint32_t jobBlocks(uint32_t blocksPerJob) const;
+
+  /** @brief a job of blocks went out, msgsSent counts it */
+  void jobSent(uint64_t msgsSent, uint32_t blocks, TimePoint when);
+
+  /** @brief a PrimProc response was read
+   *
+   * PrimProc puts its queue depth in the ISM Size field of the row group
+   * responses. The error msgs don't have it, they leave Size at whatever.
+   */
+  void responseRead(const messageqcpp::ByteStream& bs);
+
+  /** @brief DEC flow control was on in a read */
+  void umBacklog()
+  {
+    fUMBacklog = true;
+  }
+
+  /** @brief takes the jobs done by msgsRecvd, returns true if it resized */
+  bool adapt(uint64_t msgsRecvd, TimePoint now);
+
+  uint64_t sendWindow() const
+  {
+    return fSendWindow;
+  }
+  uint64_t minSendWindow() const
+  {
+    return fMinSendWindow;
+  }
+  uint64_t maxSendWindow() const
+  {
+    return fMaxSendWindow;
+  }
+  int32_t jobSizeShift() const
+  {
+    return fJobSizeShift;
+  }
+  uint64_t jobLatency() const
+  {
+    return fJobLatency;
+  }
+
+  /** @brief the job sizes and send windows so far, for the mini stats */
+  std::string miniStats() const;
+
+ private:
+  int32_t fJobSizeShift;  // the job size is blocksPerJob shifted by this
+  uint64_t fSendWindow;   // logical blocks that may be sent and not received yet
+  uint64_t fMinSendWindow;
+  uint64_t fMaxSendWindow;
+  uint64_t fJobLatency;  // usec, a moving average
+  // since the last adjustment
+  uint32_t fPMQueueDepth;    // jobs waiting per PM thread, the most any response reported
+  bool fUMBacklog;           // DEC flow control was on in a read
+  uint32_t fLatencySamples;  // jobs done
+  // msgsSent right after a job went out and when it did
+  std::deque<std::pair<uint64_t, TimePoint>> fJobsOut;
+  // for the mini stats
+  uint32_t fJobBlocksLow, fJobBlocksHigh;
+  uint64_t fSendWindowLow, fSendWindowHigh;
+};
+
+}  // namespace joblist
@@ -0,0 +1,344 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "threadsafequeue.h"
+
+namespace joblist
+{
+/** @brief A queue of ByteStreams with many writers and one reader
+ *
+ * The DEC reader threads, one per PrimProc connection, push into a ring
+ * of slots claimed with a CAS, so they don't take a lock that the reader
+ * of the queue or each other may hold. The reader only locks to wait for
+ * an empty queue, and a writer only locks to wake it up.
+ *
+ * The ring doesn't block a writer once it is full: a PrimProc connection
+ * carries the messages of every query, so one slow step would hold up
+ * the others. The extra messages go to a locked overflow list instead,
+ * and the DEC flow control keeps that short. The messages of one writer
+ * come out in the order it pushed them.
+ *
+ * Has the part of the ThreadSafeQueue interface the DEC uses.
+ */
+template <typename T>
+class MPSCRing
+{
+ public:
+  typedef T value_type;
+
+  // capacity is rounded up to a power of 2
+  explicit MPSCRing(uint32_t capacity = 1024)
+   : fTail(0), fHead(0), fBytes(0), fCount(0), fOverflowCount(0), fWaiting(false), fShutdown(false), zeroCount(0)
+  {
+    uint64_t slots = 1;
+
+    while (slots < capacity)
+      slots <<= 1;
+
+    fMask = slots - 1;
+    fSlots.reset(new Slot[slots]);
+
+    for (uint64_t i = 0; i < slots; ++i)
+      fSlots[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  /** @brief put an item on the end of the queue
+   *
+   * Returns the bytes and the count in the queue including it.
+   */
+  TSQSize_t push(const T& v)
+  {
+    TSQSize_t ret = {0, 0};
+
+    if (fShutdown)
+      return ret;
+
+    // counted before the reader can see it, so pop() never takes the sums below 0
+    size_t len = v->lengthWithHdrOverhead();
+    ret.size = fBytes.fetch_add(len) + len;
+    ret.count = fCount.fetch_add(1) + 1;
+
+    // once anything overflowed the rest goes after it
+    if (fOverflowCount.load(std::memory_order_acquire) != 0 || !tryPush(v))
+    {
+      boost::mutex::scoped_lock lk(fOverflowLock);
+      fOverflow.push_back(v);
+      fOverflowCount.store(fOverflow.size(), std::memory_order_release);
+    }
+
+    // pairs with the fence in pop(), either it sees v or this sees it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (fWaiting.load(std::memory_order_relaxed))
+    {
+      boost::mutex::scoped_lock lk(fLock);
+      fCond.notify_one();
+    }
+
+    return ret;
+  }
+
+  /** @brief take the front item off the queue
+   *
+   * Blocks until there is one. Returns a default-constructed T after shutdown().
+   */
+  TSQSize_t pop(T* out)
+  {
+    TSQSize_t ret = {0, 0};
+
+    if (fShutdown)
+    {
+      *out = fBs0;
+      return ret;
+    }
+
+    boost::mutex::scoped_lock lk(fLock);
+
+    while (true)
+    {
+      if (fShutdown)
+      {
+        *out = fBs0;
+        return ret;
+      }
+
+      if (take(*out))
+        break;
+
+      fWaiting.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool got = take(*out);
+
+      if (!got)
+        fCond.wait(lk);
+
+      fWaiting.store(false, std::memory_order_relaxed);
+
+      if (got)
+        break;
+    }
+
+    return taken(1, (*out)->lengthWithHdrOverhead());
+  }
+
+  /* If there are less than min elements in the queue, this fcn will return nothing
+   * for up to 10 consecutive calls (poor man's timer).  On the 11th, it will return
+   * the entire queue. */
+  TSQSize_t pop_some(uint32_t divisor, std::vector<T>& t, uint32_t min = 1)
+  {
+    uint32_t curSize, workSize;
+    TSQSize_t ret = {0, 0};
+
+    t.clear();
+
+    if (fShutdown)
+      return ret;
+
+    boost::mutex::scoped_lock lk(fLock);
+    curSize = fCount.load();
+
+    if (curSize < min)
+    {
+      workSize = 0;
+      zeroCount++;
+    }
+    else if (curSize / divisor <= min)
+    {
+      workSize = min;
+      zeroCount = 0;
+    }
+    else
+    {
+      workSize = curSize / divisor;
+      zeroCount = 0;
+    }
+
+    if (zeroCount > 10)
+    {
+      workSize = curSize;
+      zeroCount = 0;
+    }
+
+    size_t bytes = 0;
+    T v;
+
+    for (uint32_t i = 0; i < workSize && take(v); ++i)
+    {
+      bytes += v->lengthWithHdrOverhead();
+      t.push_back(v);
+    }
+
+    return taken(t.size(), bytes);
+  }
+
+  inline void pop_all(std::vector<T>& t)
+  {
+    pop_some(1, t);
+  }
+
+  TSQSize_t size() const
+  {
+    TSQSize_t ret;
+    ret.size = fBytes.load();
+    ret.count = fCount.load();
+    return ret;
+  }
+
+  /** @brief shutdown the queue
+   *
+   * cause the reader blocked in pop() to return a default-constructed T
+   */
+  void shutdown()
+  {
+    fShutdown = true;
+    boost::mutex::scoped_lock lk(fLock);
+    fCond.notify_all();
+  }
+
+  void clear()
+  {
+    boost::mutex::scoped_lock lk(fLock);
+    size_t bytes = 0;
+    uint32_t count = 0;
+    T v;
+
+    while (take(v))
+    {
+      bytes += v->lengthWithHdrOverhead();
+      ++count;
+    }
+
+    taken(count, bytes);
+  }
+
+ private:
+  MPSCRing(const MPSCRing&);
+  MPSCRing& operator=(const MPSCRing&);
+
+  // seq is the position a slot is free for, or one past the one it holds
+  struct Slot
+  {
+    std::atomic<uint64_t> seq;
+    T value;
+  };
+
+  // false if the ring is full
+  bool tryPush(const T& v)
+  {
+    uint64_t pos = fTail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+      Slot& slot = fSlots[pos & fMask];
+      int64_t diff = (int64_t)slot.seq.load(std::memory_order_acquire) - (int64_t)pos;
+
+      if (diff < 0)
+        return false;
+
+      if (diff == 0)
+      {
+        if (fTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          slot.value = v;
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else
+        pos = fTail.load(std::memory_order_relaxed);
+    }
+  }
+
+  // The reader side, under fLock. The ring goes before the overflow.
+  bool take(T& v)
+  {
+    while (true)
+    {
+      Slot& slot = fSlots[fHead & fMask];
+
+      if (slot.seq.load(std::memory_order_acquire) == fHead + 1)
+      {
+        v = slot.value;
+        slot.value = T();
+        slot.seq.store(fHead + fMask + 1, std::memory_order_release);
+        ++fHead;
+        return true;
+      }
+
+      if (fTail.load(std::memory_order_acquire) == fHead)
+        break;
+
+      // a writer got the slot and is about to fill it, and what it wrote
+      // before may be in the slots after it
+      std::this_thread::yield();
+    }
+
+    if (fOverflowCount.load(std::memory_order_acquire) == 0)
+      return false;
+
+    boost::mutex::scoped_lock lk(fOverflowLock);
+
+    if (fOverflow.empty())
+      return false;
+
+    v = fOverflow.front();
+    fOverflow.pop_front();
+    fOverflowCount.store(fOverflow.size(), std::memory_order_release);
+    return true;
+  }
+
+  TSQSize_t taken(uint32_t count, size_t bytes)
+  {
+    TSQSize_t ret;
+    ret.size = fBytes.fetch_sub(bytes) - bytes;
+    ret.count = fCount.fetch_sub(count) - count;
+    return ret;
+  }
+
+  std::unique_ptr<Slot[]> fSlots;
+  uint64_t fMask;
+  alignas(64) std::atomic<uint64_t> fTail;  // the next slot to claim
+  alignas(64) uint64_t fHead;               // the next slot to take, fLock
+  std::atomic<size_t> fBytes;
+  std::atomic<uint32_t> fCount;
+
+  boost::mutex fOverflowLock;
+  std::deque<T> fOverflow;
+  std::atomic<size_t> fOverflowCount;
+
+  boost::mutex fLock;  // the reader side
+  boost::condition fCond;
+  std::atomic<bool> fWaiting;
+  std::atomic<bool> fShutdown;
+  uint32_t zeroCount;  // counts the # of times pop_some returned 0
+  T fBs0;
+};
+
+}  // namespace joblist
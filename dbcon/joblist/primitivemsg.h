@@ -287,6 +287,10 @@ struct ISMPacketHeader
   uint16_t Status;
 };
 
+// ISMPacketHeader::Flags of a BATCH_PRIMITIVE_CREATE, the format of the rest of the msg.
+// Older versions send 0, their Commands carry the query and step UUIDs.
+const uint16_t BPP_CREATE_FORMAT_VERSION = 1;
+
 //      Primitive request/response structure Header
 //@Bug 2744 changed all variables to 32 bit, and took out StatementID
 // Changing this structure one !MUST! align ColResultHeader
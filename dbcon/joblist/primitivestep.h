@@ -57,6 +57,7 @@
 #include "distributedenginecomm.h"
 #include "lbidlist.h"
 #include "joblisttypes.h"
+#include "jobthrottle.h"
 #include "timestamp.h"
 #include "timeset.h"
 #include "resourcemanager.h"
@@ -1425,22 +1426,29 @@ class TupleBPS : public BatchPrimitive, public TupleDeliveryStep
   std::vector<std::shared_ptr<JoinLocalData>> joinLocalDataPool;
 
   /* shared nothing support */
+  // The blocks of an extent still to be sent. sendJobs() cuts the job msgs
+  // out of it as it goes, so they get the job size of the moment.
   struct Job
   {
-    Job(uint32_t d, uint32_t n, uint32_t b, boost::shared_ptr<messageqcpp::ByteStream>& bs)
-     : dbroot(d), connectionNum(n), expectedResponses(b), msg(bs)
+    Job(uint32_t e, uint32_t d, uint32_t n, BRM::LBID_t l, uint32_t b, uint32_t j)
+     : extentIndex(e), dbroot(d), connectionNum(n), startingLBID(l), blocks(b), blocksPerJob(j)
     {
     }
+    uint32_t extentIndex;  // into scannedExtents
     uint32_t dbroot;
     uint32_t connectionNum;
-    uint32_t expectedResponses;
-    boost::shared_ptr<messageqcpp::ByteStream> msg;
+    BRM::LBID_t startingLBID;
+    uint32_t blocks;        // logical blocks left to send
+    uint32_t blocksPerJob;  // before adaptJobs() scales it
   };
 
   void prepCasualPartitioning();
   void makeJobs(std::vector<Job>* jobs);
-  void interleaveJobs(std::vector<Job>* jobs) const;
-  void sendJobs(const std::vector<Job>& jobs);
+  void sendJobs(std::vector<Job>& jobs);
+  void adaptJobs();
+
+  JobThrottle fThrottle;  // the job size and send window, guarded by tplMutex
+
   uint32_t numDBRoots;
 
   /* Pseudo column filter processing.  Think about refactoring into a separate class. */
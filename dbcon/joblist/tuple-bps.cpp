@@ -27,6 +27,7 @@
 #include <ctime>
 #include <sys/time.h>
 #include <deque>
+#include <chrono>
 using namespace std;
 
 #include <boost/thread.hpp>
@@ -291,6 +292,8 @@ void TupleBPS::initializeConfigParms()
   if (fRequestSize >= fMaxOutstandingRequests)
     fRequestSize = 1;
 
+  fThrottle = JobThrottle((uint64_t)fMaxOutstandingRequests << LOGICAL_EXTENT_CONVERTER);
+
   if ((fSessionId & 0x80000000) == 0)
   {
     fMaxNumThreads = fRm->getJlNumScanReceiveThreads();
@@ -1397,103 +1400,83 @@ uint32_t TupleBPS::nextBand(ByteStream& bs)
   return rowCount;
 }
 
-/* The current interleaving rotates over PMs, clustering jobs for a single PM
- * by dbroot to keep block accesses adjacent & make best use of prefetching &
- * cache.
+/* The jobs rotate over PMs, clustered for a single PM by dbroot to keep
+ * block accesses adjacent & make best use of prefetching & cache. A job msg
+ * is only made when its turn comes, with the job size adaptJobs() has
+ * settled on by then.
  */
-void TupleBPS::interleaveJobs(vector<Job>* jobs) const
+void TupleBPS::sendJobs(vector<Job>& jobs)
 {
-  vector<Job> newJobs;
   uint32_t i;
   uint32_t pmCount = 0;
-  scoped_array<deque<Job>> bins;
+  ByteStream bs;
+  boost::unique_lock<boost::mutex> tplLock(tplMutex, boost::defer_lock);
 
   // the input is grouped by dbroot
+  for (i = 0; i < jobs.size(); i++)
+    if (pmCount < jobs[i].connectionNum + 1)
+      pmCount = jobs[i].connectionNum + 1;
 
-  if (pmCount == 1)
-    return;
-
-  /* Need to get the 'real' PM count */
-  for (i = 0; i < jobs->size(); i++)
-    if (pmCount < (*jobs)[i].connectionNum + 1)
-      pmCount = (*jobs)[i].connectionNum + 1;
-
-  bins.reset(new deque<Job>[pmCount]);
+  vector<deque<Job*>> bins(pmCount);
 
-  // group by connection number
-  for (i = 0; i < jobs->size(); i++)
-    bins[(*jobs)[i].connectionNum].push_back((*jobs)[i]);
+  for (i = 0; i < jobs.size(); i++)
+    bins[jobs[i].connectionNum].push_back(&jobs[i]);
 
-  // interleave by connection num
-  bool noWorkDone;
+  bool workDone = true;
 
-  while (newJobs.size() < jobs->size())
+  while (workDone && !cancelled())
   {
-    noWorkDone = true;
+    workDone = false;
 
-    for (i = 0; i < pmCount; i++)
+    for (i = 0; i < pmCount && !cancelled(); i++)
     {
-      if (!bins[i].empty())
-      {
-        newJobs.push_back(bins[i].front());
-        bins[i].pop_front();
-        noWorkDone = false;
-      }
-    }
-
-    idbassert(!noWorkDone);
-  }
+      if (bins[i].empty())
+        continue;
 
-#if 0
-    /* Work in progress */
-    // up to this point, only the first connection to a PM is used.
-    // the last step is to round-robin on the connections of each PM.
-    // ex: on a 3 PM system where connections per PM is 2,
-    // connections 0 and 3 are for PM 1, 1 and 4 are PM2, 2 and 5 are PM3.
-    uint32_t* jobCounters = (uint32_t*) alloca(pmCount * sizeof(uint32_t));
-    memset(jobCounters, 0, pmCount * sizeof(uint32_t));
-
-    for (i = 0; i < newJobs.size(); i++)
-    {
-        uint32_t& conn = newJobs[i].connectionNum;  // for readability's sake
-        conn = conn + (pmCount * jobCounters[conn]);
-        jobCounters[conn]++;
-    }
+      Job& job = *bins[i].front();
+      tplLock.lock();
+      uint32_t blocksThisJob = min(job.blocks, fThrottle.jobBlocks(job.blocksPerJob));
+      tplLock.unlock();
 
-#endif
+      fBPP->setLBID(job.startingLBID, scannedExtents[job.extentIndex]);
+      fBPP->setCount(blocksThisJob);
+      fBPP->runBPP(bs, job.connectionNum);
+      fBPP->reset();
+      job.blocks -= blocksThisJob;
+      job.startingLBID += fColType.colWidth * blocksThisJob;
 
-  jobs->swap(newJobs);
-  //	cout << "-------------\n";
-  //	for (i = 0; i < jobs->size(); i++)
-  //		cout << "job " << i+1 << ": dbroot " << (*jobs)[i].dbroot << ", PM "
-  //				<< (*jobs)[i].connectionNum + 1 << endl;
-}
+      if (job.blocks == 0)
+        bins[i].pop_front();
 
-void TupleBPS::sendJobs(const vector<Job>& jobs)
-{
-  uint32_t i;
-  boost::unique_lock<boost::mutex> tplLock(tplMutex, boost::defer_lock);
+      fDec->write(uniqueID, bs);
+      workDone = true;
+      tplLock.lock();
+      msgsSent += blocksThisJob;
+      fThrottle.jobSent(msgsSent, blocksThisJob, chrono::steady_clock::now());
 
-  for (i = 0; i < jobs.size() && !cancelled(); i++)
-  {
-    fDec->write(uniqueID, *(jobs[i].msg));
-    tplLock.lock();
-    msgsSent += jobs[i].expectedResponses;
+      if (recvWaiting)
+        condvar.notify_all();
 
-    if (recvWaiting)
-      condvar.notify_all();
+      while ((msgsSent - msgsRecvd > fThrottle.sendWindow()) && !fDie)
+      {
+        sendWaiting = true;
+        condvarWakeupProducer.wait(tplLock);
+        sendWaiting = false;
+      }
 
-    while ((msgsSent - msgsRecvd > fMaxOutstandingRequests << LOGICAL_EXTENT_CONVERTER) && !fDie)
-    {
-      sendWaiting = true;
-      condvarWakeupProducer.wait(tplLock);
-      sendWaiting = false;
+      tplLock.unlock();
     }
-
-    tplLock.unlock();
   }
 }
 
+/* Called with tplMutex held after every read. See JobThrottle. */
+void TupleBPS::adaptJobs()
+{
+  if (fThrottle.adapt(msgsRecvd, chrono::steady_clock::now()))
+    THROTTLEDEBUG << "adaptJobs: latency " << fThrottle.jobLatency() << " window " << fThrottle.sendWindow()
+                  << " job size shift " << fThrottle.jobSizeShift() << endl;
+}
+
 template <typename T>
 bool TupleBPS::compareSingleValue(uint8_t COP, T val1, T val2) const
 {
@@ -1802,7 +1785,6 @@ bool TupleBPS::processPseudoColFilters(uint32_t extentIndex,
 
 void TupleBPS::makeJobs(vector<Job>* jobs)
 {
-  boost::shared_ptr<ByteStream> bs;
   uint32_t i;
   uint32_t lbidsToScan;
   uint32_t blocksToScan;
@@ -1908,20 +1890,9 @@ void TupleBPS::makeJobs(vector<Job>* jobs)
 
     startingLBID = scannedExtents[i].range.start;
 
-    while (blocksToScan > 0)
-    {
-      uint32_t blocksThisJob = min(blocksToScan, blocksPerJob);
-
-      fBPP->setLBID(startingLBID, scannedExtents[i]);
-      fBPP->setCount(blocksThisJob);
-      bs.reset(new ByteStream());
-      fBPP->runBPP(*bs, (*dbRootConnectionMap)[scannedExtents[i].dbRoot]);
-      jobs->push_back(
-          Job(scannedExtents[i].dbRoot, (*dbRootConnectionMap)[scannedExtents[i].dbRoot], blocksThisJob, bs));
-      blocksToScan -= blocksThisJob;
-      startingLBID += fColType.colWidth * blocksThisJob;
-      fBPP->reset();
-    }
+    if (blocksToScan > 0)
+      jobs->push_back(Job(i, scannedExtents[i].dbRoot, (*dbRootConnectionMap)[scannedExtents[i].dbRoot],
+                          startingLBID, blocksToScan, blocksPerJob));
   }
 }
 
@@ -1937,7 +1908,6 @@ void TupleBPS::sendPrimitiveMessages()
   try
   {
     makeJobs(&jobs);
-    interleaveJobs(&jobs);
     sendJobs(jobs);
   }
   catch (...)
@@ -2263,11 +2233,18 @@ void TupleBPS::receiveMultiPrimitiveMessages()
       {
         if (bsv[z]->length() > 0 && fBPP->countThisMsg(*(bsv[z])))
           ++msgsRecvd;
+
+        fThrottle.responseRead(*bsv[z]);
       }
 
+      if (flowControlOn)
+        fThrottle.umBacklog();
+
+      adaptJobs();
+
       //@Bug 1424,1298
 
-      if (sendWaiting && ((msgsSent - msgsRecvd) <= (fMaxOutstandingRequests << LOGICAL_EXTENT_CONVERTER)))
+      if (sendWaiting && ((msgsSent - msgsRecvd) <= fThrottle.sendWindow()))
       {
         condvarWakeupProducer.notify_one();
         THROTTLEDEBUG << "receiveMultiPrimitiveMessages wakes up sending side .. "
@@ -3127,7 +3104,7 @@ void TupleBPS::formatMiniStats()
       << "PM " << alias() << " " << fTableOid << " " << fBPP->toMiniString() << " " << fPhysicalIO << " "
       << fCacheIO << " " << fNumBlksSkipped << " "
       << JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()) << " " << ridsReturned
-      << " ";
+      << " " << fThrottle.miniStats() << " ";
 
   fMiniInfo += oss.str();
 }
@@ -34,6 +34,7 @@ using namespace querytele;
 #include "jlf_common.h"
 #include "resourcemanager.h"
 #include "tupleunion.h"
+#include "configcpp.h"
 
 using namespace std;
 using namespace std::tr1;
@@ -56,6 +57,12 @@ inline double exp10(double x)
 }  // namespace
 #endif
 
+namespace
+{
+// the most RowAggStorages the distinct rows are partitioned into when spilling is allowed
+const uint32_t maxDiskPartitions = 16;
+}  // namespace
+
 namespace joblist
 {
 inline uint64_t TupleUnion::Hasher::operator()(const RowPosition& p) const
@@ -211,7 +218,18 @@ void TupleUnion::readInput(uint32_t which)
       l_inputRG.setData(&inRGData);
       l_inputRG.getRow(0, &inRow);
 
-      if (distinct)
+      if (distinct && !diskPartitions.empty())
+      {
+        l_tmpRG.resetRowGroup(0);
+        l_tmpRG.getRow(0, &tmpRow);
+        l_tmpRG.setRowCount(l_inputRG.getRowCount());
+
+        for (uint32_t i = 0; i < l_inputRG.getRowCount(); i++, inRow.nextRow(), tmpRow.nextRow())
+          normalize(inRow, &tmpRow);
+
+        addToDiskPartitions(l_tmpRG);
+      }
+      else if (distinct)
       {
         memDiff = 0;
         l_tmpRG.resetRowGroup(0);
@@ -286,6 +304,27 @@ void TupleUnion::readInput(uint32_t which)
     while (more)
       more = dl->next(it, &inRGData);
 
+  // the last distinct input to finish sends out the rows of the disk partitions
+  if (distinct && !diskPartitions.empty())
+  {
+    bool lastDistinct;
+
+    {
+      boost::mutex::scoped_lock lk(uniquerMutex);
+      lastDistinct = (++distinctDone == distinctCount);
+    }
+
+    if (lastDistinct && !cancelled())
+    {
+      vector<uint64_t> flushers;
+
+      for (uint32_t i = 0; i < diskPartitions.size(); i++)
+        flushers.push_back(jobstepThreadPool.invoke(DiskPartitionFlusher(this, i)));
+
+      jobstepThreadPool.join(flushers);
+    }
+  }
+
   {
     boost::mutex::scoped_lock lock1(uniquerMutex);
     boost::mutex::scoped_lock lock2(sMutex);
@@ -293,7 +332,7 @@ void TupleUnion::readInput(uint32_t which)
     if (!distinct && l_outputRG.getRowCount() > 0)
       output->insert(outRGData);
 
-    if (distinct)
+    if (distinct && diskPartitions.empty())
     {
       getOutput(&l_outputRG, &outRow, &outRGData);
 
@@ -334,6 +373,75 @@ void TupleUnion::readInput(uint32_t which)
   }
 }
 
+void TupleUnion::addToDiskPartitions(RowGroup& rg)
+{
+  vector<vector<pair<uint32_t, uint64_t> > > partRows(diskPartitions.size());  // (row, hash)
+  Row r;
+  rg.initRow(&r);
+  rg.getRow(0, &r);
+  uint32_t lastCol = r.getColumnCount() - 1;
+
+  for (uint32_t i = 0; i < rg.getRowCount(); i++, r.nextRow())
+  {
+    uint64_t hash = hashRow(r, lastCol);
+    // the low bits of the hash pick the bucket inside the storage
+    partRows[(hash >> 32) % diskPartitions.size()].push_back(make_pair(i, hash));
+  }
+
+  for (uint32_t p = 0; p < diskPartitions.size(); p++)
+  {
+    if (partRows[p].empty())
+      continue;
+
+    DiskPartition& part = *diskPartitions[p];
+    boost::mutex::scoped_lock lk(part.mutex);
+
+    for (const auto& row : partRows[p])
+    {
+      rg.getRow(row.first, &r);
+
+      if (part.storage->getTargetRow(r, row.second, part.row))
+        copyRow(r, &part.row);
+    }
+
+    part.storage->dump();
+  }
+}
+
+void TupleUnion::flushDiskPartition(uint32_t which)
+{
+  DiskPartition& part = *diskPartitions[which];
+
+  try
+  {
+    // there is nothing to aggregate, finalize() only drops the rows repeated across generations
+    part.storage->finalize([](Row&) {}, part.row);
+
+    while (auto rgData = part.storage->getNextRGData())
+    {
+      if (cancelled())
+        break;
+
+      part.rg.setData(rgData.get());
+      uint64_t rowCount = part.rg.getRowCount();
+
+      if (rowCount == 0)
+        continue;
+
+      boost::mutex::scoped_lock lk(sMutex);
+      output->insert(*rgData);
+      fRowsReturned += rowCount;
+    }
+  }
+  catch (...)
+  {
+    handleException(std::current_exception(), logging::unionStepErr, logging::ERR_UNION_TOO_BIG,
+                    "TupleUnion::flushDiskPartition()");
+    status(logging::unionStepErr);
+    abort();
+  }
+}
+
 uint32_t TupleUnion::nextBand(messageqcpp::ByteStream& bs)
 {
   RGData mem;
@@ -1198,6 +1306,25 @@ void TupleUnion::run()
     }
   }
 
+  if (distinctCount > 0 && rm->getAllowDiskAggregation())
+  {
+    // the config AllowDiskBasedAggregation came from
+    config::Config* config = rm->getConfig();
+    string tmpDir = config->getTempFileDir(config::Config::TempDirPurpose::Aggregates);
+    string compStr = config->getConfig("RowAggregation", "Compression");
+    uint32_t partCount = min(2 * distinctCount, maxDiskPartitions);
+
+    for (i = 0; i < partCount; i++)
+    {
+      DiskPartition* part = new DiskPartition();
+      diskPartitions.emplace_back(part);
+      part->rg = outputRG;
+      part->rg.initRow(&part->row);
+      part->storage.reset(new RowAggStorage(tmpDir, &part->rg, outputRG.getColumnCount(), rm, sessionMemLimit,
+                                            true, true, compress::getCompressInterfaceByName(compStr)));
+    }
+  }
+
   runners.reserve(inputs.size());
 
   for (i = 0; i < inputs.size(); i++)
@@ -1220,6 +1347,7 @@ void TupleUnion::join()
   runners.clear();
   uniquer->clear();
   rowMemory.clear();
+  diskPartitions.clear();
   rm->returnMemory(memUsage, sessionMemLimit);
   memUsage = 0;
 }
@@ -36,6 +36,7 @@
 
 #include "stlpoolallocator.h"
 #include "threadnaming.h"
+#include "rowstorage.h"
 
 #pragma once
 
@@ -126,6 +127,8 @@ class TupleUnion : public JobStep, public TupleDeliveryStep
   void normalize(const rowgroup::Row& in, rowgroup::Row* out);
   void writeNull(rowgroup::Row* out, uint32_t col);
   void readInput(uint32_t);
+  void addToDiskPartitions(rowgroup::RowGroup& rg);
+  void flushDiskPartition(uint32_t);
   void formatMiniStats();
 
   execplan::CalpontSystemCatalog::OID fTableOID;
@@ -157,6 +160,32 @@ class TupleUnion : public JobStep, public TupleDeliveryStep
   };
   std::vector<uint64_t> runners;  // thread pool handles
 
+  struct DiskPartitionFlusher
+  {
+    TupleUnion* tu;
+    uint32_t index;
+    DiskPartitionFlusher(TupleUnion* t, uint32_t in) : tu(t), index(in)
+    {
+    }
+    void operator()()
+    {
+      utils::setThreadName("TUSDiskFlush");
+      tu->flushDiskPartition(index);
+    }
+  };
+
+  // With disk aggregation allowed the distinct rows go into hash partitioned
+  // RowAggStorages instead of the uniquer.  They spill to disk like GROUP BY does
+  // and are sent out once every distinct input has been read.
+  struct DiskPartition
+  {
+    boost::mutex mutex;
+    rowgroup::RowGroup rg;
+    rowgroup::Row row;
+    std::unique_ptr<rowgroup::RowAggStorage> storage;
+  };
+  std::vector<std::unique_ptr<DiskPartition> > diskPartitions;
+
   struct Hasher
   {
     TupleUnion* ts;
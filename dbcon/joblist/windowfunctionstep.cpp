@@ -1530,37 +1530,46 @@ void WindowFunctionStep::updateWindowCols(ParseTree* pt, const map<uint64_t, uin
   }
 }
 
+void WindowFunctionStep::getSortMemory(uint64_t n)
+{
+  uint64_t memAdd = n * sizeof(ordering::KeyedRow<RowPosition>);
+  fMemUsage += memAdd;
+
+  if (fRm->getMemory(memAdd, fSessionMemLimit) == false)
+    throw IDBExcept(ERR_WF_DATA_SET_TOO_BIG);
+}
+
+void WindowFunctionStep::returnSortMemory(uint64_t n)
+{
+  uint64_t mem = n * sizeof(ordering::KeyedRow<RowPosition>);
+  fMemUsage -= mem;
+  fRm->returnMemory(mem, fSessionMemLimit);
+}
+
 void WindowFunctionStep::sort(std::vector<RowPosition>::iterator v, uint64_t n)
 {
-  // recursive function termination condition.
   if (n < 2 || cancelled())
     return;
 
-  RowPosition p = *(v + n / 2);                   // pivot value
-  vector<RowPosition>::iterator l = v;            // low   address
-  vector<RowPosition>::iterator h = v + (n - 1);  // high  address
+  getSortMemory(n);
 
-  while (l <= h && !cancelled())
+  // sort on normalized keys, the rows are only compared column by column on key ties
+  std::vector<ordering::KeyedRow<RowPosition> > rows(n);
+
+  for (uint64_t i = 0; i < n; i++)
   {
-    // Can use while here, but need check boundary and cancel status.
-    if (fQueryOrderBy->operator()(getPointer(*l), getPointer(p)))
-    {
-      l++;
-    }
-    else if (fQueryOrderBy->operator()(getPointer(p), getPointer(*h)))
-    {
-      h--;
-    }
-    else
-    {
-      RowPosition t = *l;  // temp value for swap
-      *l++ = *h;
-      *h-- = t;
-    }
+    rows[i].fPayload = *(v + i);
+    rows[i].fData = getPointer(rows[i].fPayload);
+    rows[i].fKey = fQueryOrderBy->sortKey(rows[i].fData);
   }
 
-  sort(v, std::distance(v, h) + 1);
-  sort(l, std::distance(l, v) + n);
+  fQueryOrderBy->sort(rows, [this]() { return cancelled(); });
+
+  for (uint64_t i = 0; i < n; i++)
+    *(v + i) = rows[i].fPayload;
+
+  std::vector<ordering::KeyedRow<RowPosition> >().swap(rows);
+  returnSortMemory(n);
 }
 
 void WindowFunctionStep::printCalTrace()
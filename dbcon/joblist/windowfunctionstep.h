@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "../../utils/windowfunction/idborderby.h"
 #include "jobstep.h"
 #include "rowgroup.h"
@@ -116,6 +118,10 @@ class WindowFunctionStep : public JobStep, public TupleDeliveryStep
     return row.getPointer();
   }
 
+  // the keyed copy of n rows that a sort works on, throws if it is over the memory limit
+  void getSortMemory(uint64_t n);
+  void returnSortMemory(uint64_t n);
+
  private:
   void execute();
   void doFunction();
@@ -215,8 +221,8 @@ class WindowFunctionStep : public JobStep, public TupleDeliveryStep
   uint64_t fQueryLimitStart;
   uint64_t fQueryLimitCount;
 
-  // for resource management
-  uint64_t fMemUsage;
+  // for resource management, the function threads add to it
+  std::atomic<uint64_t> fMemUsage;
   ResourceManager* fRm;
   boost::shared_ptr<int64_t> fSessionMemLimit;
 
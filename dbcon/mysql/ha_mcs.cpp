@@ -38,6 +38,8 @@ handlerton* mcs_hton = NULL;
 static handlerton* mcs_maria_hton = NULL;
 char cs_version[25];
 char cs_commit_hash[41];  // a commit hash is 40 characters
+std::atomic<uint64_t> cs_result_cache_hits(0);
+std::atomic<uint64_t> cs_result_cache_misses(0);
 
 // handlers creation function for hton.
 // Look into ha_mcs_pushdown.* for more details.
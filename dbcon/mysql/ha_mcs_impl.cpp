@@ -294,6 +294,69 @@ bool onlyOneTableinTM(cal_impl_if::cal_connection_info* ci)
   return true;
 }
 
+// Works out once per scan what fetchNextRow() used to check for every column of every row.
+void buildFieldStorePlan(sm::cpsm_tplsch_t* scan, int num_attr)
+{
+  std::vector<CalpontSystemCatalog::ColType>& colTypes = scan->ctp;
+  RowGroup* rowGroup = scan->rowGroup;
+  bool tableMode = scan->traceFlags & execplan::CalpontSelectExecutionPlan::TRACE_TUPLE_OFF;
+
+  // table mode mysql expects all columns of the table. mapping between columnoid and position in rowgroup
+  // set coltype.position to be the position in rowgroup.
+  if (tableMode)
+  {
+    for (uint32_t i = 0; i < rowGroup->getColumnCount(); i++)
+    {
+      int oid = rowGroup->getOIDs()[i];
+      int j = 0;
+
+      for (; j < num_attr; j++)
+      {
+        // mysql should haved eliminated duplicate projection columns
+        if (oid == colTypes[j].columnOID || oid == colTypes[j].ddn.dictOID)
+        {
+          colTypes[j].colPosition = i;
+          break;
+        }
+      }
+    }
+  }
+
+  // get coltype if not there yet
+  if (num_attr > 0 && colTypes[0].colWidth == 0)
+  {
+    for (short c = 0; c < num_attr; c++)
+    {
+      colTypes[c].colPosition = c;
+      colTypes[c].colWidth = rowGroup->getColumnWidth(c);
+      colTypes[c].colDataType = rowGroup->getColTypes()[c];
+      colTypes[c].columnOID = rowGroup->getOIDs()[c];
+      colTypes[c].scale = rowGroup->getScale()[c];
+      colTypes[c].precision = rowGroup->getPrecision()[c];
+    }
+  }
+
+  scan->storePlan.resize(num_attr);
+
+  for (int p = 0; p < num_attr; p++)
+  {
+    const CalpontSystemCatalog::ColType& colType = colTypes[p];
+    sm::FieldStorePlan& plan = scan->storePlan[p];
+
+    // table mode handling
+    plan.rowPos = tableMode ? colType.colPosition : p;
+    // precision == -16 is borrowed as skip null check indicator for bit ops.
+    plan.checkNull = colType.precision != -16;
+    plan.emptyStringForNull = colType.colDataType == CalpontSystemCatalog::CHAR ||
+                              colType.colDataType == CalpontSystemCatalog::VARCHAR ||
+                              colType.colDataType == CalpontSystemCatalog::VARBINARY;
+    plan.handler = colType.typeHandler();
+  }
+
+  rowGroup->initRow(&scan->row);
+  scan->storePlanReady = true;
+}
+
 int fetchNextRow(uchar* buf, cal_table_info& ti, cal_connection_info* ci, long timeZone,
                  bool handler_flag = false)
 {
@@ -346,87 +409,34 @@ int fetchNextRow(uchar* buf, cal_table_info& ti, cal_connection_info* ci, long t
       memset(ti.msTablePtr->null_flags, -1, ti.msTablePtr->s->null_bytes);
     }
 
-    std::vector<CalpontSystemCatalog::ColType>& colTypes = ti.tpl_scan_ctx->ctp;
-
-    RowGroup* rowGroup = ti.tpl_scan_ctx->rowGroup;
-
-    // table mode mysql expects all columns of the table. mapping between columnoid and position in rowgroup
-    // set coltype.position to be the position in rowgroup. only set once.
-    if (ti.tpl_scan_ctx->rowsreturned == 0 &&
-        (ti.tpl_scan_ctx->traceFlags & execplan::CalpontSelectExecutionPlan::TRACE_TUPLE_OFF))
-    {
-      for (uint32_t i = 0; i < rowGroup->getColumnCount(); i++)
-      {
-        int oid = rowGroup->getOIDs()[i];
-        int j = 0;
+    sm::cpsm_tplsch_t* scan = ti.tpl_scan_ctx.get();
+    std::vector<CalpontSystemCatalog::ColType>& colTypes = scan->ctp;
 
-        for (; j < num_attr; j++)
-        {
-          // mysql should haved eliminated duplicate projection columns
-          if (oid == colTypes[j].columnOID || oid == colTypes[j].ddn.dictOID)
-          {
-            colTypes[j].colPosition = i;
-            break;
-          }
-        }
-      }
-    }
+    if (!scan->storePlanReady)
+      buildFieldStorePlan(scan, num_attr);
 
-    rowgroup::Row row;
-    rowGroup->initRow(&row);
-    rowGroup->getRow(ti.tpl_scan_ctx->rowsreturned, &row);
-    int s;
+    rowgroup::Row& row = scan->row;
+    scan->rowGroup->getRow(scan->rowsreturned, &row);
 
     for (int p = 0; p < num_attr; p++, f++)
     {
       // This col is going to be written
       bitmap_set_bit(ti.msTablePtr->write_set, (*f)->field_index);
 
-      // get coltype if not there yet
-      if (colTypes[0].colWidth == 0)
-      {
-        for (short c = 0; c < num_attr; c++)
-        {
-          colTypes[c].colPosition = c;
-          colTypes[c].colWidth = rowGroup->getColumnWidth(c);
-          colTypes[c].colDataType = rowGroup->getColTypes()[c];
-          colTypes[c].columnOID = rowGroup->getOIDs()[c];
-          colTypes[c].scale = rowGroup->getScale()[c];
-          colTypes[c].precision = rowGroup->getPrecision()[c];
-        }
-      }
+      const sm::FieldStorePlan& plan = scan->storePlan[p];
 
-      CalpontSystemCatalog::ColType colType(colTypes[p]);
-
-      // table mode handling
-      if (ti.tpl_scan_ctx->traceFlags & execplan::CalpontSelectExecutionPlan::TRACE_TUPLE_OFF)
-      {
-        if (colType.colPosition == -1)  // not projected by tuplejoblist
-          continue;
-        else
-          s = colType.colPosition;
-      }
-      else
-      {
-        s = p;
-      }
+      if (plan.rowPos == -1)  // not projected by tuplejoblist
+        continue;
 
-      // precision == -16 is borrowed as skip null check indicator for bit ops.
-      if (row.isNullValue(s) && colType.precision != -16)
+      if (plan.checkNull && row.isNullValue(plan.rowPos))
       {
-        // @2835. Handle empty string and null confusion. store empty string for string column
-        if (colType.colDataType == CalpontSystemCatalog::CHAR ||
-            colType.colDataType == CalpontSystemCatalog::VARCHAR ||
-            colType.colDataType == CalpontSystemCatalog::VARBINARY)
-        {
+        if (plan.emptyStringForNull)
           (*f)->store("", 0, (*f)->charset());
-        }
 
         continue;
       }
 
-      const datatypes::TypeHandler* h = colType.typeHandler();
-      if (!h)
+      if (!plan.handler)
       {
         idbassert(0);
         (*f)->reset();
@@ -436,8 +446,8 @@ int fetchNextRow(uchar* buf, cal_table_info& ti, cal_connection_info* ci, long t
       {
         // fetch and store data
         (*f)->set_notnull();
-        datatypes::StoreFieldMariaDB mf(*f, colType, timeZone);
-        h->storeValueToField(row, s, &mf);
+        datatypes::StoreFieldMariaDB mf(*f, colTypes[p], timeZone);
+        plan.handler->storeValueToField(row, plan.rowPos, &mf);
       }
     }
 
@@ -5014,6 +5024,13 @@ int ha_mcs_impl_pushdown_init(mcs_handler_info* handler_info, TABLE* table)
       if (status != 0)
         goto internal_error;
 
+      // The same SELECT gives the same rows as long as the tables stay the same,
+      // unless it uses the clock, random numbers or variables
+      if (get_result_cache(thd) && thd->lex->sql_command == SQLCOM_SELECT && thd->lex->safe_to_cache_query)
+        csep->traceFlags(csep->traceFlags() | CalpontSelectExecutionPlan::RESULT_CACHE);
+      else
+        csep->traceFlags(csep->traceFlags() & ~CalpontSelectExecutionPlan::RESULT_CACHE);
+
       string query;
       query.assign(idb_mysql_query_str(thd));
       csep->data(query);
@@ -5112,6 +5129,13 @@ int ha_mcs_impl_pushdown_init(mcs_handler_info* handler_info, TABLE* table)
               push_warning(thd, Sql_condition::WARN_LEVEL_WARN, 9999, msg.c_str());
             }
           }
+          else if (csep->traceFlags() & CalpontSelectExecutionPlan::RESULT_CACHE)
+          {
+            if (emsgStr == CalpontSelectExecutionPlan::RESULT_CACHE_HIT)
+              cs_result_cache_hits++;
+            else
+              cs_result_cache_misses++;
+          }
         }
         else
         {
@@ -140,6 +140,10 @@ static MYSQL_THDVAR_ULONG(local_query, PLUGIN_VAR_RQCMDARG,
                           "Enable/disable the ColumnStore local PM query only feature.", NULL, NULL, 0, 0, 2,
                           1);
 
+static MYSQL_THDVAR_BOOL(result_cache, PLUGIN_VAR_NOCMDARG,
+                         "Let ExeMgr answer a SELECT from its result cache, if ResultCache is enabled there",
+                         NULL, NULL, 1);
+
 static MYSQL_THDVAR_ULONG(import_for_batchinsert_delimiter, PLUGIN_VAR_RQCMDARG,
                           "ASCII value of the delimiter used by LDI and INSERT..SELECT",
                           NULL,  // check
@@ -209,6 +213,7 @@ st_mysql_sys_var* mcs_system_variables[] = {MYSQL_SYSVAR(compression_type),
                                             MYSQL_SYSVAR(double_for_decimal_math),
                                             MYSQL_SYSVAR(decimal_overflow_check),
                                             MYSQL_SYSVAR(local_query),
+                                            MYSQL_SYSVAR(result_cache),
                                             MYSQL_SYSVAR(use_import_for_batchinsert),
                                             MYSQL_SYSVAR(import_for_batchinsert_delimiter),
                                             MYSQL_SYSVAR(import_for_batchinsert_enclosed_by),
@@ -219,9 +224,30 @@ st_mysql_sys_var* mcs_system_variables[] = {MYSQL_SYSVAR(compression_type),
                                             MYSQL_SYSVAR(cache_flush_threshold),
                                             NULL};
 
-st_mysql_show_var mcs_status_variables[] = {{"columnstore_version", (char*)&cs_version, SHOW_CHAR},
-                                            {"columnstore_commit_hash", (char*)&cs_commit_hash, SHOW_CHAR},
-                                            {0, 0, (enum_mysql_show_type)0}};
+static int show_result_cache_hits(THD*, st_mysql_show_var* var, void* buff, system_status_var*,
+                                  enum_var_type)
+{
+  var->type = SHOW_LONGLONG;
+  var->value = (char*)buff;
+  *(longlong*)buff = cs_result_cache_hits.load(std::memory_order_relaxed);
+  return 0;
+}
+
+static int show_result_cache_misses(THD*, st_mysql_show_var* var, void* buff, system_status_var*,
+                                    enum_var_type)
+{
+  var->type = SHOW_LONGLONG;
+  var->value = (char*)buff;
+  *(longlong*)buff = cs_result_cache_misses.load(std::memory_order_relaxed);
+  return 0;
+}
+
+st_mysql_show_var mcs_status_variables[] = {
+    {"columnstore_version", (char*)&cs_version, SHOW_CHAR},
+    {"columnstore_commit_hash", (char*)&cs_commit_hash, SHOW_CHAR},
+    {"columnstore_result_cache_hits", (char*)&show_result_cache_hits, SHOW_FUNC},
+    {"columnstore_result_cache_misses", (char*)&show_result_cache_misses, SHOW_FUNC},
+    {0, 0, (enum_mysql_show_type)0}};
 
 void* get_fe_conn_info_ptr(THD* thd)
 {
@@ -441,6 +467,15 @@ void set_local_query(THD* thd, ulong value)
   THDVAR(thd, local_query) = value;
 }
 
+bool get_result_cache(THD* thd)
+{
+  return (thd == NULL) ? false : THDVAR(thd, result_cache);
+}
+void set_result_cache(THD* thd, bool value)
+{
+  THDVAR(thd, result_cache) = value;
+}
+
 mcs_use_import_for_batchinsert_mode_t get_use_import_for_batchinsert_mode(THD* thd)
 {
   return (thd == NULL) ? mcs_use_import_for_batchinsert_mode_t::ON
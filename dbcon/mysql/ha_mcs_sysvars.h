@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <my_config.h>
 #include "idb_mysql.h"
 #include "mcsconfig.h"
@@ -26,6 +28,9 @@ extern st_mysql_sys_var* mcs_system_variables[];
 extern st_mysql_show_var mcs_status_variables[];
 extern char cs_version[];
 extern char cs_commit_hash[];
+// SELECTs ExeMgr answered from its result cache and ran, of those that may use it
+extern std::atomic<uint64_t> cs_result_cache_hits;
+extern std::atomic<uint64_t> cs_result_cache_misses;
 
 // compression_type
 enum mcs_compression_type_t
@@ -123,6 +128,9 @@ void set_decimal_overflow_check(THD* thd, bool value);
 ulong get_local_query(THD* thd);
 void set_local_query(THD* thd, ulong value);
 
+bool get_result_cache(THD* thd);
+void set_result_cache(THD* thd, bool value);
+
 mcs_use_import_for_batchinsert_mode_t get_use_import_for_batchinsert_mode(THD* thd);
 void set_use_import_for_batchinsert_mode(THD* thd, ulong value);
 
@@ -132,11 +132,32 @@ struct Profiler
   }
 };
 
+/** @brief How fetchNextRow() stores one column of the table
+ *
+ * Worked out from ctp when the first row is fetched, so the per row loop
+ * doesn't have to look at the column types again.
+ */
+struct FieldStorePlan
+{
+  int rowPos;     // position in the rowgroup, -1 if the column isn't projected
+  bool checkNull;
+  bool emptyStringForNull;  // @2835. NULL char columns are stored as empty strings
+  const datatypes::TypeHandler* handler;
+};
+
 /** @brief Calpont table scan handle */
 struct cpsm_tplsch_t
 {
   cpsm_tplsch_t()
-   : tableid(0), rowsreturned(0), rowGroup(0), traceFlags(0), bandID(0), saveFlag(0), bandsReturned(0), ctp(0)
+   : tableid(0)
+   , rowsreturned(0)
+   , rowGroup(0)
+   , traceFlags(0)
+   , bandID(0)
+   , saveFlag(0)
+   , bandsReturned(0)
+   , ctp(0)
+   , storePlanReady(false)
   {
   }
   ~cpsm_tplsch_t()
@@ -158,12 +179,18 @@ struct cpsm_tplsch_t
   std::vector<execplan::CalpontSystemCatalog::ColType> ctp;
   std::string errMsg;
   rowgroup::RGData rgData;
+  // fetchNextRow() state, the row is initialized together with the plan
+  std::vector<FieldStorePlan> storePlan;
+  rowgroup::Row row;
+  bool storePlanReady;
   void deserializeTable(messageqcpp::ByteStream& bs)
   {
     if (!rowGroup)
     {
       rowGroup = new rowgroup::RowGroup();
       rowGroup->deserialize(bs);
+      // new metadata, fetchNextRow() has to redo its plan
+      storePlanReady = false;
     }
     else
     {
@@ -22,6 +22,7 @@
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <memory>
 #include <type_traits>
 #ifndef _MSC_VER
 #include <pthread.h>
@@ -55,6 +56,27 @@ namespace
 {
 using MT = uint16_t;
 
+// The LIKE patterns of short strings analyzed last by this thread.  A scan compares every row
+// with the same few filter values, so this saves analyzing them again for every row.
+const size_t shortLikePatternCount = 4;
+thread_local std::unique_ptr<datatypes::LikePattern> shortLikePatterns[shortLikePatternCount];
+thread_local size_t nextShortLikePattern = 0;
+
+const datatypes::LikePattern& shortLikePattern(const datatypes::Charset& cs, const utils::ConstString& pattern)
+{
+  for (const auto& p : shortLikePatterns)
+  {
+    if (p && &p->getCharset() == &cs.getCharset() && p->pattern().length() == pattern.length() &&
+        !memcmp(p->pattern().data(), pattern.str(), pattern.length()))
+      return *p;
+  }
+
+  std::unique_ptr<datatypes::LikePattern>& p = shortLikePatterns[nextShortLikePattern];
+  nextShortLikePattern = (nextShortLikePattern + 1) % shortLikePatternCount;
+  p.reset(new datatypes::LikePattern(cs, pattern));
+  return *p;
+}
+
 inline uint64_t order_swap(uint64_t x)
 {
   uint64_t ret = (x >> 56) | ((x << 40) & 0x00FF000000000000ULL) | ((x << 24) & 0x0000FF0000000000ULL) |
@@ -294,7 +316,7 @@ inline bool colCompareDispatcherT(T1 columnValue, T2 filterValue, uint8_t cop, u
   {
     utils::ConstString subject{reinterpret_cast<const char*>(&columnValue), COL_WIDTH};
     utils::ConstString pattern{reinterpret_cast<const char*>(&filterValue), COL_WIDTH};
-    return typeHolder.like(cop & COMPARE_NOT, subject.rtrimZero(), pattern.rtrimZero());
+    return shortLikePattern(typeHolder, pattern.rtrimZero()).like(cop & COMPARE_NOT, subject.rtrimZero());
   }
 
   if (!rf)
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <boost/scoped_array.hpp>
 #include <boost/algorithm/string/trim.hpp>
+#include <memory>
 #include <sys/types.h>
 using namespace std;
 
@@ -420,6 +421,26 @@ void PrimitiveProcessor::p_Dictionary(const DictInput* in, vector<uint8_t>* out,
 
   in8 = reinterpret_cast<const uint8_t*>(in);
 
+  // analyze the LIKE patterns once for the block instead of once per string
+  vector<unique_ptr<datatypes::LikePattern>> likePatterns(in->NOPS);
+
+  if (in->InputFlags == 1)
+    filterOffset = sizeof(DictInput) + (in->NVALS * sizeof(OldGetSigParams));
+  else
+    filterOffset = sizeof(DictInput) + (in->NVALS * sizeof(PrimToken));
+
+  for (filterIndex = 0; filterIndex < in->NOPS; filterIndex++)
+  {
+    filter = reinterpret_cast<const DictFilterElement*>(&in8[filterOffset]);
+
+    if (filter->COP & COMPARE_LIKE)
+      likePatterns[filterIndex].reset(
+          new datatypes::LikePattern(cs, ConstString((const char*)filter->data, filter->len)));
+
+    filterOffset += sizeof(DictFilterElement) + filter->len;
+  }
+  filter = 0;
+
   {
     void* hp = static_cast<void*>(&header);
     memcpy(hp, in, sizeof(ISMPacketHeader) + sizeof(PrimitiveHeader));
@@ -519,8 +540,12 @@ void PrimitiveProcessor::p_Dictionary(const DictInput* in, vector<uint8_t>* out,
     {
       filter = reinterpret_cast<const DictFilterElement*>(&in8[filterOffset]);
 
-      cmpResult = compare(cs, filter->COP, (const char*)sigptr.data, sigptr.len, (const char*)filter->data,
-                          filter->len);
+      if (likePatterns[filterIndex])
+        cmpResult = likePatterns[filterIndex]->like(filter->COP & COMPARE_NOT,
+                                                    ConstString((const char*)sigptr.data, sigptr.len));
+      else
+        cmpResult = compare(cs, filter->COP, (const char*)sigptr.data, sigptr.len,
+                            (const char*)filter->data, filter->len);
 
       if (!cmpResult && in->BOP != BOP_OR)
         goto no_store;
@@ -96,6 +96,18 @@ uint nextPowOf2(uint x)
   return x;
 }
 
+// The jobs waiting per processing thread, rounded up. Sent back in the
+// ISM Size field of the row group responses, TupleBPS sizes its jobs and
+// send window on it.
+uint16_t processorQueueDepth()
+{
+  if (!ProcessorPool)
+    return 0;
+
+  uint32_t threads = std::max(ProcessorPool->getThreadCount(), 1U);
+  return std::min((ProcessorPool->getWaiting() + threads - 1) / threads, 0xffffU);
+}
+
 BatchPrimitiveProcessor::BatchPrimitiveProcessor()
  : ot(BPS_ELEMENT_TYPE)
  , txnID(0)
@@ -1998,6 +2010,7 @@ void BatchPrimitiveProcessor::writeProjectionPreamble()
   void* php = static_cast<void*>(&ph);
   memset(ismp, 0, sizeof(ISMPacketHeader));
   memset(php, 0, sizeof(PrimitiveHeader));
+  ism.Size = processorQueueDepth();
   ph.SessionID = sessionID;
   ph.StepID = stepID;
   ph.UniqueID = uniqueID;
@@ -2331,6 +2344,32 @@ void BatchPrimitiveProcessor::nextLBID()
 }
 
 SBPP BatchPrimitiveProcessor::duplicate()
+{
+  SBPP bpp = copyDefinition();
+
+  bpp->initProcessor();
+  return bpp;
+}
+
+SBPP BatchPrimitiveProcessor::instantiate(uint32_t txnID, uint32_t sessionID, uint32_t stepID,
+                                          uint32_t uniqueID, const BRM::QueryContext& versionInfo,
+                                          boost::shared_ptr<BPPSendThread> sendThread)
+{
+  SBPP bpp = copyDefinition();
+
+  bpp->txnID = txnID;
+  bpp->sessionID = sessionID;
+  bpp->stepID = stepID;
+  bpp->uniqueID = uniqueID;
+  bpp->versionInfo = versionInfo;
+  bpp->sendThread = sendThread;
+  bpp->firstInstance = true;
+  // the Commands pick up the IDs here
+  bpp->initProcessor();
+  return bpp;
+}
+
+SBPP BatchPrimitiveProcessor::copyDefinition()
 {
   SBPP bpp;
   uint32_t i;
@@ -2462,7 +2501,6 @@ SBPP BatchPrimitiveProcessor::duplicate()
   bpp->hasDictStep = hasDictStep;
   bpp->sendThread = sendThread;
   bpp->newConnection = true;
-  bpp->initProcessor();
   return bpp;
 }
 
@@ -109,6 +109,17 @@ class BatchPrimitiveProcessor
       It's thread-safe wrt resetBPP. */
   SBPP duplicate();
 
+  /* Instantiate() is duplicate() for another query, the copy gets the IDs, version
+      and send thread of that query.  This object is a template kept by BPPTemplates. */
+  SBPP instantiate(uint32_t txnID, uint32_t sessionID, uint32_t stepID, uint32_t uniqueID,
+                   const BRM::QueryContext& versionInfo, boost::shared_ptr<BPPSendThread> sendThread);
+
+  /* A BPP with joins shares the joiners with its duplicates and fills them per query */
+  inline bool canBeTemplate() const
+  {
+    return !doJoin;
+  }
+
   /* These need to be updated */
   // bool operator==(const BatchPrimitiveProcessor&) const;
   // inline bool operator!=(const BatchPrimitiveProcessor& bpp) const
@@ -187,6 +198,8 @@ class BatchPrimitiveProcessor
   BatchPrimitiveProcessor& operator=(const BatchPrimitiveProcessor&);
 
   void initProcessor();
+  // duplicate() without initProcessor()
+  SBPP copyDefinition();
 #ifdef PRIMPROC_STOPWATCH
   void execute(logging::StopWatch* stopwatch);
 #else
@@ -443,6 +456,7 @@ class BatchPrimitiveProcessor
   friend class ScaledFilterCmd;
   friend class StrFilterCmd;
   friend class PseudoCC;
+  friend class BPPTemplates;
 };
 
 }  // namespace primitiveprocessor
@@ -0,0 +1,133 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <sstream>
+#include <stdexcept>
+
+#include "bpptemplates.h"
+#include "primitivemsg.h"
+
+using namespace messageqcpp;
+
+namespace primitiveprocessor
+{
+void BPPTemplates::setMaxBytes(size_t maxBytes)
+{
+  boost::mutex::scoped_lock lk(fLock);
+  fMaxBytes = maxBytes;
+  evict();
+}
+
+void BPPTemplates::evict()
+{
+  while (fBytes > fMaxBytes && !fEntries.empty())
+  {
+    fBytes -= fEntries.back().second->bytes;
+    fIndex.erase(fEntries.back().first);
+    fEntries.pop_back();
+  }
+}
+
+SBPP BPPTemplates::make(ByteStream& bs, double prefetchThreshold, boost::shared_ptr<BPPSendThread> sendThread,
+                        uint processorThreads)
+{
+  // the part of the create msg that differs from query to query, see BatchPrimitiveProcessorJL::createBPP()
+  uint8_t ot;
+  uint32_t txnID, sessionID, stepID, uniqueID;
+  BRM::QueryContext versionInfo;
+
+  const ISMPacketHeader* ism = reinterpret_cast<const ISMPacketHeader*>(bs.buf());
+
+  if (ism->Flags != BPP_CREATE_FORMAT_VERSION)
+  {
+    std::ostringstream os;
+    os << "BPPTemplates::make(): got a BPP create msg of format " << ism->Flags << ", expected "
+       << BPP_CREATE_FORMAT_VERSION << ". ExeMgr and PrimProc run different versions.";
+    throw std::runtime_error(os.str());
+  }
+
+  // BPPTemplateCacheSize 0, every create msg is deserialized as before
+  if (fMaxBytes == 0)
+    return SBPP(new BatchPrimitiveProcessor(bs, prefetchThreshold, sendThread, processorThreads));
+
+  bs.advance(sizeof(ISMPacketHeader));
+  bs >> ot;
+  bs >> txnID;
+  bs >> sessionID;
+  bs >> stepID;
+  bs >> uniqueID;
+  bs >> versionInfo;
+
+  std::string key(1, (char)ot);
+  key.append(reinterpret_cast<const char*>(bs.buf()), bs.length());
+  STemplate t;
+
+  {
+    boost::mutex::scoped_lock lk(fLock);
+    auto it = fIndex.find(key);
+
+    if (it != fIndex.end())
+    {
+      fEntries.splice(fEntries.begin(), fEntries, it->second);
+      t = it->second->second;
+    }
+  }
+
+  if (t)
+  {
+    SBPP bpp;
+
+    {
+      boost::mutex::scoped_lock lk(t->lock);
+      bpp = t->bpp->instantiate(txnID, sessionID, stepID, uniqueID, versionInfo, sendThread);
+    }
+
+    bs.advance(t->definitionLength);
+    return bpp;
+  }
+
+  uint32_t definitionLength = bs.length();
+  bs.rewind();
+  SBPP bpp(new BatchPrimitiveProcessor(bs, prefetchThreshold, sendThread, processorThreads));
+  definitionLength -= bs.length();
+
+  // the Commands and expressions it deserializes to are about the size of the msg
+  size_t bytes = sizeof(BatchPrimitiveProcessor) + 2 * key.size();
+
+  if (!bpp->canBeTemplate() || bytes > fMaxBytes)
+    return bpp;
+
+  t.reset(new Template());
+  t->bpp = bpp->copyDefinition();
+  t->bpp->sendThread.reset();
+  t->definitionLength = definitionLength;
+  t->bytes = bytes;
+
+  boost::mutex::scoped_lock lk(fLock);
+
+  // another thread made the same one meanwhile
+  if (fIndex.find(key) != fIndex.end())
+    return bpp;
+
+  fEntries.emplace_front(key, t);
+  fIndex[key] = fEntries.begin();
+  fBytes += bytes;
+  evict();
+  return bpp;
+}
+
+}  // namespace primitiveprocessor
@@ -0,0 +1,90 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "bytestream.h"
+#include "batchprimitiveprocessor.h"
+
+namespace primitiveprocessor
+{
+/** @brief BPPs ready to be copied for the next query running the same step
+
+  initBPP() deserializes the RowGroups, F&E expressions and Commands of a
+  step, which for a short query can take longer than running it. Once
+  that is done for a step without joins, a copy of the BPP is kept here by
+  its create msg minus the IDs and version of the query. The next create
+  msg for the same step gets a duplicate of it with its own IDs patched in.
+
+  A BPP has its block and value buffers inline, so each template takes a
+  few hundred KB. The least recently used go first once they add up to
+  PrimitiveServers/BPPTemplateCacheSize, 0 keeps none.
+*/
+class BPPTemplates
+{
+ public:
+  static const size_t DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+
+  BPPTemplates() : fMaxBytes(DEFAULT_MAX_BYTES), fBytes(0)
+  {
+  }
+
+  void setMaxBytes(size_t maxBytes);
+
+  /** @brief The BPP of the create msg in bs
+
+    Leaves bs where the BatchPrimitiveProcessor ctor would. Throws if the
+    msg is of another BPP_CREATE_FORMAT_VERSION than this PrimProc's.
+  */
+  SBPP make(messageqcpp::ByteStream& bs, double prefetchThreshold, boost::shared_ptr<BPPSendThread> sendThread,
+            uint processorThreads);
+
+ private:
+  BPPTemplates(const BPPTemplates&);
+  BPPTemplates& operator=(const BPPTemplates&);
+
+  struct Template
+  {
+    SBPP bpp;
+    uint32_t definitionLength;  // of the msg after the version
+    size_t bytes;               // what keeping it takes, key included
+    boost::mutex lock;          // duplicating isn't safe from two threads at once
+  };
+  typedef boost::shared_ptr<Template> STemplate;
+  typedef std::list<std::pair<std::string, STemplate> > LRUList;
+
+  // drops the least recently used until the rest fit into fMaxBytes, fLock held
+  void evict();
+
+  boost::mutex fLock;
+  size_t fMaxBytes;
+  size_t fBytes;
+  // most recently used first
+  LRUList fEntries;
+  std::unordered_map<std::string, LRUList::iterator> fIndex;
+};
+
+}  // namespace primitiveprocessor
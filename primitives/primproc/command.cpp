@@ -35,8 +35,6 @@ void Command::createCommand(ByteStream& bs)
 {
   bs >> OID;
   bs >> tupleKey;
-  bs >> queryUuid;
-  bs >> stepUuid;
 }
 
 void Command::resetCommand(ByteStream& bs){};
@@ -18,7 +18,6 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
-#include <boost/uuid/uuid.hpp>
 
 #include "serializeable.h"
 #include "bytestream.h"
@@ -114,8 +113,6 @@ class Command
   uint8_t fFilterFeeder;
   uint32_t OID;
   uint32_t tupleKey;
-  boost::uuids::uuid queryUuid;
-  boost::uuids::uuid stepUuid;
 
   Command(const Command& rhs) = default;
   Command& operator=(const Command& rhs) = default;
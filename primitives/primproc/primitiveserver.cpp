@@ -74,6 +74,7 @@ using namespace oam;
 using namespace config;
 
 #include "bppseeder.h"
+#include "bpptemplates.h"
 #include "primitiveprocessor.h"
 #include "pp_logger.h"
 using namespace primitives;
@@ -125,6 +126,8 @@ oam::OamCache* oamCache = oam::OamCache::makeOamCache();
 namespace primitiveprocessor
 {
 boost::shared_ptr<threadpool::PriorityThreadPool> OOBPool;
+// the BPP jobs, the same as PrimitiveServer::fProcessorPool
+boost::shared_ptr<threadpool::PriorityThreadPool> ProcessorPool;
 
 BlockRequestProcessor** BRPp;
 #ifndef _MSC_VER
@@ -149,6 +152,7 @@ int noVB = 0;
 
 BPPMap bppMap;
 boost::mutex bppLock;
+BPPTemplates bppTemplates;
 
 #define DJLOCK_READ 0
 #define DJLOCK_WRITE 1
@@ -1395,8 +1399,8 @@ struct BPPHandler
 
     // make the new BPP object
     bppv.reset(new BPPV());
-    bpp.reset(new BatchPrimitiveProcessor(bs, fPrimitiveServerPtr->prefetchThreshold(), bppv->getSendThread(),
-                                          fPrimitiveServerPtr->ProcessorThreads()));
+    bpp = bppTemplates.make(bs, fPrimitiveServerPtr->prefetchThreshold(), bppv->getSendThread(),
+                            fPrimitiveServerPtr->ProcessorThreads());
 
     if (bs.length() > 0)
       bs >> initMsgsLeft;
@@ -2408,6 +2412,7 @@ PrimitiveServer::PrimitiveServer(int serverThreads, int serverQueueSize, int pro
 
   fProcessorPool.reset(new threadpool::PriorityThreadPool(fProcessorWeight, highPriorityThreads,
                                                           medPriorityThreads, lowPriorityThreads, 0));
+  ProcessorPool = fProcessorPool;
 
   // We're not using either the priority or the job-clustering features, just need a threadpool
   // that can reschedule jobs, and an unlimited non-blocking queue
@@ -49,6 +49,7 @@ extern oam::OamCache* oamCache;
 namespace primitiveprocessor
 {
 extern boost::shared_ptr<threadpool::PriorityThreadPool> OOBPool;
+extern boost::shared_ptr<threadpool::PriorityThreadPool> ProcessorPool;
 extern dbbc::BlockRequestProcessor** BRPp;
 extern BRM::DBRM* brm;
 extern boost::mutex bppLock;
@@ -54,6 +54,7 @@ using namespace logging;
 
 #include "primproc.h"
 #include "primitiveserver.h"
+#include "bpptemplates.h"
 #include "MonitorProcMem.h"
 #include "pp_logger.h"
 #include "umsocketselector.h"
@@ -138,6 +139,7 @@ extern uint32_t medPriorityThreads;
 extern uint32_t lowPriorityThreads;
 extern int directIOFlag;
 extern int noVB;
+extern BPPTemplates bppTemplates;
 
 DebugLevel gDebugLevel;
 Logger* mlp;
@@ -550,6 +552,11 @@ int ServicePrimProc::Child()
         BRPThreads = temp;
 
 #endif
+  strVal = cf->getConfig(primitiveServers, "BPPTemplateCacheSize");
+
+  if (!strVal.empty())
+    bppTemplates.setMaxBytes(Config::fromText(strVal));
+
   temp = toInt(cf->getConfig(dbbc, "NumCaches"));
 
   if (temp > 0)
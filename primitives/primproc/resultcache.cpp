@@ -0,0 +1,323 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <algorithm>
+
+#include <boost/uuid/nil_generator.hpp>
+
+#include "resultcache.h"
+#include "dbrm.h"
+#include "existsfilter.h"
+#include "hasher.h"
+#include "parsetree.h"
+#include "selectfilter.h"
+#include "simplescalarfilter.h"
+
+using namespace execplan;
+
+namespace
+{
+const uint64_t defaultMaxMemory = 256 * 1024 * 1024;
+const uint64_t defaultMaxResultSize = 16 * 1024 * 1024;
+
+void collectFilterSubPlans(const ParseTree* n, void* obj)
+{
+  std::vector<CalpontSelectExecutionPlan*>* plans =
+      reinterpret_cast<std::vector<CalpontSelectExecutionPlan*>*>(obj);
+  TreeNode* tn = n->data();
+  CalpontSelectExecutionPlan* sub = nullptr;
+
+  if (SelectFilter* sf = dynamic_cast<SelectFilter*>(tn))
+    sub = sf->sub().get();
+  else if (ExistsFilter* ef = dynamic_cast<ExistsFilter*>(tn))
+    sub = ef->sub().get();
+  else if (SimpleScalarFilter* ssf = dynamic_cast<SimpleScalarFilter*>(tn))
+    sub = ssf->sub().get();
+
+  if (sub)
+    plans->push_back(sub);
+}
+
+// The plans nested in plan: UNION units, FROM, select list and WHERE/HAVING subqueries
+std::vector<CalpontSelectExecutionPlan*> subPlans(const CalpontSelectExecutionPlan& plan)
+{
+  std::vector<CalpontSelectExecutionPlan*> plans;
+  const CalpontSelectExecutionPlan::SelectList* lists[] = {&plan.unionVec(), &plan.derivedTableList(),
+                                                           &plan.selectSubList(), &plan.subSelects()};
+
+  for (const CalpontSelectExecutionPlan::SelectList* list : lists)
+  {
+    for (const SCEP& sub : *list)
+    {
+      CalpontSelectExecutionPlan* subPlan = dynamic_cast<CalpontSelectExecutionPlan*>(sub.get());
+
+      if (subPlan)
+        plans.push_back(subPlan);
+    }
+  }
+
+  if (plan.filters())
+    plan.filters()->walk(collectFilterSubPlans, &plans);
+
+  if (plan.having())
+    plan.having()->walk(collectFilterSubPlans, &plans);
+
+  return plans;
+}
+
+// Clears what differs between two runs of the same statement
+void clearRunState(CalpontSelectExecutionPlan& plan)
+{
+  plan.data("");
+  plan.sessionID(0);
+  plan.txnID(0);
+  plan.verID(BRM::QueryContext());
+  plan.statementID(0);
+  plan.rmParms(CalpontSelectExecutionPlan::RMParmVec());
+  plan.priority(0);
+  plan.uuid(boost::uuids::nil_uuid());
+
+  for (CalpontSelectExecutionPlan* sub : subPlans(plan))
+    clearRunState(*sub);
+}
+
+bool addColumnOIDs(const CalpontSelectExecutionPlan& plan, boost::shared_ptr<CalpontSystemCatalog> csc,
+                   exemgr::ResultCache::OIDList& oids)
+{
+  for (const CalpontSystemCatalog::TableAliasName& tn : plan.tableList())
+  {
+    // FROM subqueries are walked below
+    if (tn.schema.empty())
+      continue;
+
+    if (!tn.fisColumnStore)
+      return false;
+
+    CalpontSystemCatalog::RIDList rids = csc->columnRIDs(CalpontSystemCatalog::TableName(tn), true);
+
+    for (const CalpontSystemCatalog::ROPair& rid : rids)
+      oids.push_back(rid.objnum);
+  }
+
+  for (CalpontSelectExecutionPlan* sub : subPlans(plan))
+  {
+    if (!addColumnOIDs(*sub, csc, oids))
+      return false;
+  }
+
+  return true;
+}
+
+}  // namespace
+
+namespace exemgr
+{
+ResultCache::ResultCache(config::Config* config)
+ : fConfig(config)
+ , fConfigTime(config->getCurrentMTime())
+ , fEnabled(false)
+ , fMaxMemory(defaultMaxMemory)
+ , fMaxResultSize(defaultMaxResultSize)
+ , fMemory(0)
+{
+  readConfig();
+}
+
+// A stat() per SELECT, so that mcsSetConfig can turn the cache on and off without a restart
+void ResultCache::configure()
+{
+  time_t mtime = fConfig->getCurrentMTime();
+
+  if (mtime == fConfigTime)
+    return;
+
+  std::lock_guard<std::mutex> lk(fMutex);
+
+  if (mtime == fConfigTime)
+    return;
+
+  fConfigTime = mtime;
+  readConfig();
+
+  while (!fEntries.empty() && (!fEnabled || fMemory > fMaxMemory))
+    erase(fIndex.find(fEntries.back().first));
+}
+
+void ResultCache::readConfig()
+{
+  std::string val = fConfig->getConfig("ResultCache", "Enabled");
+  fEnabled = (val == "Y" || val == "y");
+
+  val = fConfig->getConfig("ResultCache", "MaxMemory");
+  fMaxMemory = val.empty() ? defaultMaxMemory : config::Config::uFromText(val);
+
+  val = fConfig->getConfig("ResultCache", "MaxResultSize");
+  uint64_t maxResultSize = val.empty() ? defaultMaxResultSize : config::Config::uFromText(val);
+
+  fMaxResultSize = std::min(maxResultSize, fMaxMemory);
+}
+
+bool ResultCache::wants(const CalpontSelectExecutionPlan& csep, bool tupleMode) const
+{
+  const uint32_t untraced =
+      CalpontSelectExecutionPlan::RESULT_CACHE | CalpontSelectExecutionPlan::TRACE_TUPLE_AUTOSWITCH;
+
+  // With a transaction in flight the same plan may see other rows
+  return fEnabled && fMaxResultSize > 0 && tupleMode && !csep.isInternal() && csep.queryType() == "SELECT" &&
+         (csep.traceFlags() & CalpontSelectExecutionPlan::RESULT_CACHE) &&
+         (csep.traceFlags() & ~untraced) == 0 && csep.verID().currentTxns->empty();
+}
+
+std::string ResultCache::makeKey(const CalpontSelectExecutionPlan& csep)
+{
+  // Cleared on a copy, the joblist still needs all of it
+  messageqcpp::ByteStream bs;
+  CalpontSelectExecutionPlan plan;
+  csep.serialize(bs);
+  plan.unserialize(bs);
+  clearRunState(plan);
+  bs.restart();
+  plan.serialize(bs);
+  return std::string(reinterpret_cast<const char*>(bs.buf()), bs.length());
+}
+
+bool ResultCache::columnOIDs(const CalpontSelectExecutionPlan& csep, OIDList& oids)
+{
+  oids.clear();
+
+  try
+  {
+    boost::shared_ptr<CalpontSystemCatalog> csc =
+        CalpontSystemCatalog::makeCalpontSystemCatalog(csep.sessionID());
+
+    if (!addColumnOIDs(csep, csc, oids))
+      return false;
+  }
+  catch (std::exception&)
+  {
+    return false;
+  }
+
+  std::sort(oids.begin(), oids.end());
+  oids.erase(std::unique(oids.begin(), oids.end()), oids.end());
+  return !oids.empty();
+}
+
+uint64_t ResultCache::signature(const OIDList& oids)
+{
+  BRM::DBRM dbrm;
+  std::vector<BRM::EMEntry> extents;
+  std::vector<uint64_t> state;
+
+  for (CalpontSystemCatalog::OID oid : oids)
+  {
+    extents.clear();
+    dbrm.getExtents(oid, extents, false, false, true);
+    state.push_back(oid);
+    state.push_back(extents.size());
+
+    for (const BRM::EMEntry& extent : extents)
+    {
+      state.push_back(extent.range.start);
+      state.push_back(extent.HWM);
+      state.push_back(
+          (static_cast<uint64_t>(static_cast<uint32_t>(extent.partition.cprange.sequenceNum)) << 32) |
+          (static_cast<uint64_t>(static_cast<uint8_t>(extent.partition.cprange.isValid)) << 16) |
+          static_cast<uint16_t>(extent.status));
+    }
+  }
+
+  return utils::Hasher128()(reinterpret_cast<const char*>(state.data()), state.size() * sizeof(uint64_t));
+}
+
+ResultCache::EntrySP ResultCache::get(const std::string& key)
+{
+  EntrySP entry;
+
+  {
+    std::lock_guard<std::mutex> lk(fMutex);
+    auto it = fIndex.find(key);
+
+    if (it == fIndex.end())
+      return entry;
+
+    fEntries.splice(fEntries.begin(), fEntries, it->second);
+    entry = it->second->second;
+  }
+
+  // Read the extent map without holding up the other sessions
+  if (signature(entry->oids) == entry->signature)
+    return entry;
+
+  std::lock_guard<std::mutex> lk(fMutex);
+  auto it = fIndex.find(key);
+
+  if (it != fIndex.end() && it->second->second == entry)
+    erase(it);
+
+  return EntrySP();
+}
+
+void ResultCache::put(const std::string& key, const messageqcpp::ByteStream& rowGroup,
+                      std::vector<messageqcpp::ByteStream>& bands, uint64_t rows, const OIDList& oids,
+                      uint64_t signature)
+{
+  // Something changed while the query ran, the result may be part old and part new
+  if (ResultCache::signature(oids) != signature)
+    return;
+
+  std::shared_ptr<Entry> entry(new Entry());
+  entry->rowGroup = rowGroup;
+  entry->bands.swap(bands);
+  entry->rows = rows;
+  entry->oids = oids;
+  entry->signature = signature;
+  entry->size = key.length() + rowGroup.length();
+
+  for (const messageqcpp::ByteStream& band : entry->bands)
+    entry->size += band.length();
+
+  if (entry->size > fMaxResultSize)
+    return;
+
+  std::lock_guard<std::mutex> lk(fMutex);
+
+  // turned off while the query ran
+  if (!fEnabled)
+    return;
+
+  auto it = fIndex.find(key);
+
+  if (it != fIndex.end())
+    erase(it);
+
+  while (!fEntries.empty() && fMemory + entry->size > fMaxMemory)
+    erase(fIndex.find(fEntries.back().first));
+
+  fEntries.emplace_front(key, entry);
+  fIndex[key] = fEntries.begin();
+  fMemory += entry->size;
+}
+
+void ResultCache::erase(std::unordered_map<std::string, LRUList::iterator>::iterator it)
+{
+  fMemory -= it->second->second->size;
+  fEntries.erase(it->second);
+  fIndex.erase(it);
+}
+
+}  // namespace exemgr
@@ -0,0 +1,127 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bytestream.h"
+#include "calpontselectexecutionplan.h"
+#include "calpontsystemcatalog.h"
+#include "configcpp.h"
+
+namespace exemgr
+{
+/** @brief The results of SELECTs, kept to answer the same SELECT again
+
+  A result is looked up by its plan, serialized with everything that
+  differs between two runs of the same statement cleared. It stays good
+  only while the extent map entries of every column of every table the
+  plan reads are unchanged: inserts, cpimport and truncate move HWMs or
+  add and drop extents, updates and deletes bump the casual partitioning
+  sequence numbers of the extents they touch. That is checked on every
+  hit, and a result is only stored if nothing changed while it was made.
+
+  The cache lives in the ExeMgr memory, bounded by ResultCache/MaxMemory.
+  The least recently used results go first. Changes to the ResultCache
+  section of Columnstore.xml take effect with the next SELECT.
+*/
+class ResultCache
+{
+ public:
+  typedef std::vector<execplan::CalpontSystemCatalog::OID> OIDList;
+
+  struct Entry
+  {
+    messageqcpp::ByteStream rowGroup;  // the output RowGroup the FE gets first
+    std::vector<messageqcpp::ByteStream> bands;
+    uint64_t rows;
+    OIDList oids;  // columns of all the tables the plan reads
+    uint64_t signature;
+    uint64_t size;
+  };
+  typedef std::shared_ptr<const Entry> EntrySP;
+
+  explicit ResultCache(config::Config* config);
+
+  // Reads the ResultCache section again if Columnstore.xml changed
+  void configure();
+
+  /** @brief May the results of csep come from or go to the cache
+
+    Only user SELECTs the FE marked with RESULT_CACHE, run in tuple mode,
+    not traced, and while no transaction has uncommitted changes.
+  */
+  bool wants(const execplan::CalpontSelectExecutionPlan& csep, bool tupleMode) const;
+
+  static std::string makeKey(const execplan::CalpontSelectExecutionPlan& csep);
+
+  /** @brief The columns of every table csep and its subqueries read
+
+    False if it reads a table of another engine, whose changes the extent
+    map doesn't show.
+  */
+  static bool columnOIDs(const execplan::CalpontSelectExecutionPlan& csep, OIDList& oids);
+
+  // Sums up the extent map entries of oids
+  static uint64_t signature(const OIDList& oids);
+
+  // A result that is still good, or none
+  EntrySP get(const std::string& key);
+
+  // signature is the one taken before the query ran
+  void put(const std::string& key, const messageqcpp::ByteStream& rowGroup,
+           std::vector<messageqcpp::ByteStream>& bands, uint64_t rows, const OIDList& oids,
+           uint64_t signature);
+
+  uint64_t maxResultSize() const
+  {
+    return fMaxResultSize;
+  }
+
+ private:
+  ResultCache(const ResultCache&);
+  ResultCache& operator=(const ResultCache&);
+
+  typedef std::list<std::pair<std::string, EntrySP> > LRUList;
+
+  void readConfig();
+  void erase(std::unordered_map<std::string, LRUList::iterator>::iterator it);
+
+  config::Config* fConfig;
+  std::atomic<time_t> fConfigTime;  // mtime of Columnstore.xml when it was read
+  std::atomic<bool> fEnabled;
+  uint64_t fMaxMemory;
+  std::atomic<uint64_t> fMaxResultSize;
+  uint64_t fMemory;
+  std::mutex fMutex;
+  // most recently used first
+  LRUList fEntries;
+  std::unordered_map<std::string, LRUList::iterator> fIndex;
+};
+
+}  // namespace exemgr
@@ -217,8 +217,8 @@ const std::string ServiceExeMgr::prettyPrintMiniInfo(const std::string& in)
   CharSeparator sep1("\n");
   Tokeniser tok1(in, sep1);
   std::vector<std::string> lines;
-  std::string header = "Desc Mode Table TableOID ReferencedColumns PIO LIO PBE Elapsed Rows";
-  const int header_parts = 10;
+  std::string header = "Desc Mode Table TableOID ReferencedColumns PIO LIO PBE Elapsed Rows JobBlocks:Window";
+  const int header_parts = 11;
   lines.push_back(header);
 
   for (auto iter1 = tok1.begin(); iter1 != tok1.end(); ++iter1)
@@ -262,6 +262,13 @@ const std::string ServiceExeMgr::prettyPrintMiniInfo(const std::string& in)
       parts.push_back(part);
     }
 
+    // only the BPS steps fill in the job sizes and send windows
+    for (; i < header_parts; i++)
+    {
+      parts.push_back("-");
+      lens[i] = std::max(lens[i], 1U);
+    }
+
     assert(i == header_parts);
     lineparts.push_back(parts);
   }
@@ -342,6 +349,7 @@ int ServiceExeMgr::Child()
   messageqcpp::MessageQueueServer* mqs;
 
   statementsRunningCount_ = new ActiveStatementCounter(rm_->getEmExecQueueSize());
+  resultCache_ = new ResultCache(rm_->getConfig());
   const std::string ExeMgr = "ExeMgr1";
   for (;;)
   {
@@ -28,6 +28,7 @@
 #include "calpontselectexecutionplan.h"
 #include "mcsanalyzetableexecutionplan.h"
 #include "activestatementcounter.h"
+#include "resultcache.h"
 #include "distributedenginecomm.h"
 #include "resourcemanager.h"
 #include "configcpp.h"
@@ -252,6 +253,10 @@ namespace exemgr
     {
       return statementsRunningCount_;
     }
+    ResultCache* getResultCache()
+    {
+      return resultCache_;
+    }
     joblist::DistributedEngineComm* getDec()
     {
       return dec_;
@@ -339,6 +344,7 @@ namespace exemgr
     ThreadCntPerSessionMap_t threadCntPerSessionMap_;
     std::mutex threadCntPerSessionMapMutex_;
     ActiveStatementCounter* statementsRunningCount_;
+    ResultCache* resultCache_;
     joblist::DistributedEngineComm* dec_;
     joblist::ResourceManager* rm_;
     // Its attributes are set in Child()
@@ -60,8 +60,12 @@ namespace exemgr
       }
 
       // Get % memory usage during current query for sessionId
-      jl->querySummary(wantExtendedStats);
-      fStats = jl->queryStats();
+      // (no joblist if the result came from the result cache)
+      if (jl)
+      {
+        jl->querySummary(wantExtendedStats);
+        fStats = jl->queryStats();
+      }
       fStats.fMaxMemPct = getMaxMemPct(fStats.fSessionID);
       fStats.fRows = rowsReturned;
       fStatsRetrieved = true;
@@ -263,6 +267,65 @@ namespace exemgr
     statementsRunningCount->decr(stmtCounted);
   }
 
+  // Answers the FE from the result cache the way a tuple joblist would, but for the
+  // status message that lets the FE count the hit. Returns true if the FE sent the
+  // next plan instead of finishing, it is in bs then.
+  bool SQLFrontSessionThread::sendCachedResult(const ResultCache::Entry& result, messageqcpp::ByteStream& bs,
+                                               bool& selfJoin)
+  {
+    joblist::SJLP noJobList;
+
+    writeCodeAndError(0, execplan::CalpontExecutionPlan::RESULT_CACHE_HIT);
+    fIos.write(result.rowGroup);
+
+    for (;;)
+    {
+      bs = fIos.read();
+
+      if (bs.length() == 0)
+        return false;
+
+      if (bs.length() > 4)
+      {
+        selfJoin = true;
+        return true;
+      }
+
+      messageqcpp::ByteStream::quadbyte qb;
+      bs >> qb;
+
+      if (qb == 0)
+      {
+        return false;
+      }
+      else if (qb == 1)
+      {
+        continue;
+      }
+      else if (qb == 3)
+      {
+        std::string empty;
+        bs.restart();
+        bs << formatQueryStats(noJobList, "Query Stats", false, true, false, result.rows);
+        bs << empty;
+        bs << empty;
+        fStats.serialize(bs);
+        fIos.write(bs);
+      }
+      else if (qb == 4)
+      {
+        bs = fIos.read();
+        return true;
+      }
+      else
+      {
+        // The bands end with the empty one
+        for (const messageqcpp::ByteStream& band : result.bands)
+          fIos.write(band);
+      }
+    }
+  }
+
   void SQLFrontSessionThread::analyzeTableHandleStats(messageqcpp::ByteStream& bs)
   {
     messageqcpp::ByteStream::quadbyte qb;
@@ -516,6 +579,55 @@ namespace exemgr
 
       statementsRunningCount->incr(stmtCounted);
 
+      // A SELECT run before over tables nobody changed since is answered
+      // without a joblist. Otherwise its result may be kept for the next time.
+      ResultCache* resultCache = globServiceExeMgr->getResultCache();
+      std::string resultKey;
+      ResultCache::OIDList resultOIDs;
+      uint64_t resultSignature = 0;
+      bool fillResultCache = false;
+      messageqcpp::ByteStream resultRowGroup;
+      resultCache->configure();
+
+      if (resultCache->wants(csep, tryTuples))
+      {
+          resultKey = ResultCache::makeKey(csep);
+          ResultCache::EntrySP cached = resultCache->get(resultKey);
+
+          if (cached)
+          {
+          bool newPlan = false;
+
+          try
+          {
+              newPlan = sendCachedResult(*cached, bs, selfJoin);
+          }
+          catch (std::exception& ex)
+          {
+              std::ostringstream errMsg;
+              errMsg << "ExeMgr: error sending a cached result; " << ex.what();
+              throw std::runtime_error(errMsg.str());
+          }
+
+          deleteMaxMemPct(csep.sessionID());
+          statementsRunningCount->decr(stmtCounted);
+
+          if (newPlan)
+              goto new_plan;
+
+          qts.msg_type = querytele::QueryTeleStats::QT_SUMMARY;
+          qts.rows = cached->rows;
+          qts.end_time = querytele::QueryTeleClient::timeNowms();
+          fTeleClient.postQueryTele(qts);
+          continue;
+          }
+
+          fillResultCache = ResultCache::columnOIDs(csep, resultOIDs);
+
+          if (fillResultCache)
+          resultSignature = ResultCache::signature(resultOIDs);
+      }
+
       if (tryTuples)
       {
           try  // @bug2244: try/catch around fIos.write() calls responding to makeTupleList
@@ -535,6 +647,9 @@ namespace exemgr
               messageqcpp::ByteStream tbs;
               tbs << tjlp->getOutputRowGroup();
               fIos.write(tbs);
+
+              if (fillResultCache)
+              resultRowGroup = tbs;
           }
           else
           {
@@ -597,6 +712,8 @@ namespace exemgr
       joblist::DeliveredTableMap tm;
       uint64_t totalBytesSent = 0;
       uint64_t totalRowCount = 0;
+      std::vector<messageqcpp::ByteStream> resultBands;
+      uint64_t resultBytes = 0;
 
       // Project each table as the FE asks for it
       for (;;)
@@ -815,9 +932,30 @@ namespace exemgr
           totalRowCount += rowCount;
           totalBytesSent += bs.length();
 
+          if (fillResultCache && tableOID == 100)
+          {
+              resultBytes += bs.length();
+
+              if (resultBytes > resultCache->maxResultSize())
+              {
+              fillResultCache = false;
+              resultBands.clear();
+              }
+              else
+              {
+              resultBands.push_back(bs);
+              }
+          }
+
           if (rowCount == 0)
           {
               msgHandler.stop();
+
+              // An aborted joblist ends with an empty band too, after a KILL or a client drop
+              if (fillResultCache && tableOID == 100 && jl->status() == 0 && !jl->aborted() &&
+                  !msgHandler.aborted())
+              resultCache->put(resultKey, resultRowGroup, resultBands, totalRowCount, resultOIDs,
+                               resultSignature);
               // No more bands, table is done
               bs.reset();
 
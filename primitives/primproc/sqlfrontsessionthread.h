@@ -124,6 +124,7 @@ namespace exemgr
     void writeCodeAndError(messageqcpp::ByteStream::quadbyte code, const std::string emsg);
     void analyzeTableExecute(messageqcpp::ByteStream& bs, joblist::SJLP& jl, bool& stmtCounted);
     void analyzeTableHandleStats(messageqcpp::ByteStream& bs);
+    bool sendCachedResult(const ResultCache::Entry& result, messageqcpp::ByteStream& bs, bool& selfJoin);
     uint64_t roundMB(uint64_t value) const;
   public:
     void operator()();
@@ -128,6 +128,14 @@ void Cache::validateCacheSize()
     it->second->validateCacheSize();
 }
 
+void Cache::setPromotionDelay(uint32_t milliseconds)
+{
+  boost::unique_lock<boost::mutex> s(lru_mutex);
+
+  for (auto it = prefixCaches.begin(); it != prefixCaches.end(); ++it)
+    it->second->setPromotionDelay(milliseconds);
+}
+
 // new simplified version
 void Cache::read(const bf::path& prefix, const vector<string>& keys)
 {
@@ -141,7 +149,7 @@ void Cache::doneReading(const bf::path& prefix, const vector<string>& keys)
 
 void Cache::doneWriting(const bf::path& prefix)
 {
-  getPCache(prefix).makeSpace(0);
+  getPCache(prefix).doneWriting();
 }
 
 const bf::path& Cache::getCachePath() const
@@ -317,6 +325,17 @@ Downloader* Cache::getDownloader() const
 void Cache::shutdown()
 {
   boost::unique_lock<boost::mutex> s(lru_mutex);
+  vector<PrefixCache*> pCaches;
+  for (auto it = prefixCaches.begin(); it != prefixCaches.end(); ++it)
+    if (it->second)
+      pCaches.push_back(it->second);
+  s.unlock();
+
+  // stop the eviction threads without holding lru_mutex, an eviction in progress may need it
+  for (auto* pCache : pCaches)
+    pCache->shutdown();
+
+  s.lock();
   downloader.reset();
 }
 
@@ -97,6 +97,8 @@ class Cache : public boost::noncopyable, public ConfigListener
   // this will delete everything in the Cache and journal paths, and empty all Cache structures.
   void reset();
   void validateCacheSize();
+  // how long after its first read a second one moves an object to the protected part of the LRU
+  void setPromotionDelay(uint32_t milliseconds);
 
   virtual void configListener() override;
 
@@ -23,6 +23,7 @@
 #include <boost/thread/mutex.hpp>
 #include <string>
 #include <ctype.h>
+#include <errno.h>
 #include <iostream>
 
 using namespace std;
@@ -73,7 +74,19 @@ CloudStorage::CloudStorage()
   logger = SMLogging::get();
 
   bytesUploaded = bytesDownloaded = objectsDeleted = objectsCopied = objectsGotten = objectsPut =
-      existenceChecks = 0;
+      existenceChecks = rangesGotten = 0;
+}
+
+int CloudStorage::getObjectRange(const string& sourceKey, uint8_t* data, off_t offset, size_t length,
+                                 size_t* sizeRead)
+{
+  errno = ENOTSUP;
+  return -1;
+}
+
+bool CloudStorage::supportsRangeReads() const
+{
+  return false;
 }
 
 void CloudStorage::printKPIs() const
@@ -86,6 +99,7 @@ void CloudStorage::printKPIs() const
   cout << "\tobjectsGotten = " << objectsGotten << endl;
   cout << "\tobjectsPut = " << objectsPut << endl;
   cout << "\texistenceChecks = " << existenceChecks << endl;
+  cout << "\trangesGotten = " << rangesGotten << endl;
 }
 
 }  // namespace storagemanager
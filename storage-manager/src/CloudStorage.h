@@ -37,6 +37,13 @@ class CloudStorage
   virtual int copyObject(const std::string& sourceKey, const std::string& destKey) = 0;
   virtual int exists(const std::string& key, bool* out) = 0;
 
+  // Reads length bytes starting at offset from an object without fetching the rest of it.  sizeRead
+  // is set to the number of bytes read, which is less than length if the object ends first.
+  // Only usable if supportsRangeReads() returns true.
+  virtual int getObjectRange(const std::string& sourceKey, uint8_t* data, off_t offset, size_t length,
+                             size_t* sizeRead);
+  virtual bool supportsRangeReads() const;
+
   virtual void printKPIs() const;
 
   // this will return a CloudStorage instance of the type specified in StorageManager.cnf
@@ -48,7 +55,7 @@ class CloudStorage
 
   // some KPIs
   size_t bytesUploaded, bytesDownloaded, objectsDeleted, objectsCopied, objectsGotten, objectsPut,
-      existenceChecks;
+      existenceChecks, rangesGotten;
 
  private:
 };
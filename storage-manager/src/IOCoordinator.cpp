@@ -18,6 +18,7 @@
 #include "IOCoordinator.h"
 #include "MetadataFile.h"
 #include "Synchronizer.h"
+#include "JournalIndex.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -38,6 +39,12 @@ namespace
 {
 storagemanager::IOCoordinator* ioc = NULL;
 boost::mutex m;
+
+// a file has to be read this many times in a row where the previous read left off before read-ahead kicks in
+const uint sequentialReadThreshold = 2;
+// how many files to track the access pattern of before starting over
+const size_t maxAccessPatterns = 10000;
+const uint maxPrefetchThreads = 4;
 }  // namespace
 
 namespace bf = boost::filesystem;
@@ -50,6 +57,7 @@ IOCoordinator::IOCoordinator()
   cache = Cache::get();
   logger = SMLogging::get();
   replicator = Replicator::get();
+  storage = CloudStorage::get();
 
   try
   {
@@ -79,10 +87,47 @@ IOCoordinator::IOCoordinator()
   cachePath = cache->getCachePath();
   journalPath = cache->getJournalPath();
 
+  prefetchObjects = 2;
+  string stmp = config->getValue("ObjectStorage", "prefetch_objects");
+  if (!stmp.empty())
+  {
+    try
+    {
+      prefetchObjects = stoul(stmp);
+    }
+    catch (invalid_argument&)
+    {
+      logger->log(LOG_WARNING, "ObjectStorage/prefetch_objects is not a number.  Using %zu", prefetchObjects);
+    }
+  }
+  prefetchThreads.setMaxThreads(maxPrefetchThreads);
+  prefetchThreads.setName("Prefetch");
+
+  rangeReadMaxSize = 0;
+  stmp = config->getValue("ObjectStorage", "range_read_max_size");
+  if (!stmp.empty())
+  {
+    try
+    {
+      rangeReadMaxSize = stoul(stmp);
+    }
+    catch (invalid_argument&)
+    {
+      logger->log(LOG_WARNING, "ObjectStorage/range_read_max_size is not a number.  Disabling range reads");
+    }
+  }
+  if (rangeReadMaxSize > 0 && !storage->supportsRangeReads())
+  {
+    logger->log(LOG_INFO, "ObjectStorage/range_read_max_size is set, but the storage service does not "
+                "support range reads.  Disabling range reads");
+    rangeReadMaxSize = 0;
+  }
+
   bytesRead = bytesWritten = filesOpened = filesCreated = filesCopied = filesDeleted = bytesCopied =
       filesTruncated = listingCount = callsToWrite = 0;
   iocFilesOpened = iocObjectsCreated = iocJournalsCreated = iocBytesWritten = iocFilesDeleted = iocBytesRead =
       0;
+  iocPrefetchesIssued = iocObjectsPrefetched = iocRangeReads = iocRangeBytesRead = 0;
 }
 
 IOCoordinator::~IOCoordinator()
@@ -119,6 +164,11 @@ void IOCoordinator::printKPIs() const
   cout << "\t\tiocJournalsCreated = " << iocJournalsCreated << endl;
   cout << "\t\tiocBytesRead = " << iocBytesRead << endl;
   cout << "\t\tiocBytesWritten = " << iocBytesWritten << endl;
+  cout << "\t\tiocPrefetchesIssued = " << iocPrefetchesIssued << endl;
+  cout << "\t\tiocObjectsPrefetched = " << iocObjectsPrefetched << endl;
+  cout << "\t\tiocRangeReads = " << iocRangeReads << endl;
+  cout << "\t\tiocRangeBytesRead = " << iocRangeBytesRead << endl;
+  JournalIndex::get()->printKPIs();
 }
 
 int IOCoordinator::loadObject(int fd, uint8_t* data, off_t offset, size_t length)
@@ -158,6 +208,111 @@ int IOCoordinator::loadObjectAndJournal(const char* objFilename, const char* jou
   return 0;
 }
 
+int IOCoordinator::loadObjectRange(const string& key, uint8_t* data, off_t offset, size_t length)
+{
+  size_t sizeRead = 0;
+  int err = storage->getObjectRange(key, data, offset, length, &sizeRead);
+  if (err)
+    return err;
+  iocBytesRead += sizeRead;
+  iocRangeBytesRead += sizeRead;
+  ++iocRangeReads;
+  if (sizeRead != length)
+  {
+    errno = ENODATA;
+    return -1;
+  }
+  return 0;
+}
+
+IOCoordinator::AccessPattern::AccessPattern() : nextOffset(0), sequentialReads(0), prefetchedTo(0)
+{
+}
+
+IOCoordinator::Prefetch::Prefetch(IOCoordinator* _ioc, const bf::path& _filename, off_t _offset,
+                                  size_t _length)
+ : ioc(_ioc), filename(_filename), offset(_offset), length(_length)
+{
+}
+
+void IOCoordinator::Prefetch::operator()()
+{
+  ioc->prefetch(filename, offset, length);
+}
+
+// Records a read of filename and returns whether the file is being read sequentially.  Kicks off a
+// prefetch of the objects that follow the read if it is.
+bool IOCoordinator::trackAccess(const bf::path& filename, off_t offset, size_t length)
+{
+  off_t end = offset + length;
+  off_t prefetchFrom, prefetchTo;
+  bool sequential;
+
+  {
+    boost::mutex::scoped_lock s(accessPatternMutex);
+    if (accessPatterns.size() >= maxAccessPatterns &&
+        accessPatterns.find(filename.string()) == accessPatterns.end())
+      accessPatterns.clear();
+    AccessPattern& ap = accessPatterns[filename.string()];
+    if (offset == ap.nextOffset && ap.nextOffset != 0)
+      ++ap.sequentialReads;
+    else
+    {
+      ap.sequentialReads = 0;
+      ap.prefetchedTo = 0;
+    }
+    ap.nextOffset = end;
+    sequential = (ap.sequentialReads >= sequentialReadThreshold);
+
+    // top up the read-ahead window once half of it has been consumed
+    if (!sequential || prefetchObjects == 0 ||
+        ap.prefetchedTo - end >= (off_t)(prefetchObjects * objectSize / 2))
+      return sequential;
+    prefetchFrom = max(ap.prefetchedTo, end);
+    prefetchTo = end + prefetchObjects * objectSize;
+    ap.prefetchedTo = prefetchTo;
+  }
+
+  boost::shared_ptr<ThreadPool::Job> job(
+      new Prefetch(this, filename, prefetchFrom, prefetchTo - prefetchFrom));
+  prefetchThreads.addJob(job);
+  ++iocPrefetchesIssued;
+  return sequential;
+}
+
+void IOCoordinator::prefetch(const bf::path& filename, off_t offset, size_t length)
+{
+  const bf::path firstDir = *(filename.begin());
+
+  try
+  {
+    ScopedReadLock fileLock(this, filename.string());
+    MetadataFile meta(filename, MetadataFile::no_create_t(), true);
+    if (!meta.exists())
+      return;
+
+    vector<metadataObject> relevants = meta.metadataRead(offset, length);
+    if (relevants.empty())
+      return;
+    vector<string> keys;
+    keys.reserve(relevants.size());
+    for (const auto& object : relevants)
+      keys.push_back(object.key);
+
+    // Cache::read() downloads whatever isn't cached yet.  A reader that gets to these objects
+    // before the downloads finish will wait on them instead of starting its own.
+    cache->read(firstDir, keys);
+    fileLock.unlock();
+    cache->doneReading(firstDir, keys);
+    iocObjectsPrefetched += keys.size();
+  }
+  catch (exception& e)
+  {
+    logger->log(LOG_WARNING, "IOCoordinator::prefetch(): failed to prefetch from %s, got '%s'",
+                filename.string().c_str(), e.what());
+  }
+}
+
 ssize_t IOCoordinator::read(const char* _filename, uint8_t* data, off_t offset, size_t length)
 {
   /*
@@ -189,15 +344,40 @@ ssize_t IOCoordinator::read(const char* _filename, uint8_t* data, off_t offset,
   vector<metadataObject> relevants = meta.metadataRead(offset, length);
   map<string, int> journalFDs, objectFDs;
   map<string, string> keyToJournalName, keyToObjectName;
+  set<string> rangeReadKeys;
   utils::VLArray<ScopedCloser> fdMinders(relevants.size() * 2);
   int mindersIndex = 0;
   char buf[80];
 
-  // load them into the cache
+  bool sequential = trackAccess(filename, offset, length);
+
+  // A small read of a file that isn't being read sequentially probably won't come back for the rest
+  // of the object.  Objects that aren't cached and have no journal can be read straight from cloud
+  // storage in that case instead of downloading the whole thing.  Object keys are never reused,
+  // so the cloud copy of an uncached object is current.
   vector<string> keys;
   keys.reserve(relevants.size());
-  for (const auto& object : relevants)
-    keys.push_back(object.key);
+  if (!sequential && rangeReadMaxSize > 0 && length <= rangeReadMaxSize)
+  {
+    vector<string> allKeys;
+    vector<bool> cached;
+    allKeys.reserve(relevants.size());
+    for (const auto& object : relevants)
+      allKeys.push_back(object.key);
+    cache->exists(firstDir, allKeys, &cached);
+    for (uint i = 0; i < allKeys.size(); i++)
+    {
+      if (!cached[i] && !bf::exists(journalPath / firstDir / (allKeys[i] + ".journal")))
+        rangeReadKeys.insert(allKeys[i]);
+      else
+        keys.push_back(allKeys[i]);
+    }
+  }
+  else
+    for (const auto& object : relevants)
+      keys.push_back(object.key);
+
+  // load them into the cache
   cache->read(firstDir, keys);
 
   // open the journal files and objects that exist to prevent them from being
@@ -271,7 +451,9 @@ ssize_t IOCoordinator::read(const char* _filename, uint8_t* data, off_t offset,
     // otherwise it is the length of the object - starting offset
 
     size_t thisLength = min(object.length - thisOffset, length - count);
-    if (jit == journalFDs.end())
+    if (rangeReadKeys.find(object.key) != rangeReadKeys.end())
+      err = loadObjectRange(object.key, &data[count], thisOffset, thisLength);
+    else if (jit == journalFDs.end())
       err = loadObject(objectFDs[object.key], &data[count], thisOffset, thisLength);
     else
       err = loadObjectAndJournal(keyToObjectName[object.key].c_str(), keyToJournalName[object.key].c_str(),
@@ -1261,71 +1443,54 @@ boost::shared_array<uint8_t> IOCoordinator::mergeJournal(const char* object, con
   }
   ScopedCloser s2(journalFD);
 
-  boost::shared_array<char> headertxt = seekToEndOfHeader1(journalFD, &l_bytesRead);
-  stringstream ss;
-  ss << headertxt.get();
-
-  nlohmann::json header = nlohmann::json::parse(ss);
-
-  assert(header["version"] == 1);
-
-  // start processing the entries
-  while (1)
+  // only visit the journal entries that overlap the requested range
+  vector<JournalIndex::Entry> entries;
+  if (JournalIndex::get()->lookup(journal, journalFD, offset, len, &entries, &l_bytesRead))
   {
-    uint64_t offlen[2];
-    int err = ::read(journalFD, &offlen, 16);
-    if (err == 0)  // got EOF
-      break;
-    assert(err == 16);
-    l_bytesRead += 16;
+    int l_errno = errno;
+    char buf[80];
+    logger->log(LOG_ERR, "mergeJournal: failed to index %s, got %s", journal, strerror_r(l_errno, buf, 80));
+    ret.reset();
+    errno = l_errno;
+    goto out;
+  }
 
-    // if this entry overlaps, read the overlapping section
-    uint64_t lastJournalOffset = offlen[0] + offlen[1];
+  for (const auto& entry : entries)
+  {
+    uint64_t lastJournalOffset = entry.offset + entry.length;
     uint64_t lastBufOffset = offset + len;
-    if (offlen[0] <= lastBufOffset && lastJournalOffset >= (uint64_t)offset)
-    {
-      uint64_t startReadingAt = max(offlen[0], (uint64_t)offset);
-      uint64_t lengthOfRead = min(lastBufOffset, lastJournalOffset) - startReadingAt;
-
-      // seek to the portion of the entry to start reading at
-      if (startReadingAt != offlen[0])
-        ::lseek(journalFD, startReadingAt - offlen[0], SEEK_CUR);
+    uint64_t startReadingAt = max(entry.offset, (uint64_t)offset);
+    uint64_t lengthOfRead = min(lastBufOffset, lastJournalOffset) - startReadingAt;
+    off_t journalPos = entry.journalPos + (startReadingAt - entry.offset);
 
-      uint count = 0;
-      while (count < lengthOfRead)
+    uint count = 0;
+    while (count < lengthOfRead)
+    {
+      int err = ::pread(journalFD, &ret[startReadingAt - offset + count], lengthOfRead - count,
+                        journalPos + count);
+      if (err < 0)
       {
-        err = ::read(journalFD, &ret[startReadingAt - offset + count], lengthOfRead - count);
-        if (err < 0)
-        {
-          int l_errno = errno;
-          char buf[80];
-          logger->log(LOG_ERR, "mergeJournal: got %s", strerror_r(l_errno, buf, 80));
-          ret.reset();
-          errno = l_errno;
-          l_bytesRead += count;
-          goto out;
-        }
-        else if (err == 0)
-        {
-          logger->log(LOG_ERR,
-                      "mergeJournal: got early EOF. offset=%ld, len=%ld, jOffset=%ld, jLen=%ld,"
-                      " startReadingAt=%ld, lengthOfRead=%ld",
-                      offset, len, offlen[0], offlen[1], startReadingAt, lengthOfRead);
-          ret.reset();
-          l_bytesRead += count;
-          goto out;
-        }
-        count += err;
+        int l_errno = errno;
+        char buf[80];
+        logger->log(LOG_ERR, "mergeJournal: got %s", strerror_r(l_errno, buf, 80));
+        ret.reset();
+        errno = l_errno;
+        l_bytesRead += count;
+        goto out;
       }
-      l_bytesRead += lengthOfRead;
-
-      // advance the file pos if we didn't read to the end of the entry
-      if (startReadingAt - offlen[0] + lengthOfRead != offlen[1])
-        ::lseek(journalFD, offlen[1] - (lengthOfRead + startReadingAt - offlen[0]), SEEK_CUR);
+      else if (err == 0)
+      {
+        logger->log(LOG_ERR,
+                    "mergeJournal: got early EOF. offset=%ld, len=%ld, jOffset=%ld, jLen=%ld,"
+                    " startReadingAt=%ld, lengthOfRead=%ld",
+                    offset, len, entry.offset, entry.length, startReadingAt, lengthOfRead);
+        ret.reset();
+        l_bytesRead += count;
+        goto out;
+      }
+      count += err;
     }
-    else
-      // skip over this journal entry
-      ::lseek(journalFD, offlen[1], SEEK_CUR);
+    l_bytesRead += lengthOfRead;
   }
 out:
   *_bytesReadOut = l_bytesRead;
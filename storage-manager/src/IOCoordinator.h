@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <boost/utility.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/shared_array.hpp>
@@ -34,6 +35,8 @@
 #include "Replicator.h"
 #include "Utilities.h"
 #include "Ownership.h"
+#include "ThreadPool.h"
+#include "CloudStorage.h"
 
 namespace storagemanager
 {
@@ -96,6 +99,7 @@ class IOCoordinator : public boost::noncopyable
   Cache* cache;
   SMLogging* logger;
   Replicator* replicator;
+  CloudStorage* storage;
   Ownership ownership;  // ACK!  Need a new name for this!
 
   size_t objectSize;
@@ -116,6 +120,38 @@ class IOCoordinator : public boost::noncopyable
   int loadObjectAndJournal(const char* objFilename, const char* journalFilename, uint8_t* data, off_t offset,
                            size_t length);
   int loadObject(int fd, uint8_t* data, off_t offset, size_t length);
+  int loadObjectRange(const std::string& key, uint8_t* data, off_t offset, size_t length);
+
+  /* Read-ahead.  Reads that pick up where the previous read of the same file left off are counted
+     as sequential.  Once a file is read sequentially, the next prefetchObjects objects past the read
+     are downloaded into the cache in the background.  Files that aren't read sequentially are
+     candidates for range reads instead, if the CloudStorage impl supports them. */
+  struct AccessPattern
+  {
+    AccessPattern();
+    off_t nextOffset;
+    uint sequentialReads;
+    off_t prefetchedTo;
+  };
+
+  struct Prefetch : public ThreadPool::Job
+  {
+    Prefetch(IOCoordinator* ioc, const boost::filesystem::path& filename, off_t offset, size_t length);
+    void operator()();
+    IOCoordinator* ioc;
+    const boost::filesystem::path filename;
+    off_t offset;
+    size_t length;
+  };
+
+  bool trackAccess(const boost::filesystem::path& filename, off_t offset, size_t length);
+  void prefetch(const boost::filesystem::path& filename, off_t offset, size_t length);
+
+  size_t prefetchObjects;
+  size_t rangeReadMaxSize;
+  std::unordered_map<std::string, AccessPattern> accessPatterns;
+  boost::mutex accessPatternMutex;
+  ThreadPool prefetchThreads;
 
   // some KPIs
   // from the user's POV...
@@ -125,6 +161,7 @@ class IOCoordinator : public boost::noncopyable
   // from IOC's pov...
   size_t iocFilesOpened, iocObjectsCreated, iocJournalsCreated, iocFilesDeleted;
   size_t iocBytesRead, iocBytesWritten;
+  size_t iocPrefetchesIssued, iocObjectsPrefetched, iocRangeReads, iocRangeBytesRead;
 };
 
 }  // namespace storagemanager
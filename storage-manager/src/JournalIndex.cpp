@@ -0,0 +1,251 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include "JournalIndex.h"
+#include "Config.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+storagemanager::JournalIndex* ji = NULL;
+boost::mutex m;
+
+// the most journals we keep an index for if ObjectStorage/journal_index_max_files is not set
+const size_t defaultMaxIndexes = 10000;
+
+// a journal header is a json doc terminated by a null char that fits in the first 100 bytes
+const size_t maxJournalHeaderSize = 100;
+}  // namespace
+
+namespace storagemanager
+{
+JournalIndex::Index::Index() : device(0), inode(0), indexedTo(0), maxLength(0)
+{
+}
+
+JournalIndex::JournalIndex()
+{
+  logger = SMLogging::get();
+  maxIndexes = defaultMaxIndexes;
+
+  string stmp = Config::get()->getValue("ObjectStorage", "journal_index_max_files");
+  if (!stmp.empty())
+  {
+    try
+    {
+      maxIndexes = stoul(stmp);
+    }
+    catch (invalid_argument&)
+    {
+      logger->log(LOG_WARNING, "journal_index_max_files is not a number. Using the default = %zu",
+                  defaultMaxIndexes);
+    }
+  }
+
+  lookups = indexesBuilt = indexesRebuilt = indexesEvicted = entriesIndexed = entriesAdded =
+      entriesReturned = 0;
+}
+
+JournalIndex::~JournalIndex()
+{
+}
+
+JournalIndex* JournalIndex::get()
+{
+  if (ji)
+    return ji;
+  boost::mutex::scoped_lock s(m);
+  if (ji)
+    return ji;
+  ji = new JournalIndex();
+  return ji;
+}
+
+void JournalIndex::printKPIs() const
+{
+  cout << "JournalIndex" << endl;
+  cout << "\tlookups = " << lookups << endl;
+  cout << "\tindexesBuilt = " << indexesBuilt << endl;
+  cout << "\tindexesRebuilt = " << indexesRebuilt << endl;
+  cout << "\tindexesEvicted = " << indexesEvicted << endl;
+  cout << "\tentriesIndexed = " << entriesIndexed << endl;
+  cout << "\tentriesAdded = " << entriesAdded << endl;
+  cout << "\tentriesReturned = " << entriesReturned << endl;
+}
+
+void JournalIndex::addEntry(Index& index, off_t entryPos, uint64_t offset, uint64_t length)
+{
+  Entry e;
+  e.offset = offset;
+  e.length = length;
+  e.journalPos = entryPos + 16;
+  index.entries.insert(make_pair(offset, e));
+  index.maxLength = max(index.maxLength, length);
+  index.indexedTo = e.journalPos + length;
+}
+
+// Parses the entries appended to the journal since it was last indexed.  Called with index.mutex held.
+int JournalIndex::catchUp(Index& index, const string& journalName, int journalFD, size_t* bytesRead)
+{
+  struct stat statbuf;
+  if (::fstat(journalFD, &statbuf))
+    return -1;
+
+  if (index.indexedTo != 0 &&
+      (statbuf.st_dev != index.device || statbuf.st_ino != index.inode || statbuf.st_size < index.indexedTo))
+  {
+    // the journal was replaced or truncated since it was indexed, start over
+    index.entries.clear();
+    index.maxLength = 0;
+    index.indexedTo = 0;
+    ++indexesRebuilt;
+  }
+  index.device = statbuf.st_dev;
+  index.inode = statbuf.st_ino;
+
+  if (index.indexedTo == 0)
+  {
+    char header[maxJournalHeaderSize];
+    ssize_t err = ::pread(journalFD, header, maxJournalHeaderSize, 0);
+    if (err < 0)
+      return -1;
+    char* end = (char*)memchr(header, 0, err);
+    if (!end)
+    {
+      logger->log(LOG_ERR, "JournalIndex: did not find the end of the header in %s", journalName.c_str());
+      errno = EIO;
+      return -1;
+    }
+    index.indexedTo = end - header + 1;
+    *bytesRead += index.indexedTo;
+    ++indexesBuilt;
+  }
+
+  while (index.indexedTo + 16 <= statbuf.st_size)
+  {
+    uint64_t offlen[2];
+    ssize_t err = ::pread(journalFD, offlen, 16, index.indexedTo);
+    if (err < 0)
+      return -1;
+    if (err != 16)
+      break;
+    *bytesRead += 16;
+    // An entry whose data isn't all there yet is left for the next call
+    if ((uint64_t)(index.indexedTo + 16) + offlen[1] > (uint64_t)statbuf.st_size)
+      break;
+    addEntry(index, index.indexedTo, offlen[0], offlen[1]);
+    ++entriesIndexed;
+  }
+  return 0;
+}
+
+int JournalIndex::lookup(const string& journalName, int journalFD, off_t offset, size_t length,
+                         vector<Entry>* out, size_t* bytesRead)
+{
+  shared_ptr<Index> index;
+  {
+    boost::mutex::scoped_lock s(mutex);
+    ++lookups;
+    auto it = indexes.find(journalName);
+    if (it == indexes.end())
+    {
+      index.reset(new Index());
+      lru.push_front(journalName);
+      index->lruPos = lru.begin();
+      indexes[journalName] = index;
+      while (indexes.size() > maxIndexes && maxIndexes > 0)
+      {
+        indexes.erase(lru.back());
+        lru.pop_back();
+        ++indexesEvicted;
+      }
+    }
+    else
+    {
+      index = it->second;
+      lru.splice(lru.begin(), lru, index->lruPos);
+    }
+  }
+
+  boost::mutex::scoped_lock s(index->mutex);
+  if (catchUp(*index, journalName, journalFD, bytesRead))
+  {
+    int l_errno = errno;
+    // don't leave a half-built index behind
+    index->entries.clear();
+    index->maxLength = 0;
+    index->indexedTo = 0;
+    errno = l_errno;
+    return -1;
+  }
+
+  // every entry that overlaps the range starts in (offset - maxLength, offset + length)
+  uint64_t lastBufOffset = offset + length;
+  uint64_t firstStart = ((uint64_t)offset > index->maxLength ? offset - index->maxLength : 0);
+  out->clear();
+  for (auto it = index->entries.lower_bound(firstStart);
+       it != index->entries.end() && it->first < lastBufOffset; ++it)
+  {
+    if (it->second.offset + it->second.length > (uint64_t)offset)
+      out->push_back(it->second);
+  }
+
+  // later entries overwrite earlier ones, so they have to be applied in journal order
+  sort(out->begin(), out->end(), [](const Entry& a, const Entry& b) { return a.journalPos < b.journalPos; });
+  entriesReturned += out->size();
+  return 0;
+}
+
+void JournalIndex::entryAdded(const string& journalName, off_t entryPos, uint64_t offset, uint64_t length)
+{
+  shared_ptr<Index> index;
+  {
+    boost::mutex::scoped_lock s(mutex);
+    auto it = indexes.find(journalName);
+    if (it == indexes.end())
+      return;
+    index = it->second;
+  }
+
+  boost::mutex::scoped_lock s(index->mutex);
+  // only extend an index that is current; otherwise lookup() will reread the tail of the journal
+  if (index->indexedTo == entryPos)
+  {
+    addEntry(*index, entryPos, offset, length);
+    ++entriesAdded;
+  }
+}
+
+void JournalIndex::remove(const string& journalName)
+{
+  boost::mutex::scoped_lock s(mutex);
+  auto it = indexes.find(journalName);
+  if (it == indexes.end())
+    return;
+  lru.erase(it->second->lruPos);
+  indexes.erase(it);
+}
+
+}  // namespace storagemanager
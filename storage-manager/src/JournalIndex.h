@@ -0,0 +1,103 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#pragma once
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "SMLogging.h"
+
+/* JournalIndex keeps an in-memory interval index for each journal file, mapping the object offsets
+   covered by each journal entry to the position of that entry's data in the journal.  It lets a
+   partial read apply only the journal entries that overlap the requested range instead of walking
+   the whole journal.
+
+   Journals are append-only, so an index is brought up to date by parsing only the entries appended
+   since it was last used.  An index is thrown away and rebuilt if the journal it describes was
+   replaced or shrank. */
+
+namespace storagemanager
+{
+class JournalIndex : public boost::noncopyable
+{
+ public:
+  static JournalIndex* get();
+  virtual ~JournalIndex();
+
+  struct Entry
+  {
+    uint64_t offset;    // offset in the object
+    uint64_t length;    // length of the entry's data
+    off_t journalPos;   // position of the entry's data in the journal file
+  };
+
+  // Fills entries with the journal entries overlapping [offset, offset + length), in the order they
+  // were appended to the journal.  journalFD must be open on journalName.  bytesRead is incremented
+  // by the amount of the journal read to bring the index up to date.
+  // Returns 0 on success, -1 on error with errno set.
+  int lookup(const std::string& journalName, int journalFD, off_t offset, size_t length,
+             std::vector<Entry>* entries, size_t* bytesRead);
+
+  // Replicator calls this after appending an entry to a journal.  entryPos is the position of the
+  // entry header.  If the index for that journal is current, the entry is added without rereading
+  // the journal, otherwise the next lookup() will catch up.
+  void entryAdded(const std::string& journalName, off_t entryPos, uint64_t offset, uint64_t length);
+
+  // Drops the index of a journal that was deleted.
+  void remove(const std::string& journalName);
+
+  void printKPIs() const;
+
+ private:
+  JournalIndex();
+
+  struct Index
+  {
+    Index();
+    boost::mutex mutex;
+    dev_t device;
+    ino_t inode;
+    off_t indexedTo;     // the journal has been indexed up to this position
+    uint64_t maxLength;  // the longest entry, bounds the lookup for overlapping entries
+    std::multimap<uint64_t, Entry> entries;  // keyed by object offset
+    std::list<std::string>::iterator lruPos;
+  };
+
+  int catchUp(Index& index, const std::string& journalName, int journalFD, size_t* bytesRead);
+  void addEntry(Index& index, off_t entryPos, uint64_t offset, uint64_t length);
+
+  std::unordered_map<std::string, std::shared_ptr<Index>> indexes;
+  std::list<std::string> lru;  // front is the most recently used
+  size_t maxIndexes;
+  boost::mutex mutex;
+  SMLogging* logger;
+
+  // KPIs
+  size_t lookups, indexesBuilt, indexesRebuilt, indexesEvicted, entriesIndexed, entriesAdded,
+      entriesReturned;
+};
+
+}  // namespace storagemanager
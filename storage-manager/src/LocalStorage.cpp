@@ -172,6 +172,46 @@ int LocalStorage::getObject(const std::string& sourceKey, boost::shared_array<ui
   return 0;
 }
 
+int LocalStorage::getObjectRange(const string& sourceKey, uint8_t* data, off_t offset, size_t length,
+                                 size_t* sizeRead)
+{
+  addLatency();
+
+  bf::path source = prefix / sourceKey;
+  int l_errno;
+
+  int fd = ::open(source.string().c_str(), O_RDONLY);
+  if (fd < 0)
+    return fd;
+
+  size_t count = 0;
+  while (count < length)
+  {
+    int err = ::pread(fd, &data[count], length - count, offset + count);
+    if (err < 0)
+    {
+      l_errno = errno;
+      close(fd);
+      bytesRead += count;
+      errno = l_errno;
+      return err;
+    }
+    else if (err == 0)
+      break;
+    count += err;
+  }
+  close(fd);
+  *sizeRead = count;
+  bytesRead += count;
+  ++rangesGotten;
+  return 0;
+}
+
+bool LocalStorage::supportsRangeReads() const
+{
+  return true;
+}
+
 int LocalStorage::putObject(const string& source, const string& dest)
 {
   addLatency();
@@ -37,6 +37,9 @@ class LocalStorage : public CloudStorage
   int deleteObject(const std::string& key);
   int copyObject(const std::string& sourceKey, const std::string& destKey);
   int exists(const std::string& key, bool* out);
+  int getObjectRange(const std::string& sourceKey, uint8_t* data, off_t offset, size_t length,
+                     size_t* sizeRead);
+  bool supportsRangeReads() const;
 
   const boost::filesystem::path& getPrefix() const;
   void printKPIs() const;
@@ -19,12 +19,17 @@
  * MetadataFile.cpp
  */
 #include "MetadataFile.h"
+#include "Utilities.h"
 #include <boost/filesystem.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/random_generator.hpp>
 #include <cstdio>
 #include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <algorithm>
 #include <fstream>
 
 #define max(x, y) (x > y ? x : y)
@@ -38,6 +43,22 @@ namespace
 boost::mutex mdfLock;
 storagemanager::MetadataFile::MetadataConfig* inst = NULL;
 uint64_t metadataFilesAccessed = 0;
+uint64_t metadataFilesLoaded = 0;
+uint64_t jsonMetadataFilesLoaded = 0;
+
+// The binary metadata format.  Fields are in host byte order.  The header is followed by an array of
+// MetadataFile::ObjectList::Entry sorted by offset, followed by the keys they refer to.
+const char binaryMagic[8] = {'S', 'M', 'M', 'E', 'T', 'A', '\0', '\0'};
+const uint32_t binaryVersion = 2;
+
+struct BinaryHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t revision;
+  uint64_t objectCount;
+  uint64_t keysLength;
+};
 }  // namespace
 
 namespace storagemanager
@@ -98,7 +119,7 @@ MetadataFile::MetadataFile()
 {
   mpConfig = MetadataConfig::get();
   mpLogger = SMLogging::get();
-  mVersion = 1;
+  mVersion = binaryVersion;
   mRevision = 1;
   _exists = false;
 }
@@ -111,35 +132,28 @@ MetadataFile::MetadataFile(const boost::filesystem::path& filename)
 
   mFilename = mpConfig->msMetadataPath / (filename.string() + ".meta");
 
-  boost::unique_lock<boost::mutex> s(jsonCache.getMutex());
-  jsontree = jsonCache.get(mFilename);
-  if (!jsontree)
+  boost::unique_lock<boost::mutex> s(metadataCache.getMutex());
+  objects = metadataCache.get(mFilename);
+  if (!objects)
   {
     if (boost::filesystem::exists(mFilename))
     {
-      std::ifstream i(mFilename.string());
-      jsontree.reset(new nlohmann::json);
-      i >> *jsontree;
-      jsonCache.put(mFilename, jsontree);
+      load();
+      metadataCache.put(mFilename, objects);
       s.unlock();
-      mVersion = 1;
-      mRevision = (*jsontree)["revision"];
     }
     else
     {
-      mVersion = 1;
       mRevision = 1;
-      makeEmptyJsonTree();
+      makeEmptyObjectList();
       s.unlock();
       writeMetadata();
     }
   }
   else
-  {
     s.unlock();
-    mVersion = 1;
-    mRevision = (*jsontree)["revision"];;
-  }
+  mVersion = objects->version;
+  mRevision = objects->revision;
   ++metadataFilesAccessed;
 }
 
@@ -153,36 +167,31 @@ MetadataFile::MetadataFile(const boost::filesystem::path& filename, no_create_t,
   if (appendExt)
     mFilename = mpConfig->msMetadataPath / (mFilename.string() + ".meta");
 
-  boost::unique_lock<boost::mutex> s(jsonCache.getMutex());
-  jsontree = jsonCache.get(mFilename);
-  if (!jsontree)
+  boost::unique_lock<boost::mutex> s(metadataCache.getMutex());
+  objects = metadataCache.get(mFilename);
+  if (!objects)
   {
     if (boost::filesystem::exists(mFilename))
     {
       _exists = true;
-      jsontree.reset(new nlohmann::json);
-      std::ifstream i(mFilename.string());
-      i >> *jsontree;
-      jsonCache.put(mFilename, jsontree);
+      load();
+      metadataCache.put(mFilename, objects);
       s.unlock();
-      mVersion = 1;
-      mRevision = (*jsontree)["revision"];
     }
     else
     {
-      mVersion = 1;
       mRevision = 1;
       _exists = false;
-      makeEmptyJsonTree();
+      makeEmptyObjectList();
     }
   }
   else
   {
     s.unlock();
     _exists = true;
-    mVersion = 1;
-    mRevision = (*jsontree)["revision"];
   }
+  mVersion = objects->version;
+  mRevision = objects->revision;
   ++metadataFilesAccessed;
 }
 
@@ -190,17 +199,37 @@ MetadataFile::~MetadataFile()
 {
 }
 
-void MetadataFile::makeEmptyJsonTree()
+void MetadataFile::makeEmptyObjectList()
+{
+  objects.reset(new ObjectList(mRevision));
+}
+
+vector<metadataObject>& MetadataFile::modifiableObjects()
 {
-  jsontree.reset(new nlohmann::json);
-  (*jsontree)["version"] = mVersion;
-  (*jsontree)["revision"] = mRevision;
-  (*jsontree)["objects"] = nlohmann::json::array();
+  // Only this MetadataFile has it if the count is 1, and no one can get it from us meanwhile
+  if (objects.use_count() > 1)
+    objects.reset(objects->copy());
+  return objects->objects();
+}
+
+void MetadataFile::load()
+{
+  objects.reset(new ObjectList());
+  if (objects->load(mFilename))
+  {
+    char buf[80];
+    ostringstream oss;
+    oss << "MetadataFile: failed to load " << mFilename.string() << ", got " << strerror_r(errno, buf, 80);
+    mpLogger->log(LOG_ERR, oss.str().c_str());
+    throw runtime_error(oss.str());
+  }
 }
 
 void MetadataFile::printKPIs()
 {
   cout << "Metadata files accessed = " << metadataFilesAccessed << endl;
+  cout << "Metadata files loaded = " << metadataFilesLoaded << endl;
+  cout << "Metadata files loaded from JSON = " << jsonMetadataFilesLoaded << endl;
 }
 
 int MetadataFile::stat(struct stat* out) const
@@ -215,15 +244,10 @@ int MetadataFile::stat(struct stat* out) const
 
 size_t MetadataFile::getLength() const
 {
-  size_t totalSize = 0;
-
-  auto &objects = (*jsontree)["objects"];
-  if (!objects.empty())
-  {
-    auto& lastObject = objects.back();
-    totalSize = lastObject["offset"].get<off_t>() + lastObject["length"].get<size_t>();
-  }
-  return totalSize;
+  size_t count = objects->size();
+  if (count == 0)
+    return 0;
+  return objects->offsetAt(count - 1) + objects->lengthAt(count - 1);
 }
 
 bool MetadataFile::exists() const
@@ -233,48 +257,44 @@ bool MetadataFile::exists() const
 
 vector<metadataObject> MetadataFile::metadataRead(off_t offset, size_t length) const
 {
-  // this version assumes mObjects is sorted by offset, and there are no gaps between objects
+  // this version assumes objects is sorted by offset, and there are no gaps between objects
   vector<metadataObject> ret;
   size_t foundLen = 0;
+  size_t count = objects->size();
 
-  /* For first cut of optimizations, going to generate mObjects as it was to use the existing alg
-     rather than write a new alg.
-  */
-  set<metadataObject> mObjects;
-  for(const auto &v : (*jsontree)["objects"])
-  {
-    mObjects.insert(metadataObject(v["offset"], v["length"], v["key"]));
-  }
-
-  if (mObjects.size() == 0)
+  if (count == 0)
     return ret;
 
-  uint64_t lastOffset = mObjects.rbegin()->offset;
-  auto i = mObjects.begin();
-  // find the first object in range
-  // Note, the last object in mObjects may not be full, compare the last one against its maximum
+  uint64_t lastOffset = objects->offsetAt(count - 1);
+  // find the first object in range, starting with the last one that starts at or before offset.
+  // Note, the last object may not be full, compare the last one against its maximum
   // size rather than its current size.
-  while (i != mObjects.end())
+  size_t i = objects->upperBound(offset);
+  if (i > 0)
+    --i;
+  while (i < count)
   {
-    if ((uint64_t)offset <= (i->offset + i->length - 1) ||
-        (i->offset == lastOffset && ((uint64_t)offset <= i->offset + mpConfig->mObjectSize - 1)))
+    uint64_t objOffset = objects->offsetAt(i);
+    uint64_t objLength = objects->lengthAt(i);
+    if ((uint64_t)offset <= (objOffset + objLength - 1) ||
+        (objOffset == lastOffset && ((uint64_t)offset <= objOffset + mpConfig->mObjectSize - 1)))
     {
-      foundLen = (i->offset == lastOffset ? mpConfig->mObjectSize : i->length) - (offset - i->offset);
-      ret.push_back(*i);
+      foundLen = (objOffset == lastOffset ? mpConfig->mObjectSize : objLength) - (offset - objOffset);
+      ret.push_back(objects->at(i));
       ++i;
       break;
     }
     ++i;
   }
 
-  while (i != mObjects.end() && foundLen < length)
+  while (i < count && foundLen < length)
   {
-    ret.push_back(*i);
-    foundLen += i->length;
+    ret.push_back(objects->at(i));
+    foundLen += objects->lengthAt(i);
     ++i;
   }
 
-  assert(!(offset == 0 && length == getLength()) || (ret.size() == mObjects.size()));
+  assert(!(offset == 0 && length == getLength()) || (ret.size() == count));
   return ret;
 }
 
@@ -285,78 +305,67 @@ metadataObject MetadataFile::addMetadataObject(const boost::filesystem::path& fi
   //
 
   metadataObject addObject;
-  auto& objects = (*jsontree)["objects"];
-  if (!objects.empty())
-  {
-    auto& lastObject = objects.back();
-    addObject.offset = lastObject["offset"].get<off_t>() + mpConfig->mObjectSize;
-  }
+  vector<metadataObject>& objs = modifiableObjects();
+  if (!objs.empty())
+    addObject.offset = objs.back().offset + mpConfig->mObjectSize;
 
   addObject.length = length;
   addObject.key = getNewKey(filename.string(), addObject.offset, addObject.length);
-  nlohmann::json object = nlohmann::json::object();
-  object["offset"] = addObject.offset;
-  object["length"] = addObject.length;
-  object["key"] = addObject.key;
-  objects.push_back(object);
+  objs.push_back(addObject);
 
   return addObject;
 }
 
-// TODO: Error handling...s
 int MetadataFile::writeMetadata()
 {
   if (!boost::filesystem::exists(mFilename.parent_path()))
     boost::filesystem::create_directories(mFilename.parent_path());
 
-  std::ofstream o(mFilename.c_str());
-  o << *jsontree;
+  if (objects->write(mFilename))
+  {
+    char buf[80];
+    int l_errno = errno;
+    mpLogger->log(LOG_ERR, "MetadataFile::writeMetadata(): failed to write %s, got %s", mFilename.c_str(),
+                  strerror_r(l_errno, buf, 80));
+    errno = l_errno;
+    return -1;
+  }
+  mVersion = binaryVersion;
   _exists = true;
 
-  boost::unique_lock<boost::mutex> s(jsonCache.getMutex());
-  jsonCache.put(mFilename, jsontree);
+  boost::unique_lock<boost::mutex> s(metadataCache.getMutex());
+  metadataCache.put(mFilename, objects);
 
   return 0;
 }
 
 bool MetadataFile::getEntry(off_t offset, metadataObject* out) const
 {
-  metadataObject addObject;
-  for(auto &v: (*jsontree)["objects"])
-  {
-    if (v["offset"].get<off_t>() == offset)
-    {
-      out->offset = offset;
-      out->length = v["length"].get<size_t>();
-      out->key = v["key"];
-      return true;
-    }
-  }
-  return false;
+  ssize_t i = objects->find(offset);
+  if (i < 0)
+    return false;
+  *out = objects->at(i);
+  return true;
 }
 
 void MetadataFile::removeEntry(off_t offset)
 {
-  auto& objects = (*jsontree)["objects"];
-  for (auto it = objects.begin(); it != objects.end(); ++it)
-  {
-    if ((*it)["offset"].get<off_t>() == offset)
-    {
-      objects.erase(it);
-      break;
-    }
-  }
+  ssize_t i = objects->find(offset);
+  if (i < 0)
+    return;
+  vector<metadataObject>& objs = modifiableObjects();
+  objs.erase(objs.begin() + i);
 }
 
 void MetadataFile::removeAllEntries()
 {
-  (*jsontree)["objects"] = nlohmann::json::array();
+  modifiableObjects().clear();
 }
 
 void MetadataFile::deletedMeta(const bf::path& p)
 {
-  boost::unique_lock<boost::mutex> s(jsonCache.getMutex());
-  jsonCache.erase(p);
+  boost::unique_lock<boost::mutex> s(metadataCache.getMutex());
+  metadataCache.erase(p);
 }
 
 // There are more efficient ways to do it.  Optimize if necessary.
@@ -454,23 +463,22 @@ void MetadataFile::setLengthInKey(string& key, size_t newLength)
 
 void MetadataFile::printObjects() const
 {
-  for (auto& v : (*jsontree)["objects"])
+  for (size_t i = 0; i < objects->size(); i++)
   {
-    printf("Name: %s Length: %zu Offset: %lld\n", v["key"].get<std::string>().c_str(),
-           v["length"].get<size_t>(), (long long)v["offset"].get<off_t>());
+    printf("Name: %s Length: %zu Offset: %lld\n", objects->keyAt(i).c_str(), (size_t)objects->lengthAt(i),
+           (long long)objects->offsetAt(i));
   }
 }
 
 void MetadataFile::updateEntry(off_t offset, const string& newName, size_t newLength)
 {
-  for (auto& v : (*jsontree)["objects"])
+  ssize_t i = objects->find(offset);
+  if (i >= 0)
   {
-    if (v["offset"].get<off_t>() == offset)
-    {
-      v["key"] = newName;
-      v["length"] = newLength;
-      return;
-    }
+    metadataObject& obj = modifiableObjects()[i];
+    obj.key = newName;
+    obj.length = newLength;
+    return;
   }
   stringstream ss;
   ss << "MetadataFile::updateEntry(): failed to find object at offset " << offset;
@@ -480,13 +488,11 @@ void MetadataFile::updateEntry(off_t offset, const string& newName, size_t newLe
 
 void MetadataFile::updateEntryLength(off_t offset, size_t newLength)
 {
-  for (auto& v : (*jsontree)["objects"])
+  ssize_t i = objects->find(offset);
+  if (i >= 0)
   {
-    if (v["offset"].get<off_t>() == offset)
-    {
-      v["length"] = newLength;
-      return;
-    }
+    modifiableObjects()[i].length = newLength;
+    return;
   }
   stringstream ss;
   ss << "MetadataFile::updateEntryLength(): failed to find object at offset " << offset;
@@ -496,12 +502,7 @@ void MetadataFile::updateEntryLength(off_t offset, size_t newLength)
 
 off_t MetadataFile::getMetadataNewObjectOffset()
 {
-  auto& objects = (*jsontree)["objects"];
-  if (objects.empty())
-    return 0;
-
-  auto& lastObject = objects.back();
-  return lastObject["offset"].get<off_t>() + lastObject["length"].get<size_t>();
+  return getLength();
 }
 
 metadataObject::metadataObject() : offset(0), length(0)
@@ -517,6 +518,270 @@ metadataObject::metadataObject(uint64_t _offset, uint64_t _length, const std::st
 {
 }
 
+struct MetadataFile::ObjectList::Entry
+{
+  uint64_t offset;
+  uint64_t length;
+  uint64_t keyOffset;  // the position of the key in the key section
+  uint64_t keyLength;
+};
+
+MetadataFile::ObjectList::ObjectList(int _revision)
+ : version(binaryVersion)
+ , revision(_revision)
+ , mapping(NULL)
+ , mappingSize(0)
+ , entries(NULL)
+ , keys(NULL)
+ , entryCount(0)
+{
+}
+
+MetadataFile::ObjectList::~ObjectList()
+{
+  unmap();
+}
+
+void MetadataFile::ObjectList::unmap()
+{
+  if (mapping)
+    ::munmap(mapping, mappingSize);
+  mapping = NULL;
+  mappingSize = 0;
+  entries = NULL;
+  keys = NULL;
+  entryCount = 0;
+}
+
+int MetadataFile::ObjectList::load(const bf::path& filename)
+{
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return -1;
+  ScopedCloser sc(fd);
+
+  struct stat statbuf;
+  if (::fstat(fd, &statbuf))
+    return -1;
+  size_t fileSize = statbuf.st_size;
+
+  char magic[sizeof(binaryMagic)];
+  ssize_t err = ::pread(fd, magic, sizeof(magic), 0);
+  if (err < 0)
+    return -1;
+
+  if ((size_t)err < sizeof(magic) || memcmp(magic, binaryMagic, sizeof(magic)) != 0)
+  {
+    // it's a metadata file from an earlier version
+    nlohmann::json jsontree;
+    try
+    {
+      std::ifstream i(filename.string());
+      i >> jsontree;
+      version = jsontree["version"];
+      revision = jsontree["revision"];
+      for (const auto& v : jsontree["objects"])
+        mObjects.push_back(metadataObject(v["offset"], v["length"], v["key"]));
+    }
+    catch (exception&)
+    {
+      mObjects.clear();
+      errno = EBADMSG;
+      return -1;
+    }
+    // the json objects should already be in order.  If there are duplicate offsets, keep the first one.
+    stable_sort(mObjects.begin(), mObjects.end());
+    mObjects.erase(unique(mObjects.begin(), mObjects.end(),
+                          [](const metadataObject& a, const metadataObject& b) { return a.offset == b.offset; }),
+                   mObjects.end());
+    ++metadataFilesLoaded;
+    ++jsonMetadataFilesLoaded;
+    return 0;
+  }
+
+  if (fileSize < sizeof(BinaryHeader))
+  {
+    errno = EBADMSG;
+    return -1;
+  }
+  void* m = ::mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (m == MAP_FAILED)
+    return -1;
+  mapping = (uint8_t*)m;
+  mappingSize = fileSize;
+
+  const BinaryHeader* header = (const BinaryHeader*)mapping;
+  size_t maxEntries = (fileSize - sizeof(BinaryHeader)) / sizeof(Entry);
+  if (header->version != binaryVersion || header->objectCount > maxEntries ||
+      sizeof(BinaryHeader) + header->objectCount * sizeof(Entry) + header->keysLength != fileSize)
+  {
+    unmap();
+    errno = EBADMSG;
+    return -1;
+  }
+  entries = (const Entry*)&mapping[sizeof(BinaryHeader)];
+  keys = (const char*)&entries[header->objectCount];
+  entryCount = header->objectCount;
+  version = header->version;
+  revision = header->revision;
+
+  // the searches depend on the entries being sorted, and a key outside the key section would be bad
+  for (size_t i = 0; i < entryCount; i++)
+  {
+    if ((i > 0 && entries[i].offset <= entries[i - 1].offset) || entries[i].keyOffset > header->keysLength ||
+        entries[i].keyLength > header->keysLength - entries[i].keyOffset)
+    {
+      unmap();
+      errno = EBADMSG;
+      return -1;
+    }
+  }
+  ++metadataFilesLoaded;
+  return 0;
+}
+
+// Writes the list to a temporary file and renames it to filename.  Files that are mapped by other
+// ObjectLists are unaffected by that.
+int MetadataFile::ObjectList::write(const bf::path& filename)
+{
+  size_t count = size();
+  BinaryHeader header;
+  memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+  header.version = binaryVersion;
+  header.revision = revision;
+  header.objectCount = count;
+  header.keysLength = 0;
+
+  vector<Entry> newEntries(count);
+  string newKeys;
+  for (size_t i = 0; i < count; i++)
+  {
+    string key = keyAt(i);
+    newEntries[i].offset = offsetAt(i);
+    newEntries[i].length = lengthAt(i);
+    newEntries[i].keyOffset = newKeys.length();
+    newEntries[i].keyLength = key.length();
+    newKeys += key;
+  }
+  header.keysLength = newKeys.length();
+
+  string tmpFilename = filename.string() + ".tmp";
+  int fd = ::open(tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    return -1;
+  ScopedCloser sc(fd);
+
+  const struct
+  {
+    const void* data;
+    size_t length;
+  } sections[] = {{&header, sizeof(header)},
+                  {newEntries.data(), count * sizeof(Entry)},
+                  {newKeys.data(), newKeys.length()}};
+
+  for (const auto& section : sections)
+  {
+    size_t written = 0;
+    while (written < section.length)
+    {
+      ssize_t err = ::write(fd, (const uint8_t*)section.data + written, section.length - written);
+      if (err < 0)
+      {
+        int l_errno = errno;
+        ::unlink(tmpFilename.c_str());
+        errno = l_errno;
+        return -1;
+      }
+      written += err;
+    }
+  }
+
+  if (::rename(tmpFilename.c_str(), filename.c_str()))
+  {
+    int l_errno = errno;
+    ::unlink(tmpFilename.c_str());
+    errno = l_errno;
+    return -1;
+  }
+  return 0;
+}
+
+size_t MetadataFile::ObjectList::size() const
+{
+  return (mapping ? entryCount : mObjects.size());
+}
+
+uint64_t MetadataFile::ObjectList::offsetAt(size_t i) const
+{
+  return (mapping ? entries[i].offset : mObjects[i].offset);
+}
+
+uint64_t MetadataFile::ObjectList::lengthAt(size_t i) const
+{
+  return (mapping ? entries[i].length : mObjects[i].length);
+}
+
+string MetadataFile::ObjectList::keyAt(size_t i) const
+{
+  if (mapping)
+    return string(&keys[entries[i].keyOffset], entries[i].keyLength);
+  return mObjects[i].key;
+}
+
+metadataObject MetadataFile::ObjectList::at(size_t i) const
+{
+  if (mapping)
+    return metadataObject(entries[i].offset, entries[i].length, keyAt(i));
+  return mObjects[i];
+}
+
+size_t MetadataFile::ObjectList::upperBound(uint64_t offset) const
+{
+  size_t first = 0, count = size();
+  while (count > 0)
+  {
+    size_t step = count / 2;
+    if (offsetAt(first + step) <= offset)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+ssize_t MetadataFile::ObjectList::find(uint64_t offset) const
+{
+  size_t i = upperBound(offset);
+  if (i > 0 && offsetAt(i - 1) == offset)
+    return i - 1;
+  return -1;
+}
+
+MetadataFile::ObjectList* MetadataFile::ObjectList::copy() const
+{
+  ObjectList* ret = new ObjectList(revision);
+  ret->version = version;
+  ret->mObjects.reserve(size());
+  for (size_t i = 0; i < size(); i++)
+    ret->mObjects.push_back(at(i));
+  return ret;
+}
+
+vector<metadataObject>& MetadataFile::ObjectList::objects()
+{
+  if (mapping)
+  {
+    mObjects.reserve(entryCount);
+    for (size_t i = 0; i < entryCount; i++)
+      mObjects.push_back(at(i));
+    unmap();
+  }
+  return mObjects;
+}
+
 MetadataFile::MetadataCache::MetadataCache()
  : max_lru_size(2000)  // 2000 is an arbitrary #.  Big enough for a large working set.
 {
@@ -527,7 +792,7 @@ inline boost::mutex& MetadataFile::MetadataCache::getMutex()
   return mutex;
 }
 
-MetadataFile::Jsontree_t MetadataFile::MetadataCache::get(const bf::path& p)
+MetadataFile::ObjectList_t MetadataFile::MetadataCache::get(const bf::path& p)
 {
   auto it = lookup.find(p.string());
   if (it != lookup.end())
@@ -536,15 +801,21 @@ MetadataFile::Jsontree_t MetadataFile::MetadataCache::get(const bf::path& p)
     return it->second.first;
   }
 
-  return storagemanager::MetadataFile::Jsontree_t();
+  return storagemanager::MetadataFile::ObjectList_t();
 }
 
-// note, does not change an existing jsontree.  This should be OK.
-void MetadataFile::MetadataCache::put(const bf::path& p, const Jsontree_t& j)
+// replaces the list of p if it has a different one.  The old one lives on until the last
+// MetadataFile that has it is gone.
+void MetadataFile::MetadataCache::put(const bf::path& p, const ObjectList_t& j)
 {
   string sp = p.string();
   auto it = lookup.find(sp);
-  if (it == lookup.end())
+  if (it != lookup.end())
+  {
+    it->second.first = j;
+    lru.splice(lru.end(), lru, it->second.second);
+  }
+  else
   {
     while (lru.size() >= max_lru_size)
     {
@@ -567,6 +838,6 @@ void MetadataFile::MetadataCache::erase(const bf::path& p)
   }
 }
 
-MetadataFile::MetadataCache MetadataFile::jsonCache;
+MetadataFile::MetadataCache MetadataFile::metadataCache;
 
 }  // namespace storagemanager
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <unordered_map>
 #include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
 
 #include <utils/json/json.hpp>
 
@@ -112,7 +113,54 @@ class MetadataFile
 
   static void printKPIs();
 
-  typedef boost::shared_ptr<nlohmann::json> Jsontree_t;
+  /* The objects in a metadata file, sorted by offset.  Metadata files are stored in a binary format,
+     a sorted array of {offset, length, key position} followed by the keys.  A loaded file is mmapped
+     and searched in place.  Metadata files in the JSON format used by earlier versions are parsed into
+     a vector and are written in the binary format the next time they are saved.  Earlier versions
+     can't read the binary format; tools/metadata_to_json.py converts the files back before a downgrade.
+
+     A list in the MetadataCache is shared by every MetadataFile of that file and is never modified.
+     A MetadataFile modifies a copy of it, which replaces it in the cache when it is written. */
+  class ObjectList : public boost::noncopyable
+  {
+   public:
+    ObjectList(int revision = 1);
+    ~ObjectList();
+
+    // these return 0 on success, -1 on error with errno set
+    int load(const boost::filesystem::path& filename);
+    int write(const boost::filesystem::path& filename);
+
+    size_t size() const;
+    uint64_t offsetAt(size_t i) const;
+    uint64_t lengthAt(size_t i) const;
+    std::string keyAt(size_t i) const;
+    metadataObject at(size_t i) const;
+    // returns the index of the object at offset, or -1 if there isn't one
+    ssize_t find(uint64_t offset) const;
+    // returns the index of the first object whose offset is greater than offset
+    size_t upperBound(uint64_t offset) const;
+
+    // returns the modifiable list, copying it out of the mapped file if necessary.  Only for a list
+    // no one else has.
+    std::vector<metadataObject>& objects();
+    // returns an unmapped copy of the list
+    ObjectList* copy() const;
+
+    int version, revision;
+
+   private:
+    void unmap();
+
+    struct Entry;
+    uint8_t* mapping;
+    size_t mappingSize;
+    const Entry* entries;
+    const char* keys;
+    size_t entryCount;
+    std::vector<metadataObject> mObjects;
+  };
+  typedef boost::shared_ptr<ObjectList> ObjectList_t;
 
  private:
   MetadataConfig* mpConfig;
@@ -120,30 +168,32 @@ class MetadataFile
   int mVersion;
   int mRevision;
   boost::filesystem::path mFilename;
-  Jsontree_t jsontree;
-  // std::set<metadataObject> mObjects;
+  ObjectList_t objects;
   bool _exists;
-  void makeEmptyJsonTree();
+  void makeEmptyObjectList();
+  void load();
+  // objects->objects(), after replacing objects with a copy if it's shared
+  std::vector<metadataObject>& modifiableObjects();
 
   class MetadataCache
   {
    public:
     MetadataCache();
-    Jsontree_t get(const boost::filesystem::path&);
-    void put(const boost::filesystem::path&, const Jsontree_t&);
+    ObjectList_t get(const boost::filesystem::path&);
+    void put(const boost::filesystem::path&, const ObjectList_t&);
     void erase(const boost::filesystem::path&);
     boost::mutex& getMutex();
 
    private:
     // there's a more efficient way to do this, KISS for now.
     typedef std::list<std::string> Lru_t;
-    typedef std::unordered_map<std::string, std::pair<Jsontree_t, Lru_t::iterator> > Lookup_t;
+    typedef std::unordered_map<std::string, std::pair<ObjectList_t, Lru_t::iterator> > Lookup_t;
     Lookup_t lookup;
     Lru_t lru;
     uint max_lru_size;
     boost::mutex mutex;
   };
-  static MetadataCache jsonCache;
+  static MetadataCache metadataCache;
 };
 
 }  // namespace storagemanager
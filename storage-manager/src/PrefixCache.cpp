@@ -24,6 +24,7 @@
 #include <syslog.h>
 #include <boost/filesystem.hpp>
 #include <boost/thread.hpp>
+#include <string_view>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -33,7 +34,11 @@ namespace bf = boost::filesystem;
 
 namespace storagemanager
 {
-PrefixCache::PrefixCache(const bf::path& prefix) : firstDir(prefix), currentCacheSize(0)
+PrefixCache::PrefixCache(const bf::path& prefix)
+ : firstDir(prefix)
+ , currentCacheSize(0)
+ , promotionDelay(std::chrono::seconds(1))
+ , stopEvictor(false)
 {
   Config* conf = Config::get();
   logger = SMLogging::get();
@@ -111,11 +116,12 @@ PrefixCache::PrefixCache(const bf::path& prefix) : firstDir(prefix), currentCach
     throw e;
   }
 
-  lru_mutex.lock();  // unlocked by populate() when it's done
   // Ideally put this in background but has to be synchronous with write calls
   populate();
   // boost::thread t([this] { this->populate(); });
   // t.detach();
+
+  evictor = boost::thread([this] { this->evictionLoop(); });
 }
 
 PrefixCache::~PrefixCache()
@@ -123,6 +129,7 @@ PrefixCache::~PrefixCache()
   /*  This and shutdown() need to do whatever is necessary to leave cache contents in a safe
       state on disk.  Does anything need to be done toward that?
   */
+  shutdown();
 }
 
 void PrefixCache::populate()
@@ -133,15 +140,16 @@ void PrefixCache::populate()
   vector<string> newObjects;
   while (dir != dend)
   {
-    // put everything in lru & m_lru
+    // put everything in the probation segment
     const bf::path& p = dir->path();
     if (bf::is_regular_file(p))
     {
-      lru.push_back(p.filename().string());
-      auto last = lru.end();
-      m_lru.insert(--last);
-      currentCacheSize += bf::file_size(*dir);
-      newObjects.push_back(p.filename().string());
+      string key = p.filename().string();
+      Shard& shard = getShard(key);
+      boost::unique_lock<boost::mutex> s(shard.mutex);
+      insertNew(shard, key);
+      addToCacheSize(bf::file_size(*dir));
+      newObjects.push_back(key);
     }
     else if (p != cachePrefix / downloader->getTmpPath())
       logger->log(LOG_WARNING, "Cache: found something in the cache that does not belong '%s'",
@@ -162,7 +170,7 @@ void PrefixCache::populate()
       if (p.extension() == ".journal")
       {
         size_t s = bf::file_size(*dir);
-        currentCacheSize += s;
+        addToCacheSize(s);
         newJournals.push_back(pair<string, size_t>(p.stem().string(), s));
       }
       else
@@ -174,31 +182,45 @@ void PrefixCache::populate()
                   p.string().c_str());
     ++dir;
   }
-  lru_mutex.unlock();
   sync->newJournalEntries(firstDir, newJournals);
 }
 
 // be careful using this!  SM should be idle.  No ongoing reads or writes.
+void PrefixCache::setPromotionDelay(uint32_t milliseconds)
+{
+  promotionDelay = chrono::milliseconds(milliseconds);
+}
+
 void PrefixCache::validateCacheSize()
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
+  vector<boost::unique_lock<boost::mutex> > locks;
+  for (uint i = 0; i < shardCount; i++)
+    locks.emplace_back(shards[i].mutex);
 
-  if (!doNotEvict.empty() || !toBeDeleted.empty())
+  for (uint i = 0; i < shardCount; i++)
   {
-    cout << "Not safe to use validateCacheSize() at the moment." << endl;
-    return;
+    if (!shards[i].doNotEvict.empty() || !shards[i].toBeDeleted.empty())
+    {
+      cout << "Not safe to use validateCacheSize() at the moment." << endl;
+      return;
+    }
   }
 
   size_t oldSize = currentCacheSize;
   currentCacheSize = 0;
-  m_lru.clear();
-  lru.clear();
+  for (uint i = 0; i < shardCount; i++)
+  {
+    shards[i].m_lru.clear();
+    shards[i].probation.clear();
+    shards[i].protectedLRU.clear();
+  }
+  locks.clear();
   populate();
 
   if (oldSize != currentCacheSize)
     logger->log(LOG_DEBUG,
                 "PrefixCache::validateCacheSize(): found a discrepancy.  Actual size is %lld, had %lld.",
-                currentCacheSize, oldSize);
+                (size_t)currentCacheSize, oldSize);
   else
     logger->log(LOG_DEBUG,
                 "PrefixCache::validateCacheSize(): Cache size accounting agrees with reality for now.");
@@ -208,40 +230,59 @@ void PrefixCache::read(const vector<string>& keys)
 {
   /*  Move existing keys to the back of the LRU, start downloading nonexistant keys.
    */
+  vector<const string*> misses;
   vector<const string*> keysToFetch;
   vector<int> dlErrnos;
   vector<size_t> dlSizes;
 
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-
-  M_LRU_t::iterator mit;
+  // The common case, the keys are cached.  Only the shard a key lives in gets locked.
   for (const string& key : keys)
   {
-    mit = m_lru.find(key);
-    if (mit != m_lru.end())
+    Shard& shard = getShard(key);
+    boost::unique_lock<boost::mutex> s(shard.mutex);
+    auto mit = shard.m_lru.find(key);
+    if (mit != shard.m_lru.end())
     {
-      addToDNE(mit->lit);
-      lru.splice(lru.end(), lru, mit->lit);  // move them to the back so they are last to pick for eviction
+      addToDNE(shard, mit->lit);
+      touch(shard, mit);
     }
     else
+      misses.push_back(&key);
+  }
+  if (misses.empty())
+    return;
+
+  // Deciding to download a key and registering the download with the Downloader has to be atomic
+  // wrt other readers of the key.  downloadMutex provides that; it is always taken before a shard mutex.
+  boost::unique_lock<boost::mutex> dl(downloadMutex);
+  for (const string* key : misses)
+  {
+    Shard& shard = getShard(*key);
+    boost::unique_lock<boost::mutex> s(shard.mutex);
+    auto mit = shard.m_lru.find(*key);
+    if (mit != shard.m_lru.end())
     {
-      // There's window where the file has been downloaded but is not yet
-      // added to the lru structs.  However it is in the DNE.  If it is in the DNE, then it is also
-      // in Downloader's map.  So, this thread needs to start the download if it's not in the
-      // DNE or if there's an existing download that hasn't finished yet.  Starting the download
-      // includes waiting for an existing download to finish, which from this class's pov is the
-      // same thing.
-      if (doNotEvict.find(key) == doNotEvict.end() || downloader->inProgress(key))
-        keysToFetch.push_back(&key);
-      else
-        cout << "Cache: detected and stopped a racey download" << endl;
-      addToDNE(key);
+      // another reader finished downloading it in the meantime
+      addToDNE(shard, mit->lit);
+      touch(shard, mit);
+      continue;
     }
+    // There's window where the file has been downloaded but is not yet
+    // added to the lru structs.  However it is in the DNE.  If it is in the DNE, then it is also
+    // in Downloader's map.  So, this thread needs to start the download if it's not in the
+    // DNE or if there's an existing download that hasn't finished yet.  Starting the download
+    // includes waiting for an existing download to finish, which from this class's pov is the
+    // same thing.
+    if (shard.doNotEvict.find(*key) == shard.doNotEvict.end() || downloader->inProgress(*key))
+      keysToFetch.push_back(key);
+    else
+      cout << "Cache: detected and stopped a racey download" << endl;
+    addToDNE(shard, *key);
   }
   if (keysToFetch.empty())
     return;
 
-  downloader->download(keysToFetch, &dlErrnos, &dlSizes, cachePrefix, &lru_mutex);
+  downloader->download(keysToFetch, &dlErrnos, &dlSizes, cachePrefix, &downloadMutex);
 
   size_t sum_sizes = 0;
   for (uint i = 0; i < keysToFetch.size(); ++i)
@@ -253,12 +294,12 @@ void PrefixCache::read(const vector<string>& keys)
     // indicated by existence in doNotEvict.
     if (dlSizes[i] != 0)
     {
-      if (doNotEvict.find(*keysToFetch[i]) != doNotEvict.end())
+      Shard& shard = getShard(*keysToFetch[i]);
+      boost::unique_lock<boost::mutex> s(shard.mutex);
+      if (shard.doNotEvict.find(*keysToFetch[i]) != shard.doNotEvict.end())
       {
         sum_sizes += dlSizes[i];
-        lru.push_back(*keysToFetch[i]);
-        LRU_t::iterator lit = lru.end();
-        m_lru.insert(--lit);  // I dislike this way of grabbing the last iterator in a list.
+        insertNew(shard, *keysToFetch[i]);
       }
       else  // it was downloaded, but a deletion happened so we have to toss it
       {
@@ -268,39 +309,25 @@ void PrefixCache::read(const vector<string>& keys)
     }
   }
 
-  // move everything in keys to the back of the lru (yes, again)
-  for (const string& key : keys)
-  {
-    mit = m_lru.find(key);
-    if (mit != m_lru.end())  // all of the files exist, just not all of them are 'owned by' this thread.
-      lru.splice(lru.end(), lru, mit->lit);
-  }
-
   // fix cache size
-  //_makeSpace(sum_sizes);
-  currentCacheSize += sum_sizes;
+  addToCacheSize(sum_sizes);
 }
 
 void PrefixCache::doneReading(const vector<string>& keys)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
   for (const string& key : keys)
   {
-    removeFromDNE(key);
-    // most should be in the map.
-    // debateable whether it's faster to look up the list iterator and use it
-    // or whether it's faster to bypass that and use strings only.
-
-    // const auto &it = m_lru.find(key);
-    // if (it != m_lru.end())
-    //    removeFromDNE(it->lit);
+    Shard& shard = getShard(key);
+    boost::unique_lock<boost::mutex> s(shard.mutex);
+    removeFromDNE(shard, key);
   }
-  _makeSpace(0);
+  // readers don't delete anything themselves
+  wakeEvictor();
 }
 
 void PrefixCache::doneWriting()
 {
-  makeSpace(0);
+  wakeEvictor();
 }
 
 PrefixCache::DNEElement::DNEElement(const LRU_t::iterator& k) : key(k), refCount(1)
@@ -310,26 +337,67 @@ PrefixCache::DNEElement::DNEElement(const string& k) : sKey(k), refCount(1)
 {
 }
 
-void PrefixCache::addToDNE(const DNEElement& key)
+void PrefixCache::addToDNE(Shard& shard, const DNEElement& key)
 {
-  DNE_t::iterator it = doNotEvict.find(key);
-  if (it != doNotEvict.end())
+  DNE_t::iterator it = shard.doNotEvict.find(key);
+  if (it != shard.doNotEvict.end())
   {
     DNEElement& dnee = const_cast<DNEElement&>(*it);
     ++(dnee.refCount);
   }
   else
-    doNotEvict.insert(key);
+    shard.doNotEvict.insert(key);
 }
 
-void PrefixCache::removeFromDNE(const DNEElement& key)
+void PrefixCache::removeFromDNE(Shard& shard, const DNEElement& key)
 {
-  DNE_t::iterator it = doNotEvict.find(key);
-  if (it == doNotEvict.end())
+  DNE_t::iterator it = shard.doNotEvict.find(key);
+  if (it == shard.doNotEvict.end())
     return;
   DNEElement& dnee = const_cast<DNEElement&>(*it);
   if (--(dnee.refCount) == 0)
-    doNotEvict.erase(it);
+    shard.doNotEvict.erase(it);
+}
+
+void PrefixCache::insertNew(Shard& shard, const string& key)
+{
+  shard.probation.push_back(key);
+  LRU_t::iterator back = shard.probation.end();
+  shard.m_lru.insert(M_LRU_element_t(--back, false, chrono::steady_clock::now()));
+}
+
+// moves an entry to the back of the protected segment, and keeps the protected segment at
+// most ~80% of the shard by demoting its least recently used entries to probation.  An entry in
+// probation stays where it is until it's read promotionDelay after it got there.
+void PrefixCache::touch(Shard& shard, const M_LRU_t::iterator& mit)
+{
+  auto now = chrono::steady_clock::now();
+  if (!mit->isProtected && now - mit->stamp < promotionDelay.load())
+    return;
+
+  LRU_t& from = (mit->isProtected ? shard.protectedLRU : shard.probation);
+  shard.protectedLRU.splice(shard.protectedLRU.end(), from, mit->lit);
+  mit->isProtected = true;
+  mit->stamp = now;
+
+  size_t maxProtected = (shard.probation.size() + shard.protectedLRU.size()) * 4 / 5;
+  while (shard.protectedLRU.size() > maxProtected && shard.protectedLRU.size() > 1)
+  {
+    auto demoted = shard.m_lru.find(shard.protectedLRU.front());
+    assert(demoted != shard.m_lru.end());
+    shard.probation.splice(shard.probation.end(), shard.protectedLRU, demoted->lit);
+    demoted->isProtected = false;
+    demoted->stamp = now;
+  }
+}
+
+void PrefixCache::erase(Shard& shard, const M_LRU_t::iterator& mit)
+{
+  LRU_t::iterator lit = mit->lit;
+  bool isProtected = mit->isProtected;
+  shard.doNotEvict.erase(lit);
+  shard.m_lru.erase(mit);
+  (isProtected ? shard.protectedLRU : shard.probation).erase(lit);
 }
 
 const bf::path& PrefixCache::getCachePath()
@@ -345,92 +413,95 @@ const bf::path& PrefixCache::getJournalPath()
 void PrefixCache::exists(const vector<string>& keys, vector<bool>* out) const
 {
   out->resize(keys.size());
-  boost::unique_lock<boost::mutex> s(lru_mutex);
   for (uint i = 0; i < keys.size(); i++)
-    (*out)[i] = (m_lru.find(keys[i]) != m_lru.end());
+  {
+    const Shard& shard = getShard(keys[i]);
+    boost::unique_lock<boost::mutex> s(shard.mutex);
+    (*out)[i] = (shard.m_lru.find(keys[i]) != shard.m_lru.end());
+  }
 }
 
 bool PrefixCache::exists(const string& key) const
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  return m_lru.find(key) != m_lru.end();
+  const Shard& shard = getShard(key);
+  boost::unique_lock<boost::mutex> s(shard.mutex);
+  return shard.m_lru.find(key) != shard.m_lru.end();
 }
 
 void PrefixCache::newObject(const string& key, size_t size)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  assert(m_lru.find(key) == m_lru.end());
-  if (m_lru.find(key) != m_lru.end())
+  Shard& shard = getShard(key);
+  boost::unique_lock<boost::mutex> s(shard.mutex);
+  assert(shard.m_lru.find(key) == shard.m_lru.end());
+  if (shard.m_lru.find(key) != shard.m_lru.end())
   {
     // This should never happen but was in MCOL-3499
     // Remove this when PrefixCache ctor can call populate() synchronous with write calls
     logger->log(LOG_ERR, "PrefixCache::newObject(): key exists in m_lru already %s", key.c_str());
   }
-  //_makeSpace(size);
-  lru.push_back(key);
-  LRU_t::iterator back = lru.end();
-  m_lru.insert(--back);
-  currentCacheSize += size;
+  insertNew(shard, key);
+  addToCacheSize(size);
 }
 
 void PrefixCache::newJournalEntry(size_t size)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  //_makeSpace(size);
-  currentCacheSize += size;
+  addToCacheSize(size);
 }
 
 void PrefixCache::deletedJournal(size_t size)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-
-  if (currentCacheSize >= size)
-    currentCacheSize -= size;
-  else
-  {
-    ostringstream oss;
-    oss << "PrefixCache::deletedJournal(): Detected an accounting error.";
-    logger->log(LOG_WARNING, oss.str().c_str());
-    currentCacheSize = 0;
-  }
+  subtractFromCacheSize(size, "PrefixCache::deletedJournal()");
 }
 
 void PrefixCache::deletedObject(const string& key, size_t size)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
+  Shard& shard = getShard(key);
+  boost::unique_lock<boost::mutex> s(shard.mutex);
 
-  M_LRU_t::iterator mit = m_lru.find(key);
-  assert(mit != m_lru.end());
+  M_LRU_t::iterator mit = shard.m_lru.find(key);
+  assert(mit != shard.m_lru.end());
 
   // if it's being flushed, let makeSpace() do the deleting
-  if (toBeDeleted.find(mit->lit) == toBeDeleted.end())
+  if (shard.toBeDeleted.find(mit->lit) == shard.toBeDeleted.end())
   {
-    doNotEvict.erase(mit->lit);
-    lru.erase(mit->lit);
-    m_lru.erase(mit);
-    if (currentCacheSize >= size)
-      currentCacheSize -= size;
-    else
+    erase(shard, mit);
+    subtractFromCacheSize(size, "PrefixCache::deletedObject()");
+  }
+}
+
+void PrefixCache::addToCacheSize(size_t size)
+{
+  currentCacheSize += size;
+}
+
+void PrefixCache::subtractFromCacheSize(size_t size, const char* caller)
+{
+  size_t current = currentCacheSize;
+  while (true)
+  {
+    if (current >= size)
+    {
+      if (currentCacheSize.compare_exchange_weak(current, current - size))
+        return;
+    }
+    else if (currentCacheSize.compare_exchange_weak(current, 0))
     {
       ostringstream oss;
-      oss << "PrefixCache::deletedObject(): Detected an accounting error.";
+      oss << caller << ": Detected an accounting error.";
       logger->log(LOG_WARNING, oss.str().c_str());
-      currentCacheSize = 0;
+      return;
     }
   }
 }
 
 void PrefixCache::setMaxCacheSize(size_t size)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  if (size < maxCacheSize)
-    _makeSpace(maxCacheSize - size);
   maxCacheSize = size;
+  wakeEvictor();
 }
 
 void PrefixCache::makeSpace(size_t size)
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
   _makeSpace(size);
 }
 
@@ -439,38 +510,91 @@ size_t PrefixCache::getMaxCacheSize() const
   return maxCacheSize;
 }
 
-// call this holding lru_mutex
-void PrefixCache::_makeSpace(size_t size)
+void PrefixCache::wakeEvictor()
 {
-  ssize_t thisMuch = currentCacheSize + size - maxCacheSize;
-  if (thisMuch <= 0)
+  if (currentCacheSize <= maxCacheSize)
     return;
+  boost::unique_lock<boost::mutex> s(evictorMutex);
+  evictorCond.notify_one();
+}
 
-  LRU_t::iterator it;
-  while (thisMuch > 0 && !lru.empty())
+void PrefixCache::evictionLoop()
+{
+  boost::unique_lock<boost::mutex> s(evictorMutex);
+  while (!stopEvictor)
   {
-    it = lru.begin();
-    // find the first element not being either read() right now or being processed by another
-    // makeSpace() call.
-    while (it != lru.end())
+    bool madeProgress = false;
+    if (currentCacheSize > maxCacheSize)
     {
-      // make sure it's not currently being read or being flushed by another _makeSpace() call
-      if ((doNotEvict.find(it) == doNotEvict.end()) && (toBeDeleted.find(it) == toBeDeleted.end()))
-        break;
-      ++it;
+      s.unlock();
+      madeProgress = (_makeSpace(0) > 0);
+      s.lock();
     }
-    if (it == lru.end())
+    // if everything is in use right now, check again in a bit
+    if (!stopEvictor && !madeProgress)
+      evictorCond.timed_wait(s, boost::posix_time::seconds(1));
+  }
+}
+
+// find the first element not being either read() right now or being processed by another
+// makeSpace() call.
+PrefixCache::LRU_t::iterator PrefixCache::firstEvictable(Shard& shard, LRU_t& segment)
+{
+  LRU_t::iterator it = segment.begin();
+  while (it != segment.end())
+  {
+    if ((shard.doNotEvict.find(it) == shard.doNotEvict.end()) &&
+        (shard.toBeDeleted.find(it) == shard.toBeDeleted.end()))
+      break;
+    ++it;
+  }
+  return it;
+}
+
+// Evicts the least recently used object that isn't in use, first of all the probation segments,
+// then of all the protected segments.  Returns false if there was nothing that could be evicted.
+bool PrefixCache::evictOne(size_t* freed)
+{
+  *freed = 0;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    // the shards are sorted by themselves, so the oldest of their first evictable entries is the one
+    int victim = -1;
+    chrono::steady_clock::time_point oldest;
+    for (uint i = 0; i < shardCount; i++)
     {
-      // nothing can be deleted right now
-      return;
+      Shard& shard = shards[i];
+      boost::unique_lock<boost::mutex> s(shard.mutex);
+      LRU_t& segment = (pass == 0 ? shard.probation : shard.protectedLRU);
+      LRU_t::iterator it = firstEvictable(shard, segment);
+      if (it == segment.end())
+        continue;
+      auto mit = shard.m_lru.find(*it);
+      assert(mit != shard.m_lru.end());
+      if (victim < 0 || mit->stamp < oldest)
+      {
+        victim = i;
+        oldest = mit->stamp;
+      }
     }
+    if (victim < 0)
+      continue;
+
+    Shard& shard = shards[victim];
+    boost::unique_lock<boost::mutex> s(shard.mutex);
+    LRU_t& segment = (pass == 0 ? shard.probation : shard.protectedLRU);
+
+    // it may have changed since it was looked at, the next call looks again
+    LRU_t::iterator it = firstEvictable(shard, segment);
+    if (it == segment.end())
+      return true;
 
     // ran into this a couple times, still happens as of commit 948ee1aa5
     // BT: made this more visable in logging.
     //     likely related to MCOL-3499 and lru containing double entries.
     if (!bf::exists(cachePrefix / *it))
-      logger->log(LOG_WARNING, "PrefixCache::makeSpace(): doesn't exist, %s/%s", cachePrefix.string().c_str(),
-                  ((string)(*it)).c_str());
+      logger->log(LOG_WARNING, "PrefixCache::makeSpace(): doesn't exist, %s/%s",
+                  cachePrefix.string().c_str(), ((string)(*it)).c_str());
     assert(bf::exists(cachePrefix / *it));
     /*
         tell Synchronizer that this key will be evicted
@@ -480,11 +604,11 @@ void PrefixCache::_makeSpace(size_t size)
     */
 
     // logger->log(LOG_WARNING, "Cache:  flushing!");
-    toBeDeleted.insert(it);
+    shard.toBeDeleted.insert(it);
 
     string key = *it;  // need to make a copy; it could get changed after unlocking.
 
-    lru_mutex.unlock();
+    s.unlock();
     try
     {
       Synchronizer::get()->flushObject(firstDir, key);
@@ -492,37 +616,40 @@ void PrefixCache::_makeSpace(size_t size)
     catch (...)
     {
       // it gets logged by Sync
-      lru_mutex.lock();
-      toBeDeleted.erase(it);
-      continue;
+      s.lock();
+      shard.toBeDeleted.erase(it);
+      return true;
     }
-    lru_mutex.lock();
+    s.lock();
 
-    // check doNotEvict again in case this object is now being read
-    if (doNotEvict.find(it) == doNotEvict.end())
+    // check doNotEvict again in case this object is now being read.  A rename
+    // during the flush keeps the entry in this shard, see shardIndex().
+    if (shard.doNotEvict.find(it) == shard.doNotEvict.end())
     {
       bf::path cachedFile = cachePrefix / *it;
-      m_lru.erase(*it);
-      toBeDeleted.erase(it);
-      lru.erase(it);
+      shard.toBeDeleted.erase(it);
+      auto mit = shard.m_lru.find(*it);
+      assert(mit != shard.m_lru.end());
+      erase(shard, mit);
       size_t newSize = bf::file_size(cachedFile);
       replicator->remove(cachedFile, Replicator::LOCAL_ONLY);
-      if (newSize < currentCacheSize)
-      {
-        currentCacheSize -= newSize;
-        thisMuch -= newSize;
-      }
-      else
-      {
-        logger->log(LOG_WARNING,
-                    "PrefixCache::makeSpace(): accounting error.  Almost wrapped currentCacheSize on flush.");
-        currentCacheSize = 0;
-        thisMuch = 0;
-      }
+      subtractFromCacheSize(newSize, "PrefixCache::makeSpace()");
+      *freed = newSize;
     }
     else
-      toBeDeleted.erase(it);
+      shard.toBeDeleted.erase(it);
+    return true;
   }
+  return false;
+}
+
+// returns the number of bytes freed
+size_t PrefixCache::_makeSpace(size_t size)
+{
+  size_t totalFreed = 0, freed;
+  while (currentCacheSize + size > maxCacheSize && evictOne(&freed))
+    totalFreed += freed;
+  return totalFreed;
 }
 
 void PrefixCache::rename(const string& oldKey, const string& newKey, ssize_t sizediff)
@@ -530,38 +657,48 @@ void PrefixCache::rename(const string& oldKey, const string& newKey, ssize_t siz
   // rename it in the LRU
   // erase/insert to rehash it everywhere else
 
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  auto it = m_lru.find(oldKey);
-  if (it == m_lru.end())
+  Shard& shard = getShard(oldKey);
+  boost::unique_lock<boost::mutex> s(shard.mutex);
+  auto it = shard.m_lru.find(oldKey);
+  if (it == shard.m_lru.end())
     return;
 
+  // renames come from merging a journal, which keeps the object's offset & source file, so the
+  // new key hashes to the same shard.
+  assert(&getShard(newKey) == &shard);
+
   auto lit = it->lit;
-  m_lru.erase(it);
+  bool isProtected = it->isProtected;
+  auto stamp = it->stamp;
+  shard.m_lru.erase(it);
   int refCount = 0;
-  auto dne_it = doNotEvict.find(lit);
-  if (dne_it != doNotEvict.end())
+  auto dne_it = shard.doNotEvict.find(lit);
+  if (dne_it != shard.doNotEvict.end())
   {
     refCount = dne_it->refCount;
-    doNotEvict.erase(dne_it);
+    shard.doNotEvict.erase(dne_it);
   }
 
-  auto tbd_it = toBeDeleted.find(lit);
-  bool hasTBDEntry = (tbd_it != toBeDeleted.end());
+  auto tbd_it = shard.toBeDeleted.find(lit);
+  bool hasTBDEntry = (tbd_it != shard.toBeDeleted.end());
   if (hasTBDEntry)
-    toBeDeleted.erase(tbd_it);
+    shard.toBeDeleted.erase(tbd_it);
 
   *lit = newKey;
 
   if (hasTBDEntry)
-    toBeDeleted.insert(lit);
+    shard.toBeDeleted.insert(lit);
   if (refCount != 0)
   {
-    pair<DNE_t::iterator, bool> dne_tmp = doNotEvict.insert(lit);
+    pair<DNE_t::iterator, bool> dne_tmp = shard.doNotEvict.insert(lit);
     const_cast<DNEElement&>(*(dne_tmp.first)).refCount = refCount;
   }
 
-  m_lru.insert(lit);
-  currentCacheSize += sizediff;
+  shard.m_lru.insert(M_LRU_element_t(lit, isProtected, stamp));
+  if (sizediff >= 0)
+    addToCacheSize(sizediff);
+  else
+    subtractFromCacheSize(-sizediff, "PrefixCache::rename()");
 }
 
 int PrefixCache::ifExistsThenDelete(const string& key)
@@ -569,17 +706,16 @@ int PrefixCache::ifExistsThenDelete(const string& key)
   bf::path cachedPath = cachePrefix / key;
   bf::path journalPath = journalPrefix / (key + ".journal");
 
-  boost::unique_lock<boost::mutex> s(lru_mutex);
+  Shard& shard = getShard(key);
+  boost::unique_lock<boost::mutex> s(shard.mutex);
   bool objectExists = false;
 
-  auto it = m_lru.find(key);
-  if (it != m_lru.end())
+  auto it = shard.m_lru.find(key);
+  if (it != shard.m_lru.end())
   {
-    if (toBeDeleted.find(it->lit) == toBeDeleted.end())
+    if (shard.toBeDeleted.find(it->lit) == shard.toBeDeleted.end())
     {
-      doNotEvict.erase(it->lit);
-      lru.erase(it->lit);
-      m_lru.erase(it);
+      erase(shard, it);
       objectExists = true;
     }
     else  // let makeSpace() delete it if it's already in progress
@@ -591,7 +727,7 @@ int PrefixCache::ifExistsThenDelete(const string& key)
   size_t objectSize = (objectExists ? bf::file_size(cachedPath) : 0);
   // size_t objectSize = (objectExists ? MetadataFile::getLengthFromKey(key) : 0);
   size_t journalSize = (journalExists ? bf::file_size(journalPath) : 0);
-  currentCacheSize -= (objectSize + journalSize);
+  subtractFromCacheSize(objectSize + journalSize, "PrefixCache::ifExistsThenDelete()");
 
   // assert(!objectExists || objectSize == bf::file_size(cachedPath));
 
@@ -605,18 +741,30 @@ size_t PrefixCache::getCurrentCacheSize() const
 
 size_t PrefixCache::getCurrentCacheElementCount() const
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  assert(m_lru.size() == lru.size());
-  return m_lru.size();
+  size_t ret = 0;
+  for (uint i = 0; i < shardCount; i++)
+  {
+    boost::unique_lock<boost::mutex> s(shards[i].mutex);
+    assert(shards[i].m_lru.size() == shards[i].probation.size() + shards[i].protectedLRU.size());
+    ret += shards[i].m_lru.size();
+  }
+  return ret;
 }
 
 void PrefixCache::reset()
 {
-  boost::unique_lock<boost::mutex> s(lru_mutex);
-  m_lru.clear();
-  lru.clear();
-  toBeDeleted.clear();
-  doNotEvict.clear();
+  vector<boost::unique_lock<boost::mutex> > locks;
+  for (uint i = 0; i < shardCount; i++)
+    locks.emplace_back(shards[i].mutex);
+
+  for (uint i = 0; i < shardCount; i++)
+  {
+    shards[i].m_lru.clear();
+    shards[i].probation.clear();
+    shards[i].protectedLRU.clear();
+    shards[i].toBeDeleted.clear();
+    shards[i].doNotEvict.clear();
+  }
 
   bf::directory_iterator dir;
   bf::directory_iterator dend;
@@ -630,20 +778,54 @@ void PrefixCache::reset()
 
 void PrefixCache::shutdown()
 {
-  /* Does this need to do something anymore? */
+  boost::unique_lock<boost::mutex> s(evictorMutex);
+  if (stopEvictor)
+    return;
+  stopEvictor = true;
+  evictorCond.notify_all();
+  s.unlock();
+  evictor.join();
+}
+
+// Object keys look like <uuid>_<offset>_<length>_<source file>.  When a journal gets merged the object
+// is renamed with a new uuid and length, so only the offset & source pick the shard.  Anything else
+// gets hashed whole.
+uint PrefixCache::shardIndex(const string& key) const
+{
+  size_t first = key.find('_');
+  size_t second = (first == string::npos ? string::npos : key.find('_', first + 1));
+  size_t third = (second == string::npos ? string::npos : key.find('_', second + 1));
+  if (third == string::npos)
+    return hash<string>()(key) % shardCount;
+
+  size_t h = hash<string_view>()(string_view(key).substr(first + 1, second - first - 1));
+  h ^= hash<string_view>()(string_view(key).substr(third + 1)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h % shardCount;
+}
+
+inline PrefixCache::Shard& PrefixCache::getShard(const string& key)
+{
+  return shards[shardIndex(key)];
+}
+
+inline const PrefixCache::Shard& PrefixCache::getShard(const string& key) const
+{
+  return shards[shardIndex(key)];
 }
 
 /* The helper classes */
 
-PrefixCache::M_LRU_element_t::M_LRU_element_t(const string* k) : key(k)
+PrefixCache::M_LRU_element_t::M_LRU_element_t(const string* k) : key(k), isProtected(false)
 {
 }
 
-PrefixCache::M_LRU_element_t::M_LRU_element_t(const string& k) : key(&k)
+PrefixCache::M_LRU_element_t::M_LRU_element_t(const string& k) : key(&k), isProtected(false)
 {
 }
 
-PrefixCache::M_LRU_element_t::M_LRU_element_t(const LRU_t::iterator& i) : key(&(*i)), lit(i)
+PrefixCache::M_LRU_element_t::M_LRU_element_t(const LRU_t::iterator& i, bool _isProtected,
+                                              chrono::steady_clock::time_point _stamp)
+ : key(&(*i)), lit(i), isProtected(_isProtected), stamp(_stamp)
 {
 }
 
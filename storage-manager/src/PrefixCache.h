@@ -29,10 +29,15 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <set>
+#include <atomic>
+#include <chrono>
 #include <unordered_set>
 #include <boost/utility.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
 
 namespace storagemanager
 {
@@ -68,6 +73,8 @@ class PrefixCache : public boost::noncopyable
   // the size will change in that process; sizediff is by how much
   void rename(const std::string& oldKey, const std::string& newKey, ssize_t sizediff);
   void setMaxCacheSize(size_t size);
+  // makeSpace() evicts synchronously.  doneReading() and doneWriting() leave eviction to the
+  // eviction thread.
   void makeSpace(size_t size);
   size_t getCurrentCacheSize() const;
   size_t getCurrentCacheElementCount() const;
@@ -80,6 +87,7 @@ class PrefixCache : public boost::noncopyable
   // this will delete everything in the PrefixCache and journal paths, and empty all PrefixCache structures.
   void reset();
   void validateCacheSize();
+  void setPromotionDelay(uint32_t milliseconds);
 
  private:
   PrefixCache();
@@ -87,28 +95,41 @@ class PrefixCache : public boost::noncopyable
   boost::filesystem::path cachePrefix;
   boost::filesystem::path journalPrefix;
   boost::filesystem::path firstDir;
-  size_t maxCacheSize;
+  std::atomic<size_t> maxCacheSize;
   size_t objectSize;
-  size_t currentCacheSize;
+  std::atomic<size_t> currentCacheSize;
   Replicator* replicator;
   SMLogging* logger;
   Downloader* downloader;
 
   void populate();
-  void _makeSpace(size_t size);
-
-  /* The main PrefixCache structures */
-  // lru owns the string memory for the filenames it manages.  m_lru and DNE point to those strings.
+  // returns the number of bytes freed
+  size_t _makeSpace(size_t size);
+  void addToCacheSize(size_t size);
+  void subtractFromCacheSize(size_t size, const char* caller);
+
+  /* The main PrefixCache structures.
+     They are split into shards by key s.t. readers of different objects rarely contend on the same
+     mutex.  Each shard keeps a segmented LRU.  Objects enter the probation segment and move to the
+     protected segment when they are read again at least promotionDelay later; a scan reads each object
+     several times in a row, and that doesn't count.  Eviction takes the least recently used object of
+     all the probation segments first, then of all the protected segments.  That way a scan that reads
+     a lot of objects once doesn't flush the objects that are read repeatedly. */
+
+  // an LRU list owns the string memory for the filenames it manages.  m_lru and DNE point to those strings.
   typedef std::list<std::string> LRU_t;
-  LRU_t lru;
 
   struct M_LRU_element_t
   {
     M_LRU_element_t(const std::string&);
     M_LRU_element_t(const std::string*);
-    M_LRU_element_t(const LRU_t::iterator&);
+    M_LRU_element_t(const LRU_t::iterator&, bool isProtected = false,
+                    std::chrono::steady_clock::time_point stamp = std::chrono::steady_clock::time_point());
     const std::string* key;
     LRU_t::iterator lit;
+    mutable bool isProtected;  // which segment lit is in
+    // when it was put at its place in the segment, so each segment is sorted by it
+    mutable std::chrono::steady_clock::time_point stamp;
   };
   struct KeyHasher
   {
@@ -121,7 +142,6 @@ class PrefixCache : public boost::noncopyable
   };
 
   typedef std::unordered_set<M_LRU_element_t, KeyHasher, KeyEquals> M_LRU_t;
-  M_LRU_t m_lru;  // the LRU entries as a hash table
 
   /* The do-not-evict list stuff. */
   struct DNEElement
@@ -144,9 +164,6 @@ class PrefixCache : public boost::noncopyable
   };
 
   typedef std::unordered_set<DNEElement, DNEHasher, DNEEquals> DNE_t;
-  DNE_t doNotEvict;
-  void addToDNE(const DNEElement&);
-  void removeFromDNE(const DNEElement&);
 
   // the to-be-deleted set.  Elements removed from the LRU but not yet deleted will be here.
   // Elements are inserted and removed by makeSpace().  If read() references a file that is in this,
@@ -157,9 +174,45 @@ class PrefixCache : public boost::noncopyable
   };
 
   typedef std::set<LRU_t::iterator, TBDLess> TBD_t;
-  TBD_t toBeDeleted;
 
-  mutable boost::mutex lru_mutex;  // protects the main PrefixCache structures & the do-not-evict set
+  struct Shard
+  {
+    LRU_t probation;
+    LRU_t protectedLRU;
+    M_LRU_t m_lru;  // the entries of both segments as a hash table
+    DNE_t doNotEvict;
+    TBD_t toBeDeleted;
+    mutable boost::mutex mutex;  // protects the structures above
+  };
+
+  static const uint shardCount = 16;
+  Shard shards[shardCount];
+  std::atomic<std::chrono::steady_clock::duration> promotionDelay;
+
+  uint shardIndex(const std::string& key) const;
+  Shard& getShard(const std::string& key);
+  const Shard& getShard(const std::string& key) const;
+
+  // these are called holding the shard's mutex
+  void addToDNE(Shard&, const DNEElement&);
+  void removeFromDNE(Shard&, const DNEElement&);
+  void insertNew(Shard&, const std::string& key);
+  void touch(Shard&, const M_LRU_t::iterator&);
+  void erase(Shard&, const M_LRU_t::iterator&);
+  // the first entry of segment that isn't in use, or segment.end()
+  LRU_t::iterator firstEvictable(Shard&, LRU_t& segment);
+  bool evictOne(size_t* freed);
+
+  // downloads are started and finished holding this, see read()
+  boost::mutex downloadMutex;
+
+  // the eviction thread
+  void evictionLoop();
+  void wakeEvictor();
+  boost::thread evictor;
+  boost::mutex evictorMutex;
+  boost::condition evictorCond;
+  bool stopEvictor;
 };
 
 }  // namespace storagemanager
@@ -20,6 +20,7 @@
 #include "SMLogging.h"
 #include "Utilities.h"
 #include "Cache.h"
+#include "JournalIndex.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -455,6 +456,7 @@ int Replicator::addJournalEntry(const boost::filesystem::path& filename, const u
     count += err;
   }
 
+  JournalIndex::get()->entryAdded(journalFilename, entryHeaderOffset, offset, length);
   repUserDataWritten += count;
   return count;
 }
@@ -466,6 +468,9 @@ int Replicator::remove(const boost::filesystem::path& filename, Flags flags)
   if (flags & NO_LOCAL)
     return 0;  // not implemented yet
 
+  if (filename.extension() == ".journal")
+    JournalIndex::get()->remove(filename.string());
+
   try
   {
     //#ifndef NDEBUG
@@ -32,6 +32,9 @@ namespace
 {
 storagemanager::Synchronizer* instance = NULL;
 boost::mutex inst_mutex;
+
+// objects smaller than this are batched with others from the same file if upload_batch_size is not set
+const size_t defaultUploadBatchSize = 1 << 20;
 }  // namespace
 
 namespace bf = boost::filesystem;
@@ -48,7 +51,8 @@ Synchronizer* Synchronizer::get()
   return instance;
 }
 
-Synchronizer::Synchronizer() : maxUploads(0)
+Synchronizer::Synchronizer()
+ : maxUploads(0), uploadBatchSize(0), adaptiveUploads(false), minUploads(1), currentUploads(0)
 {
   Config* config = Config::get();
   logger = SMLogging::get();
@@ -59,7 +63,12 @@ Synchronizer::Synchronizer() : maxUploads(0)
 
   numBytesRead = numBytesWritten = numBytesUploaded = numBytesDownloaded = mergeDiff =
       flushesTriggeredBySize = flushesTriggeredByTimer = journalsMerged = objectsSyncedWithNoJournal =
-          bytesReadBySync = bytesReadBySyncWithJournal = 0;
+          bytesReadBySync = bytesReadBySyncWithJournal = batchedJobs = objectsBatched =
+              uploadConcurrencyIncreases = uploadConcurrencyDecreases = 0;
+  peakUploadThroughput = lastUploadThroughput = 0;
+  concurrencyDirection = -1;
+  bytesUploadedAtLastAdjustment = 0;
+  lastAdjustment = boost::chrono::steady_clock::now();
 
   journalPath = cache->getJournalPath();
   cachePath = cache->getCachePath();
@@ -294,8 +303,8 @@ void Synchronizer::periodicSync()
     }
     // cout << "Sync'ing " << pendingOps.size() << " objects" << " queue size is " <<
     //    threadPool.currentQueueSize() << endl;
-    for (auto& job : pendingOps)
-      makeJob(job.first);
+    adjustUploadConcurrency();
+    makeJobs();
     for (auto it = uncommittedJournalSize.begin(); it != uncommittedJournalSize.end(); ++it)
       it->second = 0;
   }
@@ -312,8 +321,7 @@ void Synchronizer::syncNow(const bf::path& prefix)
   blockNewJobs = true;
   while (pendingOps.size() != 0 || opsInProgress.size() != 0)
   {
-    for (auto& job : pendingOps)
-      makeJob(job.first);
+    makeJobs();
     for (auto it = uncommittedJournalSize.begin(); it != uncommittedJournalSize.end(); ++it)
       it->second = 0;
     lock.unlock();
@@ -336,8 +344,7 @@ void Synchronizer::syncNow()
   blockNewJobs = true;
   while (pendingOps.size() != 0 || opsInProgress.size() != 0)
   {
-    for (auto& job : pendingOps)
-      makeJob(job.first);
+    makeJobs();
     for (auto it = uncommittedJournalSize.begin(); it != uncommittedJournalSize.end(); ++it)
       it->second = 0;
     lock.unlock();
@@ -363,6 +370,115 @@ void Synchronizer::makeJob(const string& key)
   threadPool->addJob(j);
 }
 
+// Starts jobs for everything in pendingOps, grouped by groupUploads().  Called with mutex held.
+void Synchronizer::makeJobs()
+{
+  vector<string> keys;
+  keys.reserve(pendingOps.size());
+  for (auto& job : pendingOps)
+    keys.push_back(job.first);
+
+  for (auto& group : groupUploads(keys, uploadBatchSize))
+  {
+    vector<list<string>::iterator> names;
+    for (auto& key : group)
+    {
+      objNames.push_front(key);
+      names.push_back(objNames.begin());
+    }
+    boost::shared_ptr<Job> j(new Job(this, names));
+    threadPool->addJob(j);
+    if (names.size() > 1)
+    {
+      ++batchedJobs;
+      objectsBatched += names.size();
+    }
+  }
+}
+
+// Groups keys of the form firstDir/key into jobs.  Objects smaller than batchSize are grouped with the
+// other small objects of the same file, up to batchSize bytes per job.  The others get a job each.
+vector<vector<string>> Synchronizer::groupUploads(const vector<string>& keys, size_t batchSize)
+{
+  vector<vector<string>> jobs;
+  map<string, pair<size_t, size_t>> batches;  // file -> its job in jobs, bytes in that job
+
+  for (const string& key : keys)
+  {
+    size_t pos = key.find_first_of('/');
+    string realKey = key.substr(pos + 1);
+    size_t length = MetadataFile::getLengthFromKey(realKey);
+    if (length >= batchSize)
+    {
+      jobs.push_back(vector<string>(1, key));
+      continue;
+    }
+
+    string file = key.substr(0, pos + 1) + MetadataFile::getSourceFromKey(realKey);
+    auto it = batches.find(file);
+    if (it == batches.end())
+    {
+      it = batches.insert(make_pair(file, make_pair(jobs.size(), (size_t)0))).first;
+      jobs.emplace_back();
+    }
+    jobs[it->second.first].push_back(key);
+    it->second.second += length;
+    // the next object of the file starts a new job
+    if (it->second.second >= batchSize)
+      batches.erase(it);
+  }
+  return jobs;
+}
+
+// Called with mutex held once per sync period, before new jobs are started.
+void Synchronizer::adjustUploadConcurrency()
+{
+  auto now = boost::chrono::steady_clock::now();
+  double elapsed = boost::chrono::duration<double>(now - lastAdjustment).count();
+  size_t uploaded = numBytesUploaded - bytesUploadedAtLastAdjustment;
+  bool backlogged = (threadPool->currentQueueSize() > 0);
+
+  lastAdjustment = now;
+  bytesUploadedAtLastAdjustment = numBytesUploaded;
+  if (!adaptiveUploads || !backlogged || elapsed < 1 || minUploads >= maxUploads)
+    return;
+
+  double throughput = uploaded / elapsed;
+  peakUploadThroughput = max(peakUploadThroughput, throughput);
+
+  uint newUploads = nextUploadConcurrency(currentUploads, minUploads, maxUploads, throughput,
+                                          lastUploadThroughput, &concurrencyDirection);
+  lastUploadThroughput = throughput;
+  if (newUploads == currentUploads)
+    return;
+
+  if (newUploads > currentUploads)
+    ++uploadConcurrencyIncreases;
+  else
+    ++uploadConcurrencyDecreases;
+  logger->log(LOG_DEBUG,
+              "Synchronizer: upload throughput = %.0f bytes/s, changing upload concurrency from %u to %u",
+              throughput, currentUploads, newUploads);
+  currentUploads = newUploads;
+  threadPool->setMaxThreads(currentUploads);
+}
+
+// One step of the hill climbing.  Keeps going the same way while throughput improves, turns around
+// when it gets worse.  When it doesn't change, goes for fewer uploads; each one holds a file lock for
+// its duration.
+uint Synchronizer::nextUploadConcurrency(uint current, uint minUploads, uint maxUploads, double throughput,
+                                         double lastThroughput, int* direction)
+{
+  if (throughput < lastThroughput * 0.95)
+    *direction = -*direction;
+  else if (throughput <= lastThroughput * 1.05)
+    *direction = -1;
+
+  int step = max<int>(1, current / 8);
+  int newUploads = (int)current + *direction * step;
+  return min<int>(max<int>(newUploads, minUploads), maxUploads);
+}
+
 void Synchronizer::process(list<string>::iterator name)
 {
   /*
@@ -841,6 +957,12 @@ void Synchronizer::printKPIs() const
   cout << "\tflushesTriggeredByTimer: " << flushesTriggeredByTimer << endl;
   cout << "\tjournalsMerged: " << journalsMerged << endl;
   cout << "\tobjectsSyncedWithNoJournal: " << objectsSyncedWithNoJournal << endl;
+  cout << "\tbatchedJobs: " << batchedJobs << endl;
+  cout << "\tobjectsBatched: " << objectsBatched << endl;
+  cout << "\tuploadConcurrency: " << currentUploads << endl;
+  cout << "\tuploadConcurrencyIncreases: " << uploadConcurrencyIncreases << endl;
+  cout << "\tuploadConcurrencyDecreases: " << uploadConcurrencyDecreases << endl;
+  cout << "\tpeakUploadThroughput: " << (size_t)peakUploadThroughput << " bytes/s" << endl;
 }
 
 /* The helper objects & fcns */
@@ -870,23 +992,31 @@ void Synchronizer::PendingOps::wait(boost::mutex* m)
   }
 }
 
-Synchronizer::Job::Job(Synchronizer* s, std::list<std::string>::iterator i) : sync(s), it(i)
+Synchronizer::Job::Job(Synchronizer* s, std::list<std::string>::iterator i) : sync(s), its(1, i)
+{
+}
+
+Synchronizer::Job::Job(Synchronizer* s, const std::vector<std::list<std::string>::iterator>& i)
+ : sync(s), its(i)
 {
 }
 
 void Synchronizer::Job::operator()()
 {
-  sync->process(it);
+  for (auto& it : its)
+    sync->process(it);
 }
 
 void Synchronizer::configListener()
 {
+  boost::unique_lock<boost::mutex> s(mutex);
+
   // Uploader threads
   string stmp = Config::get()->getValue("ObjectStorage", "max_concurrent_uploads");
   if (maxUploads == 0)
   {
     maxUploads = 20;
-    threadPool->setMaxThreads(maxUploads);
+    resetUploadConcurrency();
     logger->log(LOG_INFO, "max_concurrent_uploads = %u",maxUploads);
   }
   if (stmp.empty())
@@ -899,7 +1029,7 @@ void Synchronizer::configListener()
     if (newValue != maxUploads)
     {
       maxUploads = newValue;
-      threadPool->setMaxThreads(maxUploads);
+      resetUploadConcurrency();
       logger->log(LOG_INFO, "max_concurrent_uploads = %u", maxUploads);
     }
   }
@@ -907,5 +1037,39 @@ void Synchronizer::configListener()
   {
     logger->log(LOG_CRIT, "max_concurrent_uploads is not a number. Using current value = %u", maxUploads);
   }
+
+  stmp = Config::get()->getValue("ObjectStorage", "upload_batch_size");
+  size_t newBatchSize = defaultUploadBatchSize;
+  if (!stmp.empty())
+  {
+    try
+    {
+      newBatchSize = stoul(stmp);
+    }
+    catch (invalid_argument&)
+    {
+      logger->log(LOG_WARNING, "upload_batch_size is not a number. Using the default = %zu",
+                  defaultUploadBatchSize);
+    }
+  }
+  uploadBatchSize = newBatchSize;
+
+  stmp = Config::get()->getValue("ObjectStorage", "adaptive_upload_concurrency");
+  bool newAdaptive = (stmp != "disabled");
+  if (newAdaptive != adaptiveUploads)
+  {
+    adaptiveUploads = newAdaptive;
+    resetUploadConcurrency();
+  }
+}
+
+// Restarts concurrency tuning from maxUploads
+void Synchronizer::resetUploadConcurrency()
+{
+  minUploads = max<uint>(1, maxUploads / 4);
+  currentUploads = maxUploads;
+  concurrencyDirection = -1;
+  lastUploadThroughput = 0;
+  threadPool->setMaxThreads(currentUploads);
 }
 }  // namespace storagemanager
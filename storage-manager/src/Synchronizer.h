@@ -20,6 +20,7 @@
 #include <string>
 #include <map>
 #include <deque>
+#include <vector>
 #include <boost/utility.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/chrono.hpp>
@@ -60,6 +61,10 @@ class Synchronizer : public boost::noncopyable, public ConfigListener
   boost::filesystem::path getJournalPath();
   boost::filesystem::path getCachePath();
   void printKPIs() const;
+  static std::vector<std::vector<std::string> > groupUploads(const std::vector<std::string>& keys,
+                                                             size_t batchSize);
+  static uint nextUploadConcurrency(uint current, uint minUploads, uint maxUploads, double throughput,
+                                    double lastThroughput, int* direction);
 
   virtual void configListener() override;
 
@@ -73,6 +78,9 @@ class Synchronizer : public boost::noncopyable, public ConfigListener
   void synchronizeWithJournal(const std::string& sourceFile, std::list<std::string>::iterator& it);
   void rename(const std::string& oldkey, const std::string& newkey);
   void makeJob(const std::string& key);
+  void makeJobs();
+  void adjustUploadConcurrency();
+  void resetUploadConcurrency();
 
   // this struct kind of got sloppy.  Need to clean it at some point.
   struct PendingOps
@@ -87,16 +95,30 @@ class Synchronizer : public boost::noncopyable, public ConfigListener
     void notify();
   };
 
+  // A Job processes one or more objects in order.  Small objects that belong to the same file
+  // are batched into one Job; they would serialize on that file's lock anyway.
   struct Job : public ThreadPool::Job
   {
     virtual ~Job(){};
     Job(Synchronizer* s, std::list<std::string>::iterator i);
+    Job(Synchronizer* s, const std::vector<std::list<std::string>::iterator>& i);
     void operator()();
     Synchronizer* sync;
-    std::list<std::string>::iterator it;
+    std::vector<std::list<std::string>::iterator> its;
   };
 
   uint maxUploads;
+  size_t uploadBatchSize;
+
+  /* Upload concurrency is tuned between minUploads and maxUploads by hill climbing on the upload
+     throughput measured each sync period.  A period only counts if the upload queue was still backed
+     up at the end of it, otherwise the throughput reflects demand, not capacity. */
+  bool adaptiveUploads;
+  uint minUploads, currentUploads;
+  int concurrencyDirection;
+  double lastUploadThroughput;
+  size_t bytesUploadedAtLastAdjustment;
+  boost::chrono::steady_clock::time_point lastAdjustment;
   boost::scoped_ptr<ThreadPool> threadPool;
   std::map<std::string, boost::shared_ptr<PendingOps> > pendingOps;
   std::map<std::string, boost::shared_ptr<PendingOps> > opsInProgress;
@@ -121,8 +143,10 @@ class Synchronizer : public boost::noncopyable, public ConfigListener
   // some KPIs
   size_t numBytesRead, numBytesWritten, numBytesUploaded, numBytesDownloaded, flushesTriggeredBySize,
       flushesTriggeredByTimer, journalsMerged, objectsSyncedWithNoJournal, bytesReadBySync,
-      bytesReadBySyncWithJournal;
+      bytesReadBySyncWithJournal, batchedJobs, objectsBatched, uploadConcurrencyIncreases,
+      uploadConcurrencyDecreases;
   ssize_t mergeDiff;
+  double peakUploadThroughput;
 
   SMLogging* logger;
   Cache* cache;
@@ -1183,6 +1183,80 @@ bool cacheTest1()
   return true;
 }
 
+// An object read again later is kept over the objects a scan reads, even several times in a row, and
+// eviction goes by age across all the shards.
+bool cacheSLRUTest()
+{
+  Cache* cache = Cache::get();
+  CloudStorage* cs = CloudStorage::get();
+  LocalStorage* ls = dynamic_cast<LocalStorage*>(cs);
+  if (ls == NULL)
+  {
+    cout << "Cache SLRU test requires using local storage" << endl;
+    return false;
+  }
+
+  cache->reset();
+  bf::path storagePath = ls->getPrefix();
+  const size_t objSize = 8192;
+  const int scanned = 4;
+  size_t oldMaxCacheSize = cache->getMaxCacheSize();
+  cache->setMaxCacheSize((scanned + 1) * objSize);
+  cache->setPromotionDelay(100);
+
+  // the source names differ, so they are in different shards
+  vector<string> keys;
+  for (int i = 0; i <= scanned; i++)
+  {
+    keys.push_back("12345_0_8192_" + prefix + "~slru-" + to_string(i));
+    makeTestObject((storagePath / keys.back()).string().c_str());
+  }
+  vector<string> hot(1, keys[scanned]);
+
+  cache->read(prefix, hot);
+  cache->doneReading(prefix, hot);
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+  cache->read(prefix, hot);
+  cache->doneReading(prefix, hot);
+
+  for (int i = 0; i < scanned; i++)
+  {
+    vector<string> key(1, keys[i]);
+    for (int j = 0; j < 3; j++)
+    {
+      cache->read(prefix, key);
+      cache->doneReading(prefix, key);
+    }
+  }
+  assert(cache->getCurrentCacheSize(prefix) == (scanned + 1) * objSize);
+
+  // the first object of the scan is the oldest in probation
+  vector<bool> exists;
+  cache->makeSpace(prefix, objSize);
+  cache->exists(prefix, keys, &exists);
+  assert(!exists[0] && exists[1] && exists[2] && exists[3] && exists[scanned]);
+
+  // the rest of the scan goes before the object that was read again
+  cache->makeSpace(prefix, scanned * objSize);
+  cache->exists(prefix, keys, &exists);
+  for (int i = 0; i < scanned; i++)
+    assert(!exists[i]);
+  assert(exists[scanned]);
+  assert(cache->getCurrentCacheSize(prefix) == objSize);
+
+  // then the protected one
+  cache->makeSpace(prefix, (scanned + 1) * objSize);
+  assert(!cache->exists(prefix, keys[scanned]));
+  assert(cache->getCurrentCacheSize(prefix) == 0);
+
+  for (const string& key : keys)
+    bf::remove(storagePath / key);
+  cache->setPromotionDelay(1000);
+  cache->setMaxCacheSize(oldMaxCacheSize);
+  cout << "cache SLRU test OK" << endl;
+  return true;
+}
+
 bool mergeJournalTest()
 {
   /*
@@ -1238,6 +1312,27 @@ bool mergeJournalTest()
   for (; i < 3; i++)
     assert(idata[i] == i + 7);
 
+  // append an entry to the journal, the journal index should pick it up on the next read
+  {
+    int journalFD = open("test-journal", O_WRONLY | O_APPEND);
+    assert(journalFD >= 0);
+    scoped_closer s(journalFD);
+    uint64_t offlen[2] = {0, 8};
+    assert(write(journalFD, offlen, 16) == 16);
+    for (i = 100; i < 102; i++)
+      assert(write(journalFD, &i, 4) == 4);
+  }
+  len = 28;
+  data = ioc->mergeJournal("test-object", "test-journal", 0, len, &tmp);
+  assert(data);
+  idata = (int*)data.get();
+  for (i = 0; i < 2; i++)
+    assert(idata[i] == i + 100);
+  for (; i < 5; i++)
+    assert(idata[i] == i);
+  for (; i < 7; i++)
+    assert(idata[i] == i - 5);
+
   // cleanup
   bf::remove("test-object");
   bf::remove("test-journal");
@@ -1370,6 +1465,99 @@ bool syncTest1()
   return true;
 }
 
+bool syncBatchingTest()
+{
+  // keys the way the Synchronizer gets them, firstDir/key
+  auto makeKey = [](const string& firstDir, const string& file, off_t offset, size_t length) {
+    return firstDir + "/" + MetadataFile::getNewKey(prefix + "/" + file, offset, length);
+  };
+  string a0 = makeKey(prefix, "a", 0, 4096), a1 = makeKey(prefix, "a", 4096, 4096),
+         a2 = makeKey(prefix, "a", 8192, 4096), a3 = makeKey(prefix, "a", 12288, 4096);
+  string aBig = makeKey(prefix, "a", 16384, 16384), b0 = makeKey(prefix, "b", 0, 4096);
+  string otherA0 = makeKey("other", "a", 0, 4096);
+
+  // the small objects of a file go together up to the batch size, a3 starts another batch
+  vector<vector<string>> jobs = Synchronizer::groupUploads({a0, b0, a1, aBig, otherA0, a2, a3}, 10000);
+  assert(jobs.size() == 5);
+  assert(jobs[0] == vector<string>({a0, a1, a2}));
+  assert(jobs[1] == vector<string>({b0}));
+  assert(jobs[2] == vector<string>({aBig}));
+  assert(jobs[3] == vector<string>({otherA0}));
+  assert(jobs[4] == vector<string>({a3}));
+
+  // batching disabled
+  jobs = Synchronizer::groupUploads({a0, a1, a2}, 0);
+  assert(jobs.size() == 3);
+
+  // the objects of a batch all make it to the cloud
+  Cache* cache = Cache::get();
+  Synchronizer* sync = Synchronizer::get();
+  IOCoordinator* ioc = IOCoordinator::get();
+  CloudStorage* cs = CloudStorage::get();
+  cache->reset();
+
+  bf::path file = bf::path(prefix) / "batched";
+  bf::path cachePath = sync->getCachePath();
+  MetadataFile meta(file);
+  vector<string> keys;
+  for (int i = 0; i < 4; i++)
+  {
+    metadataObject obj = meta.addMetadataObject(file, 8192);
+    makeTestObject((cachePath / prefix / obj.key).string().c_str());
+    cache->newObject(prefix, obj.key, 8192);
+    keys.push_back(obj.key);
+  }
+  assert(meta.writeMetadata() == 0);
+
+  sync->newObjects(prefix, keys);
+  sync->forceFlush();
+  for (auto& key : keys)
+  {
+    bool exists = false;
+    for (int i = 0; i < 300 && !exists; i++)
+    {
+      usleep(10000);
+      assert(cs->exists(key, &exists) == 0);
+    }
+    assert(exists);
+  }
+
+  cache->reset();
+  assert(ioc->unlink((homepath / file).string().c_str()) == 0);
+  cout << "Sync batching test OK" << endl;
+  return true;
+}
+
+bool uploadConcurrencyTest()
+{
+  int direction = -1;
+
+  // it starts out going down, keeps going while throughput improves, turns around when it gets worse
+  uint uploads = Synchronizer::nextUploadConcurrency(20, 5, 20, 1000, 0, &direction);
+  assert(uploads == 18);
+  uploads = Synchronizer::nextUploadConcurrency(uploads, 5, 20, 1200, 1000, &direction);
+  assert(uploads == 16);
+  uploads = Synchronizer::nextUploadConcurrency(uploads, 5, 20, 900, 1200, &direction);
+  assert(uploads == 18 && direction == 1);
+  uploads = Synchronizer::nextUploadConcurrency(uploads, 5, 20, 1300, 900, &direction);
+  assert(uploads == 20);
+
+  // no higher than max_concurrent_uploads
+  uploads = Synchronizer::nextUploadConcurrency(uploads, 5, 20, 1400, 1300, &direction);
+  assert(uploads == 20 && direction == 1);
+
+  // no change in throughput, fewer uploads
+  uploads = Synchronizer::nextUploadConcurrency(uploads, 5, 20, 1410, 1400, &direction);
+  assert(uploads == 18 && direction == -1);
+
+  // no lower than the min
+  uploads = Synchronizer::nextUploadConcurrency(5, 5, 20, 1000, 1000, &direction);
+  assert(uploads == 5);
+
+  cout << "Upload concurrency test OK" << endl;
+  return true;
+}
+
 void metadataUpdateTest()
 {
   Config* config = Config::get();
@@ -1385,6 +1573,76 @@ void metadataUpdateTest()
   ::unlink(metaFilePath.c_str());
 }
 
+void metadataFormatTest()
+{
+  Config* config = Config::get();
+  bf::path metaPath = config->getValue("ObjectStorage", "metadata_path");
+  bf::path metaFile = metaPath / prefix / "format-test.meta";
+  string source = prefix + "/format-test";
+  string key = "12345_0_8192_" + prefix + "~format-test";
+  size_t objectSize = MetadataFile::MetadataConfig::get()->mObjectSize;
+  bf::create_directories(metaFile.parent_path());
+
+  // a metadata file in the JSON format is readable, and is converted to the binary format when written
+  makeTestMetadata(metaFile.string().c_str(), key);
+  MetadataFile::deletedMeta(metaFile);
+  {
+    MetadataFile meta(metaFile, MetadataFile::no_create_t(), false);
+    assert(meta.exists());
+    assert(meta.getLength() == 8192);
+    metadataObject obj;
+    assert(meta.getEntry(0, &obj));
+    assert(obj.key == key && obj.length == 8192);
+    for (int i = 0; i < 3; i++)
+      meta.addMetadataObject(source, 8192);
+    assert(meta.writeMetadata() == 0);
+  }
+  char magic[6];
+  int fd = ::open(metaFile.string().c_str(), O_RDONLY);
+  assert(fd >= 0);
+  assert(::read(fd, magic, 6) == 6);
+  ::close(fd);
+  assert(memcmp(magic, "SMMETA", 6) == 0);
+
+  // load it from the binary file and check the lookups
+  MetadataFile::deletedMeta(metaFile);
+  MetadataFile meta(metaFile, MetadataFile::no_create_t(), false);
+  assert(meta.exists());
+  assert(meta.getLength() == 3 * objectSize + 8192);
+  metadataObject obj;
+  assert(meta.getEntry(2 * objectSize, &obj));
+  assert(obj.offset == 2 * objectSize && obj.length == 8192);
+  assert(MetadataFile::getSourceFromKey(obj.key) == source);
+  assert(!meta.getEntry(100, &obj));
+  vector<metadataObject> objects = meta.metadataRead(objectSize + 100, objectSize);
+  assert(objects.size() == 2);
+  assert(objects[0].offset == objectSize && objects[1].offset == 2 * objectSize);
+  assert(meta.metadataRead(0, meta.getLength()).size() == 4);
+
+  // modifying a loaded file doesn't change the list another MetadataFile got from the cache
+  MetadataFile reader(metaFile, MetadataFile::no_create_t(), false);
+  meta.updateEntryLength(3 * objectSize, 100);
+  meta.removeEntry(objectSize);
+  assert(reader.getLength() == 3 * objectSize + 8192);
+  assert(reader.getEntry(objectSize, &obj));
+  assert(meta.writeMetadata() == 0);
+  assert(reader.metadataRead(0, reader.getLength()).size() == 4);
+
+  // a MetadataFile made after the write gets the new list from the cache, and from the file after that
+  MetadataFile cached(metaFile, MetadataFile::no_create_t(), false);
+  assert(cached.getLength() == 3 * objectSize + 100);
+  assert(!cached.getEntry(objectSize, &obj));
+  MetadataFile::deletedMeta(metaFile);
+  MetadataFile meta2(metaFile, MetadataFile::no_create_t(), false);
+  assert(meta2.getLength() == 3 * objectSize + 100);
+  assert(!meta2.getEntry(objectSize, &obj));
+  assert(meta2.metadataRead(0, meta2.getLength()).size() == 3);
+
+  MetadataFile::deletedMeta(metaFile);
+  bf::remove(metaFile);
+  cout << "metadataFormatTest OK" << endl;
+}
+
 void s3storageTest1()
 {
   try
@@ -1550,6 +1808,158 @@ void IOCReadTest1()
   cout << "IOC read test 1 OK" << endl;
 }
 
+// A file of count objects made by makeTestObject() in cloud storage, none of them cached
+void makeCloudTestFile(const bf::path& file, uint count, vector<string>* keys)
+{
+  LocalStorage* ls = dynamic_cast<LocalStorage*>(CloudStorage::get());
+  assert(ls);
+
+  MetadataFile meta(file);
+  for (uint i = 0; i < count; i++)
+  {
+    metadataObject obj = meta.addMetadataObject(file, 8192);
+    makeTestObject((ls->getPrefix() / obj.key).string().c_str());
+    keys->push_back(obj.key);
+  }
+  assert(meta.writeMetadata() == 0);
+}
+
+bool waitForCache(const string& key)
+{
+  Cache* cache = Cache::get();
+  for (int i = 0; i < 500 && !cache->exists(prefix, key); i++)
+    usleep(10000);
+  return cache->exists(prefix, key);
+}
+
+// verifies the ints makeTestObject() wrote between offset and offset + length of an object
+void verifyTestObjectData(const uint8_t* data, off_t offset, size_t length)
+{
+  for (size_t i = 0; i < length; i += 4)
+    assert(*((int*)&data[i]) == (int)((offset + i) / 4));
+}
+
+void IOCPrefetchTest()
+{
+  /*
+      Make a file of 8 objects in cloud storage
+      read the first 3 one after another, the third read is sequential
+      verify objects 4 and 5 get downloaded in the background, object 6 doesn't
+      continue reading, verify the read-ahead is topped up once half of it is used
+  */
+  IOCoordinator* ioc = IOCoordinator::get();
+  Cache* cache = Cache::get();
+  if (!dynamic_cast<LocalStorage*>(CloudStorage::get()))
+  {
+    cout << "IOC prefetch test requires LocalStorage for now." << endl;
+    return;
+  }
+
+  cache->reset();
+  bf::path file = bf::path(prefix) / "prefetch";
+  bf::path fullPath = homepath / file;
+  vector<string> keys;
+  makeCloudTestFile(file, 8, &keys);
+
+  uint8_t data[8192];
+  for (uint i = 0; i < 3; i++)
+  {
+    int err = ioc->read(fullPath.string().c_str(), data, i * 8192, 8192);
+    assert(err == 8192);
+    verifyTestObjectData(data, 0, 8192);
+  }
+
+  assert(waitForCache(keys[3]));
+  assert(waitForCache(keys[4]));
+  sleep(1);
+  assert(!cache->exists(prefix, keys[5]));
+
+  // reading object 4 uses up half of the read-ahead, object 5 the rest, that tops it up
+  int err = ioc->read(fullPath.string().c_str(), data, 3 * 8192, 8192);
+  assert(err == 8192);
+  verifyTestObjectData(data, 0, 8192);
+  sleep(1);
+  assert(!cache->exists(prefix, keys[5]));
+  err = ioc->read(fullPath.string().c_str(), data, 4 * 8192, 8192);
+  assert(err == 8192);
+  verifyTestObjectData(data, 0, 8192);
+  assert(waitForCache(keys[5]));
+  assert(waitForCache(keys[6]));
+  sleep(1);
+  assert(!cache->exists(prefix, keys[7]));
+
+  // a read elsewhere isn't sequential, it doesn't prefetch
+  cache->reset();
+  err = ioc->read(fullPath.string().c_str(), data, 0, 8192);
+  assert(err == 8192);
+  sleep(1);
+  assert(!cache->exists(prefix, keys[1]));
+
+  cache->reset();
+  assert(ioc->unlink(fullPath.string().c_str()) == 0);
+  cout << "IOC prefetch test OK" << endl;
+}
+
+void IOCRangeReadTest()
+{
+  /*
+      Make a file of 4 objects in cloud storage
+      small reads of uncached objects are read from cloud storage, the objects don't get cached
+      a small read of an object with a journal downloads it and merges the journal
+      a read bigger than range_read_max_size downloads the object
+  */
+  IOCoordinator* ioc = IOCoordinator::get();
+  Cache* cache = Cache::get();
+  if (!dynamic_cast<LocalStorage*>(CloudStorage::get()))
+  {
+    cout << "IOC range read test requires LocalStorage for now." << endl;
+    return;
+  }
+
+  cache->reset();
+  bf::path file = bf::path(prefix) / "rangeread";
+  bf::path fullPath = homepath / file;
+  bf::path journalPath = ioc->getJournalPath();
+  vector<string> keys;
+  makeCloudTestFile(file, 4, &keys);
+
+  uint8_t data[8192];
+  int err = ioc->read(fullPath.string().c_str(), data, 2 * 8192 + 40, 100);
+  assert(err == 100);
+  verifyTestObjectData(data, 40, 100);
+  assert(!cache->exists(prefix, keys[2]));
+
+  // one that spans 2 objects
+  err = ioc->read(fullPath.string().c_str(), data, 8192 - 1000, 2000);
+  assert(err == 2000);
+  verifyTestObjectData(data, 8192 - 1000, 1000);
+  verifyTestObjectData(&data[1000], 0, 1000);
+  assert(!cache->exists(prefix, keys[0]));
+  assert(!cache->exists(prefix, keys[1]));
+
+  // the cloud copy of an object with a journal is out of date
+  string journalName = (journalPath / prefix / (keys[1] + ".journal")).string();
+  makeTestJournal(journalName.c_str());
+  cache->newJournalEntry(prefix, bf::file_size(journalName));
+  err = ioc->read(fullPath.string().c_str(), data, 8192, 40);
+  assert(err == 40);
+  int* data32 = (int*)data;
+  for (int i = 0; i < 5; i++)
+    assert(data32[i] == i);
+  for (int i = 5; i < 10; i++)
+    assert(data32[i] == i - 5);
+  assert(cache->exists(prefix, keys[1]));
+
+  err = ioc->read(fullPath.string().c_str(), data, 3 * 8192, 8192);
+  assert(err == 8192);
+  verifyTestObjectData(data, 0, 8192);
+  assert(cache->exists(prefix, keys[3]));
+
+  cache->reset();
+  assert(ioc->unlink(fullPath.string().c_str()) == 0);
+  cout << "IOC range read test OK" << endl;
+}
+
 void IOCUnlink()
 {
   IOCoordinator* ioc = IOCoordinator::get();
@@ -1913,6 +2323,7 @@ int main(int argc, char* argv[])
 
   opentask();
   // metadataUpdateTest();
+  metadataFormatTest();
   // create the metadatafile to use
   // requires 8K object size to test boundries
   // Case 1 new write that spans full object
@@ -1950,11 +2361,16 @@ int main(int argc, char* argv[])
 
   localstorageTest1();
   cacheTest1();
+  cacheSLRUTest();
   mergeJournalTest();
   replicatorTest();
   syncTest1();
+  syncBatchingTest();
+  uploadConcurrencyTest();
 
   IOCReadTest1();
+  IOCPrefetchTest();
+  IOCRangeReadTest();
   IOCTruncate();
   IOCUnlink();
   IOCCopyFile();
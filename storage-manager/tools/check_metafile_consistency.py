@@ -7,6 +7,7 @@ import os
 import configparser
 import re
 import traceback
+import struct
 
 
 cloudPath = None
@@ -51,9 +52,28 @@ def parseArgs():
 def key_breakout(key):
     return key.split("_", 3)
 
+# Metadata files are stored in a binary format: a header, an array of entries sorted by offset, then
+# the keys the entries refer to.  Files written by earlier versions are JSON.
+binaryMagic = b"SMMETA\0\0"
+binaryHeader = struct.Struct("=8sIIQQ")   # magic, version, revision, object count, length of the keys
+binaryEntry = struct.Struct("=QQQQ")      # offset, length, key offset, key length
+
+def loadMetadata(metafile):
+    data = open(metafile, "rb").read()
+    if not data.startswith(binaryMagic):
+        return json.loads(data)
+    magic, version, revision, count, keysLength = binaryHeader.unpack_from(data, 0)
+    keysStart = binaryHeader.size + count * binaryEntry.size
+    objects = []
+    for i in range(count):
+        offset, length, keyOffset, keyLength = binaryEntry.unpack_from(data, binaryHeader.size + i * binaryEntry.size)
+        key = data[keysStart + keyOffset : keysStart + keyOffset + keyLength].decode()
+        objects.append({ "offset" : offset, "length" : length, "key" : key })
+    return { "version" : version, "revision" : revision, "objects" : objects }
+
 def validateMetadata(metafile):
     try:
-        metadata = json.load(open(metafile))
+        metadata = loadMetadata(metafile)
 
         for obj in metadata["objects"]:
             bigObjectSet.add(obj["key"])
@@ -0,0 +1,43 @@
+import os
+import sys
+import argparse
+import json
+from pathlib import Path
+
+from check_metafile_consistency import loadMetadata, binaryMagic
+
+# Converts the binary metadata files back to the JSON format StorageManager used before, so that
+# an earlier version can read them after a downgrade.  StorageManager must not be running.
+
+def convert(metafile):
+    with open(metafile, "rb") as f:
+        if f.read(len(binaryMagic)) != binaryMagic:
+            return False
+    metadata = loadMetadata(metafile)
+    # the version the JSON format had
+    metadata["version"] = 1
+    tmpfile = str(metafile) + ".tmp"
+    with open(tmpfile, "w") as f:
+        json.dump(metadata, f)
+    os.rename(tmpfile, metafile)
+    return True
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts StorageManager metadata files to the JSON format")
+    parser.add_argument("metadata_path", type=str, help="ObjectStorage/metadata_path from storagemanager.cnf")
+    args = parser.parse_args()
+
+    converted = 0
+    for metafile in Path(args.metadata_path).rglob("*.meta"):
+        if convert(metafile):
+            converted += 1
+    print("Converted {} files".format(converted))
+    sys.exit(0)
+
+
+if sys.version_info < (3, 5):
+    print("Please use python version 3.5 or greater")
+    sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,125 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "brmtypes.h"
+#include "bytestream.h"
+#include "slavecomm.h"
+
+using namespace BRM;
+using namespace messageqcpp;
+namespace bf = boost::filesystem;
+
+// The journals are printed, not applied, so nothing here touches the BRM of the system
+class BRMJournalTest : public ::testing::Test
+{
+ protected:
+  void SetUp() override
+  {
+    dir = bf::temp_directory_path() / bf::unique_path("brm-journal-%%%%-%%%%");
+    bf::create_directories(dir);
+  }
+
+  void TearDown() override
+  {
+    bf::remove_all(dir);
+  }
+
+  // a journal of deleteOID commands, the way SlaveComm::saveDelta() writes them
+  void writeJournal(const std::string& name, const std::vector<uint32_t>& oids)
+  {
+    std::ofstream f(name.c_str(), std::ios::binary | std::ios::trunc);
+
+    for (uint32_t oid : oids)
+    {
+      ByteStream cmd;
+      cmd << DELETE_OID << oid;
+      uint32_t len = cmd.length();
+      f.write((const char*)&len, sizeof(len));
+      f.write((const char*)cmd.buf(), len);
+    }
+  }
+
+  // the deleted OIDs in the order they were replayed
+  std::vector<uint32_t> replay(const std::string& prefix, int& count)
+  {
+    SlaveComm comm;
+    std::vector<uint32_t> ret;
+
+    testing::internal::CaptureStdout();
+    count = comm.printJournal(prefix);
+    std::string out = testing::internal::GetCapturedStdout();
+
+    for (size_t pos = out.find("oid="); pos != std::string::npos; pos = out.find("oid=", pos + 1))
+      ret.push_back(std::stoul(out.substr(pos + 4)));
+
+    return ret;
+  }
+
+  bf::path dir;
+};
+
+TEST_F(BRMJournalTest, ReplaysTheJournal)
+{
+  writeJournal((dir / "BRM_saves_journal").string(), {1, 2});
+
+  int count;
+  std::vector<uint32_t> oids = replay((dir / "BRM_savesA").string(), count);
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(oids, std::vector<uint32_t>({1, 2}));
+}
+
+// A background snapshot that didn't complete left the entries since snapshot A in
+// A_oldjournal, and the ones after the rotation in the journal
+TEST_F(BRMJournalTest, ReplaysTheRotatedJournalFirst)
+{
+  std::string snapshot = (dir / "BRM_savesA").string();
+  writeJournal(SlaveComm::oldJournalName(snapshot), {1, 2, 3});
+  writeJournal((dir / "BRM_saves_journal").string(), {4, 5});
+
+  int count;
+  std::vector<uint32_t> oids = replay(snapshot, count);
+  EXPECT_EQ(count, 5);
+  EXPECT_EQ(oids, std::vector<uint32_t>({1, 2, 3, 4, 5}));
+
+  // the other snapshot's rotated journal isn't part of this one
+  writeJournal(SlaveComm::oldJournalName((dir / "BRM_savesB").string()), {6});
+  oids = replay(snapshot, count);
+  EXPECT_EQ(count, 5);
+  EXPECT_EQ(oids, std::vector<uint32_t>({1, 2, 3, 4, 5}));
+}
+
+// mcs-loadbrm stores the files it pulls from the primary as BRM_saves_<name> and loads
+// BRM_saves, the rotated journal has to be BRM_saves_oldjournal for that
+TEST_F(BRMJournalTest, ReplaysTheJournalsPulledByAReplica)
+{
+  std::string prefix = (dir / "BRM_saves").string();
+  EXPECT_EQ(SlaveComm::oldJournalName(prefix), prefix + "_oldjournal");
+  writeJournal(prefix + "_oldjournal", {1});
+  writeJournal(prefix + "_journal", {2});
+
+  int count;
+  std::vector<uint32_t> oids = replay(prefix, count);
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(oids, std::vector<uint32_t>({1, 2}));
+}
@@ -120,6 +120,7 @@ class FilterDriver : public CppUnit::TestFixture
   CPPUNIT_TEST(INT_TEST);
   CPPUNIT_TEST(FLOAT_TEST);
   CPPUNIT_TEST(WIDEDT_TEST);
+  CPPUNIT_TEST(SORT_RUNS_TEST);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -391,6 +392,146 @@ class FilterDriver : public CppUnit::TestFixture
     std::cout << r3.toString() << " < " << r3.toString() << " is " << ((result) ? "true" : "false")
               << std::endl;
     CPPUNIT_ASSERT(result == true);
+
+    // Normalized keys that differ must order the rows like the comparator does
+    uint64_t k1 = odbData.sortKey(r1.getPointer());
+    uint64_t k2 = odbData.sortKey(r2.getPointer());
+    uint64_t k3 = odbData.sortKey(r3.getPointer());
+    CPPUNIT_ASSERT(k1 <= k2 && k3 <= k1);
+    CPPUNIT_ASSERT(k1 == k2 || odbData(r1.getPointer(), r2.getPointer()));
+    CPPUNIT_ASSERT(k3 == k1 || odbData(r3.getPointer(), r1.getPointer()));
+
+    std::vector<ordering::KeyedRow<int> > rows(3);
+    rows[0] = {k2, r2.getPointer(), 2};
+    rows[1] = {k3, r3.getPointer(), 3};
+    rows[2] = {k1, r1.getPointer(), 1};
+    odbData.sort(rows, []() { return false; });
+    CPPUNIT_ASSERT(rows[0].fPayload == 3 && rows[1].fPayload == 1 && rows[2].fPayload == 2);
+  }
+
+  // Sorts the rows of rg by specVect in runs of runRows and checks that the result is a
+  // permutation of the rows ordered by the rules.  The keys only order the rows they tell
+  // apart, so a key that disagreed with the rules would show up as two rows out of order.
+  std::vector<ordering::KeyedRow<uint32_t> > sortRuns(const rowgroup::RowGroup& rg,
+                                                       const std::vector<ordering::IdbSortSpec>& specVect,
+                                                       size_t runRows)
+  {
+    const uint32_t rowCount = rg.getRowCount();
+    ordering::OrderByData odbData(specVect, rg);
+    std::vector<ordering::KeyedRow<uint32_t> > rows(rowCount);
+    rowgroup::Row r;
+    rg.initRow(&r);
+
+    for (uint32_t i = 0; i < rowCount; i++)
+    {
+      rg.getRow(i, &r);
+      rows[i] = {odbData.sortKey(r.getPointer()), r.getPointer(), i};
+    }
+
+    odbData.sort(rows, []() { return false; }, runRows);
+
+    std::vector<bool> seen(rowCount, false);
+
+    for (uint32_t i = 0; i < rowCount; i++)
+    {
+      CPPUNIT_ASSERT(!seen[rows[i].fPayload]);
+      seen[rows[i].fPayload] = true;
+
+      if (i > 0)
+        CPPUNIT_ASSERT(!odbData(rows[i].fData, rows[i - 1].fData));
+    }
+
+    return rows;
+  }
+
+  // Sorts more rows than fit into one run, with duplicates and NULLs, so that the runs
+  // are merged over several passes, some of them with an odd run left over.  There are
+  // enough rows for several sort threads.
+  void SORT_RUNS_TEST()
+  {
+    using execplan::CalpontSystemCatalog;
+    const uint32_t rowCount = 200000;
+    const size_t runRows = 1000;
+    // BIGINT, VARCHAR(24) latin1_swedish_ci, DOUBLE, FLOAT, DECIMAL(38)
+    std::vector<uint32_t> offsets{2, 10, 34, 42, 46, 62};
+    std::vector<uint32_t> roids{3001, 3002, 3003, 3004, 3005};
+    std::vector<uint32_t> tkeys{1, 2, 3, 4, 5};
+    std::vector<CalpontSystemCatalog::ColDataType> types{CalpontSystemCatalog::BIGINT,
+                                                         CalpontSystemCatalog::VARCHAR,
+                                                         CalpontSystemCatalog::DOUBLE,
+                                                         CalpontSystemCatalog::FLOAT,
+                                                         CalpontSystemCatalog::DECIMAL};
+    std::vector<uint32_t> charSetNumVec(5, 8);
+    std::vector<uint32_t> cscale(5, 0);
+    std::vector<uint32_t> cprecision{20, 20, 20, 20, 38};
+    rowgroup::RowGroup inRG(5, offsets, roids, tkeys, types, charSetNumVec, cscale, cprecision, 20, false);
+
+    rowgroup::RGData rgD = rowgroup::RGData(inRG, rowCount);
+    inRG.setData(&rgD);
+    rowgroup::Row r;
+    inRG.initRow(&r);
+    inRG.getRow(0, &r);
+
+    // Strings longer than their 7 bytes of key that differ in case only, or after the key
+    const char* prefixes[] = {"abcdefghij", "ABCDEFGHIJ", "abcdefgHiK", "abc", "b"};
+    const int128_t wideScale = static_cast<int128_t>(1000000000000LL) * 100000000LL;
+
+    for (uint32_t i = 0; i < rowCount; i++)
+    {
+      int64_t v = (int64_t)((i * 7919ULL) % 251) - 125;
+
+      if (i % 97 == 0)
+      {
+        r.setIntField<8>(joblist::BIGINTNULL, 0);
+        r.setStringField(std::string(), 1);  // an empty inline string is NULL
+        r.setUintField(joblist::DOUBLENULL, 2);
+        r.setUintField(joblist::FLOATNULL, 3);
+        r.setInt128Field(datatypes::Decimal128Null, 4);
+      }
+      else
+      {
+        std::string str = prefixes[i % 5];
+        str += (char)((i % 2 ? 'a' : 'A') + (i * 31) % 26);
+        r.setIntField<8>(v, 0);
+        r.setStringField(str, 1);
+        // -0 and 0 are equal
+        r.setDoubleField((v == 0 && i % 2) ? -0.0 : v * 1.5e10 + (i % 3) * 1e-3, 2);
+        r.setFloatField((float)v / 7, 3);
+        // rows that only differ in the low bytes the key has no room for
+        r.setInt128Field(v * wideScale + (int128_t)(i % 13), 4);
+      }
+
+      r.nextRow();
+    }
+
+    inRG.setRowCount(rowCount);
+
+    std::vector<std::vector<ordering::IdbSortSpec> > specs{
+        {{0, true, true}},
+        {{0, false, true}},
+        {{1, true, true}},
+        {{1, false, false}},
+        {{2, true, true}},
+        {{2, false, false}},
+        {{3, true, true}},
+        {{3, false, true}},
+        {{4, true, true}},
+        {{4, false, false}},
+        // the BIGINT only fits partly into the key, the DOUBLE not at all
+        {{0, false, true}, {2, false, true}},
+        // a string ends the key, the columns after it are compared on key ties
+        {{1, false, true}, {0, false, false}, {4, true, true}},
+        {{4, false, true}, {1, false, true}},
+        {{3, false, false}, {2, false, true}, {0, true, true}}};
+
+    for (const std::vector<ordering::IdbSortSpec>& specVect : specs)
+    {
+      std::vector<ordering::KeyedRow<uint32_t> > rows = sortRuns(inRG, specVect, runRows);
+
+      // NULLs first or last, either way
+      inRG.getRow(rows[specVect[0].fNf > 0 ? 0 : rowCount - 1].fPayload, &r);
+      CPPUNIT_ASSERT(r.isNullValue(specVect[0].fIndex));
+    }
   }
 
   void INT_TEST()
@@ -0,0 +1,95 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+
+#include "compressed_iss.h"
+
+using namespace messageqcpp;
+
+namespace
+{
+typedef CompressedInetStreamSocket CISS;
+
+// A link that takes linkUsPerByte to send a byte, with Snappy and LZ4 measured as given
+void measure(CISS::CodecChoice& choice, double linkUsPerByte, double snappyRatio, double snappyUs,
+             double lz4Ratio, double lz4Us)
+{
+  choice.linkBytes = 1000000;
+  choice.linkUs = linkUsPerByte * choice.linkBytes;
+  choice.ratio[CISS::SNAPPY_COMPRESSION] = snappyRatio;
+  choice.usPerByte[CISS::SNAPPY_COMPRESSION] = snappyUs;
+  choice.ratio[CISS::LZ4_COMPRESSION] = lz4Ratio;
+  choice.usPerByte[CISS::LZ4_COMPRESSION] = lz4Us;
+}
+
+}  // namespace
+
+TEST(PickCodecTest, KeepsTheConfiguredOneUntilSomethingIsSent)
+{
+  CISS::CodecChoice choice;
+  choice.codec = CISS::LZ4_COMPRESSION;
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::LZ4_COMPRESSION);
+}
+
+TEST(PickCodecTest, CompressesOnASlowLink)
+{
+  CISS::CodecChoice choice;
+  choice.codec = CISS::NO_COMPRESSION;
+
+  // Snappy 0.01 + 0.5, LZ4 0.02 + 0.4 of the 1us a byte takes as is
+  measure(choice, 1.0, 0.5, 0.01, 0.4, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::LZ4_COMPRESSION);
+
+  measure(choice, 1.0, 0.4, 0.01, 0.5, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::SNAPPY_COMPRESSION);
+}
+
+TEST(PickCodecTest, SendsAsIsOnAFastLink)
+{
+  CISS::CodecChoice choice;
+  choice.codec = CISS::SNAPPY_COMPRESSION;
+
+  // compressing a byte takes longer than sending it
+  measure(choice, 0.001, 0.5, 0.01, 0.4, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::NO_COMPRESSION);
+
+  // data that doesn't compress
+  choice.codec = CISS::NO_COMPRESSION;
+  measure(choice, 1.0, 1.0, 0.01, 1.0, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::NO_COMPRESSION);
+}
+
+// The one in use stays unless another is more than 10% faster
+TEST(PickCodecTest, DoesntSwitchForALittleLess)
+{
+  CISS::CodecChoice choice;
+  choice.codec = CISS::SNAPPY_COMPRESSION;
+
+  // Snappy 0.51us, LZ4 0.49us a byte
+  measure(choice, 1.0, 0.5, 0.01, 0.47, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::SNAPPY_COMPRESSION);
+
+  // LZ4 0.32us a byte
+  measure(choice, 1.0, 0.5, 0.01, 0.3, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::LZ4_COMPRESSION);
+
+  // as is 1us, Snappy 0.95us a byte
+  choice.codec = CISS::NO_COMPRESSION;
+  measure(choice, 1.0, 0.94, 0.01, 1.0, 0.02);
+  EXPECT_EQ(CISS::pickCodec(choice), CISS::NO_COMPRESSION);
+}
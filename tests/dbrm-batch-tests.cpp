@@ -0,0 +1,164 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "brmtypes.h"
+#include "bytestream.h"
+#include "extentmap.h"
+#include "masterdbrmnode.h"
+#include "slavecomm.h"
+
+using namespace BRM;
+using namespace messageqcpp;
+namespace bf = boost::filesystem;
+
+namespace
+{
+// no extent has it, marking it invalid takes the locks and changes nothing
+const LBID_t unusedLBID = 0x7ffffffffff0LL;
+
+ByteStream markInvalidCmd()
+{
+  ByteStream cmd;
+  cmd << MARKMANYEXTENTSINVALID << (uint32_t)1 << (uint64_t)unusedLBID
+      << (uint32_t)execplan::CalpontSystemCatalog::BIGINT;
+  return cmd;
+}
+
+}  // namespace
+
+TEST(DBRMBatchTest, BatchableCommands)
+{
+  EXPECT_TRUE(MasterDBRMNode::isBatchable(SETEXTENTMAXMIN));
+  EXPECT_TRUE(MasterDBRMNode::isBatchable(MARKMANYEXTENTSINVALID));
+  EXPECT_TRUE(MasterDBRMNode::isBatchable(SET_LOCAL_HWM));
+  EXPECT_TRUE(MasterDBRMNode::isBatchable(BULK_SET_HWM_AND_CP));
+
+  // creating an extent can move the extent map segments under the undo records
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(CREATE_STRIPE_COLUMN_EXTENTS));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(CREATE_COLUMN_EXTENT_DBROOT));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(CREATE_COLUMN_EXTENT_EXACT_FILE));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(CREATE_DICT_STORE_EXTENT));
+
+  // the version buffer and the OIDs are more than the extent map
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(BEGIN_VB_COPY));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(VB_COMMIT));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(DELETE_OID));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(BRM_BATCH));
+  EXPECT_FALSE(MasterDBRMNode::isBatchable(GET_COMMAND_LATENCIES));
+}
+
+TEST(DBRMBatchTest, LatencyBuckets)
+{
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(0), 0U);
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(1), 1U);
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(2), 2U);
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(3), 2U);
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(1000), 10U);
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(1ULL << (LATENCY_BUCKETS - 2)), LATENCY_BUCKETS - 1);
+  EXPECT_EQ(MasterDBRMNode::latencyBucket(~0ULL), LATENCY_BUCKETS - 1);
+}
+
+// Uses the extent map of the configured system.  Its write locks aren't reentrant, a
+// batch would wait for itself on the second command without holdWriteLocks().
+TEST(DBRMBatchTest, HeldWriteLocksAreTakenAgain)
+{
+  ExtentMap em;
+  std::vector<LBID_t> lbids(1, unusedLBID);
+  std::vector<execplan::CalpontSystemCatalog::ColDataType> types(1, execplan::CalpontSystemCatalog::BIGINT);
+
+  em.holdWriteLocks(true);
+  EXPECT_EQ(em.markInvalid(lbids, types), 0);
+  EXPECT_EQ(em.markInvalid(lbids, types), 0);
+  em.holdWriteLocks(false);
+  em.undoChanges();
+
+  // the undo released them
+  EXPECT_EQ(em.markInvalid(lbids, types), 0);
+  em.confirmChanges();
+}
+
+class DBRMBatchJournalTest : public ::testing::Test
+{
+ protected:
+  void SetUp() override
+  {
+    dir = bf::temp_directory_path() / bf::unique_path("dbrm-batch-%%%%-%%%%");
+    bf::create_directories(dir);
+  }
+
+  void TearDown() override
+  {
+    bf::remove_all(dir);
+  }
+
+  // one BRM_BATCH entry of cmds, the way the first worker journals a batch
+  void writeBatch(const std::vector<ByteStream>& cmds)
+  {
+    ByteStream entry;
+    entry << BRM_BATCH << (uint32_t)cmds.size();
+
+    for (const ByteStream& cmd : cmds)
+      entry << cmd;
+
+    std::ofstream f((dir / "BRM_saves_journal").c_str(), std::ios::binary | std::ios::trunc);
+    uint32_t len = entry.length();
+    f.write((const char*)&len, sizeof(len));
+    f.write((const char*)entry.buf(), len);
+  }
+
+  bf::path dir;
+};
+
+TEST_F(DBRMBatchJournalTest, PrintsTheCommandsOfABatch)
+{
+  writeBatch({markInvalidCmd(), markInvalidCmd()});
+
+  SlaveComm comm;
+  testing::internal::CaptureStdout();
+  int count = comm.printJournal((dir / "BRM_savesA").string());
+  std::string out = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(count, 1);
+  EXPECT_NE(out.find("batch of 2 commands"), std::string::npos);
+  size_t first = out.find("markManyExtentsInvalid");
+  ASSERT_NE(first, std::string::npos);
+  EXPECT_NE(out.find("markManyExtentsInvalid", first + 1), std::string::npos);
+}
+
+// Applied to the extent map of the configured system, the commands of the batch
+// stay pending under the same locks until the replay confirms them
+TEST_F(DBRMBatchJournalTest, ReplaysABatch)
+{
+  writeBatch({markInvalidCmd(), markInvalidCmd(), markInvalidCmd()});
+
+  SlaveComm comm;
+  EXPECT_EQ(comm.replayJournal((dir / "BRM_savesA").string()), 1);
+
+  // and the locks are free again
+  ExtentMap em;
+  std::vector<LBID_t> lbids(1, unusedLBID);
+  std::vector<execplan::CalpontSystemCatalog::ColDataType> types(1, execplan::CalpontSystemCatalog::BIGINT);
+  EXPECT_EQ(em.markInvalid(lbids, types), 0);
+  em.confirmChanges();
+}
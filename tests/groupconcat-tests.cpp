@@ -0,0 +1,313 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "configcpp.h"
+#include "exceptclasses.h"
+#include "groupconcat.h"
+#include "resourcemanager.h"
+#include "rowgroup.h"
+
+using namespace joblist;
+using namespace rowgroup;
+
+namespace
+{
+const int64_t sessionLimit = 16 * 1024;  // a few RGDatas of the test rows
+
+// A ResourceManager on a config of its own, to turn disk aggregation on and
+// keep the spilled runs in a temp dir of the test
+config::Config* makeTestConfig(const std::string& dir, bool allowDisk)
+{
+  std::string file = dir + (allowDisk ? "/disk.xml" : "/nodisk.xml");
+  std::ofstream xml(file);
+  xml << "<Columnstore Version=\"V1.0.0\">\n"
+      << "<SystemConfig><SystemTempFileDir>" << dir << "/tmp</SystemTempFileDir></SystemConfig>\n"
+      << "<JobList><MaxOutstandingRequests>20</MaxOutstandingRequests></JobList>\n"
+      << "<RowAggregation><AllowDiskBasedAggregation>" << (allowDisk ? "Y" : "N")
+      << "</AllowDiskBasedAggregation></RowAggregation>\n"
+      << "</Columnstore>\n";
+  xml.close();
+  return config::Config::makeConfig(file);
+}
+
+}  // namespace
+
+class GroupConcatSpillTest : public ::testing::Test
+{
+ protected:
+  void SetUp() override
+  {
+    fDir = "/tmp/groupconcat-tests-" + std::to_string(getpid());
+    boost::filesystem::create_directories(fDir);
+
+    std::vector<uint32_t> offsets, roids, tkeys, scale, precision, charSets;
+    std::vector<execplan::CalpontSystemCatalog::ColDataType> types;
+    offsets.push_back(2);
+    offsets.push_back(2 + 8);
+    roids.push_back(3000);
+    tkeys.push_back(1);
+    scale.push_back(0);
+    precision.push_back(19);
+    charSets.push_back(8);
+    types.push_back(execplan::CalpontSystemCatalog::BIGINT);
+    fRowGroup = RowGroup(1, offsets, roids, tkeys, types, charSets, scale, precision, 20, false);
+
+    fRowData.reinit(fRowGroup, 1);
+    fRowGroup.setData(&fRowData);
+    fRowGroup.resetRowGroup(0);
+    fRowGroup.initRow(&fRow);
+    fRowGroup.getRow(0, &fRow);
+  }
+
+  void TearDown() override
+  {
+    fRm.reset();
+    boost::filesystem::remove_all(fDir);
+  }
+
+  SP_GroupConcat makeGroupConcat(bool allowDisk, bool distinct, bool ordered)
+  {
+    fRm.reset(new ResourceManager(false, makeTestConfig(fDir, allowDisk)));
+    fSessionLimit.reset(new int64_t(sessionLimit));
+
+    SP_GroupConcat gcc(new GroupConcat);
+    gcc->fGroupCols.push_back(std::make_pair(1, 0));
+    gcc->fSeparator = ",";
+    gcc->fDistinct = distinct;
+    gcc->fSize = 1024 * 1024;
+    gcc->fRowGroup = fRowGroup;
+    gcc->fRm = fRm.get();
+    gcc->fSessionMemLimit = fSessionLimit;
+    gcc->fTimeZone = 0;
+
+    if (ordered)
+      gcc->fOrderCond.push_back(std::make_pair(0, true));
+
+    return gcc;
+  }
+
+  void add(GroupConcator& gc, int64_t v)
+  {
+    fRow.setIntField(v, 0);
+    gc.processRow(fRow);
+  }
+
+  uint64_t runFiles()
+  {
+    std::string dir = fDir + "/tmp/aggregates/";
+    uint64_t n = 0;
+
+    if (boost::filesystem::exists(dir))
+      for (boost::filesystem::directory_iterator it(dir); it != boost::filesystem::directory_iterator(); ++it)
+        n++;
+
+    return n;
+  }
+
+  std::string fDir;
+  RowGroup fRowGroup;
+  RGData fRowData;
+  Row fRow;
+  boost::scoped_ptr<ResourceManager> fRm;
+  boost::shared_ptr<int64_t> fSessionLimit;
+};
+
+TEST_F(GroupConcatSpillTest, NoOrderKeepsTheRowOrder)
+{
+  SP_GroupConcat gcc = makeGroupConcat(true, false, false);
+  std::string expected;
+
+  {
+    GroupConcatNoOrder gc;
+    gc.initialize(gcc);
+
+    for (int64_t i = 0; i < 5000; i++)
+    {
+      add(gc, i);
+      expected += (i ? "," : "") + std::to_string(i);
+    }
+
+    EXPECT_GT(runFiles(), 0U);
+    EXPECT_GE(*fSessionLimit, 0);
+    EXPECT_EQ(std::string((char*)gc.getResult(",")), expected);
+  }
+
+  EXPECT_EQ(*fSessionLimit, sessionLimit);
+  EXPECT_EQ(runFiles(), 0U);
+}
+
+TEST_F(GroupConcatSpillTest, OrderByMergesTheRuns)
+{
+  SP_GroupConcat gcc = makeGroupConcat(true, false, true);
+  std::string expected;
+
+  {
+    GroupConcatOrderBy gc;
+    gc.initialize(gcc);
+
+    // descending in, so every run has rows that go before the ones of the run before
+    for (int64_t i = 4999; i >= 0; i--)
+      add(gc, i);
+
+    for (int64_t i = 0; i < 5000; i++)
+      expected += (i ? "," : "") + std::to_string(i);
+
+    EXPECT_GT(runFiles(), 1U);
+    EXPECT_EQ(std::string((char*)gc.getResult(",")), expected);
+  }
+
+  EXPECT_EQ(*fSessionLimit, sessionLimit);
+  EXPECT_EQ(runFiles(), 0U);
+}
+
+TEST_F(GroupConcatSpillTest, DistinctAcrossRuns)
+{
+  SP_GroupConcat gcc = makeGroupConcat(true, true, true);
+  std::string expected;
+
+  {
+    GroupConcatOrderBy gc;
+    gc.initialize(gcc);
+
+    // each value three times, far enough apart to be in different runs
+    for (int64_t n = 0; n < 3; n++)
+      for (int64_t i = 0; i < 2000; i++)
+        add(gc, (i * 7 + n) % 2000);
+
+    for (int64_t i = 0; i < 2000; i++)
+      expected += (i ? "," : "") + std::to_string(i);
+
+    EXPECT_GT(runFiles(), 1U);
+    EXPECT_EQ(std::string((char*)gc.getResult(",")), expected);
+  }
+
+  EXPECT_EQ(*fSessionLimit, sessionLimit);
+}
+
+// The runs of the GROUP_CONCATs of the other threads come with merge()
+TEST_F(GroupConcatSpillTest, MergeTakesTheRuns)
+{
+  SP_GroupConcat gcc = makeGroupConcat(true, true, true);
+  std::string expected;
+
+  {
+    GroupConcatOrderBy gc1, gc2;
+    gc1.initialize(gcc);
+    gc2.initialize(gcc);
+
+    for (int64_t i = 0; i < 3000; i++)
+      add((i % 2) ? gc1 : gc2, i);
+
+    // every third one again, some of them went to gc1 first
+    for (int64_t i = 0; i < 3000; i += 3)
+      add(gc2, i);
+
+    for (int64_t i = 0; i < 3000; i++)
+      expected += (i ? "," : "") + std::to_string(i);
+
+    gc1.merge(&gc2);
+    EXPECT_EQ(std::string((char*)gc1.getResult(",")), expected);
+  }
+
+  EXPECT_EQ(*fSessionLimit, sessionLimit);
+  EXPECT_EQ(runFiles(), 0U);
+}
+
+// Each run is as long as group_concat_max_len, only what fits in the result is read back
+TEST_F(GroupConcatSpillTest, StopsAtTheMaxLength)
+{
+  SP_GroupConcat gcc = makeGroupConcat(true, false, true);
+  gcc->fSize = 20000;
+  std::string expected;
+
+  GroupConcatOrderBy gc;
+  gc.initialize(gcc);
+
+  for (int64_t i = 10000; i < 20000; i++)
+  {
+    add(gc, i);
+    expected += (i > 10000 ? "," : "") + std::to_string(i);
+  }
+
+  EXPECT_GT(runFiles(), 1U);
+  EXPECT_EQ(std::string((char*)gc.getResult(",")), expected.substr(0, 20000));
+}
+
+// The group that runs out of memory writes the rows of all the groups to disk
+TEST_F(GroupConcatSpillTest, SpillWritesEveryGroup)
+{
+  SP_GroupConcat gcc = makeGroupConcat(true, false, true);
+  gcc->fMapping.reset(new int[1]);
+  gcc->fMapping[0] = 0;
+  const int64_t groupCount = 4;
+  std::vector<std::string> expected(groupCount);
+
+  {
+    std::vector<SP_GroupConcatAg> groups;
+
+    for (int64_t g = 0; g < groupCount; g++)
+      groups.emplace_back(new GroupConcatAgUM(gcc, &groups));
+
+    auto addTo = [&](int64_t i)
+    {
+      std::string& e = expected[i % groupCount];
+      e += (e.empty() ? "" : ",") + std::to_string(i);
+      fRow.setIntField(i, 0);
+      groups[i % groupCount]->processRow(fRow);
+    };
+
+    int64_t i = 0;
+
+    while (runFiles() == 0 && i < 100000)
+      addTo(i++);
+
+    EXPECT_EQ(runFiles(), (uint64_t)groupCount);
+
+    for (int64_t n = 0; n < 1000; n++)
+      addTo(i++);
+
+    for (int64_t g = 0; g < groupCount; g++)
+      EXPECT_EQ(std::string((char*)dynamic_cast<GroupConcatAgUM*>(groups[g].get())->getResult()),
+                expected[g]);
+  }
+
+  EXPECT_EQ(*fSessionLimit, sessionLimit);
+  EXPECT_EQ(runFiles(), 0U);
+}
+
+TEST_F(GroupConcatSpillTest, ThrowsWithoutDiskAggregation)
+{
+  SP_GroupConcat gcc = makeGroupConcat(false, false, false);
+  GroupConcatNoOrder gc;
+  gc.initialize(gcc);
+
+  EXPECT_THROW(
+      {
+        for (int64_t i = 0; i < 5000; i++)
+          add(gc, i);
+      },
+      logging::IDBExcept);
+  EXPECT_EQ(runFiles(), 0U);
+}
@@ -0,0 +1,218 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+
+#include "bytestream.h"
+#include "jobthrottle.h"
+#include "primitivemsg.h"
+
+using namespace joblist;
+using namespace messageqcpp;
+
+namespace
+{
+const uint64_t maxWindow = 1024;
+const uint64_t midUsec = 50000;  // neither fast nor slow
+
+// A response the way PrimProc sends it, with a row group or the error msg headers only
+ByteStream makeResponse(uint16_t queueDepth, uint16_t status, bool withBody)
+{
+  ISMPacketHeader ism;
+  PrimitiveHeader ph = {0, 0, 0, 0, 0, 0};
+  ByteStream bs;
+
+  ism.Size = queueDepth;
+  ism.Status = status;
+  bs.append((uint8_t*)&ism, sizeof(ism));
+  bs.append((uint8_t*)&ph, sizeof(ph));
+
+  if (withBody)
+    bs << (uint8_t)0 << (uint64_t)0;
+
+  return bs;
+}
+
+}  // namespace
+
+class JobThrottleTest : public ::testing::Test
+{
+ protected:
+  JobThrottleTest() : fThrottle(maxWindow), fMsgsSent(0), fStart(JobThrottle::TimePoint())
+  {
+  }
+
+  // sends and receives n one-block jobs that took usec each, returns what the last adapt() did
+  bool runJobs(uint32_t n, uint64_t usec)
+  {
+    bool adapted = false;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+      fThrottle.jobSent(++fMsgsSent, 1, fStart);
+      adapted = fThrottle.adapt(fMsgsSent, fStart + std::chrono::microseconds(usec));
+      fStart += std::chrono::microseconds(usec);
+    }
+
+    return adapted;
+  }
+
+  bool runAdjustment(uint64_t usec)
+  {
+    return runJobs(JobThrottle::JOBS_PER_ADJUSTMENT, usec);
+  }
+
+  JobThrottle fThrottle;
+  uint64_t fMsgsSent;
+  JobThrottle::TimePoint fStart;
+};
+
+TEST_F(JobThrottleTest, StartsWithTheDefaults)
+{
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow);
+  EXPECT_EQ(fThrottle.minSendWindow(), maxWindow >> JobThrottle::MIN_SEND_WINDOW_SHIFT);
+  EXPECT_EQ(fThrottle.jobSizeShift(), 0);
+  EXPECT_EQ(fThrottle.jobBlocks(16), 16U);
+}
+
+TEST_F(JobThrottleTest, WaitsForEnoughJobs)
+{
+  fThrottle.responseRead(makeResponse(100, 0, true));
+  EXPECT_FALSE(runJobs(JobThrottle::JOBS_PER_ADJUSTMENT - 1, midUsec));
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow);
+
+  // jobs still out don't count
+  fThrottle.jobSent(++fMsgsSent, 1, fStart);
+  EXPECT_FALSE(fThrottle.adapt(fMsgsSent - 1, fStart));
+  EXPECT_TRUE(fThrottle.adapt(fMsgsSent, fStart));
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow / 2);
+}
+
+TEST_F(JobThrottleTest, BusyPMHalvesTheWindow)
+{
+  for (uint64_t window = maxWindow / 2; window >= fThrottle.minSendWindow(); window /= 2)
+  {
+    fThrottle.responseRead(makeResponse(JobThrottle::PM_QUEUE_HIGH + 1, 0, true));
+    EXPECT_TRUE(runAdjustment(midUsec));
+    EXPECT_EQ(fThrottle.sendWindow(), window);
+  }
+
+  fThrottle.responseRead(makeResponse(JobThrottle::PM_QUEUE_HIGH + 1, 0, true));
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), fThrottle.minSendWindow());
+  EXPECT_EQ(fThrottle.jobSizeShift(), 0);
+}
+
+TEST_F(JobThrottleTest, UMBacklogHalvesTheWindow)
+{
+  fThrottle.umBacklog();
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow / 2);
+
+  // the backlog is over with the adjustment
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow / 2 + maxWindow / 16);
+}
+
+TEST_F(JobThrottleTest, IdlePMGrowsTheWindowBack)
+{
+  fThrottle.umBacklog();
+  runAdjustment(midUsec);
+  fThrottle.umBacklog();
+  runAdjustment(midUsec);
+  ASSERT_EQ(fThrottle.sendWindow(), maxWindow / 4);
+
+  fThrottle.responseRead(makeResponse(JobThrottle::PM_QUEUE_LOW, 0, true));
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow / 4 + maxWindow / 16);
+
+  // in between it stays where it is
+  fThrottle.responseRead(makeResponse(JobThrottle::PM_QUEUE_HIGH, 0, true));
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow / 4 + maxWindow / 16);
+
+  for (uint32_t i = 0; i < 16; i++)
+    runAdjustment(midUsec);
+
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow);
+}
+
+TEST_F(JobThrottleTest, FastJobsGetBigger)
+{
+  for (int32_t shift = 1; shift <= JobThrottle::MAX_JOB_SIZE_SHIFT; shift++)
+  {
+    runAdjustment(JobThrottle::FAST_JOB_USEC - 1);
+    EXPECT_EQ(fThrottle.jobSizeShift(), shift);
+  }
+
+  runAdjustment(JobThrottle::FAST_JOB_USEC - 1);
+  EXPECT_EQ(fThrottle.jobSizeShift(), JobThrottle::MAX_JOB_SIZE_SHIFT);
+  EXPECT_EQ(fThrottle.jobBlocks(16), 16U << JobThrottle::MAX_JOB_SIZE_SHIFT);
+}
+
+TEST_F(JobThrottleTest, FastJobsStayWhileOverloaded)
+{
+  fThrottle.umBacklog();
+  runAdjustment(JobThrottle::FAST_JOB_USEC - 1);
+  EXPECT_EQ(fThrottle.jobSizeShift(), 0);
+}
+
+TEST_F(JobThrottleTest, SlowJobsGetSmaller)
+{
+  for (int32_t shift = -1; shift >= JobThrottle::MIN_JOB_SIZE_SHIFT; shift--)
+  {
+    runAdjustment(JobThrottle::SLOW_JOB_USEC + 1);
+    EXPECT_EQ(fThrottle.jobSizeShift(), shift);
+  }
+
+  runAdjustment(JobThrottle::SLOW_JOB_USEC + 1);
+  EXPECT_EQ(fThrottle.jobSizeShift(), JobThrottle::MIN_JOB_SIZE_SHIFT);
+  EXPECT_EQ(fThrottle.jobBlocks(16), 16U >> -JobThrottle::MIN_JOB_SIZE_SHIFT);
+  EXPECT_EQ(fThrottle.jobBlocks(2), 1U);
+}
+
+// The latency is a moving average, one slow job among fast ones doesn't shrink them
+TEST_F(JobThrottleTest, LatencyIsAveraged)
+{
+  runJobs(JobThrottle::JOBS_PER_ADJUSTMENT - 1, 1000);
+  runJobs(1, JobThrottle::SLOW_JOB_USEC * 2);
+  EXPECT_LT(fThrottle.jobLatency(), JobThrottle::SLOW_JOB_USEC);
+  EXPECT_EQ(fThrottle.jobSizeShift(), 0);
+}
+
+// Only the row groups carry the queue depth, the error msgs leave Size at whatever
+TEST_F(JobThrottleTest, ErrorResponsesHaveNoQueueDepth)
+{
+  fThrottle.responseRead(makeResponse(0xffff, 1, true));
+  fThrottle.responseRead(makeResponse(0xffff, 1, false));
+  fThrottle.responseRead(makeResponse(0xffff, 0, false));
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow);
+
+  fThrottle.responseRead(makeResponse(0xffff, 0, true));
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.sendWindow(), maxWindow / 2);
+}
+
+TEST_F(JobThrottleTest, MiniStats)
+{
+  fThrottle.jobSent(fMsgsSent += 4, 4, fStart);
+  fThrottle.jobSent(fMsgsSent += 2, 2, fStart);
+  fThrottle.umBacklog();
+  runAdjustment(midUsec);
+  EXPECT_EQ(fThrottle.miniStats(), "1-4:512-1024");
+}
@@ -0,0 +1,138 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "bytestream.h"
+#include "mpscring.h"
+
+using namespace messageqcpp;
+using namespace joblist;
+
+namespace
+{
+SBS makeMsg(uint32_t writer, uint32_t seq)
+{
+  SBS sbs(new ByteStream());
+  *sbs << writer << seq;
+  return sbs;
+}
+
+}  // namespace
+
+TEST(MPSCRingTest, PopsInOrderAndCounts)
+{
+  MPSCRing<SBS> ring(4);
+  uint64_t bytes = 0;
+
+  // twice the ring, the rest goes to the overflow
+  for (uint32_t i = 0; i < 8; ++i)
+  {
+    SBS msg = makeMsg(0, i);
+    bytes += msg->lengthWithHdrOverhead();
+    TSQSize_t size = ring.push(msg);
+    EXPECT_EQ(size.count, i + 1);
+    EXPECT_EQ(size.size, bytes);
+  }
+
+  for (uint32_t i = 0; i < 8; ++i)
+  {
+    SBS msg;
+    uint32_t writer, seq;
+    TSQSize_t size = ring.pop(&msg);
+    *msg >> writer >> seq;
+    EXPECT_EQ(seq, i);
+    EXPECT_EQ(size.count, 7 - i);
+  }
+
+  EXPECT_EQ(ring.size().count, 0U);
+  EXPECT_EQ(ring.size().size, 0U);
+}
+
+TEST(MPSCRingTest, PopSomeAndClear)
+{
+  MPSCRing<SBS> ring(4);
+  std::vector<SBS> msgs;
+
+  for (uint32_t i = 0; i < 6; ++i)
+    ring.push(makeMsg(0, i));
+
+  TSQSize_t size = ring.pop_some(2, msgs);
+  EXPECT_EQ(msgs.size(), 3U);
+  EXPECT_EQ(size.count, 3U);
+
+  ring.clear();
+  EXPECT_EQ(ring.size().count, 0U);
+  EXPECT_EQ(ring.size().size, 0U);
+
+  ring.pop_all(msgs);
+  EXPECT_TRUE(msgs.empty());
+}
+
+TEST(MPSCRingTest, ShutdownWakesReader)
+{
+  MPSCRing<SBS> ring;
+  SBS msg(new ByteStream());
+
+  std::thread reader([&] { ring.pop(&msg); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ring.shutdown();
+  reader.join();
+
+  EXPECT_FALSE(msg);
+  EXPECT_EQ(ring.push(makeMsg(0, 0)).count, 0U);
+}
+
+// Each writer's messages come out in the order it pushed them, with a
+// ring small enough for some of them to overflow
+TEST(MPSCRingTest, ManyWriters)
+{
+  const uint32_t writers = 8;
+  const uint32_t perWriter = 20000;
+  MPSCRing<SBS> ring(64);
+  std::vector<std::thread> threads;
+
+  for (uint32_t w = 0; w < writers; ++w)
+    threads.emplace_back(
+        [&ring, w]
+        {
+          for (uint32_t i = 0; i < perWriter; ++i)
+            ring.push(makeMsg(w, i));
+        });
+
+  std::vector<uint32_t> next(writers, 0);
+
+  for (uint32_t n = 0; n < writers * perWriter; ++n)
+  {
+    SBS msg;
+    uint32_t writer, seq;
+    ring.pop(&msg);
+    ASSERT_TRUE(msg);
+    *msg >> writer >> seq;
+    ASSERT_LT(writer, writers);
+    ASSERT_EQ(seq, next[writer]);
+    ++next[writer];
+  }
+
+  for (std::thread& t : threads)
+    t.join();
+
+  EXPECT_EQ(ring.size().count, 0U);
+  EXPECT_EQ(ring.size().size, 0U);
+}
@@ -0,0 +1,153 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "collation.h"
+#include "compiledregex.h"
+
+using namespace datatypes;
+using namespace funcexp;
+
+namespace
+{
+const uint32_t latin1Bin = 47;
+const uint32_t latin1SwedishCi = 8;
+const uint32_t utf8mb3Bin = 83;
+
+LikePattern::Kind likeKind(uint32_t charset, const std::string& pattern)
+{
+  return LikePattern(Charset(charset), utils::ConstString(pattern)).kind();
+}
+
+bool like(uint32_t charset, const std::string& pattern, const std::string& subject, bool neg = false)
+{
+  LikePattern p(Charset(charset), utils::ConstString(pattern));
+  return p.like(neg, utils::ConstString(subject));
+}
+
+}  // namespace
+
+TEST(LikePatternTest, Kinds)
+{
+  EXPECT_EQ(likeKind(latin1Bin, "%"), LikePattern::ANY);
+  EXPECT_EQ(likeKind(latin1Bin, "%%"), LikePattern::ANY);
+  EXPECT_EQ(likeKind(latin1Bin, "abc"), LikePattern::EXACT);
+  EXPECT_EQ(likeKind(latin1Bin, "abc%"), LikePattern::PREFIX);
+  EXPECT_EQ(likeKind(latin1Bin, "%abc"), LikePattern::SUFFIX);
+  EXPECT_EQ(likeKind(latin1Bin, "%abc%"), LikePattern::SUBSTRING);
+  EXPECT_EQ(likeKind(latin1Bin, "a_c"), LikePattern::WILDCMP);
+  EXPECT_EQ(likeKind(latin1Bin, "a%c"), LikePattern::WILDCMP);
+  EXPECT_EQ(likeKind(latin1Bin, "a\\%"), LikePattern::WILDCMP);
+  EXPECT_EQ(likeKind(utf8mb3Bin, "%abc%"), LikePattern::SUBSTRING);
+}
+
+// 'a' LIKE 'A' in a case insensitive collation, only wildcmp() knows
+TEST(LikePatternTest, NonBinaryCollationsUseWildcmp)
+{
+  EXPECT_EQ(likeKind(latin1SwedishCi, "abc"), LikePattern::WILDCMP);
+  EXPECT_EQ(likeKind(latin1SwedishCi, "%abc%"), LikePattern::WILDCMP);
+  EXPECT_TRUE(like(latin1SwedishCi, "%ABC%", "xxabcxx"));
+  EXPECT_TRUE(like(latin1SwedishCi, "abc", "ABC"));
+}
+
+TEST(LikePatternTest, Matches)
+{
+  EXPECT_TRUE(like(latin1Bin, "%", ""));
+  EXPECT_TRUE(like(latin1Bin, "%", "abc"));
+
+  EXPECT_TRUE(like(latin1Bin, "abc", "abc"));
+  EXPECT_FALSE(like(latin1Bin, "abc", "abcd"));
+  EXPECT_FALSE(like(latin1Bin, "abc", "ABC"));
+
+  EXPECT_TRUE(like(latin1Bin, "abc%", "abcd"));
+  EXPECT_TRUE(like(latin1Bin, "abc%", "abc"));
+  EXPECT_FALSE(like(latin1Bin, "abc%", "ab"));
+  EXPECT_FALSE(like(latin1Bin, "abc%", "xabc"));
+
+  EXPECT_TRUE(like(latin1Bin, "%abc", "xabc"));
+  EXPECT_FALSE(like(latin1Bin, "%abc", "abcx"));
+  EXPECT_FALSE(like(latin1Bin, "%abc", "bc"));
+
+  EXPECT_TRUE(like(latin1Bin, "%abc%", "xxabcxx"));
+  EXPECT_TRUE(like(latin1Bin, "%abc%", "abc"));
+  EXPECT_FALSE(like(latin1Bin, "%abc%", "xxabxcxx"));
+
+  EXPECT_TRUE(like(latin1Bin, "a_c", "abc"));
+  EXPECT_FALSE(like(latin1Bin, "a_c", "abbc"));
+  EXPECT_TRUE(like(latin1Bin, "a%c", "abbc"));
+}
+
+TEST(LikePatternTest, NotLike)
+{
+  EXPECT_FALSE(like(latin1Bin, "%", "abc", true));
+  EXPECT_FALSE(like(latin1Bin, "abc%", "abcd", true));
+  EXPECT_TRUE(like(latin1Bin, "abc%", "xabc", true));
+  EXPECT_TRUE(like(latin1Bin, "%abc%", "xyz", true));
+  EXPECT_FALSE(like(latin1Bin, "a_c", "abc", true));
+}
+
+// A multibyte character is matched whole
+TEST(LikePatternTest, Utf8)
+{
+  EXPECT_TRUE(like(utf8mb3Bin, "%\xc3\xa9t\xc3\xa9%", "un \xc3\xa9t\xc3\xa9 chaud"));
+  EXPECT_FALSE(like(utf8mb3Bin, "%\xc3\xa9t\xc3\xa9%", "un ete chaud"));
+  EXPECT_TRUE(like(utf8mb3Bin, "_t_", "\xc3\xa9t\xc3\xa9"));
+}
+
+TEST(CompiledRegexTest, Kinds)
+{
+  EXPECT_EQ(CompiledRegex("^abc$").kind(), CompiledRegex::EXACT);
+  EXPECT_EQ(CompiledRegex("^abc").kind(), CompiledRegex::PREFIX);
+  EXPECT_EQ(CompiledRegex("abc$").kind(), CompiledRegex::SUFFIX);
+  EXPECT_EQ(CompiledRegex("abc").kind(), CompiledRegex::SUBSTRING);
+  EXPECT_EQ(CompiledRegex("a.c").kind(), CompiledRegex::REGEX);
+  EXPECT_EQ(CompiledRegex("^a+$").kind(), CompiledRegex::REGEX);
+  EXPECT_EQ(CompiledRegex("a\\.c").kind(), CompiledRegex::REGEX);
+}
+
+TEST(CompiledRegexTest, Matches)
+{
+  EXPECT_TRUE(CompiledRegex("^abc$").match("abc"));
+  EXPECT_FALSE(CompiledRegex("^abc$").match("abcd"));
+
+  EXPECT_TRUE(CompiledRegex("^abc").match("abcd"));
+  EXPECT_FALSE(CompiledRegex("^abc").match("ab"));
+  EXPECT_FALSE(CompiledRegex("^abc").match("xabc"));
+
+  EXPECT_TRUE(CompiledRegex("abc$").match("xabc"));
+  EXPECT_FALSE(CompiledRegex("abc$").match("abcx"));
+  EXPECT_FALSE(CompiledRegex("abc$").match("bc"));
+
+  EXPECT_TRUE(CompiledRegex("abc").match("xxabcxx"));
+  EXPECT_FALSE(CompiledRegex("abc").match("xxabxcxx"));
+  EXPECT_TRUE(CompiledRegex("").match("anything"));
+
+  EXPECT_TRUE(CompiledRegex("^a.c$").match("abc"));
+  EXPECT_FALSE(CompiledRegex("^a.c$").match("abbc"));
+  EXPECT_TRUE(CompiledRegex("b+").match("abbbc"));
+  EXPECT_TRUE(CompiledRegex("x|c$").match("abc"));
+}
+
+TEST(CompiledRegexTest, InvalidRegexNeverMatches)
+{
+  CompiledRegex re("a(b");
+  EXPECT_EQ(re.kind(), CompiledRegex::REGEX);
+  EXPECT_FALSE(re.match("a(b"));
+  EXPECT_FALSE(re.match("ab"));
+}
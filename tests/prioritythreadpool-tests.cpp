@@ -0,0 +1,156 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "prioritythreadpool.h"
+
+using namespace threadpool;
+
+namespace
+{
+// Holds its thread until the gate opens, asks to run again the first `again` times
+class GatedJob : public PriorityThreadPool::Functor
+{
+ public:
+  GatedJob(std::atomic<bool>& gate, std::atomic<uint32_t>& started, std::atomic<uint32_t>& done,
+           uint32_t again = 0)
+   : fGate(gate), fStarted(started), fDone(done), fAgain(again)
+  {
+  }
+
+  int operator()()
+  {
+    fStarted++;
+
+    while (!fGate)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    if (fAgain > 0)
+    {
+      fAgain--;
+      return -1;
+    }
+
+    fDone++;
+    return 0;
+  }
+
+ private:
+  std::atomic<bool>& fGate;
+  std::atomic<uint32_t>& fStarted;
+  std::atomic<uint32_t>& fDone;
+  uint32_t fAgain;
+};
+
+bool waitFor(const std::atomic<uint32_t>& counter, uint32_t value)
+{
+  for (uint32_t i = 0; i < 5000 && counter < value; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  return counter >= value;
+}
+
+}  // namespace
+
+class PriorityThreadPoolTest : public ::testing::Test
+{
+ protected:
+  void SetUp() override
+  {
+    fGate = false;
+    fStarted = 0;
+    fDone = 0;
+    // one job per run on a single thread. The threads are detached and
+    // outlive the pool, so like PrimProc's it is never deleted.
+    fPool = new PriorityThreadPool(1, 0, 0, 1);
+  }
+
+  void addJob(uint32_t id, uint32_t priority = 0, uint32_t again = 0)
+  {
+    PriorityThreadPool::Job job;
+    job.functor.reset(new GatedJob(fGate, fStarted, fDone, again));
+    job.id = id;
+    job.priority = priority;
+    fPool->addJob(job);
+  }
+
+  std::atomic<bool> fGate;
+  std::atomic<uint32_t> fStarted;
+  std::atomic<uint32_t> fDone;
+  PriorityThreadPool* fPool;
+};
+
+TEST_F(PriorityThreadPoolTest, CountsTheWaitingJobs)
+{
+  EXPECT_EQ(fPool->getThreadCount(), 1U);
+  EXPECT_EQ(fPool->getWaiting(), 0U);
+
+  // the one the thread runs doesn't wait
+  addJob(1);
+  ASSERT_TRUE(waitFor(fStarted, 1));
+  EXPECT_EQ(fPool->getWaiting(), 0U);
+
+  for (uint32_t i = 0; i < 5; i++)
+    addJob(2, i * 40);
+
+  EXPECT_EQ(fPool->getWaiting(), 5U);
+
+  fGate = true;
+  ASSERT_TRUE(waitFor(fDone, 6));
+  EXPECT_EQ(fPool->getWaiting(), 0U);
+}
+
+TEST_F(PriorityThreadPoolTest, RemovedJobsDontWait)
+{
+  addJob(1);
+  ASSERT_TRUE(waitFor(fStarted, 1));
+
+  for (uint32_t i = 0; i < 3; i++)
+    addJob(2, i * 40);
+
+  addJob(3);
+  addJob(3, 90);
+  ASSERT_EQ(fPool->getWaiting(), 5U);
+
+  fPool->removeJobs(2);
+  EXPECT_EQ(fPool->getWaiting(), 2U);
+
+  fPool->removeJobs(4);
+  EXPECT_EQ(fPool->getWaiting(), 2U);
+
+  fGate = true;
+  ASSERT_TRUE(waitFor(fDone, 3));
+  EXPECT_EQ(fPool->getWaiting(), 0U);
+}
+
+// A rescheduled job waits again and is counted again
+TEST_F(PriorityThreadPoolTest, RescheduledJobsWaitAgain)
+{
+  addJob(1, 0, 3);
+  ASSERT_TRUE(waitFor(fStarted, 1));
+  addJob(2);
+  EXPECT_EQ(fPool->getWaiting(), 1U);
+
+  fGate = true;
+  ASSERT_TRUE(waitFor(fDone, 2));
+  EXPECT_EQ(fStarted.load(), 5U);
+  EXPECT_EQ(fPool->getWaiting(), 0U);
+}
@@ -0,0 +1,195 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "configcpp.h"
+#include "errorids.h"
+#include "jlf_common.h"
+#include "resourcemanager.h"
+#include "rowgroup.h"
+#include "tupleunion.h"
+
+using namespace joblist;
+using namespace rowgroup;
+
+namespace
+{
+const int64_t sessionLimit = 2 * 1024 * 1024;  // a fraction of the distinct rows
+const uint32_t rowsPerRG = 8192;
+
+// UNION DISTINCT only spills with AllowDiskBasedAggregation, which the
+// ResourceManager reads once from its config
+config::Config* makeTestConfig(const std::string& dir, bool allowDisk)
+{
+  std::string file = dir + (allowDisk ? "/disk.xml" : "/nodisk.xml");
+  std::ofstream xml(file);
+  xml << "<Columnstore Version=\"V1.0.0\">\n"
+      << "<SystemConfig><SystemTempFileDir>" << dir << "/tmp</SystemTempFileDir></SystemConfig>\n"
+      << "<RowAggregation><AllowDiskBasedAggregation>" << (allowDisk ? "Y" : "N")
+      << "</AllowDiskBasedAggregation></RowAggregation>\n"
+      << "</Columnstore>\n";
+  xml.close();
+  return config::Config::makeConfig(file);
+}
+
+}  // namespace
+
+class TupleUnionSpillTest : public ::testing::Test
+{
+ protected:
+  void SetUp() override
+  {
+    fDir = "/tmp/tupleunion-tests-" + std::to_string(getpid());
+    boost::filesystem::create_directories(fDir);
+
+    std::vector<uint32_t> offsets, roids, tkeys, scale, precision, charSets;
+    std::vector<execplan::CalpontSystemCatalog::ColDataType> types;
+    offsets.push_back(2);
+    offsets.push_back(2 + 8);
+    roids.push_back(3000);
+    tkeys.push_back(1);
+    scale.push_back(0);
+    precision.push_back(19);
+    charSets.push_back(8);
+    types.push_back(execplan::CalpontSystemCatalog::BIGINT);
+    fRowGroup = RowGroup(1, offsets, roids, tkeys, types, charSets, scale, precision, 20, false);
+  }
+
+  void TearDown() override
+  {
+    fRm.reset();
+    boost::filesystem::remove_all(fDir);
+  }
+
+  // the values [from, to) in full RGDatas
+  AnyDataListSPtr makeInput(int64_t from, int64_t to)
+  {
+    RowGroupDL* dl = new RowGroupDL(1, (to - from) / rowsPerRG + 2);
+    AnyDataListSPtr spdl(new AnyDataList());
+    spdl->rowGroupDL(dl);
+
+    for (int64_t v = from; v < to;)
+    {
+      RGData rgData(fRowGroup);
+      Row row;
+      fRowGroup.setData(&rgData);
+      fRowGroup.resetRowGroup(0);
+      fRowGroup.initRow(&row);
+      fRowGroup.getRow(0, &row);
+
+      for (; v < to && fRowGroup.getRowCount() < rowsPerRG; v++, row.nextRow())
+      {
+        row.setIntField(v, 0);
+        fRowGroup.incRowCount();
+      }
+
+      dl->insert(rgData);
+    }
+
+    dl->endOfInput();
+    return spdl;
+  }
+
+  // runs a UNION DISTINCT of [0, 400000) and [200000, 600000), returns how
+  // often each value came out
+  std::vector<uint32_t> runUnion(bool allowDisk, uint32_t& status)
+  {
+    fRm.reset(new ResourceManager(false, makeTestConfig(fDir, allowDisk)));
+    JobInfo jobInfo(fRm.get());
+    jobInfo.umMemLimit.reset(new int64_t(sessionLimit));
+    jobInfo.errorInfo.reset(new ErrorInfo());
+
+    TupleUnion tu(3000, jobInfo);
+    JobStepAssociation jsaIn, jsaOut;
+    jsaIn.outAdd(makeInput(0, 400000));
+    jsaIn.outAdd(makeInput(200000, 600000));
+    tu.inputAssociation(jsaIn);
+
+    AnyDataListSPtr spdlOut(new AnyDataList());
+    RowGroupDL* dlOut = new RowGroupDL(1, 16);
+    spdlOut->rowGroupDL(dlOut);
+    jsaOut.outAdd(spdlOut);
+    tu.outputAssociation(jsaOut);
+
+    tu.setInputRowGroups(std::vector<RowGroup>(2, fRowGroup));
+    tu.setOutputRowGroup(fRowGroup);
+    tu.setDistinctFlags(std::vector<bool>(2, true));
+
+    std::vector<uint32_t> seen(600000, 0);
+    uint32_t it = dlOut->getIterator();
+    RGData rgData;
+    RowGroup outRG(fRowGroup);
+    Row row;
+    outRG.initRow(&row);
+
+    tu.run();
+
+    while (dlOut->next(it, &rgData))
+    {
+      outRG.setData(&rgData);
+      outRG.getRow(0, &row);
+
+      for (uint32_t i = 0; i < outRG.getRowCount(); i++, row.nextRow())
+      {
+        int64_t v = row.getIntField(0);
+
+        if (v >= 0 && v < 600000)
+          seen[v]++;
+      }
+    }
+
+    tu.join();
+    status = tu.status();
+    return seen;
+  }
+
+  std::string fDir;
+  RowGroup fRowGroup;
+  boost::scoped_ptr<ResourceManager> fRm;
+};
+
+TEST_F(TupleUnionSpillTest, DistinctCountWithSpill)
+{
+  uint32_t status;
+  std::vector<uint32_t> seen = runUnion(true, status);
+  uint64_t distinct = 0, dups = 0;
+
+  for (uint32_t n : seen)
+  {
+    distinct += (n > 0);
+    dups += (n > 1);
+  }
+
+  EXPECT_EQ(status, 0U);
+  EXPECT_EQ(distinct, 600000U);
+  EXPECT_EQ(dups, 0U);
+}
+
+// the same union doesn't fit the session limit in memory
+TEST_F(TupleUnionSpillTest, TooBigWithoutDiskAggregation)
+{
+  uint32_t status;
+  runUnion(false, status);
+  EXPECT_EQ(status, (uint32_t)logging::ERR_UNION_TOO_BIG);
+}
@@ -0,0 +1,117 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+
+#include "vss.h"
+
+using namespace BRM;
+
+TEST(VSSChangeSeqTest, WriterMakesItOddThenEven)
+{
+  EXPECT_EQ(VSS::writeStartSeq(0), 1U);
+  EXPECT_EQ(VSS::writeEndSeq(1), 2U);
+  EXPECT_EQ(VSS::writeStartSeq(2), 3U);
+  EXPECT_EQ(VSS::writeEndSeq(3), 4U);
+}
+
+// A writer that died holding the lock left it odd, the next one must still end on even
+TEST(VSSChangeSeqTest, RecoversFromAnOddValue)
+{
+  uint32_t seq = 7;
+
+  seq = VSS::writeStartSeq(seq);
+  EXPECT_EQ(seq & 1, 1U);
+  seq = VSS::writeEndSeq(seq);
+  EXPECT_EQ(seq & 1, 0U);
+  EXPECT_GT(seq, 7U);
+
+  seq = 0xffffffff;
+  EXPECT_EQ(VSS::writeStartSeq(seq) & 1, 1U);
+  EXPECT_EQ(VSS::writeEndSeq(seq) & 1, 0U);
+}
+
+// Uses the VSS segment of the configured system, on an LBID no table has
+class VSSLookupUnlockedTest : public ::testing::Test
+{
+ protected:
+  static const LBID_t lbid = 0x7ffffffffff0LL;
+  static const VER_t version = 5;
+
+  void SetUp() override
+  {
+    vss.lock(VSS::WRITE);
+    vss.insert(lbid, version, false, false);
+    vss.confirmChanges();
+    vss.release(VSS::WRITE);
+  }
+
+  void TearDown() override
+  {
+    vss.lock(VSS::WRITE);
+    vss.removeEntry(lbid, version, nullptr);
+    vss.confirmChanges();
+    vss.release(VSS::WRITE);
+  }
+
+  bool lookupUnlocked(int& rc, VER_t& outVer)
+  {
+    QueryContext_vss verInfo;
+    bool vbFlag;
+
+    verInfo.currentScn = version + 1;
+    return vss.lookupUnlocked(lbid, verInfo, 0, &outVer, &vbFlag, false, rc);
+  }
+
+  VSS vss;
+};
+
+TEST_F(VSSLookupUnlockedTest, RejectedWhileAWriterHoldsTheLock)
+{
+  int rc;
+  VER_t outVer = -1;
+
+  vss.lock(VSS::WRITE);
+  EXPECT_FALSE(lookupUnlocked(rc, outVer));
+  vss.release(VSS::WRITE);
+
+  ASSERT_TRUE(lookupUnlocked(rc, outVer));
+  EXPECT_EQ(rc, 0);
+  EXPECT_EQ(outVer, version);
+}
+
+TEST_F(VSSLookupUnlockedTest, BulkLookupTakesTheWholeBatchOrNothing)
+{
+  QueryContext_vss verInfo;
+  std::vector<LBID_t> lbids{lbid, lbid + 1, lbid};
+  std::vector<VSSData> out;
+
+  verInfo.currentScn = version + 1;
+
+  vss.lock(VSS::WRITE);
+  EXPECT_FALSE(vss.bulkLookupUnlocked(lbids, verInfo, 0, out));
+  vss.release(VSS::WRITE);
+
+  ASSERT_TRUE(vss.bulkLookupUnlocked(lbids, verInfo, 0, out));
+  ASSERT_EQ(out.size(), 3U);
+  EXPECT_EQ(out[0].returnCode, 0);
+  EXPECT_EQ(out[0].verID, version);
+  EXPECT_EQ(out[1].returnCode, -1);
+  EXPECT_EQ(out[1].verID, 0);
+  EXPECT_EQ(out[2].returnCode, 0);
+  EXPECT_EQ(out[2].verID, version);
+}
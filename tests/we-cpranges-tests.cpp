@@ -0,0 +1,152 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "writeengine.h"
+
+using namespace WriteEngine;
+using execplan::CalpontSystemCatalog;
+
+namespace
+{
+const int32_t seqNum = 7;
+
+// The range of an INT column the way AddLBIDtoList() fetches it from the extent map
+ExtCPInfo intRange(int64_t min, int64_t max)
+{
+  ExtCPInfo cpInfo(CalpontSystemCatalog::INT, 4);
+  cpInfo.fCPInfo.firstLbid = 1024;
+  cpInfo.fCPInfo.min = cpInfo.fCPInfo.bigMin = min;
+  cpInfo.fCPInfo.max = cpInfo.fCPInfo.bigMax = max;
+  cpInfo.fCPInfo.seqNum = seqNum;
+  return cpInfo;
+}
+
+ExtCPInfo invalidIntRange()
+{
+  ExtCPInfo cpInfo = intRange(0, 0);
+  cpInfo.toInvalid();
+  return cpInfo;
+}
+
+}  // namespace
+
+// The sequence of insertColumnRec_Single(): mark the range, write the rows, set the new range
+class CPRangesTest : public ::testing::Test
+{
+ protected:
+  CPRangesTest()
+  {
+    fColType.colDataType = CalpontSystemCatalog::INT;
+    fColType.colWidth = 4;
+    fMaxMins.push_back(ColSplitMaxMinInfo(CalpontSystemCatalog::INT, 4));
+  }
+
+  // the current extent of the column has the range cpInfo
+  void appendTo(const ExtCPInfo& cpInfo)
+  {
+    fMaxMins[0].fSplitMaxMinInfo[0] = cpInfo;
+    fMaxMins[0].fSplitMaxMinInfoPtrs[0] = &fMaxMins[0].fSplitMaxMinInfo[0];
+  }
+
+  void insertRow(int value, bool firstRowOfExtent = false)
+  {
+    fWE.updateMaxMinRange(1, 1, fColType, WR_INT, &value, NULL, fMaxMins[0].fSplitMaxMinInfoPtrs[0],
+                          firstRowOfExtent);
+  }
+
+  WriteEngineWrapper fWE;
+  CalpontSystemCatalog::ColType fColType;
+  ColSplitMaxMinInfoList fMaxMins;
+};
+
+TEST_F(CPRangesTest, RangeIsMarkedWhileTheRowsAreWritten)
+{
+  appendTo(intRange(10, 20));
+
+  std::vector<ExtCPInfo> cpInfos = WriteEngineWrapper::getMaxMinsBeingSet(fMaxMins);
+  ASSERT_EQ(cpInfos.size(), 1U);
+  EXPECT_EQ(cpInfos[0].fCPInfo.firstLbid, 1024);
+  EXPECT_EQ(cpInfos[0].fCPInfo.seqNum, SEQNUM_MARK_INVALID_SET_RANGE);
+  EXPECT_EQ(cpInfos[0].fCPInfo.min, 10);
+  EXPECT_EQ(cpInfos[0].fCPInfo.max, 20);
+}
+
+TEST_F(CPRangesTest, RangeGrowsWithTheInsertedRows)
+{
+  appendTo(intRange(10, 20));
+  insertRow(15);
+  insertRow(25);
+  insertRow(-5);
+
+  std::vector<ExtCPInfo> cpInfos = WriteEngineWrapper::getNewMaxMins(fMaxMins);
+  ASSERT_EQ(cpInfos.size(), 1U);
+  EXPECT_EQ(cpInfos[0].fCPInfo.seqNum, seqNum + 1);
+  EXPECT_EQ(cpInfos[0].fCPInfo.min, -5);
+  EXPECT_EQ(cpInfos[0].fCPInfo.max, 25);
+}
+
+// Nothing is known about the rows already there
+TEST_F(CPRangesTest, InvalidRangeStaysInvalid)
+{
+  appendTo(invalidIntRange());
+  insertRow(15);
+
+  std::vector<ExtCPInfo> cpInfos = WriteEngineWrapper::getNewMaxMins(fMaxMins);
+  ASSERT_EQ(cpInfos.size(), 1U);
+  EXPECT_TRUE(cpInfos[0].isInvalid());
+  EXPECT_EQ(cpInfos[0].fCPInfo.seqNum, SEQNUM_MARK_INVALID_SET_RANGE);
+}
+
+// Unless the row is the first one of the extent
+TEST_F(CPRangesTest, FirstRowStartsTheRange)
+{
+  appendTo(invalidIntRange());
+  insertRow(15, true);
+
+  std::vector<ExtCPInfo> cpInfos = WriteEngineWrapper::getNewMaxMins(fMaxMins);
+  ASSERT_EQ(cpInfos.size(), 1U);
+  EXPECT_FALSE(cpInfos[0].isInvalid());
+  EXPECT_EQ(cpInfos[0].fCPInfo.seqNum, seqNum + 1);
+  EXPECT_EQ(cpInfos[0].fCPInfo.min, 15);
+  EXPECT_EQ(cpInfos[0].fCPInfo.max, 15);
+}
+
+// Rows going to a new extent or types without ranges leave no range to set
+TEST_F(CPRangesTest, NoRangeToSet)
+{
+  EXPECT_TRUE(WriteEngineWrapper::getMaxMinsBeingSet(fMaxMins).empty());
+  EXPECT_TRUE(WriteEngineWrapper::getNewMaxMins(fMaxMins).empty());
+}
+
+TEST_F(CPRangesTest, RangesOfBothExtentsOfASplit)
+{
+  // a second column without a range
+  fMaxMins.push_back(ColSplitMaxMinInfo(CalpontSystemCatalog::INT, 4));
+  appendTo(intRange(10, 20));
+  fMaxMins[0].fSplitMaxMinInfo[1] = intRange(30, 40);
+  fMaxMins[0].fSplitMaxMinInfo[1].fCPInfo.firstLbid = 2048;
+  fMaxMins[0].fSplitMaxMinInfoPtrs[1] = &fMaxMins[0].fSplitMaxMinInfo[1];
+
+  std::vector<ExtCPInfo> cpInfos = WriteEngineWrapper::getNewMaxMins(fMaxMins);
+  ASSERT_EQ(cpInfos.size(), 2U);
+  EXPECT_EQ(cpInfos[0].fCPInfo.firstLbid, 1024);
+  EXPECT_EQ(cpInfos[1].fCPInfo.firstLbid, 2048);
+  EXPECT_EQ(cpInfos[1].fCPInfo.min, 30);
+}
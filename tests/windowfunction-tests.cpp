@@ -0,0 +1,130 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "calpontsystemcatalog.h"
+#include "wf_stats.h"
+#include "wf_sum_avg.h"
+
+using namespace windowfunction;
+using execplan::CalpontSystemCatalog;
+
+namespace
+{
+// dropValues() of an empty range only tells whether the frame would be slid or recalculated
+bool slides(const boost::shared_ptr<WindowFunctionType>& func)
+{
+  func->fieldIndex({0, 1});
+  return func->dropValues(3, 3);
+}
+
+}  // namespace
+
+TEST(WindowFunctionDropTest, BigintSumTakesTheDropPath)
+{
+  EXPECT_TRUE(slides(WF_sum_avg<int64_t, long double>::makeFunction(WF__SUM, "SUM",
+                                                                     CalpontSystemCatalog::BIGINT, nullptr)));
+  EXPECT_TRUE(slides(WF_sum_avg<int64_t, long double>::makeFunction(WF__AVG, "AVG",
+                                                                     CalpontSystemCatalog::BIGINT, nullptr)));
+  EXPECT_TRUE(slides(WF_sum_avg<int64_t, long double>::makeFunction(WF__SUM, "SUM",
+                                                                     CalpontSystemCatalog::UBIGINT, nullptr)));
+}
+
+TEST(WindowFunctionDropTest, FloatingPointAndDistinctSumsAreRecalculated)
+{
+  EXPECT_FALSE(slides(WF_sum_avg<int64_t, long double>::makeFunction(WF__SUM, "SUM",
+                                                                      CalpontSystemCatalog::DOUBLE, nullptr)));
+  EXPECT_FALSE(slides(WF_sum_avg<int64_t, long double>::makeFunction(WF__SUM, "SUM",
+                                                                      CalpontSystemCatalog::FLOAT, nullptr)));
+  EXPECT_FALSE(slides(WF_sum_avg<int64_t, long double>::makeFunction(
+      WF__SUM_DISTINCT, "SUM", CalpontSystemCatalog::BIGINT, nullptr)));
+}
+
+TEST(WindowFunctionDropTest, BigintStddevTakesTheDropPath)
+{
+  EXPECT_TRUE(slides(WF_stats<int64_t>::makeFunction(WF__STDDEV_POP, "STDDEV_POP",
+                                                     CalpontSystemCatalog::BIGINT, nullptr)));
+  EXPECT_FALSE(slides(WF_stats<int64_t>::makeFunction(WF__STDDEV_POP, "STDDEV_POP",
+                                                      CalpontSystemCatalog::DOUBLE, nullptr)));
+}
+
+// A ROWS 99 PRECEDING frame sliding over large BIGINT values, the way windowfunction.cpp
+// drives it: drop the row leaving the frame unless the sum should be added up again.
+TEST(RunningVarianceTest, SlidingFrameMatchesFullRecompute)
+{
+  const size_t rows = 20000;
+  const size_t frame = 100;
+  std::mt19937_64 gen(1);
+  std::vector<int64_t> values(rows);
+
+  for (auto& v : values)
+    v = 1000000000000000LL + (int64_t)(gen() % 2000000) - 1000000;
+
+  RunningVariance sliding;
+  size_t reanchored = 0;
+
+  for (size_t i = 0; i < frame; i++)
+    sliding.add(values[i]);
+
+  for (size_t i = frame; i < rows; i++)
+  {
+    if (sliding.reanchor(1))
+    {
+      reanchored++;
+      sliding.reset();
+
+      for (size_t j = i + 1 - frame; j <= i; j++)
+        sliding.add(values[j]);
+    }
+    else
+    {
+      sliding.drop(values[i - frame]);
+      sliding.add(values[i]);
+    }
+
+    RunningVariance full;
+
+    for (size_t j = i + 1 - frame; j <= i; j++)
+      full.add(values[j]);
+
+    ASSERT_EQ(sliding.count(), full.count());
+    ASSERT_NEAR((double)sliding.m2(), (double)full.m2(), 1e-9 * (double)full.m2()) << "row " << i;
+  }
+
+  // about once per frame length, the rest of the rows slid
+  EXPECT_GT(reanchored, rows / frame / 2);
+  EXPECT_LT(reanchored, rows / frame * 2);
+}
+
+TEST(RunningVarianceTest, DroppingEverything)
+{
+  RunningVariance var;
+  var.add(5);
+  var.add(7);
+  EXPECT_EQ(var.count(), 2U);
+  EXPECT_DOUBLE_EQ((double)var.m2(), 2.0);
+
+  var.drop(5);
+  var.drop(7);
+  EXPECT_EQ(var.count(), 0U);
+  EXPECT_EQ(var.m2(), 0);
+  EXPECT_TRUE(var.reanchor(1));
+}
@@ -211,6 +211,93 @@ class Charset
   }
 };
 
+// A LIKE pattern analyzed once so it can be matched against many subjects.
+// Patterns that are a literal with '%' only at the ends are matched with a plain
+// prefix/suffix/substring search when the collation compares bytes, everything else
+// goes to wildcmp() like Charset::like() does.
+
+class LikePattern : public Charset
+{
+ public:
+  enum Kind
+  {
+    WILDCMP,    // general pattern
+    ANY,        // '%'
+    EXACT,      // 'abc'
+    PREFIX,     // 'abc%'
+    SUFFIX,     // '%abc'
+    SUBSTRING,  // '%abc%'
+  };
+
+  LikePattern(const Charset& cs, const utils::ConstString& pattern)
+   : Charset(cs), mPattern(pattern.str(), pattern.length()), mKind(WILDCMP)
+  {
+    // byte matching is only the same as wildcmp() when equal characters have equal bytes
+    // and a byte match can't start in the middle of a character
+    if (!(mCharset->state & MY_CS_BINSORT) || mCharset->mbminlen != 1 ||
+        (mCharset->mbmaxlen != 1 && !(mCharset->state & MY_CS_UNICODE)))
+      return;
+
+    size_t b = mPattern.find_first_not_of('%');
+    if (b == std::string::npos)
+    {
+      mKind = ANY;
+      return;
+    }
+    size_t e = mPattern.find_last_not_of('%') + 1;
+    mLiteral = mPattern.substr(b, e - b);
+    if (mLiteral.find_first_of("%_\\") != std::string::npos)
+      return;
+
+    if (b == 0)
+      mKind = (e == mPattern.length() ? EXACT : PREFIX);
+    else
+      mKind = (e == mPattern.length() ? SUFFIX : SUBSTRING);
+  }
+
+  Kind kind() const
+  {
+    return mKind;
+  }
+  const std::string& pattern() const
+  {
+    return mPattern;
+  }
+
+  bool like(bool neg, const utils::ConstString& subject) const
+  {
+    bool res;
+    size_t len = mLiteral.length();
+
+    switch (mKind)
+    {
+      case ANY: res = true; break;
+
+      case EXACT: res = (subject.length() == len && !memcmp(subject.str(), mLiteral.data(), len)); break;
+
+      case PREFIX: res = (subject.length() >= len && !memcmp(subject.str(), mLiteral.data(), len)); break;
+
+      case SUFFIX:
+        res = (subject.length() >= len && !memcmp(subject.end() - len, mLiteral.data(), len));
+        break;
+
+      case SUBSTRING: res = (memmem(subject.str(), subject.length(), mLiteral.data(), len) != NULL); break;
+
+      default:
+        res = !mCharset->wildcmp(subject.str(), subject.end(), mPattern.data(),
+                                 mPattern.data() + mPattern.length(), '\\', '_', '%');
+        break;
+    }
+
+    return neg ? !res : res;
+  }
+
+ private:
+  std::string mPattern;
+  std::string mLiteral;  // the pattern without the leading and trailing '%'
+  Kind mKind;
+};
+
 class CollationAwareHasher : public Charset
 {
  public:
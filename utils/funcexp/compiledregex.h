@@ -0,0 +1,124 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <regex.h>
+#else
+#include <regex>
+#endif
+
+namespace funcexp
+{
+// A REGEXP pattern compiled once.  A pattern without special characters other than the
+// ^ and $ anchors is matched with a plain string search instead of the regex engine.
+class CompiledRegex
+{
+ public:
+  enum Kind
+  {
+    REGEX,
+    EXACT,      // ^abc$
+    PREFIX,     // ^abc
+    SUFFIX,     // abc$
+    SUBSTRING,  // abc
+  };
+
+  explicit CompiledRegex(const std::string& pattern) : fKind(REGEX), fValid(false)
+  {
+    size_t b = (!pattern.empty() && pattern[0] == '^') ? 1 : 0;
+    size_t e = (pattern.length() > b && pattern[pattern.length() - 1] == '$') ? pattern.length() - 1
+                                                                               : pattern.length();
+    fLiteral = pattern.substr(b, e - b);
+
+    if (fLiteral.find_first_of(".[]()*+?{}|^$\\") == std::string::npos)
+    {
+      if (b == 1)
+        fKind = (e < pattern.length() ? EXACT : PREFIX);
+      else
+        fKind = (e < pattern.length() ? SUFFIX : SUBSTRING);
+
+      fValid = true;
+      return;
+    }
+
+#ifdef __linux__
+    fValid = (regcomp(&fRe, pattern.c_str(), REG_EXTENDED | REG_NOSUB) == 0);
+#else
+    fRe = std::regex(pattern.c_str());
+    fValid = true;
+#endif
+  }
+
+  ~CompiledRegex()
+  {
+#ifdef __linux__
+    if (fKind == REGEX && fValid)
+      regfree(&fRe);
+#endif
+  }
+
+  Kind kind() const
+  {
+    return fKind;
+  }
+
+  bool match(const std::string& expr) const
+  {
+    if (!fValid)
+      return false;
+
+    size_t len = fLiteral.length();
+
+    switch (fKind)
+    {
+      case EXACT: return expr == fLiteral;
+
+      case PREFIX: return expr.compare(0, len, fLiteral) == 0;
+
+      case SUFFIX: return expr.length() >= len && expr.compare(expr.length() - len, len, fLiteral) == 0;
+
+      case SUBSTRING: return memmem(expr.data(), expr.length(), fLiteral.data(), len) != NULL;
+
+      default:
+#ifdef __linux__
+        return regexec(&fRe, expr.c_str(), 0, NULL, 0) == 0;
+#else
+        return std::regex_search(expr.c_str(), fRe);
+#endif
+    }
+  }
+
+ private:
+  CompiledRegex(const CompiledRegex&) = delete;
+  CompiledRegex& operator=(const CompiledRegex&) = delete;
+
+  Kind fKind;
+  bool fValid;
+  std::string fLiteral;
+#ifdef __linux__
+  regex_t fRe;
+#else
+  std::regex fRe;
+#endif
+};
+
+}  // namespace funcexp
@@ -22,16 +22,13 @@
  ****************************************************************************/
 
 #include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <unordered_map>
 using namespace std;
 
-#ifdef __linux__
-#include <regex.h>
-#else
-#include <regex>
-using namespace boost;
-#endif
-
+#include "compiledregex.h"
 #include "functor_bool.h"
 #include "functioncolumn.h"
 #include "predicateoperator.h"
@@ -44,9 +41,30 @@ using namespace execplan;
 #include "idberrorinfo.h"
 #include "errorids.h"
 using namespace logging;
+using namespace funcexp;
 
 namespace
 {
+// Patterns compiled by this thread.  The pattern is nearly always a constant, so it is
+// compiled once per thread instead of once per row.
+const size_t maxCachedPatterns = 32;
+thread_local unordered_map<string, unique_ptr<CompiledRegex>> compiledPatterns;
+
+const CompiledRegex& getCompiledRegex(const string& pattern)
+{
+  auto it = compiledPatterns.find(pattern);
+
+  if (it != compiledPatterns.end())
+    return *it->second;
+
+  if (compiledPatterns.size() >= maxCachedPatterns)
+    compiledPatterns.clear();
+
+  CompiledRegex* re = new CompiledRegex(pattern);
+  compiledPatterns[pattern].reset(re);
+  return *re;
+}
+
 inline bool getBool(rowgroup::Row& row, funcexp::FunctionParm& pm, bool& isNull,
                     CalpontSystemCatalog::ColType& ct, long timeZone)
 {
@@ -212,23 +230,7 @@ inline bool getBool(rowgroup::Row& row, funcexp::FunctionParm& pm, bool& isNull,
     }
   }
 
-#ifdef __linux__
-  regex_t re;
-
-  regcomp(&re, pattern.c_str(), REG_EXTENDED | REG_NOSUB);
-
-  int res = regexec(&re, expr.c_str(), 0, NULL, 0);
-  regfree(&re);
-
-  if (res == 0)
-    return true;
-  else
-    return false;
-
-#else
-  std::regex pat(pattern.c_str());
-  return std::regex_search(expr.c_str(), pat);
-#endif
+  return getCompiledRegex(pattern).match(expr);
 }
 
 }  // namespace
@@ -49,6 +49,8 @@
 #include <fcntl.h>
 #endif
 
+#include <chrono>
+
 #include "compressed_iss.h"
 #include "iosocket.h"
 #include "configcpp.h"
@@ -57,8 +59,41 @@ using namespace std;
 using namespace boost;
 using namespace compress;
 
+namespace
+{
+// The codecs a connection can pick from
+const uint32_t codecs[] = {messageqcpp::CompressedInetStreamSocket::SNAPPY_COMPRESSION,
+                           messageqcpp::CompressedInetStreamSocket::LZ4_COMPRESSION};
+
+// weight of the old samples in the averages
+const double decay = 0.875;
+
+CompressorPool& compressors()
+{
+  static CompressorPool pool = []
+  {
+    CompressorPool p;
+    initializeCompressorPool(p);
+    return p;
+  }();
+
+  return pool;
+}
+
+double elapsedUs(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
 namespace messageqcpp
 {
+CompressedInetStreamSocket::CodecChoice::CodecChoice()
+ : codec(NO_COMPRESSION), untilSample(0), linkBytes(0), linkUs(0), ratio(), usPerByte()
+{
+}
+
 CompressedInetStreamSocket::CompressedInetStreamSocket()
 {
   config::Config* config = config::Config::makeConfig();
@@ -86,11 +121,21 @@ CompressedInetStreamSocket::CompressedInetStreamSocket()
   {
   }
 
-  auto* compressInterface = compress::getCompressInterfaceByName(compressionType);
-  if (!compressInterface)
-    compressInterface = new compress::CompressInterfaceSnappy();
+  val.clear();
+
+  try
+  {
+    val = config->getConfig("NetworkCompression", "Adaptive");
+  }
+  catch (...)
+  {
+  }
+
+  adaptive = (val != "N" && val != "n");
 
-  alg.reset(compressInterface);
+  // Snappy unless configured otherwise, until the first sample says which
+  fChoice.reset(new CodecChoice());
+  fChoice->codec = (compressionType == "LZ4" ? LZ4_COMPRESSION : SNAPPY_COMPRESSION);
 }
 
 Socket* CompressedInetStreamSocket::clone() const
@@ -106,23 +151,98 @@ const SBS CompressedInetStreamSocket::read(const struct timespec* timeout, bool*
 
   readBS = InetStreamSocket::read(timeout, isTimeOut, stats);
 
-  if (readBS->length() == 0 || fMagicBuffer == BYTESTREAM_MAGIC)
+  if (readBS->length() == 0)
+    return readBS;
+
+  if (fMagicBuffer == BYTESTREAM_MAGIC)
+  {
+    if (stats)
+      stats->codecRecvd(NO_COMPRESSION, 1, readBS->length(), readBS->length());
+
     return readBS;
+  }
 
-  // Read stored len, first 4 bytes.
+  if (fMagicBuffer != COMPRESSED_BYTESTREAM_MAGIC_V2)
+    throw runtime_error(
+        "CompressedInetStreamSocket::read: compressed message without a compression type, "
+        "the peer runs an older version");
+
+  // Read stored len, first 4 bytes, then the compression type.
   uint32_t storedLen = *(uint32_t*)readBS->buf();
+  uint8_t codec = readBS->buf()[sizeof(storedLen)];
 
   if (!storedLen)
     return SBS(new ByteStream(0));
 
+  std::shared_ptr<CompressInterface> codecAlg = getCompressorByType(compressors(), codec);
+
+  if (!codecAlg)
+    throw runtime_error("CompressedInetStreamSocket::read: unknown compression type");
+
   uncompressedSize = storedLen;
   ret.reset(new ByteStream(uncompressedSize));
 
-  alg->uncompress((char*)readBS->buf() + HEADER_SIZE, readBS->length() - HEADER_SIZE,
-                  (char*)ret->getInputPtr(), &uncompressedSize);
+  if (codecAlg->uncompress((char*)readBS->buf() + HEADER_SIZE, readBS->length() - HEADER_SIZE,
+                           (char*)ret->getInputPtr(), &uncompressedSize) != CompressInterface::ERR_OK)
+    throw runtime_error("CompressedInetStreamSocket::read: uncompress failed");
 
   ret->advanceInputPtr(uncompressedSize);
 
+  if (stats)
+    stats->codecRecvd(codec, 1, uncompressedSize, readBS->length());
+
+  return ret;
+}
+
+bool CompressedInetStreamSocket::compress(const ByteStream& msg, uint32_t codec, ByteStream& out,
+                                          double& usPerByte) const
+{
+  std::shared_ptr<CompressInterface> codecAlg = getCompressorByType(compressors(), codec);
+  size_t len = msg.length();
+  size_t outLen = codecAlg->maxCompressedSize(len);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  out.needAtLeast(outLen + HEADER_SIZE);
+
+  int rc = codecAlg->compress((char*)msg.buf(), len, (char*)out.getInputPtr() + HEADER_SIZE, &outLen);
+  usPerByte = elapsedUs(start) / len;
+
+  if (rc != CompressInterface::ERR_OK || outLen >= len)
+    return false;
+
+  // Save original len and how it was compressed.
+  *(uint32_t*)out.getInputPtr() = len;
+  out.getInputPtr()[sizeof(uint32_t)] = codec;
+  out.advanceInputPtr(outLen + HEADER_SIZE);
+  return true;
+}
+
+uint32_t CompressedInetStreamSocket::pickCodec(const CodecChoice& choice)
+{
+  // Nothing sent yet
+  if (choice.linkUs == 0)
+    return choice.codec;
+
+  // time per byte to get it across, compressing first or not;
+  // a bit better than the one in use isn't worth switching for
+  double usPerLinkByte = choice.linkUs / choice.linkBytes;
+  double best = usPerLinkByte * (choice.codec != NO_COMPRESSION ? 1.1 : 1.0);
+  uint32_t ret = NO_COMPRESSION;
+
+  for (uint32_t codec : codecs)
+  {
+    double us = choice.usPerByte[codec] + choice.ratio[codec] * usPerLinkByte;
+
+    if (codec != choice.codec)
+      us *= 1.1;
+
+    if (us < best)
+    {
+      best = us;
+      ret = codec;
+    }
+  }
+
   return ret;
 }
 
@@ -130,23 +250,106 @@ void CompressedInetStreamSocket::write(const ByteStream& msg, Stats* stats)
 {
   size_t len = msg.length();
 
-  if (useCompression && (len > 512))
+  if (!useCompression || len <= MIN_COMPRESS_SIZE)
   {
-    size_t outLen = alg->maxCompressedSize(len) + HEADER_SIZE;
-    ByteStream smsg(outLen);
+    InetStreamSocket::write(msg, stats);
+    return;
+  }
 
-    alg->compress((char*)msg.buf(), len, (char*)smsg.getInputPtr() + HEADER_SIZE, &outLen);
-    // Save original len.
-    *(uint32_t*)smsg.getInputPtr() = len;
-    smsg.advanceInputPtr(outLen + HEADER_SIZE);
+  if (!adaptive)
+  {
+    ByteStream smsg;
+    double usPerByte;
 
-    if (outLen < len)
-      do_write(smsg, COMPRESSED_BYTESTREAM_MAGIC, stats);
+    if (compress(msg, fChoice->codec, smsg, usPerByte))
+    {
+      do_write(smsg, COMPRESSED_BYTESTREAM_MAGIC_V2, stats);
+
+      if (stats)
+        stats->codecSent(fChoice->codec, 1, len, smsg.length());
+    }
     else
+    {
       InetStreamSocket::write(msg, stats);
+
+      if (stats)
+        stats->codecSent(NO_COMPRESSION, 1, len, len);
+    }
+
+    return;
   }
+
+  uint32_t codec;
+  bool sample;
+
+  {
+    std::lock_guard<std::mutex> lk(fChoice->lock);
+    sample = (fChoice->untilSample == 0);
+    fChoice->untilSample = (sample ? SAMPLE_INTERVAL : fChoice->untilSample - 1);
+    codec = fChoice->codec;
+  }
+
+  ByteStream smsg;
+  bool compressed = false;
+
+  if (sample)
+  {
+    // Try them all and keep the output of the one picked
+    ByteStream tries[Stats::CODECS];
+    double ratio[Stats::CODECS];
+    double usPerByte[Stats::CODECS];
+
+    for (uint32_t c : codecs)
+    {
+      bool smaller = compress(msg, c, tries[c], usPerByte[c]);
+      ratio[c] = (smaller ? (double)tries[c].length() / len : 1.0);
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(fChoice->lock);
+
+      for (uint32_t c : codecs)
+      {
+        fChoice->ratio[c] = ratio[c];
+        fChoice->usPerByte[c] = usPerByte[c];
+      }
+
+      codec = fChoice->codec = pickCodec(*fChoice);
+    }
+
+    if (codec != NO_COMPRESSION && ratio[codec] < 1.0)
+    {
+      smsg.swap(tries[codec]);
+      compressed = true;
+    }
+  }
+  else if (codec != NO_COMPRESSION)
+  {
+    double usPerByte;
+    compressed = compress(msg, codec, smsg, usPerByte);
+    double ratio = (compressed ? (double)smsg.length() / len : 1.0);
+
+    std::lock_guard<std::mutex> lk(fChoice->lock);
+    fChoice->ratio[codec] = decay * fChoice->ratio[codec] + (1 - decay) * ratio;
+    fChoice->usPerByte[codec] = decay * fChoice->usPerByte[codec] + (1 - decay) * usPerByte;
+  }
+
+  size_t wireLen = (compressed ? smsg.length() : len);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  if (compressed)
+    do_write(smsg, COMPRESSED_BYTESTREAM_MAGIC_V2, stats);
   else
     InetStreamSocket::write(msg, stats);
+
+  double us = elapsedUs(start);
+
+  if (stats)
+    stats->codecSent(compressed ? codec : NO_COMPRESSION, 1, len, wireLen);
+
+  std::lock_guard<std::mutex> lk(fChoice->lock);
+  fChoice->linkBytes = decay * fChoice->linkBytes + wireLen;
+  fChoice->linkUs = decay * fChoice->linkUs + us;
 }
 
 void CompressedInetStreamSocket::write(SBS msg, Stats* stats)
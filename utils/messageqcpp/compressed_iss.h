@@ -28,6 +28,9 @@
 #include <netinet/in.h>
 #endif
 
+#include <memory>
+#include <mutex>
+
 #include "socket.h"
 #include "iosocket.h"
 #include "bytestream.h"
@@ -36,6 +39,21 @@
 
 namespace messageqcpp
 {
+/** @brief An InetStreamSocket that compresses what it writes when that pays
+ *
+ * Each compressed message starts with its uncompressed length and the
+ * compression type it was made with, so the reading side needs no setup.
+ * It goes out under COMPRESSED_BYTESTREAM_MAGIC_V2, and read() rejects
+ * COMPRESSED_BYTESTREAM_MAGIC, the length-only header of older versions.
+ *
+ * Unless NetworkCompression/Adaptive is N, the codec is picked per
+ * connection. Every SAMPLE_INTERVAL messages one is compressed with each
+ * codec to see how fast it is and how much it saves on this data, and the
+ * time write() takes per byte gives the throughput of the link. A codec is
+ * used while compressing a byte costs less than the link time it saves.
+ * write() only blocks once the socket buffer is full, so on a link with
+ * room to spare that is never, and the messages go as is.
+ */
 class CompressedInetStreamSocket : public InetStreamSocket
 {
  public:
@@ -52,10 +70,41 @@ class CompressedInetStreamSocket : public InetStreamSocket
   virtual const IOSocket accept(const struct timespec* timeout);
   virtual void connect(const sockaddr* addr);
 
+  // Compression types, as getCompressorByType() and Stats take them
+  static const uint32_t NO_COMPRESSION = 0;
+  static const uint32_t SNAPPY_COMPRESSION = 2;
+  static const uint32_t LZ4_COMPRESSION = 3;
+
+  // What the writing side learned about a connection, shared by its clones
+  struct CodecChoice
+  {
+    CodecChoice();
+
+    std::mutex lock;
+    uint32_t codec;        // compression type, NO_COMPRESSION for none
+    uint32_t untilSample;  // messages left
+    // decayed sums for the link throughput
+    double linkBytes;
+    double linkUs;
+    // per compression type, wire bytes per byte and compress time per byte
+    double ratio[Stats::CODECS];
+    double usPerByte[Stats::CODECS];
+  };
+
+  // The compression type that gets a byte across the fastest by what choice has measured
+  static uint32_t pickCodec(const CodecChoice& choice);
+
  private:
-  std::shared_ptr<compress::CompressInterface> alg;
+  static const uint32_t SAMPLE_INTERVAL = 64;
+  static const uint32_t MIN_COMPRESS_SIZE = 512;
+
+  // Compresses msg with codec into out, header included; false if it didn't get smaller
+  bool compress(const ByteStream& msg, uint32_t codec, ByteStream& out, double& usPerByte) const;
+
   bool useCompression;
-  static const uint32_t HEADER_SIZE = 4;
+  bool adaptive;
+  std::shared_ptr<CodecChoice> fChoice;
+  static const uint32_t HEADER_SIZE = 5;
 };
 
 }  // namespace messageqcpp
@@ -351,7 +351,8 @@ bool InetStreamSocket::readToMagic(long msecs, bool* isTimeOut, Stats* stats) co
   pfd[0].fd = fSocketParms.sd();
   pfd[0].events = POLLIN;
 
-  while ((fMagicBuffer != BYTESTREAM_MAGIC) && (fMagicBuffer != COMPRESSED_BYTESTREAM_MAGIC))
+  while ((fMagicBuffer != BYTESTREAM_MAGIC) && (fMagicBuffer != COMPRESSED_BYTESTREAM_MAGIC) &&
+         (fMagicBuffer != COMPRESSED_BYTESTREAM_MAGIC_V2))
   {
     if (msecs >= 0)
     {
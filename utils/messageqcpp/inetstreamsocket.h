@@ -48,7 +48,10 @@ class IOSocket;
 
 /// random # marking the beginning of a ByteStream in the stream
 const uint32_t BYTESTREAM_MAGIC = 0x14fbc137;
+/// a compressed ByteStream with only the uncompressed length in its header, which older versions send
 const uint32_t COMPRESSED_BYTESTREAM_MAGIC = 0x14fbc138;
+/// a compressed ByteStream whose header also has the compression type
+const uint32_t COMPRESSED_BYTESTREAM_MAGIC_V2 = 0x14fbc139;
 
 /** An Inet Stream Socket
  *
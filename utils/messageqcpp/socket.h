@@ -41,7 +41,18 @@ class SocketParms;
 class Stats
 {
  public:
-  Stats() : data_sent(0), data_recvd(0)
+  // Messages by the codec CompressedInetStreamSocket picked for them,
+  // indexed by compression type, 0 being sent as is
+  static const uint32_t CODECS = 4;
+
+  struct CodecCount
+  {
+    uint64_t msgs;
+    uint64_t bytes;      // before compression
+    uint64_t wireBytes;  // after
+  };
+
+  Stats() : data_sent(0), data_recvd(0), codec_sent(), codec_recvd()
   {
   }
   virtual ~Stats()
@@ -63,10 +74,35 @@ class Stats
   {
     data_recvd += amt;
   }
+  const CodecCount& codecSent(uint32_t codec) const
+  {
+    return codec_sent[codec];
+  }
+  const CodecCount& codecRecvd(uint32_t codec) const
+  {
+    return codec_recvd[codec];
+  }
+  void codecSent(uint32_t codec, uint64_t msgs, uint64_t bytes, uint64_t wireBytes)
+  {
+    add(codec_sent[codec], msgs, bytes, wireBytes);
+  }
+  void codecRecvd(uint32_t codec, uint64_t msgs, uint64_t bytes, uint64_t wireBytes)
+  {
+    add(codec_recvd[codec], msgs, bytes, wireBytes);
+  }
 
  private:
+  static void add(CodecCount& c, uint64_t msgs, uint64_t bytes, uint64_t wireBytes)
+  {
+    c.msgs += msgs;
+    c.bytes += bytes;
+    c.wireBytes += wireBytes;
+  }
+
   uint64_t data_sent;
   uint64_t data_recvd;
+  CodecCount codec_sent[CODECS];
+  CodecCount codec_recvd[CODECS];
 };
 
 /** an abstract socket class interface
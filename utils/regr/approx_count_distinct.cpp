@@ -0,0 +1,130 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <cstring>
+#include "approx_count_distinct.h"
+#include "hyperloglog.h"
+
+using namespace mcsv1sdk;
+
+class Add_approx_count_distinct_ToUDAFMap
+{
+ public:
+  Add_approx_count_distinct_ToUDAFMap()
+  {
+    UDAFMap::getMap()["approx_count_distinct"] = new approx_count_distinct();
+  }
+};
+
+static Add_approx_count_distinct_ToUDAFMap addToMap;
+
+namespace
+{
+const static_any::any& longDoubleTypeId((long double)1);
+}
+
+// The sketch is the whole of the user data, so the simple data model is used
+mcsv1_UDAF::ReturnCode approx_count_distinct::init(mcsv1Context* context, ColumnDatum* colTypes)
+{
+  if (context->getParameterCount() != 1)
+  {
+    // The error message will be prepended with
+    // "The storage engine for the table doesn't support "
+    context->setErrorMessage("approx_count_distinct() with other than 1 arguments");
+    return mcsv1_UDAF::ERROR;
+  }
+
+  context->setUserDataSize(hll::REGISTERS);
+  context->setResultType(execplan::CalpontSystemCatalog::BIGINT);
+  context->setColWidth(8);
+  context->setRunFlag(mcsv1sdk::UDAF_IGNORE_NULLS);
+  return mcsv1_UDAF::SUCCESS;
+}
+
+mcsv1_UDAF::ReturnCode approx_count_distinct::reset(mcsv1Context* context)
+{
+  memset(context->getUserData()->data, 0, hll::REGISTERS);
+  return mcsv1_UDAF::SUCCESS;
+}
+
+mcsv1_UDAF::ReturnCode approx_count_distinct::nextValue(mcsv1Context* context, ColumnDatum* valsIn)
+{
+  static_any::any& valIn = valsIn[0].columnData;
+
+  if (valIn.empty())
+  {
+    return mcsv1_UDAF::SUCCESS;  // Ought not happen when UDAF_IGNORE_NULLS is on.
+  }
+
+  hll::add(context->getUserData()->data, hash(valIn));
+  return mcsv1_UDAF::SUCCESS;
+}
+
+mcsv1_UDAF::ReturnCode approx_count_distinct::subEvaluate(mcsv1Context* context, const UserData* userDataIn)
+{
+  if (!userDataIn)
+  {
+    return mcsv1_UDAF::SUCCESS;
+  }
+
+  hll::merge(context->getUserData()->data, userDataIn->data);
+  return mcsv1_UDAF::SUCCESS;
+}
+
+mcsv1_UDAF::ReturnCode approx_count_distinct::evaluate(mcsv1Context* context, static_any::any& valOut)
+{
+  valOut = static_cast<long long>(hll::estimate(context->getUserData()->data));
+  return mcsv1_UDAF::SUCCESS;
+}
+
+uint64_t approx_count_distinct::hash(static_any::any& valIn) const
+{
+  if (valIn.compatible(strTypeId))
+  {
+    // Trailing spaces don't make a value distinct
+    const std::string& str = valIn.cast<std::string>();
+    size_t len = str.find_last_not_of(' ');
+    return hll::hash(str.data(), len == std::string::npos ? 0 : len + 1);
+  }
+
+  if (valIn.compatible(int128TypeId))
+  {
+    int128_t val = valIn.cast<int128_t>();
+    return hll::hash(&val, sizeof(val));
+  }
+
+  if (valIn.compatible(longDoubleTypeId))
+  {
+    // For Linux x86_64, long double is stored in 128 bits, but only 80 are significant
+    long double val = valIn.cast<long double>();
+    if (val == 0)
+      val = 0;  // -0.0 is 0.0
+    return hll::hash(&val, sizeof(long double) == 8 ? 8 : 10);
+  }
+
+  if (valIn.compatible(doubleTypeId) || valIn.compatible(floatTypeId))
+  {
+    double val = convertAnyTo<double>(valIn);
+    if (val == 0)
+      val = 0;  // -0.0 is 0.0
+    return hll::hash(&val, sizeof(val));
+  }
+
+  // Every integer type, the temporal types and the narrow decimals
+  uint64_t val = convertAnyTo<uint64_t>(valIn);
+  return hll::hash(&val, sizeof(val));
+}
@@ -0,0 +1,85 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/***********************************************************************
+ *   $Id$
+ *
+ *   approx_count_distinct.h
+ ***********************************************************************/
+
+/**
+ * Columnstore interface for the approx_count_distinct function
+ *
+ *
+ *    CREATE AGGREGATE FUNCTION approx_count_distinct returns INTEGER soname 'libregr_mysql.so';
+ *
+ * approx_count_distinct estimates COUNT(DISTINCT x) with a HyperLogLog
+ * sketch. Each group keeps a fixed 4KB sketch no matter how many distinct
+ * values it has, and the sketches PrimProc builds are merged by ExeMgr,
+ * so unlike COUNT(DISTINCT) the values never have to be collected in
+ * one place. The estimate is usually within a few percent.
+ *
+ * Strings are compared by their bytes with trailing spaces ignored, so
+ * values that are equal only under a case or accent insensitive collation
+ * are counted as different.
+ */
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "mcsv1_udaf.h"
+#include "calpontsystemcatalog.h"
+#include "windowfunctioncolumn.h"
+
+#if defined(_MSC_VER) && defined(xxxRGNODE_DLLEXPORT)
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+namespace mcsv1sdk
+{
+// Return an estimate of the number of distinct values in the dataset
+
+class approx_count_distinct : public mcsv1_UDAF
+{
+ public:
+  // Defaults OK
+  approx_count_distinct() : mcsv1_UDAF(){};
+  virtual ~approx_count_distinct(){};
+
+  virtual ReturnCode init(mcsv1Context* context, ColumnDatum* colTypes);
+
+  virtual ReturnCode reset(mcsv1Context* context);
+
+  virtual ReturnCode nextValue(mcsv1Context* context, ColumnDatum* valsIn);
+
+  virtual ReturnCode subEvaluate(mcsv1Context* context, const UserData* valIn);
+
+  virtual ReturnCode evaluate(mcsv1Context* context, static_any::any& valOut);
+
+  // No dropValue(), a value can't be taken back out of a sketch
+
+ protected:
+  uint64_t hash(static_any::any& valIn) const;
+};
+
+};  // namespace mcsv1sdk
+
+#undef EXPORT
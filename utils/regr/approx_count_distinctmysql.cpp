@@ -0,0 +1,111 @@
+#include <my_config.h>
+#include <cmath>
+#include <string.h>
+
+#include "idb_mysql.h"
+#include "hyperloglog.h"
+
+using namespace mcsv1sdk;
+
+/****************************************************************************
+ * UDF function interface for MariaDB connector to recognize is defined in
+ * this section. MariaDB's UDF function creation guideline needs to be followed.
+ *
+ * See regrmysql.cpp for the details. When the query runs in ColumnStore the
+ * approx_count_distinct class in approx_count_distinct.cpp does the work.
+ */
+extern "C"
+{
+  //=======================================================================
+
+  /**
+   * approx_count_distinct
+   */
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      my_bool approx_count_distinct_init(UDF_INIT* initid, UDF_ARGS* args, char* message)
+  {
+    if (args->arg_count != 1)
+    {
+      strcpy(message, "approx_count_distinct() requires one argument");
+      return 1;
+    }
+
+    if (!(initid->ptr = (char*)calloc(hll::REGISTERS, 1)))
+    {
+      strmov(message, "Couldn't allocate memory");
+      return 1;
+    }
+
+    initid->maybe_null = 0;
+    return 0;
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_count_distinct_deinit(UDF_INIT* initid)
+  {
+    free(initid->ptr);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_count_distinct_clear(UDF_INIT* initid, char* is_null __attribute__((unused)),
+                                       char* message __attribute__((unused)))
+  {
+    memset(initid->ptr, 0, hll::REGISTERS);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_count_distinct_add(UDF_INIT* initid, UDF_ARGS* args, char* is_null,
+                                     char* message __attribute__((unused)))
+  {
+    if (args->args[0] == 0)
+    {
+      return;
+    }
+
+    uint64_t hash;
+
+    switch (args->arg_type[0])
+    {
+      case INT_RESULT: hash = hll::hash(args->args[0], sizeof(long long)); break;
+
+      case REAL_RESULT:
+      {
+        double val = *((double*)args->args[0]);
+        if (val == 0)
+          val = 0;  // -0.0 is 0.0
+        hash = hll::hash(&val, sizeof(val));
+        break;
+      }
+
+      default:
+      {
+        // Trailing spaces don't make a value distinct
+        size_t len = args->lengths[0];
+        while (len > 0 && args->args[0][len - 1] == ' ')
+          len--;
+        hash = hll::hash(args->args[0], len);
+        break;
+      }
+    }
+
+    hll::add((uint8_t*)initid->ptr, hash);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      long long approx_count_distinct(UDF_INIT* initid, UDF_ARGS* args __attribute__((unused)),
+                                      char* is_null __attribute__((unused)),
+                                      char* error __attribute__((unused)))
+  {
+    return hll::estimate((uint8_t*)initid->ptr);
+  }
+}
@@ -0,0 +1,131 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/***********************************************************************
+ *   $Id$
+ *
+ *   approx_percentile.h
+ ***********************************************************************/
+
+/**
+ * Columnstore interface for the approx_percentile and approx_median functions
+ *
+ *
+ *    CREATE AGGREGATE FUNCTION approx_percentile returns REAL soname 'libregr_mysql.so';
+ *    CREATE AGGREGATE FUNCTION approx_median returns REAL soname 'libregr_mysql.so';
+ *
+ * approx_percentile(x, p) estimates PERCENTILE_CONT(p) WITHIN GROUP (ORDER BY x)
+ * as an ordinary aggregate, and approx_median(x) is approx_percentile(x, 0.5).
+ * Each group keeps a t-digest of bounded size instead of its values, and the
+ * digests PrimProc builds are merged by ExeMgr, so nothing has to be sorted.
+ */
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "mcsv1_udaf.h"
+#include "calpontsystemcatalog.h"
+#include "windowfunctioncolumn.h"
+#include "tdigest.h"
+
+#if defined(_MSC_VER) && defined(xxxRGNODE_DLLEXPORT)
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+namespace mcsv1sdk
+{
+// Override UserData for data storage
+struct ApproxPercentileData : public UserData
+{
+  ApproxPercentileData() : fPercentile(0.5){};
+
+  virtual ~ApproxPercentileData(){};
+
+  virtual void serialize(messageqcpp::ByteStream& bs) const;
+  virtual void unserialize(messageqcpp::ByteStream& bs);
+
+  double fPercentile;
+  TDigest fDigest;
+
+ private:
+  // For now, copy construction is unwanted
+  ApproxPercentileData(UserData&);
+};
+
+// Return an estimate of the p-th percentile of the dataset
+
+class approx_percentile : public mcsv1_UDAF
+{
+ public:
+  // Defaults OK
+  approx_percentile() : mcsv1_UDAF(){};
+  virtual ~approx_percentile(){};
+
+  virtual ReturnCode init(mcsv1Context* context, ColumnDatum* colTypes);
+
+  virtual ReturnCode reset(mcsv1Context* context);
+
+  virtual ReturnCode nextValue(mcsv1Context* context, ColumnDatum* valsIn);
+
+  virtual ReturnCode subEvaluate(mcsv1Context* context, const UserData* valIn);
+
+  virtual ReturnCode evaluate(mcsv1Context* context, static_any::any& valOut);
+
+  // No dropValue(), a value can't be taken back out of a digest
+
+  virtual ReturnCode createUserData(UserData*& userData, int32_t& length);
+
+ protected:
+  virtual const char* name() const
+  {
+    return "approx_percentile";
+  }
+
+  virtual size_t parameterCount() const
+  {
+    return 2;
+  }
+};
+
+// approx_percentile(x, 0.5)
+
+class approx_median : public approx_percentile
+{
+ public:
+  // Defaults OK
+  approx_median() : approx_percentile(){};
+  virtual ~approx_median(){};
+
+ protected:
+  virtual const char* name() const
+  {
+    return "approx_median";
+  }
+
+  virtual size_t parameterCount() const
+  {
+    return 1;
+  }
+};
+
+};  // namespace mcsv1sdk
+
+#undef EXPORT
@@ -0,0 +1,220 @@
+#include <my_config.h>
+#include <cmath>
+#include <cstdio>
+#include <new>
+#include <string.h>
+
+#include "idb_mysql.h"
+#include "tdigest.h"
+
+using namespace mcsv1sdk;
+
+namespace
+{
+inline bool isNumeric(int type, const char* attr)
+{
+  if (type == INT_RESULT || type == REAL_RESULT || type == DECIMAL_RESULT)
+  {
+    return true;
+  }
+#if _MSC_VER
+  if (_strnicmp("NULL", attr, 4) == 0))
+#else
+  if (strncasecmp("NULL", attr, 4) == 0)
+#endif
+    {
+      return true;
+    }
+  return false;
+}
+
+inline double cvtArgToDouble(int t, const char* v)
+{
+  double d = 0.0;
+
+  switch (t)
+  {
+    case INT_RESULT: d = (double)(*((long long*)v)); break;
+
+    case REAL_RESULT: d = *((double*)v); break;
+
+    case DECIMAL_RESULT:
+    case STRING_RESULT: d = strtod(v, 0); break;
+
+    case ROW_RESULT: break;
+  }
+
+  return d;
+}
+
+struct approx_percentile_data
+{
+  double percentile;
+  TDigest digest;
+};
+
+my_bool approx_percentile_init_impl(UDF_INIT* initid, UDF_ARGS* args, char* message, const char* name,
+                                    uint paramCount)
+{
+  if (args->arg_count != paramCount)
+  {
+    sprintf(message, "%s() requires %s", name, paramCount == 1 ? "one argument" : "two arguments");
+    return 1;
+  }
+
+  for (uint i = 0; i < paramCount; i++)
+  {
+    if (!(isNumeric(args->arg_type[i], args->attributes[i])))
+    {
+      sprintf(message, "%s() with non-numeric arguments", name);
+      return 1;
+    }
+  }
+
+  approx_percentile_data* data = new (std::nothrow) approx_percentile_data;
+  if (!data)
+  {
+    strmov(message, "Couldn't allocate memory");
+    return 1;
+  }
+  data->percentile = 0.5;
+
+  initid->decimals = DECIMAL_NOT_SPECIFIED;
+  initid->ptr = (char*)data;
+  return 0;
+}
+}  // namespace
+
+/****************************************************************************
+ * UDF function interface for MariaDB connector to recognize is defined in
+ * this section. MariaDB's UDF function creation guideline needs to be followed.
+ *
+ * See regrmysql.cpp for the details. When the query runs in ColumnStore the
+ * approx_percentile classes in approx_percentile.cpp do the work.
+ */
+extern "C"
+{
+  //=======================================================================
+
+  /**
+   * approx_percentile
+   */
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      my_bool approx_percentile_init(UDF_INIT* initid, UDF_ARGS* args, char* message)
+  {
+    return approx_percentile_init_impl(initid, args, message, "approx_percentile", 2);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_percentile_deinit(UDF_INIT* initid)
+  {
+    delete (approx_percentile_data*)initid->ptr;
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_percentile_clear(UDF_INIT* initid, char* is_null __attribute__((unused)),
+                                   char* message __attribute__((unused)))
+  {
+    approx_percentile_data* data = (approx_percentile_data*)initid->ptr;
+    data->percentile = 0.5;
+    data->digest.clear();
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_percentile_add(UDF_INIT* initid, UDF_ARGS* args, char* is_null __attribute__((unused)),
+                                 char* error)
+  {
+    // Test for NULL in x and p
+    if (args->args[0] == 0 || (args->arg_count > 1 && args->args[1] == 0))
+    {
+      return;
+    }
+
+    approx_percentile_data* data = (approx_percentile_data*)initid->ptr;
+
+    if (args->arg_count > 1)
+    {
+      double percentile = cvtArgToDouble(args->arg_type[1], args->args[1]);
+
+      if (percentile < 0 || percentile > 1)
+      {
+        *error = 1;
+        return;
+      }
+
+      data->percentile = percentile;
+    }
+
+    data->digest.add(cvtArgToDouble(args->arg_type[0], args->args[0]));
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      double approx_percentile(UDF_INIT* initid, UDF_ARGS* args __attribute__((unused)), char* is_null,
+                               char* error __attribute__((unused)))
+  {
+    approx_percentile_data* data = (approx_percentile_data*)initid->ptr;
+
+    if (data->digest.count() == 0)
+    {
+      *is_null = 1;
+      return 0;
+    }
+
+    return data->digest.quantile(data->percentile);
+  }
+
+  //=======================================================================
+
+  /**
+   * approx_median
+   */
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      my_bool approx_median_init(UDF_INIT* initid, UDF_ARGS* args, char* message)
+  {
+    return approx_percentile_init_impl(initid, args, message, "approx_median", 1);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_median_deinit(UDF_INIT* initid)
+  {
+    approx_percentile_deinit(initid);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_median_clear(UDF_INIT* initid, char* is_null, char* message)
+  {
+    approx_percentile_clear(initid, is_null, message);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      void approx_median_add(UDF_INIT* initid, UDF_ARGS* args, char* is_null, char* error)
+  {
+    approx_percentile_add(initid, args, is_null, error);
+  }
+
+#ifdef _MSC_VER
+  __declspec(dllexport)
+#endif
+      double approx_median(UDF_INIT* initid, UDF_ARGS* args, char* is_null, char* error)
+  {
+    return approx_percentile(initid, args, is_null, error);
+  }
+}
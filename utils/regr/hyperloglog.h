@@ -0,0 +1,109 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/**
+ * A HyperLogLog sketch for approx_count_distinct().
+ *
+ * The sketch is a plain array of REGISTERS bytes, so it fits in fixed size
+ * UDAF user data and is streamed between PrimProc and ExeMgr as is. Two
+ * sketches are merged by keeping the larger of each pair of registers, which
+ * gives the same sketch as adding both inputs to one.
+ *
+ * approx_count_distinctmysql.cpp fills the same registers when the server
+ * runs the query itself, so only the standard library is included here.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace mcsv1sdk
+{
+namespace hll
+{
+// 2^12 registers, for a standard error of about 1.6%
+const uint32_t PRECISION = 12;
+const uint32_t REGISTERS = 1 << PRECISION;
+
+inline uint64_t hash(const void* data, size_t len)
+{
+  // FNV-1a followed by the murmur3 finalizer, which spreads every input bit over the
+  // high bits the register index comes from
+  const uint8_t* p = (const uint8_t*)data;
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    h ^= p[i];
+    h *= 0x100000001b3ULL;
+  }
+
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline void add(uint8_t* registers, uint64_t hash)
+{
+  uint32_t index = hash >> (64 - PRECISION);
+  // the rank is the position of the first set bit after the index bits, the
+  // extra bit caps it when all of them are zero
+  uint64_t rest = (hash << PRECISION) | (1ULL << (PRECISION - 1));
+  uint8_t rank = __builtin_clzll(rest) + 1;
+
+  if (rank > registers[index])
+    registers[index] = rank;
+}
+
+inline void merge(uint8_t* registers, const uint8_t* other)
+{
+  for (uint32_t i = 0; i < REGISTERS; i++)
+  {
+    if (other[i] > registers[i])
+      registers[i] = other[i];
+  }
+}
+
+inline uint64_t estimate(const uint8_t* registers)
+{
+  const double m = REGISTERS;
+  double sum = 0.0;
+  uint32_t zeros = 0;
+
+  for (uint32_t i = 0; i < REGISTERS; i++)
+  {
+    sum += std::ldexp(1.0, -registers[i]);
+
+    if (registers[i] == 0)
+      zeros++;
+  }
+
+  double e = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+
+  // Small counts are estimated better from the number of registers that are still empty
+  if (e <= 2.5 * m && zeros > 0)
+    e = m * std::log(m / zeros);
+
+  return (uint64_t)(e + 0.5);
+}
+
+}  // namespace hll
+}  // namespace mcsv1sdk
@@ -0,0 +1,173 @@
+/* Copyright (C) 2026 MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/**
+ * A merging t-digest for approx_percentile() and approx_median().
+ *
+ * The digest summarizes a dataset as a sorted list of centroids, each the
+ * mean and count of a run of neighbouring values. Centroids near the ends of
+ * the distribution are kept small and the ones in the middle are allowed to
+ * grow, so the tails stay accurate while the whole digest stays under a
+ * thousand centroids however many values are added. Digests are merged by
+ * compressing their centroids together.
+ *
+ * New values and merged centroids are appended unsorted and folded in once
+ * enough of them pile up. A small dataset keeps a centroid per value, and
+ * its quantiles are exact, interpolated between neighbouring values the way
+ * PERCENTILE_CONT does.
+ *
+ * approx_percentilemysql.cpp keeps a TDigest behind initid->ptr for queries
+ * the server runs itself, which is why it is a header of plain C++ only.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace mcsv1sdk
+{
+class TDigest
+{
+ public:
+  struct Centroid
+  {
+    double mean;
+    double weight;
+
+    bool operator<(const Centroid& rhs) const
+    {
+      return mean < rhs.mean;
+    }
+  };
+
+  // Higher compression keeps more centroids and gives more accurate quantiles
+  static constexpr double COMPRESSION = 100.0;
+  // How many unsorted centroids may pile up before they are compressed
+  static constexpr size_t BUFFER_SIZE = 500;
+
+  TDigest() : fSorted(0), fCount(0)
+  {
+  }
+
+  void clear()
+  {
+    fCentroids.clear();
+    fSorted = 0;
+    fCount = 0;
+  }
+
+  double count() const
+  {
+    return fCount;
+  }
+
+  void add(double value, double weight = 1.0)
+  {
+    fCentroids.push_back({value, weight});
+    fCount += weight;
+
+    if (fCentroids.size() - fSorted > BUFFER_SIZE)
+      compress();
+  }
+
+  void merge(const TDigest& other)
+  {
+    for (const Centroid& c : other.fCentroids)
+      add(c.mean, c.weight);
+  }
+
+  const std::vector<Centroid>& centroids() const
+  {
+    return fCentroids;
+  }
+
+  // Estimate the value at quantile q, 0 <= q <= 1. The digest must not be empty.
+  double quantile(double q)
+  {
+    compress();
+
+    const size_t n = fCentroids.size();
+    // The position of the value we want, and of the middle of the first centroid,
+    // if the values were numbered 0 .. count - 1
+    double pos = q * (fCount - 1);
+    double prevPos = (fCentroids[0].weight - 1) / 2;
+    double prevMean = fCentroids[0].mean;
+
+    if (pos <= prevPos || n == 1)
+      return prevMean;
+
+    for (size_t i = 1; i < n; i++)
+    {
+      double curPos = prevPos + (fCentroids[i - 1].weight + fCentroids[i].weight) / 2;
+
+      if (pos <= curPos)
+        return prevMean + (fCentroids[i].mean - prevMean) * (pos - prevPos) / (curPos - prevPos);
+
+      prevPos = curPos;
+      prevMean = fCentroids[i].mean;
+    }
+
+    return prevMean;
+  }
+
+  // Sort everything and combine neighbouring centroids as far as the size limit allows.
+  void compress()
+  {
+    if (fSorted == fCentroids.size())
+      return;
+
+    std::sort(fCentroids.begin(), fCentroids.end());
+
+    std::vector<Centroid> out;
+    Centroid cur = fCentroids[0];
+    double before = 0;  // weight of the centroids already in out
+
+    for (size_t i = 1; i < fCentroids.size(); i++)
+    {
+      const Centroid& next = fCentroids[i];
+      double proposed = cur.weight + next.weight;
+      double q0 = before / fCount;
+      double q2 = (before + proposed) / fCount;
+      // a centroid at quantile q may hold up to 4 * count * q * (1 - q) / COMPRESSION values
+      double limit = 4 * fCount * std::min(q0 * (1 - q0), q2 * (1 - q2)) / COMPRESSION;
+
+      if (proposed <= limit)
+      {
+        cur.mean += (next.mean - cur.mean) * next.weight / proposed;
+        cur.weight = proposed;
+      }
+      else
+      {
+        before += cur.weight;
+        out.push_back(cur);
+        cur = next;
+      }
+    }
+
+    out.push_back(cur);
+    fCentroids.swap(out);
+    fSorted = fCentroids.size();
+  }
+
+ private:
+  std::vector<Centroid> fCentroids;  // the first fSorted are sorted and compressed
+  size_t fSorted;
+  double fCount;
+};
+
+}  // namespace mcsv1sdk
@@ -2472,7 +2472,7 @@ void RowAggregationUM::attachGroupConcatAg()
       if (fFunctionColGc[i]->fAggFunction == ROWAGG_GROUP_CONCAT)
       {
         // save the object's address in the result row
-        SP_GroupConcatAg gcc(new joblist::GroupConcatAgUM(fGroupConcat[j++]));
+        SP_GroupConcatAg gcc(new joblist::GroupConcatAgUM(fGroupConcat[j++], &fGroupConcatAg));
         fGroupConcatAg.push_back(gcc);
         *((GroupConcatAg**)(data + fRow.getOffset(colOut))) = gcc.get();
       }
@@ -363,6 +363,12 @@ class GroupConcatAg
     return nullptr;
   }
 
+  // writes the rows held in memory to disk, false if there were none to write
+  virtual bool spill()
+  {
+    return false;
+  }
+
  protected:
   rowgroup::SP_GroupConcat fGroupConcat;
 };
@@ -39,7 +39,7 @@ namespace threadpool
 {
 PriorityThreadPool::PriorityThreadPool(uint targetWeightPerRun, uint highThreads, uint midThreads,
                                        uint lowThreads, uint ID)
- : _stop(false), weightPerRun(targetWeightPerRun), id(ID)
+ : waitingJobs(0), _stop(false), weightPerRun(targetWeightPerRun), id(ID)
 {
   boost::thread* newThread;
   for (uint32_t i = 0; i < highThreads; i++)
@@ -105,6 +105,8 @@ void PriorityThreadPool::addJob(const Job& job, bool useLock)
   else
     jobQueues[LOW].push_back(job);
 
+  waitingJobs++;
+
   if (useLock)
     newJob.notify_one();
 }
@@ -118,7 +120,10 @@ void PriorityThreadPool::removeJobs(uint32_t id)
   for (uint32_t i = 0; i < _COUNT; i++)
     for (it = jobQueues[i].begin(); it != jobQueues[i].end();)
       if (it->id == id)
+      {
         it = jobQueues[i].erase(it);
+        waitingJobs--;
+      }
       else
         ++it;
 }
@@ -175,6 +180,7 @@ void PriorityThreadPool::threadFcn(const Priority preferredQueue) throw()
         weight += runList.back().weight;
       }
 
+      waitingJobs -= runList.size();
       lk.unlock();
 
       reschedule.resize(runList.size());
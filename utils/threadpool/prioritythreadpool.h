@@ -29,6 +29,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <stdexcept>
+#include <atomic>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
@@ -91,6 +92,18 @@ class PriorityThreadPool
   void addJob(const Job& job, bool useLock = true);
   void stop();
 
+  /** @brief the number of jobs waiting for a thread
+   */
+  inline uint32_t getWaiting() const
+  {
+    return waitingJobs;
+  }
+
+  inline uint32_t getThreadCount() const
+  {
+    return defaultThreadCounts[HIGH] + defaultThreadCounts[MEDIUM] + defaultThreadCounts[LOW];
+  }
+
   /** @brief for use in debugging
    */
   void dump();
@@ -119,6 +132,7 @@ class PriorityThreadPool
   void sendErrorMsg(uint32_t id, uint32_t step, primitiveprocessor::SP_UM_IOSOCK sock);
 
   std::list<Job> jobQueues[3];  // higher indexes = higher priority
+  std::atomic<uint32_t> waitingJobs;
   uint32_t threadCounts[3];
   uint32_t defaultThreadCounts[3];
   boost::mutex mutex;
@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <stack>
 using namespace std;
@@ -635,7 +636,9 @@ void CompareRule::compileRules(const std::vector<IdbSortSpec>& spec, const rowgr
       case CalpontSystemCatalog::VARCHAR:
       case CalpontSystemCatalog::TEXT:
       {
-        Compare* c = new StringCompare(*i);
+        StringCompare* c = new StringCompare(*i);
+        // set here rather than on first use, OrderByData::sort() shares the rules across threads
+        c->cs = &datatypes::Charset(rg.getCharsetNumber(i->fIndex)).getCharset();
         fCompares.push_back(c);
         break;
       }
@@ -691,6 +694,260 @@ void CompareRule::compileRules(const std::vector<IdbSortSpec>& spec, const rowgr
   }
 }
 
+void SortKey::compile(const std::vector<IdbSortSpec>& spec, const rowgroup::RowGroup& rg)
+{
+  const vector<CalpontSystemCatalog::ColDataType>& types = rg.getColTypes();
+  uint32_t bytes = 0;
+
+  fParts.clear();
+
+  // Stop at the first column that can't be encoded or doesn't fit, the columns after it
+  // only matter for rows that tie on it.
+  for (vector<IdbSortSpec>::const_iterator i = spec.begin(); i != spec.end() && bytes < sizeof(uint64_t); i++)
+  {
+    Part p;
+    p.fIndex = i->fIndex;
+    p.fDesc = (i->fAsc < 0);
+    p.fNullsFirst = (i->fNf > 0);
+    p.fNull = 0;
+    p.fCs = NULL;
+
+    switch (types[i->fIndex])
+    {
+      case CalpontSystemCatalog::TINYINT:
+        p.fKind = SIGNED;
+        p.fWidth = 1;
+        p.fNull = joblist::TINYINTNULL;
+        break;
+
+      case CalpontSystemCatalog::SMALLINT:
+        p.fKind = SIGNED;
+        p.fWidth = 2;
+        p.fNull = joblist::SMALLINTNULL;
+        break;
+
+      case CalpontSystemCatalog::MEDINT:
+      case CalpontSystemCatalog::INT:
+        p.fKind = SIGNED;
+        p.fWidth = 4;
+        p.fNull = joblist::INTNULL;
+        break;
+
+      case CalpontSystemCatalog::BIGINT:
+        p.fKind = SIGNED;
+        p.fWidth = 8;
+        p.fNull = joblist::BIGINTNULL;
+        break;
+
+      case CalpontSystemCatalog::DECIMAL:
+      case CalpontSystemCatalog::UDECIMAL:
+        p.fKind = SIGNED;
+        p.fWidth = rg.getColumnWidth(i->fIndex);
+
+        switch (p.fWidth)
+        {
+          case datatypes::MAXDECIMALWIDTH: p.fKind = WIDE_DECIMAL; break;
+          case datatypes::MAXLEGACYWIDTH: p.fNull = joblist::BIGINTNULL; break;
+          case 1: p.fNull = joblist::TINYINTNULL; break;
+          case 2: p.fNull = joblist::SMALLINTNULL; break;
+          case 4: p.fNull = joblist::INTNULL; break;
+          default: return;
+        }
+
+        break;
+
+      case CalpontSystemCatalog::UTINYINT:
+        p.fKind = UNSIGNED;
+        p.fWidth = 1;
+        p.fNull = joblist::UTINYINTNULL;
+        break;
+
+      case CalpontSystemCatalog::USMALLINT:
+        p.fKind = UNSIGNED;
+        p.fWidth = 2;
+        p.fNull = joblist::USMALLINTNULL;
+        break;
+
+      case CalpontSystemCatalog::UMEDINT:
+      case CalpontSystemCatalog::UINT:
+        p.fKind = UNSIGNED;
+        p.fWidth = 4;
+        p.fNull = joblist::UINTNULL;
+        break;
+
+      case CalpontSystemCatalog::UBIGINT:
+        p.fKind = UNSIGNED;
+        p.fWidth = 8;
+        p.fNull = joblist::UBIGINTNULL;
+        break;
+
+      case CalpontSystemCatalog::DATE:
+        p.fKind = UNSIGNED;
+        p.fWidth = 4;
+        p.fNull = joblist::DATENULL;
+        break;
+
+      case CalpontSystemCatalog::DATETIME:
+      case CalpontSystemCatalog::TIMESTAMP:
+        p.fKind = UNSIGNED;
+        p.fWidth = 8;
+        p.fNull = joblist::DATETIMENULL;
+        break;
+
+      case CalpontSystemCatalog::FLOAT:
+      case CalpontSystemCatalog::UFLOAT:
+        p.fKind = FLOAT;
+        p.fWidth = 4;
+        break;
+
+      case CalpontSystemCatalog::DOUBLE:
+      case CalpontSystemCatalog::UDOUBLE:
+        p.fKind = DOUBLE;
+        p.fWidth = 8;
+        break;
+
+      case CalpontSystemCatalog::CHAR:
+      case CalpontSystemCatalog::VARCHAR:
+      case CalpontSystemCatalog::TEXT:
+      {
+        // a prefix of the weights orders like strnncollsp() only for collations that
+        // map characters to weights one to one and pad with spaces
+        datatypes::Charset cs(rg.getCharsetNumber(i->fIndex));
+
+        if (!cs.strnxfrmIsValid() || (cs.getCharset().state & MY_CS_NOPAD))
+          return;
+
+        p.fKind = STRING;
+        p.fWidth = sizeof(uint64_t);
+        p.fCs = &cs.getCharset();
+        break;
+      }
+
+      default:
+        // TIME and LONG DOUBLE don't order by their bytes
+        return;
+    }
+
+    fParts.push_back(p);
+    bytes += 1 + p.fWidth;
+
+    // a string key is a truncated prefix, so rows with equal bytes may still differ
+    if (p.fKind == STRING)
+      break;
+  }
+}
+
+uint64_t SortKey::operator()(const rowgroup::Row& row) const
+{
+  uint8_t key[sizeof(uint64_t)] = {0};
+  uint32_t pos = 0;
+
+  for (const Part& p : fParts)
+  {
+    uint8_t value[sizeof(int128_t)];
+    bool isNull = false;
+
+    switch (p.fKind)
+    {
+      case SIGNED:
+      case UNSIGNED:
+      {
+        uint64_t mask = (p.fWidth == 8) ? ~0ULL : ((1ULL << (p.fWidth * 8)) - 1);
+        uint64_t v = row.getUintField(p.fIndex) & mask;
+        isNull = (v == (p.fNull & mask));
+
+        // flipping the sign bit makes signed values order as unsigned
+        if (p.fKind == SIGNED)
+          v ^= 1ULL << (p.fWidth * 8 - 1);
+
+        for (uint32_t b = 0; b < p.fWidth; b++)
+          value[b] = v >> ((p.fWidth - 1 - b) * 8);
+
+        break;
+      }
+
+      case FLOAT:
+      {
+        isNull = (static_cast<int32_t>(row.getIntField(p.fIndex)) == static_cast<int32_t>(joblist::FLOATNULL));
+        float f = row.getFloatField(p.fIndex);
+        uint32_t v;
+
+        if (f == 0)
+          f = 0;  // -0 == 0
+
+        memcpy(&v, &f, sizeof(v));
+        v = (v & 0x80000000U) ? ~v : (v | 0x80000000U);
+
+        for (uint32_t b = 0; b < 4; b++)
+          value[b] = v >> ((3 - b) * 8);
+
+        break;
+      }
+
+      case DOUBLE:
+      {
+        isNull = (row.getUintField(p.fIndex) == joblist::DOUBLENULL);
+        double d = row.getDoubleField(p.fIndex);
+        uint64_t v;
+
+        if (d == 0)
+          d = 0;  // -0 == 0
+
+        memcpy(&v, &d, sizeof(v));
+        v = (v & (1ULL << 63)) ? ~v : (v | (1ULL << 63));
+
+        for (uint32_t b = 0; b < 8; b++)
+          value[b] = v >> ((7 - b) * 8);
+
+        break;
+      }
+
+      case WIDE_DECIMAL:
+      {
+        int128_t d;
+        row.getInt128Field(p.fIndex, d);
+        isNull = (d == datatypes::Decimal128Null);
+        uint128_t v = static_cast<uint128_t>(d) ^ (static_cast<uint128_t>(1) << 127);
+
+        for (uint32_t b = 0; b < 16; b++)
+          value[b] = v >> ((15 - b) * 8);
+
+        break;
+      }
+
+      case STRING:
+      {
+        isNull = row.isNullValue(p.fIndex);
+
+        if (!isNull)
+        {
+          utils::ConstString str = row.getConstString(p.fIndex);
+          p.fCs->strnxfrm((char*)value, p.fWidth, p.fWidth, str.str(), str.length(),
+                          MY_STRXFRM_PAD_WITH_SPACE | MY_STRXFRM_PAD_TO_MAXLEN);
+        }
+
+        break;
+      }
+    }
+
+    // NULLs are equal to each other and ordered before or after every value
+    key[pos++] = (isNull != p.fNullsFirst) ? 1 : 0;
+
+    for (uint32_t b = 0; b < p.fWidth && pos < sizeof(key); b++)
+      key[pos++] = isNull ? 0 : (p.fDesc ? ~value[b] : value[b]);
+
+    if (pos == sizeof(key))
+      break;
+  }
+
+  uint64_t ret = 0;
+
+  for (uint32_t b = 0; b < sizeof(key); b++)
+    ret = (ret << 8) | key[b];
+
+  return ret;
+}
+
 void IdbCompare::initialize(const RowGroup& rg)
 {
   fRowGroup = rg;
@@ -711,6 +968,7 @@ OrderByData::OrderByData(const std::vector<IdbSortSpec>& spec, const rowgroup::R
   IdbCompare::initialize(rg);
   fRule.compileRules(spec, rg);
   fRule.fIdbCompare = this;
+  fSortKey.compile(spec, rg);
 }
 
 // OrderByData class dtor
@@ -732,7 +990,12 @@ OrderByData::~OrderByData()
 
 // IdbOrderBy class implementation
 IdbOrderBy::IdbOrderBy()
- : fDistinct(false), fMemSize(0), fRowsPerRG(rowgroup::rgCommonSize), fErrorCode(0), fRm(NULL)
+ : fDistinct(false)
+ , fDistinctMapPoolSize(utils::STLPoolAllocator<rowgroup::Row::Pointer>::DEFAULT_SIZE)
+ , fMemSize(0)
+ , fRowsPerRG(rowgroup::rgCommonSize)
+ , fErrorCode(0)
+ , fRm(NULL)
 {
 }
 
@@ -776,7 +1039,8 @@ void IdbOrderBy::initialize(const RowGroup& rg)
 
   if (fDistinct)
   {
-    fDistinctMap.reset(new DistinctMap_t(10, Hasher(this, getKeyLength()), Eq(this, getKeyLength())));
+    fDistinctMap.reset(new DistinctMap_t(10, Hasher(this, getKeyLength()), Eq(this, getKeyLength()),
+                                         utils::STLPoolAllocator<rowgroup::Row::Pointer>(fDistinctMapPoolSize)));
   }
 }
 
@@ -22,10 +22,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <queue>
 #include <utility>
 #include <vector>
 #include <sstream>
+#include <thread>
 #include <boost/shared_array.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -381,6 +385,52 @@ class EqualCompData : public IdbCompare
   std::vector<uint64_t> fIndex;
 };
 
+// Normalized sort key.
+// The leading sort columns of a row are packed big-endian into 64 bits, each as a
+// NULL-ordering byte followed by the value bytes (inverted for DESC), so that two
+// keys that differ compare the same way as CompareRule::less() does on the rows.
+// Equal keys only mean that the rows tie on the prefix that fits into the key.
+class SortKey
+{
+ public:
+  void compile(const std::vector<IdbSortSpec>&, const rowgroup::RowGroup&);
+  uint64_t operator()(const rowgroup::Row&) const;
+
+ private:
+  enum Kind
+  {
+    SIGNED,
+    UNSIGNED,
+    FLOAT,
+    DOUBLE,
+    WIDE_DECIMAL,
+    STRING
+  };
+
+  struct Part
+  {
+    uint32_t fIndex;
+    Kind fKind;
+    uint32_t fWidth;  // value bytes
+    uint64_t fNull;   // NULL marker of the integer kinds
+    bool fDesc;
+    bool fNullsFirst;
+    CHARSET_INFO* fCs;
+  };
+
+  std::vector<Part> fParts;
+};
+
+// A row to be sorted by OrderByData::sort(), T is whatever the caller needs to find
+// the row again.
+template <typename T>
+struct KeyedRow
+{
+  uint64_t fKey;
+  rowgroup::Row::Pointer fData;
+  T fPayload;
+};
+
 class OrderByData : public IdbCompare
 {
  public:
@@ -396,10 +446,116 @@ class OrderByData : public IdbCompare
     return fRule;
   }
 
+  uint64_t sortKey(rowgroup::Row::Pointer p)
+  {
+    fRow1.setData(p);
+    return fSortKey(fRow1);
+  }
+
+  // Sorts rows by fKey, falling back to the rules only on key ties.  The rows are sorted in
+  // runs of up to runRows on several threads and then merged pairwise, so that a cancel is
+  // noticed between them; returns early if cancelled() becomes true.
+  template <typename T>
+  void sort(std::vector<KeyedRow<T> >& rows, const std::function<bool()>& cancelled,
+            size_t runRows = MAX_ROWS_PER_SORT_RUN);
+
  protected:
+  class KeyedRowLess
+  {
+   public:
+    KeyedRowLess(const CompareRule& rule, const rowgroup::RowGroup& rg) : fRule(rule)
+    {
+      fCompare.initialize(rg);
+      fRule.fIdbCompare = &fCompare;
+    }
+    template <typename T>
+    bool operator()(const KeyedRow<T>& a, const KeyedRow<T>& b)
+    {
+      if (a.fKey != b.fKey)
+        return a.fKey < b.fKey;
+
+      return fRule.less(a.fData, b.fData);
+    }
+
+   private:
+    IdbCompare fCompare;
+    CompareRule fRule;
+  };
+
+  static const size_t MAX_ROWS_PER_SORT_RUN = 1 << 20;
+  static const size_t MIN_ROWS_PER_SORT_THREAD = 1 << 16;
+
   CompareRule fRule;
+  SortKey fSortKey;
 };
 
+template <typename T>
+void OrderByData::sort(std::vector<KeyedRow<T> >& rows, const std::function<bool()>& cancelled,
+                       size_t runRows)
+{
+  const size_t n = rows.size();
+
+  if (n < 2)
+    return;
+
+  size_t threads = std::max(1U, std::thread::hardware_concurrency());
+  threads = std::min(threads, std::max<size_t>(1, n / MIN_ROWS_PER_SORT_THREAD));
+  size_t runs = std::max(threads, (n + runRows - 1) / runRows);
+
+  std::vector<size_t> bounds;
+
+  for (size_t i = 0; i <= runs; i++)
+    bounds.push_back(n * i / runs);
+
+  // Runs task(less, 0 .. tasks - 1) on up to threads threads.
+  auto runTasks = [&](size_t tasks, const std::function<void(KeyedRowLess&, size_t)>& task)
+  {
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+      KeyedRowLess less(fRule, fRowGroup);
+      size_t t;
+
+      while ((t = next++) < tasks && !cancelled())
+        task(less, t);
+    };
+
+    std::vector<std::thread> pool;
+
+    for (size_t i = 1; i < std::min(threads, tasks); i++)
+      pool.emplace_back(worker);
+
+    worker();
+
+    for (auto& t : pool)
+      t.join();
+  };
+
+  runTasks(runs,
+           [&](KeyedRowLess& less, size_t t)
+           { std::sort(rows.begin() + bounds[t], rows.begin() + bounds[t + 1], std::ref(less)); });
+
+  while (bounds.size() > 2 && !cancelled())
+  {
+    runTasks((bounds.size() - 1) / 2,
+             [&](KeyedRowLess& less, size_t t)
+             {
+               std::inplace_merge(rows.begin() + bounds[2 * t], rows.begin() + bounds[2 * t + 1],
+                                  rows.begin() + bounds[2 * t + 2], std::ref(less));
+             });
+
+    std::vector<size_t> merged;
+
+    for (size_t i = 0; i < bounds.size(); i += 2)
+      merged.push_back(bounds[i]);
+
+    if (merged.back() != n)
+      merged.push_back(n);
+
+    bounds.swap(merged);
+  }
+}
+
 // base classs for order by clause used in IDB
 class IdbOrderBy : public IdbCompare
 {
@@ -468,6 +624,7 @@ class IdbOrderBy : public IdbCompare
   rowgroup::Row row1, row2;  // scratch space for Hasher & Eq
 
   bool fDistinct;
+  uint64_t fDistinctMapPoolSize;  // window of the distinct map's pool allocator
   uint64_t fMemSize;
   uint64_t fRowsPerRG;
   uint64_t fErrorCode;
@@ -105,6 +105,51 @@ void WF_count<T>::resetData()
   WindowFunctionType::resetData();
 }
 
+template <typename T>
+bool WF_count<T>::dropValues(int64_t b, int64_t e)
+{
+  // DISTINCT would need to count each value, those frames are recalculated instead
+  if (fFunctionId == WF__COUNT_DISTINCT)
+    return false;
+
+  int64_t colIn = (fFunctionId == WF__COUNT_ASTERISK) ? 0 : fFieldIndex[1];
+
+  if (colIn == -1)
+  {
+    ConstantColumn* cc = static_cast<ConstantColumn*>(fConstantParms[0].get());
+
+    if (cc)
+    {
+      bool isNull = false;
+      cc->getIntVal(fRow, isNull);
+
+      if (!isNull)
+        fCount -= e - b;
+    }
+  }
+  else if (fFunctionId == WF__COUNT_ASTERISK)
+  {
+    fCount -= e - b;
+  }
+  else
+  {
+    for (int64_t i = b; i < e; i++)
+    {
+      if (i % 1000 == 0 && fStep->cancelled())
+        break;
+
+      fRow.setData(getPointer(fRowData->at(i)));
+
+      if (fRow.isNullValue(colIn) == false)
+        fCount--;
+    }
+  }
+
+  // operator() adds the rows entering the frame, skip the unbounded - current row handling
+  fPrev = -1;
+  return true;
+}
+
 template <typename T>
 void WF_count<T>::operator()(int64_t b, int64_t e, int64_t c)
 {
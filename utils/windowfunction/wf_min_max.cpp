@@ -138,6 +138,7 @@ template <typename T>
 void WF_min_max<T>::resetData()
 {
   fCount = 0;
+  fWindow.clear();
 
   WindowFunctionType::resetData();
 }
@@ -166,6 +167,19 @@ void WF_min_max<T>::operator()(int64_t b, int64_t e, int64_t c)
     T valIn;
     getValue(colIn, valIn);
 
+    if (fSlidingFrame)
+    {
+      // a value that is not better than the new one can never be the result again
+      while (!fWindow.empty() && ((fFunctionId == WF__MIN && !(fWindow.back().second < valIn)) ||
+                                  (fFunctionId == WF__MAX && !(fWindow.back().second > valIn))))
+        fWindow.pop_back();
+
+      fWindow.push_back(make_pair(i, valIn));
+      fValue = fWindow.front().second;
+      fCount = fWindow.size();
+      continue;
+    }
+
     if ((fCount == 0) || (valIn < fValue && fFunctionId == WF__MIN) ||
         (valIn > fValue && fFunctionId == WF__MAX))
     {
@@ -181,6 +195,27 @@ void WF_min_max<T>::operator()(int64_t b, int64_t e, int64_t c)
   fPrev = c;
 }
 
+template <typename T>
+bool WF_min_max<T>::dropValues(int64_t b, int64_t e)
+{
+  // without the deque the remaining values are unknown
+  if (!fSlidingFrame)
+    return false;
+
+  while (!fWindow.empty() && fWindow.front().first < e)
+    fWindow.pop_front();
+
+  // only the rows in the deque matter from here on
+  fCount = fWindow.size();
+
+  if (fCount > 0)
+    fValue = fWindow.front().second;
+
+  // operator() adds the rows entering the frame, skip the unbounded - current row handling
+  fPrev = -1;
+  return true;
+}
+
 template boost::shared_ptr<WindowFunctionType> WF_min_max<int64_t>::makeFunction(int, const string&, int,
                                                                                  WindowFunctionColumn*);
 
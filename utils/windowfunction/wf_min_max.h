@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include <deque>
+#include <utility>
+
 #include "windowfunctiontype.h"
 
 namespace windowfunction
@@ -36,12 +39,17 @@ class WF_min_max : public WindowFunctionType
   void operator()(int64_t b, int64_t e, int64_t c);
   WindowFunctionType* clone() const;
   void resetData();
+  bool dropValues(int64_t, int64_t);
 
   static boost::shared_ptr<WindowFunctionType> makeFunction(int, const string&, int, WindowFunctionColumn*);
 
  protected:
   T fValue;
   uint64_t fCount;
+
+  // for moving frames: (row, value) of the rows that can still become the min/max,
+  // the front holds the current result
+  std::deque<std::pair<int64_t, T> > fWindow;
 };
 
 }  // namespace windowfunction
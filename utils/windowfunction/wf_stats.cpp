@@ -23,6 +23,7 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <type_traits>
 using namespace std;
 
 #include <boost/shared_ptr.hpp>
@@ -139,18 +140,45 @@ WindowFunctionType* WF_stats<T>::clone() const
 template <typename T>
 void WF_stats<T>::resetData()
 {
-  fSum1 = 0;
-  fSum2 = 0;
-  fCount = 0;
+  fVar.reset();
   fStats = 0.0;
 
   WindowFunctionType::resetData();
 }
 
+template <typename T>
+bool WF_stats<T>::dropValues(int64_t b, int64_t e)
+{
+  // removing floating point values loses too much precision, those frames are recalculated instead,
+  // and so is a frame once dropping values could have rounded away more than the frame has
+  if (std::is_floating_point<T>::value || fVar.reanchor(e - b))
+    return false;
+
+  uint64_t colIn = fFieldIndex[1];
+
+  for (int64_t i = b; i < e; i++)
+  {
+    if (i % 1000 == 0 && fStep->cancelled())
+      break;
+
+    fRow.setData(getPointer(fRowData->at(i)));
+
+    if (fRow.isNullValue(colIn) == true)
+      continue;
+
+    T valIn;
+    getValue(colIn, valIn);
+    fVar.drop((long double)valIn);
+  }
+
+  // operator() adds the rows entering the frame, skip the unbounded - current row handling
+  fPrev = -1;
+  return true;
+}
+
 template <typename T>
 void WF_stats<T>::operator()(int64_t b, int64_t e, int64_t c)
 {
-  CDT cdt;
   if ((fFrameUnit == WF__FRAME_ROWS) || (fPrev == -1) ||
       (!fPeer->operator()(getPointer(fRowData->at(c)), getPointer(fRowData->at(fPrev)))))
   {
@@ -173,49 +201,38 @@ void WF_stats<T>::operator()(int64_t b, int64_t e, int64_t c)
         continue;
 
       T valIn;
-      getValue(colIn, valIn, &cdt);
-      long double val = (long double)valIn;
-
-      fSum1 += val;
-      fSum2 += val * val;
-      fCount++;
+      getValue(colIn, valIn);
+      fVar.add((long double)valIn);
     }
 
-    if (fCount > 1)
+    if (fVar.count() > 1)
     {
       uint32_t scale = fRow.getScale(colIn);
       auto factor = datatypes::scaleDivisor<long double>(scale);
-      long double ldSum1 = fSum1;
-      long double ldSum2 = fSum2;
+      long double stat = fVar.m2();
 
       // adjust the scale if necessary
-      if (scale != 0 && cdt != CalpontSystemCatalog::LONGDOUBLE)
-      {
-        ldSum1 /= factor;
-        ldSum2 /= factor * factor;
-      }
-
-      long double stat = ldSum1 * ldSum1 / fCount;
-      stat = ldSum2 - stat;
+      if (scale != 0 && !std::is_same<T, long double>::value)
+        stat /= factor * factor;
 
       if (fFunctionId == WF__STDDEV_POP)
-        stat = sqrt(stat / fCount);
+        stat = sqrt(stat / fVar.count());
       else if (fFunctionId == WF__STDDEV_SAMP)
-        stat = sqrt(stat / (fCount - 1));
+        stat = sqrt(stat / (fVar.count() - 1));
       else if (fFunctionId == WF__VAR_POP)
-        stat = stat / fCount;
+        stat = stat / fVar.count();
       else if (fFunctionId == WF__VAR_SAMP)
-        stat = stat / (fCount - 1);
+        stat = stat / (fVar.count() - 1);
 
       fStats = (double)stat;
     }
   }
 
-  if (fCount == 0)
+  if (fVar.count() == 0)
   {
     setValue(CalpontSystemCatalog::DOUBLE, b, e, c, (double*)NULL);
   }
-  else if (fCount == 1)
+  else if (fVar.count() == 1)
   {
     if (fFunctionId == WF__STDDEV_SAMP || fFunctionId == WF__VAR_SAMP)
     {
@@ -23,6 +23,73 @@
 
 namespace windowfunction
 {
+// Running mean and sum of squared differences from it (Welford's method). Values can be
+// dropped again, but each drop rounds a little, so once as many values were dropped as are
+// left the frame should be summed up again instead, which keeps that O(1) per row.
+class RunningVariance
+{
+ public:
+  RunningVariance()
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    fMean = 0;
+    fM2 = 0;
+    fCount = 0;
+    fDropped = 0;
+  }
+
+  void add(long double val)
+  {
+    fCount++;
+    long double delta = val - fMean;
+    fMean += delta / fCount;
+    fM2 += delta * (val - fMean);
+  }
+
+  void drop(long double val)
+  {
+    fDropped++;
+
+    if (--fCount == 0)
+    {
+      fMean = 0;
+      fM2 = 0;
+      return;
+    }
+
+    long double delta = val - fMean;
+    fMean -= delta / fCount;
+    fM2 -= delta * (val - fMean);
+  }
+
+  // true if the values should be added up again rather than n more of them dropped
+  bool reanchor(uint64_t n) const
+  {
+    return fDropped + n > fCount;
+  }
+
+  uint64_t count() const
+  {
+    return fCount;
+  }
+
+  // rounding can leave a tiny negative sum after values were dropped
+  long double m2() const
+  {
+    return (fM2 > 0 ? fM2 : 0);
+  }
+
+ private:
+  long double fMean;
+  long double fM2;
+  uint64_t fCount;
+  uint64_t fDropped;  // since the values were last added up from scratch
+};
+
 template <typename T>
 class WF_stats : public WindowFunctionType
 {
@@ -36,13 +103,12 @@ class WF_stats : public WindowFunctionType
   void operator()(int64_t b, int64_t e, int64_t c);
   WindowFunctionType* clone() const;
   void resetData();
+  bool dropValues(int64_t, int64_t);
 
   static boost::shared_ptr<WindowFunctionType> makeFunction(int, const string&, int, WindowFunctionColumn*);
 
  protected:
-  long double fSum1;
-  long double fSum2;
-  uint64_t fCount;
+  RunningVariance fVar;
   double fStats;
 };
 
@@ -23,6 +23,7 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <type_traits>
 using namespace std;
 
 #include <boost/shared_ptr.hpp>
@@ -235,12 +236,54 @@ void WF_sum_avg<T_IN, T_OUT>::resetData()
 {
   fAvg = 0;
   fSum = 0;
+  fExactSum = 0;
   fCount = 0;
   fSet.clear();
 
   WindowFunctionType::resetData();
 }
 
+template <typename T_IN, typename T_OUT>
+bool WF_sum_avg<T_IN, T_OUT>::dropValues(int64_t b, int64_t e)
+{
+  // Subtracting floating point values doesn't give back the sum of the remaining ones exactly,
+  // and DISTINCT would need to count each value.  Those frames are recalculated instead.
+  if (fDistinct || std::is_floating_point<T_IN>::value)
+    return false;
+
+  uint64_t colIn = fFieldIndex[1];
+
+  for (int64_t i = b; i < e; i++)
+  {
+    if (i % 1000 == 0 && fStep->cancelled())
+      break;
+
+    fRow.setData(getPointer(fRowData->at(i)));
+
+    if (fRow.isNullValue(colIn) == true)
+      continue;
+
+    CDT cdt;
+    getValue(colIn, fVal, &cdt);
+
+    if constexpr (EXACT_SUM)
+    {
+      fExactSum -= fVal;
+      fSum = (T_OUT)fExactSum;
+    }
+    else
+    {
+      fSum -= (T_OUT)fVal;
+    }
+
+    fCount--;
+  }
+
+  // operator() adds the rows entering the frame, skip the unbounded - current row handling
+  fPrev = -1;
+  return true;
+}
+
 template <typename T_IN, typename T_OUT>
 void WF_sum_avg<T_IN, T_OUT>::operator()(int64_t b, int64_t e, int64_t c)
 {
@@ -273,7 +316,17 @@ void WF_sum_avg<T_IN, T_OUT>::operator()(int64_t b, int64_t e, int64_t c)
       if ((!fDistinct) || (fSet.find(fVal) == fSet.end()))
       {
         checkSumLimit(fVal, fSum);
-        fSum += (T_OUT)fVal;
+
+        if constexpr (EXACT_SUM)
+        {
+          fExactSum += fVal;
+          fSum = (T_OUT)fExactSum;
+        }
+        else
+        {
+          fSum += (T_OUT)fVal;
+        }
+
         fCount++;
 
         if (fDistinct)
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <set>
+#include <type_traits>
 #include "windowfunctiontype.h"
 
 namespace windowfunction
@@ -41,13 +42,19 @@ class WF_sum_avg : public WindowFunctionType
   void operator()(int64_t b, int64_t e, int64_t c);
   WindowFunctionType* clone() const;
   void resetData();
+  bool dropValues(int64_t, int64_t);
 
   static boost::shared_ptr<WindowFunctionType> makeFunction(int, const string&, int, WindowFunctionColumn*);
 
  protected:
+  // Integers summed up in long double are also summed up exactly, so that the values leaving
+  // a sliding frame can be taken off again. fSum is that sum rounded.
+  static constexpr bool EXACT_SUM = std::is_integral<T_IN>::value && std::is_floating_point<T_OUT>::value;
+
   T_IN fVal;
   T_OUT fAvg;
   T_OUT fSum;
+  int128_t fExactSum;
   uint64_t fCount;
   bool fDistinct;
   std::set<T_IN> fSet;
@@ -100,6 +100,8 @@ void WindowFunction::operator()()
     bool lowerCnrw = (lft == WF__CURRENT_ROW);
     fFunctionType->setRowData(fRowData);
     fFunctionType->setRowMetaData(fRowGroup, fRow);
+    fFunctionType->slidingFrame(!(upperUbnd && lowerUbnd) && !(upperUbnd && lowerCnrw) &&
+                                !(upperCnrw && lowerUbnd));
     fFrame->setRowData(fRowData);
     fFrame->setRowMetaData(fRowGroup, fRow);
 
@@ -179,14 +181,19 @@ void WindowFunction::operator()()
             prevFrame = w;
           }
 
-          // UDAnF functions may have a dropValue function implemented.
+          // UDAnF functions may have a dropValue function implemented, as do
+          // the built-in aggregates that can remove a value.
           // If they do, we can optimize by calling dropValue() for those
           // values leaving the window and nextValue for those entering, rather
           // than a resetData() and then iterating over the entire window.
-          // Built-in functions may have this functionality added in the future.
+          // That only works if the previous frame was not empty, and the frame
+          // moved forward without skipping past the end of the previous one.
           // If b > e then the frame is entirely outside of the partition
           // and there's no values to drop
-          if (!firstTime && (b <= e) && fFunctionType->dropValues(prevFrame.first, w.first))
+          bool frameMoved = !firstTime && (b <= e) && (prevFrame.first <= prevFrame.second) &&
+                            (prevFrame.first <= b) && (prevFrame.second <= e) && (b <= prevFrame.second + 1);
+
+          if (frameMoved && fFunctionType->dropValues(prevFrame.first, w.first))
           {
             // Adjust the beginning of the frame for nextValue
             // to start where the previous frame left off.
@@ -227,35 +234,28 @@ const Row& WindowFunction::getRow() const
 
 void WindowFunction::sort(std::vector<RowPosition>::iterator v, uint64_t n)
 {
-  // recursive function termination condition.
   if (n < 2 || fStep->cancelled())
     return;
 
-  RowPosition p = *(v + n / 2);                   // pivot value
-  vector<RowPosition>::iterator l = v;            // low   address
-  vector<RowPosition>::iterator h = v + (n - 1);  // high  address
+  fStep->getSortMemory(n);
+
+  // sort on normalized keys, the rows are only compared column by column on key ties
+  std::vector<ordering::KeyedRow<RowPosition> > rows(n);
 
-  while (l <= h && !(fStep->cancelled()))
+  for (uint64_t i = 0; i < n; i++)
   {
-    // Can use while here, but need check boundary and cancel status.
-    if (fOrderBy->operator()(getPointer(*l), getPointer(p)))
-    {
-      l++;
-    }
-    else if (fOrderBy->operator()(getPointer(p), getPointer(*h)))
-    {
-      h--;
-    }
-    else
-    {
-      RowPosition t = *l;  // temp value for swap
-      *l++ = *h;
-      *h-- = t;
-    }
+    rows[i].fPayload = *(v + i);
+    rows[i].fData = getPointer(rows[i].fPayload);
+    rows[i].fKey = fOrderBy->sortKey(rows[i].fData);
   }
 
-  sort(v, std::distance(v, h) + 1);
-  sort(l, std::distance(l, v) + n);
+  fOrderBy->sort(rows, [this]() { return fStep->cancelled(); });
+
+  for (uint64_t i = 0; i < n; i++)
+    *(v + i) = rows[i].fPayload;
+
+  std::vector<ordering::KeyedRow<RowPosition> >().swap(rows);
+  fStep->returnSortMemory(n);
 }
 
 }  // namespace windowfunction
@@ -109,7 +109,7 @@ class WindowFunctionType
  public:
   // @brief WindowFunctionType constructor
   WindowFunctionType(int id = 0, const std::string& name = "")
-   : fFunctionId(id), fFunctionName(name), fFrameUnit(0){};
+   : fFunctionId(id), fFunctionName(name), fFrameUnit(0), fSlidingFrame(false){};
 
   // use default copy construct
   // WindowFunctionType(const WindowFunctionType&);
@@ -134,7 +134,9 @@ class WindowFunctionType
   {
   }
 
-  // @brief virtual dropValues() For UDAnF functions
+  // @brief virtual dropValues() For UDAnF functions and the built-in aggregates
+  // Removes rows [b, e) from the values accumulated for the previous frame, so that only the rows
+  // entering the next frame have to be added.
   // return false if there's no dropValue() implemented in the function.
   virtual bool dropValues(int64_t, int64_t)
   {
@@ -184,6 +186,14 @@ class WindowFunctionType
   {
     fFrameUnit = u;
   }
+  bool slidingFrame() const
+  {
+    return fSlidingFrame;
+  }
+  void slidingFrame(bool s)
+  {
+    fSlidingFrame = s;
+  }
   std::pair<int64_t, int64_t> partition() const
   {
     return fPartition;
@@ -288,6 +298,9 @@ class WindowFunctionType
   // frame unit ( ROWS | RANGE )
   int64_t fFrameUnit;
 
+  // the frame has bounds that move with the current row, dropValues() may be called
+  bool fSlidingFrame;
+
   // partition
   std::pair<int64_t, int64_t> fPartition;
 
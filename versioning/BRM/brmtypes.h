@@ -26,6 +26,7 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <sys/types.h>
 #include <climits>
 #include <string>
@@ -259,6 +260,12 @@ struct FileInfo
 
 typedef std::tr1::unordered_map<execplan::CalpontSystemCatalog::OID, ExtentInfo> ExtentsInfoMap_t;
 
+/* Latency histograms the controller node keeps for the commands it distributes,
+   keyed by command.  Bucket i counts the commands that took less than 2^i
+   microseconds to answer, the last bucket counts the rest. */
+const uint32_t LATENCY_BUCKETS = 24;
+typedef std::map<uint8_t, std::vector<uint64_t> > CommandLatencies_t;
+
 enum LockState
 {
   LOADING,
@@ -553,6 +560,8 @@ const uint8_t RELEASE_LBID_RANGES = 91;
 const uint8_t BULK_UPDATE_DBROOT = 100;
 const uint8_t GET_SYSTEM_CATALOG = 101;
 const uint8_t BULK_WRITE_VB_ENTRY = 102;
+const uint8_t BRM_BATCH = 103;  // several of the above, applied one after another
+const uint8_t GET_COMMAND_LATENCIES = 104;
 
 /* Error codes returned by the DBRM functions. */
 /// The operation was successful
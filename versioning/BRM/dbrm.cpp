@@ -673,9 +673,14 @@ int DBRM::vssLookup(LBID_t lbid, const QueryContext& verInfo, VER_t txnID, VER_t
   try
   {
     int rc = 0;
+    QueryContext_vss vssInfo(verInfo);
+
+    if (vss->lookupUnlocked(lbid, vssInfo, txnID, outVer, vbFlag, vbOnly, rc))
+      return rc;
+
     vss->lock(VSS::READ);
     locked = true;
-    rc = vss->lookup(lbid, verInfo, txnID, outVer, vbFlag, vbOnly);
+    rc = vss->lookup(lbid, vssInfo, txnID, outVer, vbFlag, vbOnly);
     vss->release(VSS::READ);
     return rc;
   }
@@ -697,6 +702,11 @@ int DBRM::bulkVSSLookup(const std::vector<LBID_t>& lbids, const QueryContext_vss
 
   try
   {
+    // One unlocked pass over the batch, it's all looked up again under the read lock
+    // if a writer showed up meanwhile
+    if (vss->bulkLookupUnlocked(lbids, verInfo, txnID, *out))
+      return 0;
+
     out->resize(lbids.size());
     vss->lock(VSS::READ);
     locked = true;
@@ -2731,6 +2741,44 @@ int DBRM::setReadOnly(bool b) DBRM_THROW
   return err;
 }
 
+int DBRM::getCommandLatencies(CommandLatencies_t& latencies) DBRM_THROW
+{
+  ByteStream command, response;
+  uint8_t err, cmd;
+  uint32_t count;
+  uint64_t tmp64;
+
+  command << GET_COMMAND_LATENCIES;
+  err = send_recv(command, response);
+
+  if (err != ERR_OK)
+    return err;
+
+  response >> err;
+
+  if (err != ERR_OK)
+    return err;
+
+  response >> count;
+  latencies.clear();
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    response >> cmd;
+    vector<uint64_t>& buckets = latencies[cmd];
+    buckets.resize(LATENCY_BUCKETS);
+
+    for (uint32_t j = 0; j < LATENCY_BUCKETS; j++)
+    {
+      response >> tmp64;
+      buckets[j] = tmp64;
+    }
+  }
+
+  CHECK_EMPTY(response);
+  return ERR_OK;
+}
+
 int DBRM::isReadWrite() throw()
 {
 #ifdef BRM_INFO
@@ -820,6 +820,13 @@ class DBRM
   EXPORT int setReadOnly(bool b) DBRM_THROW;
   EXPORT int isReadWrite() throw();
 
+  /** @brief Returns the latency histograms of the commands the controller node distributed
+   *
+   * @param latencies (out) the histograms, keyed by command.  See CommandLatencies_t.
+   * @return 0 on success, an error code otherwise
+   */
+  EXPORT int getCommandLatencies(CommandLatencies_t& latencies) DBRM_THROW;
+
   EXPORT bool isEMEmpty() throw();
 
   EXPORT std::vector<InlineLBIDRange> getEMFreeListEntries() throw();
@@ -39,7 +39,7 @@ bool vflg;
 
 void usage(char* c)
 {
-  cerr << "Usage: " << c << " [-vh] status | halt | resume | readonly | readwrite | reload" << endl;
+  cerr << "Usage: " << c << " [-vh] status | halt | resume | readonly | readwrite | reload | latencies" << endl;
   exit(1);
 }
 
@@ -129,6 +129,38 @@ void do_sysstatus()
   errMsg(err);
 }
 
+void do_latencies()
+{
+  CommandLatencies_t latencies;
+  int err;
+
+  err = dbrm.getCommandLatencies(latencies);
+
+  if (err != ERR_OK)
+  {
+    errMsg(err);
+    return;
+  }
+
+  for (CommandLatencies_t::const_iterator it = latencies.begin(); it != latencies.end(); ++it)
+  {
+    cout << "command " << (int)it->first << ":";
+
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++)
+    {
+      if (it->second[i] == 0)
+        continue;
+
+      if (i < LATENCY_BUCKETS - 1)
+        cout << " <" << (1ULL << i) << "us: " << it->second[i];
+      else
+        cout << " >=" << (1ULL << (i - 1)) << "us: " << it->second[i];
+    }
+
+    cout << endl;
+  }
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
@@ -174,6 +206,8 @@ int main(int argc, char** argv)
     do_reload();
   else if (cmd == "sysstatus")
     do_sysstatus();
+  else if (cmd == "latencies")
+    do_latencies();
   else
     usage(argv[0]);
 
@@ -590,6 +590,7 @@ ExtentMap::ExtentMap()
   flLocked = false;
   emLocked = false;
   emIndexLocked = false;
+  fHoldWriteLocks = false;
   fPFreeListImpl = nullptr;
   fPExtMapIndexImpl_ = nullptr;
 
@@ -1909,6 +1910,48 @@ void ExtentMap::save(const string& filename)
 
 #endif
 
+  // the file is opened once the EM is locked and known not to be empty
+  scoped_ptr<IDBDataFile> out;
+
+  saveImpl(
+      [&](const char* buf, size_t len)
+      {
+        if (!out)
+        {
+          const char* filename_p = filename.c_str();
+          out.reset(IDBDataFile::open(IDBPolicy::getType(filename_p, IDBPolicy::WRITEENG), filename_p, "wb",
+                                      IDBDataFile::USE_VBUF));
+
+          if (!out)
+          {
+            log_errno("ExtentMap::save(): open");
+            throw ios_base::failure("ExtentMap::save(): open failed. Check the error log.");
+          }
+        }
+
+        size_t progress = 0;
+
+        while (progress < len)
+        {
+          int err = out->write(buf + progress, len - progress);
+
+          if (err < 0)
+            throw ios_base::failure("ExtentMap::save(): write failed. Check the error log.");
+
+          progress += err;
+        }
+      });
+}
+
+void ExtentMap::saveImage(vector<char>& image)
+{
+  image.clear();
+  saveImpl([&](const char* buf, size_t len) { image.insert(image.end(), buf, buf + len); });
+}
+
+template <typename Writer>
+void ExtentMap::saveImpl(const Writer& write)
+{
   int allocdSize, loadSize[3], i;
 
   grabEMEntryTable(READ);
@@ -1925,41 +1968,37 @@ void ExtentMap::save(const string& filename)
     throw;
   }
 
-  if (fEMShminfo->currentSize == 0)
-  {
-    log("ExtentMap::save(): got request to save an empty BRM");
-    releaseFreeList(READ);
-    releaseEMIndex(READ);
-    releaseEMEntryTable(READ);
-    throw runtime_error("ExtentMap::save(): got request to save an empty BRM");
-  }
-
-  const char* filename_p = filename.c_str();
-  scoped_ptr<IDBDataFile> out(IDBDataFile::open(IDBPolicy::getType(filename_p, IDBPolicy::WRITEENG),
-                                                filename_p, "wb", IDBDataFile::USE_VBUF));
-
-  if (!out)
+  try
   {
-    log_errno("ExtentMap::save(): open");
-    releaseFreeList(READ);
-    releaseEMIndex(READ);
-    releaseEMEntryTable(READ);
-    throw ios_base::failure("ExtentMap::save(): open failed. Check the error log.");
-  }
+    if (fEMShminfo->currentSize == 0)
+    {
+      log("ExtentMap::save(): got request to save an empty BRM");
+      throw runtime_error("ExtentMap::save(): got request to save an empty BRM");
+    }
 
-  loadSize[0] = EM_MAGIC_V5;
-  loadSize[1] = fEMShminfo->currentSize / sizeof(EMEntry);
-  loadSize[2] = fFLShminfo->allocdSize / sizeof(InlineLBIDRange);  // needs to send all entries
+    loadSize[0] = EM_MAGIC_V5;
+    loadSize[1] = fEMShminfo->currentSize / sizeof(EMEntry);
+    loadSize[2] = fFLShminfo->allocdSize / sizeof(InlineLBIDRange);  // needs to send all entries
+    write((char*)loadSize, 3 * sizeof(int));
 
-  int bytes = 0;
+    allocdSize = fEMShminfo->allocdSize / sizeof(EMEntry);
 
-  try
-  {
-    const int wsize = 3 * sizeof(int);
-    bytes = out->write((char*)loadSize, wsize);
+    // write the runs of used entries
+    int first = -1;
+    for (i = 0; i < allocdSize; i++)
+    {
+      if (fExtentMap[i].range.size > 0 && first == -1)
+        first = i;
+      else if (fExtentMap[i].range.size <= 0 && first != -1)
+      {
+        write((char*)&fExtentMap[first], (i - first) * sizeof(EMEntry));
+        first = -1;
+      }
+    }
+    if (first != -1)
+      write((char*)&fExtentMap[first], (allocdSize - first) * sizeof(EMEntry));
 
-    if (bytes != wsize)
-      throw ios_base::failure("ExtentMap::save(): write failed. Check the error log.");
+    write((char*)fFreeList, fFLShminfo->allocdSize);
   }
   catch (...)
   {
@@ -1969,72 +2008,6 @@ void ExtentMap::save(const string& filename)
     throw;
   }
 
-  allocdSize = fEMShminfo->allocdSize / sizeof(EMEntry);
-  // const int emEntrySize = sizeof(EMEntry);
-
-  int first = -1, last = -1, err;
-  size_t progress, writeSize;
-  for (i = 0; i < allocdSize; i++)
-  {
-    if (fExtentMap[i].range.size > 0 && first == -1)
-      first = i;
-    else if (fExtentMap[i].range.size <= 0 && first != -1)
-    {
-      last = i;
-      writeSize = (last - first) * sizeof(EMEntry);
-      progress = 0;
-      char* writePos = (char*)&fExtentMap[first];
-      while (progress < writeSize)
-      {
-        err = out->write(writePos + progress, writeSize - progress);
-        if (err < 0)
-        {
-          releaseFreeList(READ);
-          releaseEMIndex(READ);
-          releaseEMEntryTable(READ);
-          throw ios_base::failure("ExtentMap::save(): write failed. Check the error log.");
-        }
-        progress += err;
-      }
-      first = -1;
-    }
-  }
-  if (first != -1)
-  {
-    writeSize = (allocdSize - first) * sizeof(EMEntry);
-    progress = 0;
-    char* writePos = (char*)&fExtentMap[first];
-    while (progress < writeSize)
-    {
-      err = out->write(writePos + progress, writeSize - progress);
-      if (err < 0)
-      {
-        releaseFreeList(READ);
-        releaseEMIndex(READ);
-        releaseEMEntryTable(READ);
-        throw ios_base::failure("ExtentMap::save(): write failed. Check the error log.");
-      }
-      progress += err;
-    }
-  }
-
-  progress = 0;
-  writeSize = fFLShminfo->allocdSize;
-  char* writePos = (char*)fFreeList;
-  while (progress < writeSize)
-  {
-    err = out->write(writePos + progress, writeSize - progress);
-    if (err < 0)
-    {
-      releaseFreeList(READ);
-      releaseEMIndex(READ);
-      releaseEMEntryTable(READ);
-      throw ios_base::failure("ExtentMap::save(): write failed. Check the error log.");
-    }
-
-    progress += err;
-  }
-
   releaseFreeList(READ);
   releaseEMIndex(READ);
   releaseEMEntryTable(READ);
@@ -2045,6 +2018,13 @@ void ExtentMap::grabEMEntryTable(OPS op)
 {
   boost::mutex::scoped_lock lk(mutex);
 
+  // an earlier command of the batch has it
+  if (op == WRITE && emLocked && fHoldWriteLocks)
+  {
+    fExtentMap = fPExtMapImpl->get();
+    return;
+  }
+
   if (op == READ)
   {
     fEMShminfo = fMST.getTable_read(MasterSegmentTable::EMTable);
@@ -2111,6 +2091,12 @@ void ExtentMap::grabFreeList(OPS op)
 {
   boost::mutex::scoped_lock lk(mutex, boost::defer_lock);
 
+  if (op == WRITE && flLocked && fHoldWriteLocks)
+  {
+    fFreeList = fPFreeListImpl->get();
+    return;
+  }
+
   if (op == READ)
   {
     fFLShminfo = fMST.getTable_read(MasterSegmentTable::EMFreeList);
@@ -2179,6 +2165,9 @@ void ExtentMap::grabEMIndex(OPS op)
 {
   boost::mutex::scoped_lock lk(emIndexMutex);
 
+  if (op == WRITE && emIndexLocked && fHoldWriteLocks)
+    return;
+
   if (op == READ)
   {
     fEMIndexShminfo = fMST.getTable_read(MasterSegmentTable::EMIndex);
@@ -2235,7 +2224,7 @@ void ExtentMap::releaseEMEntryTable(OPS op)
   {
     fMST.releaseTable_read(MasterSegmentTable::EMTable);
   }
-  else
+  else if (!fHoldWriteLocks)
   {
     /*
        Note: Technically we should mark it unlocked after it's unlocked,
@@ -2253,7 +2242,7 @@ void ExtentMap::releaseFreeList(OPS op)
 {
   if (op == READ)
     fMST.releaseTable_read(MasterSegmentTable::EMFreeList);
-  else
+  else if (!fHoldWriteLocks)
   {
     flLocked = false;
     fMST.releaseTable_write(MasterSegmentTable::EMFreeList);
@@ -2266,7 +2255,7 @@ void ExtentMap::releaseEMIndex(OPS op)
   {
     fMST.releaseTable_read(MasterSegmentTable::EMIndex);
   }
-  else
+  else if (!fHoldWriteLocks)
   {
     emIndexLocked = false;
     fMST.releaseTable_write(MasterSegmentTable::EMIndex);
@@ -515,6 +515,14 @@ class ExtentMap : public Undoable
    */
   EXPORT void save(const std::string& filename);
 
+  /** @brief Copies what save() would write to a file into memory
+   *
+   * Holds the ExtentMap locks only for as long as the copy takes, so
+   * the image can be written out later without blocking writers.
+   * @param image (out) The contents of the save file.
+   */
+  EXPORT void saveImage(std::vector<char>& image);
+
   // @bug 1509.  Added new version of lookup below.
   /** @brief Returns the first and last LBID in the range for a given LBID
    *
@@ -989,6 +997,19 @@ class ExtentMap : public Undoable
 
   EXPORT void setReadOnly();
 
+  /** @brief Keep the write locks from one change to the next
+   *
+   * The DBRM worker applies the commands of a batch one after another and
+   * confirms or undoes them together.  While this is on a write lock this
+   * ExtentMap already holds is taken again without waiting for itself, and
+   * a command that fails keeps it for the undo of the commands before it.
+   * Turn it off before confirmChanges() or undoChanges() release the locks.
+   */
+  void holdWriteLocks(bool b)
+  {
+    fHoldWriteLocks = b;
+  }
+
   EXPORT virtual void undoChanges();
 
   EXPORT virtual void confirmChanges();
@@ -1075,6 +1096,7 @@ class ExtentMap : public Undoable
 
   int numUndoRecords;
   bool flLocked, emLocked, emIndexLocked;
+  bool fHoldWriteLocks;
   static boost::mutex mutex;  // @bug5355 - made mutex static
   static boost::mutex emIndexMutex;
   boost::mutex fConfigCacheMutex;  // protect access to Config Cache
@@ -1138,6 +1160,9 @@ class ExtentMap : public Undoable
 
   int _markInvalid(const LBID_t lbid, const execplan::CalpontSystemCatalog::ColDataType colDataType);
 
+  template <typename Writer>
+  void saveImpl(const Writer& write);
+
   template <class T>
   void load(T* in);
   /** @brief Loads the extent map from a file into memory.
@@ -24,6 +24,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sstream>
+#include <algorithm>
 
 #include "sessionmanager.h"
 #include "socketclosed.h"
@@ -106,6 +107,14 @@ MasterDBRMNode::MasterDBRMNode()
     MSG_TIMEOUT.tv_sec = secondsToWait;
   else
     MSG_TIMEOUT.tv_sec = 20;
+
+  retStr = config->getConfig("SystemConfig", "DBRMGroupCommit");
+  batchCommands = (retStr == "y" || retStr == "Y");
+  batchLeader = false;
+
+  for (uint32_t i = 0; i < 256; i++)
+    for (uint32_t j = 0; j < LATENCY_BUCKETS; j++)
+      latencies[i][j] = 0;
 }
 
 MasterDBRMNode::~MasterDBRMNode()
@@ -383,6 +392,7 @@ void MasterDBRMNode::msgProcessor()
   int err;
   uint8_t cmd;
   StopWatch timer;
+  std::chrono::steady_clock::time_point start;
 #ifdef BRM_VERBOSE
   cerr << "DBRM Controller: msgProcessor()" << endl;
 #endif
@@ -414,6 +424,7 @@ void MasterDBRMNode::msgProcessor()
 
     /* Check for an command for the master */
     msg.peek(cmd);
+    start = std::chrono::steady_clock::now();
 #ifdef BRM_VERBOSE
     cerr << "DBRM Controller: recv'd message " << (int)cmd << " length " << msg.length() << endl;
 #endif
@@ -442,6 +453,8 @@ void MasterDBRMNode::msgProcessor()
 
       case GETREADONLY: doGetReadOnly(p->sock); continue;
 
+      case GET_COMMAND_LATENCIES: doGetCommandLatencies(p->sock); continue;
+
       case GET_SYSTEM_CATALOG: doGetSystemCatalog(msg, p); continue;
     }
 
@@ -529,6 +542,27 @@ void MasterDBRMNode::msgProcessor()
       case DELETE_AI_SEQUENCE: doDeleteAISequence(msg, p); continue;
     }
 
+    if (batchCommands && isBatchable(cmd))
+    {
+      ByteStream reply;
+
+      if (runBatched(msg, reply))
+      {
+        try
+        {
+          p->sock->write(reply);
+        }
+        catch (...)
+        {
+          p->sock->close();
+          log("DBRM Controller: Warning: could not send the reply to a command", logging::LOG_TYPE_WARNING);
+        }
+
+        recordLatency(cmd, start);
+        continue;
+      }
+    }
+
   retrycmd:
     uint32_t haltloops = 0;
 
@@ -773,6 +807,7 @@ void MasterDBRMNode::msgProcessor()
     }
 
   out:
+    recordLatency(cmd, start);
 
     for (it = responses.begin(); it != responses.end(); it++)
       delete *it;
@@ -787,6 +822,193 @@ void MasterDBRMNode::msgProcessor()
   return;
 }
 
+// Commands that only change existing extent map entries and don't depend on each other.
+// A batch is applied in the order its commands were received.  Creating an extent can
+// grow the extent map or free list segment, which moves it and leaves the undo records
+// of the commands before it in the batch pointing at the old one, so those are never
+// batched.
+bool MasterDBRMNode::isBatchable(uint8_t cmd)
+{
+  switch (cmd)
+  {
+    case SETEXTENTMAXMIN:
+    case SETMANYEXTENTSMAXMIN:
+    case MERGEMANYEXTENTSMAXMIN:
+    case MARKEXTENTINVALID:
+    case MARKMANYEXTENTSINVALID:
+    case SET_LOCAL_HWM:
+    case BULK_SET_HWM:
+    case BULK_SET_HWM_AND_CP: return true;
+
+    default: return false;
+  }
+}
+
+/* Group commit.  A command that can be batched is queued, and the thread that
+   finds nobody sending a batch becomes the leader.  Once it has the slave lock it
+   takes everything that queued up in the meantime and sends it to the workers as
+   one BRM_BATCH, one round trip and one journal write for all of them.  The
+   other threads wait for their replies and send them to their callers.
+
+   Returns false if the command has to be sent on its own. */
+bool MasterDBRMNode::runBatched(ByteStream& msg, ByteStream& reply)
+{
+  const size_t MAX_BATCH = 64;
+  BatchedCommand self(&msg);
+  boost::mutex::scoped_lock lk(batchMutex);
+
+  batchQueue.push_back(&self);
+
+  while (self.state == BatchedCommand::WAITING)
+  {
+    if (batchLeader)
+    {
+      batchCond.wait(lk);
+      continue;
+    }
+
+    batchLeader = true;
+    lk.unlock();
+
+    slaveLock.lock();
+
+    lk.lock();
+    size_t n = min(batchQueue.size(), MAX_BATCH);
+    vector<BatchedCommand*> batch(batchQueue.begin(), batchQueue.begin() + n);
+    batchQueue.erase(batchQueue.begin(), batchQueue.begin() + n);
+    lk.unlock();
+
+    bool sent = distributeBatch(batch);
+    slaveLock.unlock();
+
+    lk.lock();
+
+    for (vector<BatchedCommand*>::iterator it = batch.begin(); it != batch.end(); ++it)
+      (*it)->state = (sent ? BatchedCommand::DONE : BatchedCommand::UNBATCHED);
+
+    batchLeader = false;
+    batchCond.notify_all();
+  }
+
+  if (self.state == BatchedCommand::UNBATCHED)
+    return false;
+
+  reply.swap(self.reply);
+  return true;
+}
+
+/* Called with the slave lock held.  The workers keep a batch pending the way
+   they keep a single command, it's confirmed only once they all sent the same
+   replies and every command in it succeeded.  Otherwise it's undone and false
+   is returned, and its commands are sent again one at a time so that a failing
+   one gets its error and a divergent worker is retried or reported by the usual
+   path.  Only a failed confirm makes the controller read-only. */
+bool MasterDBRMNode::distributeBatch(vector<BatchedCommand*>& batch)
+{
+  // alone, or when the workers are being reconfigured, a command goes the usual way
+  if (batch.size() < 2 || halting || readOnly)
+    return false;
+
+  ByteStream msg;
+  vector<ByteStream*> responses;
+  vector<ByteStream*>::iterator it;
+  vector<BatchedCommand*>::iterator bit;
+  bool readErrFlag;
+  int err;
+
+  msg << BRM_BATCH << (uint32_t)batch.size();
+
+  for (bit = batch.begin(); bit != batch.end(); ++bit)
+    msg << *(*bit)->msg;
+
+  try
+  {
+    distribute(&msg);
+    err = gatherResponses(BRM_BATCH, msg.length(), &responses, readErrFlag);
+
+    if (err == ERR_OK && halting)
+      err = ERR_NETWORK;
+
+    if (err == ERR_OK)
+      err = compareResponses(BRM_BATCH, msg.length(), responses);
+
+    if (err == ERR_OK)
+    {
+      ByteStream& first = *responses.front();
+      uint8_t tmp8, cmdErr;
+      uint32_t count;
+
+      // a worker stops at the first command that fails
+      first >> tmp8 >> count;
+
+      if (count != batch.size())
+        err = ERR_FAILURE;
+
+      for (bit = batch.begin(); err == ERR_OK && bit != batch.end(); ++bit)
+      {
+        first >> (*bit)->reply;
+        (*bit)->reply.peek(cmdErr);
+        err = cmdErr;
+      }
+    }
+  }
+  catch (...)
+  {
+    err = ERR_NETWORK;
+  }
+
+  for (it = responses.begin(); it != responses.end(); it++)
+    delete *it;
+
+  if (err != ERR_OK)
+  {
+#ifdef BRM_VERBOSE
+    cerr << "DBRM Controller: a batch of " << batch.size() << " commands failed with error " << err
+         << ", sending them one at a time" << endl;
+#endif
+    undo();
+    return false;
+  }
+
+  // the workers journal the batch on the confirm
+  try
+  {
+    confirm();
+  }
+  catch (...)
+  {
+    if (!halting)
+    {
+      ostringstream ostr;
+      ostr << "DBRM Controller: Caught network error.  "
+              "Confirming a batch of "
+           << batch.size() << " commands.  Setting read-only mode.";
+      log(ostr.str());
+      readOnly = true;
+    }
+  }
+
+  return true;
+}
+
+void MasterDBRMNode::recordLatency(uint8_t cmd, std::chrono::steady_clock::time_point start)
+{
+  uint64_t us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  latencies[cmd][latencyBucket(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t MasterDBRMNode::latencyBucket(uint64_t usec)
+{
+  uint32_t bucket = 0;
+
+  while (bucket < LATENCY_BUCKETS - 1 && usec >= (1ULL << bucket))
+    bucket++;
+
+  return bucket;
+}
+
 void MasterDBRMNode::distribute(ByteStream* msg)
 {
   uint32_t i;
@@ -1166,6 +1388,45 @@ void MasterDBRMNode::doSetReadOnly(messageqcpp::IOSocket* sock, bool b)
   }
 }
 
+void MasterDBRMNode::doGetCommandLatencies(messageqcpp::IOSocket* sock)
+{
+  ByteStream reply, histograms;
+  uint32_t count = 0;
+
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint64_t buckets[LATENCY_BUCKETS];
+    bool used = false;
+
+    for (uint32_t j = 0; j < LATENCY_BUCKETS; j++)
+    {
+      buckets[j] = latencies[i][j].load(std::memory_order_relaxed);
+      used |= (buckets[j] != 0);
+    }
+
+    if (!used)
+      continue;
+
+    histograms << (uint8_t)i;
+
+    for (uint32_t j = 0; j < LATENCY_BUCKETS; j++)
+      histograms << buckets[j];
+
+    count++;
+  }
+
+  reply << (uint8_t)ERR_OK << count;
+  reply += histograms;
+
+  try
+  {
+    sock->write(reply);
+  }
+  catch (exception&)
+  {
+  }
+}
+
 void MasterDBRMNode::doGetReadOnly(messageqcpp::IOSocket* sock)
 {
   ByteStream reply;
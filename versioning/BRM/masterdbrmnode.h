@@ -30,6 +30,8 @@
 #include <boost/scoped_ptr.hpp>
 
 #include <stdint.h>
+#include <atomic>
+#include <chrono>
 #include "brmtypes.h"
 #include "lbidresourcegraph.h"
 #include "messagequeue.h"
@@ -147,6 +149,12 @@ class MasterDBRMNode
   void getNumWorkersAndTimeout(size_t& connectTimeoutSecs, const std::string& methodName,
                                config::Config* config);
 
+  /** @brief Returns true if cmd may be sent to the workers in a batch with others */
+  static bool isBatchable(uint8_t cmd);
+
+  /** @brief The latency histogram bucket of a command that took usec, see CommandLatencies_t */
+  static uint32_t latencyBucket(uint64_t usec);
+
  private:
   class MsgProcessor
   {
@@ -165,6 +173,25 @@ class MasterDBRMNode
     boost::thread* t;
   };
 
+  /* A command waiting to go out as part of a batch */
+  struct BatchedCommand
+  {
+    enum State
+    {
+      WAITING,
+      DONE,       // reply holds the workers' answer
+      UNBATCHED,  // the command has to be sent on its own
+    };
+
+    explicit BatchedCommand(messageqcpp::ByteStream* m) : msg(m), state(WAITING)
+    {
+    }
+
+    messageqcpp::ByteStream* msg;
+    messageqcpp::ByteStream reply;
+    State state;
+  };
+
   MasterDBRMNode(const MasterDBRMNode& m);
   MasterDBRMNode& operator=(const MasterDBRMNode& m);
 
@@ -180,12 +207,18 @@ class MasterDBRMNode
                        const std::vector<messageqcpp::ByteStream*>& responses) const;
   void finalCleanup();
 
+  /* Group commit */
+  bool runBatched(messageqcpp::ByteStream& msg, messageqcpp::ByteStream& reply);
+  bool distributeBatch(std::vector<BatchedCommand*>& batch);
+  void recordLatency(uint8_t cmd, std::chrono::steady_clock::time_point start);
+
   /* Commands the master executes */
   void doHalt(messageqcpp::IOSocket* sock);
   void doResume(messageqcpp::IOSocket* sock);
   void doReload(messageqcpp::IOSocket* sock);
   void doSetReadOnly(messageqcpp::IOSocket* sock, bool b);
   void doGetReadOnly(messageqcpp::IOSocket* sock);
+  void doGetCommandLatencies(messageqcpp::IOSocket* sock);
 
   /* SessionManager interface */
   SessionManagerServer sm;
@@ -253,6 +286,13 @@ class MasterDBRMNode
   bool reloadCmd;
   mutable bool readOnly;
   struct timespec MSG_TIMEOUT;
+
+  bool batchCommands;
+  boost::mutex batchMutex;  // protects the batch queue and leader
+  boost::condition_variable batchCond;
+  std::vector<BatchedCommand*> batchQueue;
+  bool batchLeader;
+  std::atomic<uint64_t> latencies[256][LATENCY_BUCKETS];
 };
 
 }  // namespace BRM
@@ -27,6 +27,8 @@
 #include <fcntl.h>
 #include <cstdio>
 #include <ctime>
+#include <climits>
+#include <memory>
 #ifdef _MSC_VER
 #include <io.h>
 #include <psapi.h>
@@ -65,6 +67,9 @@ SlaveComm::SlaveComm(string hostname, SlaveDBRMNode* s)
  : slave(s)
  , currentSaveFile(NULL)
  , journalh(NULL)
+ , backgroundSnapshots(false)
+ , snapshotDone(false)
+ , batchReply(NULL)
 #ifdef _MSC_VER
  , fPids(0)
  , fMaxPids(64)
@@ -135,6 +140,18 @@ SlaveComm::SlaveComm(string hostname, SlaveDBRMNode* s)
     else
       snapshotInterval = config->fromText(tmp);
 
+    tmp = "";
+
+    try
+    {
+      tmp = config->getConfig("SystemConfig", "DBRMBackgroundSnapshots");
+    }
+    catch (exception& e)
+    {
+    }
+
+    backgroundSnapshots = (tmp == "y" || tmp == "Y");
+
     journalCount = 0;
 
     firstSlave = true;
@@ -172,6 +189,9 @@ SlaveComm::SlaveComm(string hostname, SlaveDBRMNode* s)
 SlaveComm::SlaveComm()
  : currentSaveFile(NULL)
  , journalh(NULL)
+ , backgroundSnapshots(false)
+ , snapshotDone(false)
+ , batchReply(NULL)
 #ifdef _MSC_VER
  , fPids(0)
  , fMaxPids(64)
@@ -209,6 +229,8 @@ SlaveComm::SlaveComm()
 
 SlaveComm::~SlaveComm()
 {
+  waitForSnapshot();
+
   delete server;
   server = NULL;
 
@@ -307,7 +329,8 @@ void SlaveComm::processCommand(ByteStream& msg)
 {
   uint8_t cmd;
 
-  if (firstSlave)
+  // the commands in a batch are journaled as part of it
+  if (firstSlave && !batchReply)
   {
     msg.peek(cmd);
 
@@ -400,6 +423,8 @@ void SlaveComm::processCommand(ByteStream& msg)
 
     case BULK_UPDATE_DBROOT: do_bulkUpdateDBRoot(msg); break;
 
+    case BRM_BATCH: do_batch(msg); break;
+
     default: cerr << "WorkerComm: unknown command " << (int)cmd << endl;
   }
 }
@@ -454,8 +479,7 @@ void SlaveComm::do_createStripeColumnExtents(ByteStream& msg)
   cerr << "WorkerComm: do_createStripeColumnExtents() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   // see bug 3596.  Need to make sure a snapshot file exists.
   if ((cols.size() > 0) && (cols[0].oid < 3000))
@@ -523,8 +547,7 @@ void SlaveComm::do_createColumnExtent_DBroot(ByteStream& msg)
   cerr << "WorkerComm: do_createColumnExtent_DBroot() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   if (oid < 3000)  // see bug 3596.  Need to make sure a snapshot file exists.
     takeSnapshot = true;
@@ -592,8 +615,7 @@ void SlaveComm::do_createColumnExtentExactFile(ByteStream& msg)
   cerr << "WorkerComm: do_createColumnExtentExactFile() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   if (oid < 3000)  // see bug 3596.  Need to make sure a snapshot file exists.
     takeSnapshot = true;
@@ -648,8 +670,7 @@ void SlaveComm::do_createDictStoreExtent(ByteStream& msg)
   cerr << "WorkerComm: do_createDictStoreExtent() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -704,8 +725,7 @@ void SlaveComm::do_rollbackColumnExtents_DBroot(ByteStream& msg)
   cerr << "WorkerComm: do_rollbackColumnExtents_DBroot() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -757,8 +777,7 @@ void SlaveComm::do_rollbackDictStoreExtents_DBroot(ByteStream& msg)
   cerr << "WorkerComm: do_rollbackDictStoreExtents() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -813,8 +832,7 @@ void SlaveComm::do_deleteEmptyColExtents(messageqcpp::ByteStream& msg)
   cerr << "WorkerComm: do_deleteEmptyColExtents() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -872,8 +890,7 @@ void SlaveComm::do_deleteEmptyDictStoreExtents(messageqcpp::ByteStream& msg)
   cerr << "WorkerComm: do_deleteEmptyDictStoreExtents() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -904,8 +921,7 @@ void SlaveComm::do_deleteOID(ByteStream& msg)
   cerr << "WorkerComm: do_deleteOID() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -947,8 +963,7 @@ void SlaveComm::do_deleteOIDs(ByteStream& msg)
   cerr << "WorkerComm: do_deleteOIDs() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -994,8 +1009,7 @@ void SlaveComm::do_setLocalHWM(ByteStream& msg)
   cerr << "WorkerComm: do_setLocalHWM() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1033,8 +1047,7 @@ void SlaveComm::do_bulkSetHWM(ByteStream& msg)
   cerr << "WorkerComm: do_setLocalHWM() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1080,8 +1093,7 @@ void SlaveComm::do_bulkSetHWMAndCP(ByteStream& msg)
   cerr << "WorkerComm: do_setLocalHWM() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1096,8 +1108,7 @@ void SlaveComm::do_bulkUpdateDBRoot(ByteStream& msg)
   err = slave->bulkUpdateDBRoot(args);
   reply << (uint8_t)err;
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1128,8 +1139,7 @@ void SlaveComm::do_markInvalid(ByteStream& msg)
   cerr << "WorkerComm: do_markInvalid() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1173,8 +1183,7 @@ void SlaveComm::do_markManyExtentsInvalid(ByteStream& msg)
   cerr << "WorkerComm: do_markManyExtentsInvalid() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1219,8 +1228,7 @@ void SlaveComm::do_setExtentMaxMin(ByteStream& msg)
   cerr << "WorkerComm: do_setExtentMaxMin() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1297,8 +1305,7 @@ void SlaveComm::do_setExtentsMaxMin(ByteStream& msg)
   cerr << "WorkerComm: do_setExtentsMaxMin() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1365,8 +1372,7 @@ void SlaveComm::do_mergeExtentsMaxMin(ByteStream& msg)
   cerr << "WorkerComm: do_mergeExtentsMaxMin() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1427,8 +1433,7 @@ void SlaveComm::do_deletePartition(ByteStream& msg)
   cerr << "WorkerComm: do_deletePartition() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1489,8 +1494,7 @@ void SlaveComm::do_markPartitionForDeletion(ByteStream& msg)
   cerr << "WorkerComm: do_markPartitionforDeletion() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1535,8 +1539,7 @@ void SlaveComm::do_markAllPartitionForDeletion(ByteStream& msg)
   cerr << "WorkerComm: do_markAllPartitionforDeletion() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1597,8 +1600,7 @@ void SlaveComm::do_restorePartition(ByteStream& msg)
   cerr << "WorkerComm: do_restorePartition() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1633,8 +1635,7 @@ void SlaveComm::do_deleteDBRoot(ByteStream& msg)
   cerr << "WorkerComm: do_deleteDBRoot() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1674,8 +1675,7 @@ void SlaveComm::do_writeVBEntry(ByteStream& msg)
   cerr << "WorkerComm: do_writeVBEntry() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1717,8 +1717,7 @@ void SlaveComm::do_bulkWriteVBEntry(ByteStream& msg)
   cerr << "WorkerComm: do_bulkWriteVBEntry() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1763,8 +1762,7 @@ void SlaveComm::do_beginVBCopy(ByteStream& msg)
   cerr << "WorkerComm: do_beginVBCopy() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1801,8 +1799,7 @@ void SlaveComm::do_endVBCopy(ByteStream& msg)
   cerr << "WorkerComm: do_endVBCopy() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1839,8 +1836,7 @@ void SlaveComm::do_vbRollback1(ByteStream& msg)
   cerr << "WorkerComm: do_vbRollback1() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1877,8 +1873,7 @@ void SlaveComm::do_vbRollback2(ByteStream& msg)
   cerr << "WorkerComm: do_vbRollback2() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1909,8 +1904,7 @@ void SlaveComm::do_vbCommit(ByteStream& msg)
   cerr << "WorkerComm: do_vbCommit() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -1944,7 +1938,10 @@ void SlaveComm::do_confirm()
     return;
   }
 
-  if (firstSlave && doSaveDelta && (journalCount < snapshotInterval || snapshotInterval < 0))
+  // A background snapshot is written from a copy taken after confirmChanges(), but the
+  // journal it replaces has to have this change too in case the snapshot never completes
+  if (firstSlave && doSaveDelta &&
+      (journalCount < snapshotInterval || snapshotInterval < 0 || backgroundSnapshots))
   {
     doSaveDelta = false;
     saveDelta();
@@ -1956,6 +1953,13 @@ void SlaveComm::do_confirm()
 
   if (firstSlave && (takeSnapshot || (journalCount >= snapshotInterval && snapshotInterval >= 0)))
   {
+    // Interval snapshots go to a background thread when they can.  One that was asked for
+    // is written here so that it's on disk by the time the caller hears back.
+    if (!takeSnapshot && backgroundSnapshots && (snapshotRunning() || startBackgroundSnapshot()))
+      return;
+
+    waitForSnapshot();
+
     if (!currentSaveFile)
     {
       currentSaveFile =
@@ -2004,12 +2008,177 @@ void SlaveComm::do_confirm()
     if (!journalh)
       throw runtime_error("Could not open the BRM journal for writing!");
 
+    // whatever a background snapshot left behind is covered by this one
+    IDBPolicy::remove(oldJournalName(savefile + "A").c_str());
+    IDBPolicy::remove(oldJournalName(savefile + "B").c_str());
+
     takeSnapshot = false;
     doSaveDelta = false;
     journalCount = 0;
   }
 }
 
+string SlaveComm::currentSnapshot()
+{
+  string current = savefile + "_current";
+  const char* filename = current.c_str();
+
+  if (!IDBPolicy::exists(filename))
+    return string();
+
+  boost::scoped_ptr<IDBDataFile> currentf(
+      IDBDataFile::open(IDBPolicy::getType(filename, IDBPolicy::WRITEENG), filename, "r", 0));
+
+  if (!currentf)
+    return string();
+
+  char buf[PATH_MAX];
+  ssize_t readIn = currentf->read(buf, sizeof(buf) - 1);
+
+  if (readIn <= 0)
+    return string();
+
+  string name(buf, readIn);
+  string::size_type end = name.find_first_of("\r\n");
+
+  if (end != string::npos)
+    name.erase(end);
+
+  // MCOL-1558.  The _current file is relative to DBRMRoot.
+  if (name.find('/') == string::npos)
+    name = savefile.substr(0, savefile.find_last_of('/') + 1) + name;
+
+  return name;
+}
+
+/* The journal entries since the current snapshot S are moved to S_oldjournal and the
+   state is copied while the worker is between commands.  The copy goes to the other
+   save file, and _current is switched to it only once it's complete, so until then
+   recovery loads S and replays S_oldjournal and the journal on top of it. */
+bool SlaveComm::startBackgroundSnapshot()
+{
+  string base = currentSnapshot();
+
+  if (base.empty() || (base[base.length() - 1] != 'A' && base[base.length() - 1] != 'B'))
+    return false;
+
+  string baseJournal = oldJournalName(base);
+
+  // Left by a snapshot that didn't complete.  Its entries are still needed, so this one
+  // is written the usual way.
+  if (IDBPolicy::exists(baseJournal.c_str()))
+    return false;
+
+  string target = savefile + (base[base.length() - 1] == 'A' ? 'B' : 'A');
+  IDBPolicy::remove(oldJournalName(target).c_str());
+
+  std::unique_ptr<SlaveDBRMNode::StateImage> image(new SlaveDBRMNode::StateImage());
+
+  if (slave->copyState(*image) != 0)
+  {
+    log("WorkerComm: failed to copy the BRM state, taking the snapshot in the foreground");
+    return false;
+  }
+
+  delete journalh;
+  journalh = NULL;
+  bool rotated = (IDBPolicy::rename(journalName.c_str(), baseJournal.c_str()) == 0);
+  journalh = IDBDataFile::open(IDBPolicy::getType(journalName.c_str(), IDBPolicy::WRITEENG),
+                               journalName.c_str(), rotated ? "w+b" : "a", 0);
+
+  if (!journalh)
+    throw runtime_error("Could not open the BRM journal for writing!");
+
+  if (!rotated)
+  {
+    ostringstream os;
+    os << "WorkerComm: failed to rename the journal to " << baseJournal
+       << ", taking the snapshot in the foreground";
+    log(os.str());
+    return false;
+  }
+
+  takeSnapshot = false;
+  doSaveDelta = false;
+  journalCount = 0;
+  // the next foreground snapshot goes to the file this one doesn't use
+  saveFileToggle = (target[target.length() - 1] == 'B');
+  snapshotDone = false;
+  snapshotThread.reset(
+      new boost::thread(&SlaveComm::writeBackgroundSnapshot, this, image.release(), target, base));
+  return true;
+}
+
+void SlaveComm::writeBackgroundSnapshot(SlaveDBRMNode::StateImage* imagep, string target, string base)
+{
+  std::unique_ptr<SlaveDBRMNode::StateImage> image(imagep);
+
+  if (SlaveDBRMNode::saveState(*image, target) != 0)
+  {
+    log("WorkerComm: failed to write a background snapshot to " + target);
+    snapshotDone = true;
+    return;
+  }
+
+  image.reset();
+
+  string current = savefile + "_current";
+  boost::scoped_ptr<IDBDataFile> currentf(IDBDataFile::open(
+      IDBPolicy::getType(current.c_str(), IDBPolicy::WRITEENG), current.c_str(), "wb", 0));
+
+  if (!currentf)
+  {
+    ostringstream os;
+    os << "WorkerComm: failed to open the current savefile. errno: " << strerror(errno);
+    log(os.str());
+    snapshotDone = true;
+    return;
+  }
+
+  // MCOL-1558.  Make the _current file relative to DBRMRoot.
+  string relative = target.substr(target.find_last_of('/') + 1);
+#ifndef _MSC_VER
+  relative += '\n';
+#endif
+  int err = currentf->write(relative.c_str(), relative.length());
+
+  if (err < (int)relative.length())
+  {
+    ostringstream os;
+    os << "WorkerComm: currentfile write() returned " << err;
+
+    if (err < 0)
+      os << " errno: " << strerror(errno);
+
+    log(os.str());
+    snapshotDone = true;
+    return;
+  }
+
+  currentf->flush();
+  currentf.reset();
+
+  IDBPolicy::remove(oldJournalName(base).c_str());
+  snapshotDone = true;
+}
+
+bool SlaveComm::snapshotRunning()
+{
+  if (snapshotThread && snapshotDone)
+    waitForSnapshot();
+
+  return (bool)snapshotThread;
+}
+
+void SlaveComm::waitForSnapshot()
+{
+  if (snapshotThread)
+  {
+    snapshotThread->join();
+    snapshotThread.reset();
+  }
+}
+
 void SlaveComm::do_flushInodeCache()
 {
   ByteStream reply;
@@ -2087,8 +2256,7 @@ void SlaveComm::do_flushInodeCache()
 #endif
   reply << (uint8_t)ERR_OK;
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 }
 
 void SlaveComm::do_clear()
@@ -2117,16 +2285,11 @@ void SlaveComm::do_clear()
 
   reply << (uint8_t)(err == 0 ? ERR_OK : ERR_FAILURE);
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 }
 
 int SlaveComm::replayJournal(string prefix)
 {
-  ByteStream cmd;
-  uint32_t len;
-  int ret = 0;
-
   // @Bug 2667+
   // Fix for issue where load_brm was using the journal file from DBRMRoot instead of the one from the command
   // line argument.
@@ -2154,6 +2317,29 @@ int SlaveComm::replayJournal(string prefix)
     fName = prefix + "_journal";
   }
 
+  // A background snapshot that didn't complete leaves the entries journaled between this
+  // snapshot and the one it was writing in <snapshot>_oldjournal
+  string oldJournal = oldJournalName(prefix);
+
+  if (IDBPolicy::exists(oldJournal.c_str()))
+  {
+    int err = replayJournalFile(oldJournal);
+
+    if (err < 0)
+      return err;
+
+    int ret = replayJournalFile(fName);
+    return (ret < 0 ? ret : err + ret);
+  }
+
+  return replayJournalFile(fName);
+}
+
+int SlaveComm::replayJournalFile(const string& fName)
+{
+  ByteStream cmd;
+  uint32_t len;
+  int ret = 0;
   const char* filename = fName.c_str();
 
   IDBDataFile* journalf =
@@ -2200,6 +2386,97 @@ int SlaveComm::replayJournal(string prefix)
   return ret;
 }
 
+/* The controller sends concurrent requests that don't depend on each other as one
+   batch to save round trips and journal writes.  The commands stay pending here
+   until the controller has compared the replies of all workers and sends CONFIRM or
+   BRM_UNDO for the whole batch, so a divergent worker can be rolled back like it
+   can for a single command.  The first command that fails ends the batch, the
+   controller undoes it and sends the commands again one at a time. */
+void SlaveComm::do_batch(ByteStream& msg)
+{
+  uint32_t count, done = 0, saved = 0;
+  ByteStream cmd, work, cmdReply, replies, journaled, reply;
+
+  msg >> count;
+
+  if (printOnly)
+    cout << "batch of " << count << " commands" << endl;
+
+  slave->holdWriteLocks(true);
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    msg >> cmd;
+    work = cmd;
+    cmdReply.restart();
+    doSaveDelta = false;
+    batchReply = &cmdReply;
+
+    try
+    {
+      processCommand(work);
+    }
+    catch (...)
+    {
+      batchReply = NULL;
+      slave->holdWriteLocks(false);
+      throw;
+    }
+
+    batchReply = NULL;
+
+    if (printOnly)
+      continue;
+
+    uint8_t cmdErr = ERR_OK;
+
+    if (cmdReply.length() > 0)
+      cmdReply.peek(cmdErr);
+
+    replies << cmdReply;
+    done++;
+
+    if (cmdErr != ERR_OK)
+      break;
+
+    if (doSaveDelta)
+    {
+      journaled << cmd;
+      saved++;
+    }
+  }
+
+  slave->holdWriteLocks(false);
+
+  if (printOnly)
+    return;
+
+  if (firstSlave)
+  {
+    delta.restart();
+    delta << BRM_BATCH << saved;
+    delta += journaled;
+  }
+
+  doSaveDelta = (saved > 0);
+
+  // the errors of the commands are in their own replies, the ones after a
+  // failed command weren't run
+  reply << (uint8_t)ERR_OK << done;
+  reply += replies;
+
+  if (!standalone)
+    master.write(reply);
+}
+
+void SlaveComm::sendReply(ByteStream& reply)
+{
+  if (batchReply)
+    *batchReply = reply;
+  else if (!standalone)
+    master.write(reply);
+}
+
 void SlaveComm::do_takeSnapshot()
 {
   ByteStream reply;
@@ -2214,8 +2491,7 @@ void SlaveComm::do_takeSnapshot()
   do_confirm();
   reply << (uint8_t)0;
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 }
 
 void SlaveComm::saveDelta()
@@ -2393,8 +2669,7 @@ void SlaveComm::do_dmlLockLBIDRanges(ByteStream& msg)
   cerr << "WorkerComm: do_dmlLockLBIDRanges() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
@@ -2424,8 +2699,7 @@ void SlaveComm::do_dmlReleaseLBIDRanges(ByteStream& msg)
   cerr << "WorkerComm: do_dmlReleaseLBIDRanges() err code is " << err << endl;
 #endif
 
-  if (!standalone)
-    master.write(reply);
+  sendReply(reply);
 
   doSaveDelta = true;
 }
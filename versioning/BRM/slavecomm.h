@@ -28,8 +28,11 @@
 
 #include <unistd.h>
 #include <iostream>
+#include <atomic>
 
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "brmtypes.h"
 #include "slavedbrmnode.h"
@@ -68,6 +71,13 @@ class SlaveComm
   EXPORT int replayJournal(std::string prefix);
   EXPORT int printJournal(std::string prefix);
 
+  /** Where a background snapshot moves the journal of the snapshot it replaces.
+      replayJournal(snapshot) replays it before the journal. */
+  static std::string oldJournalName(const std::string& snapshot)
+  {
+    return snapshot + "_oldjournal";
+  }
+
  private:
   SlaveComm& operator=(const SlaveComm& s);
 
@@ -113,7 +123,15 @@ class SlaveComm
   void do_clear();
   void do_ownerCheck(messageqcpp::ByteStream& msg);
   void do_takeSnapshot();
+  void do_batch(messageqcpp::ByteStream& msg);
+  void sendReply(messageqcpp::ByteStream& reply);
   void saveDelta();
+  bool startBackgroundSnapshot();
+  void writeBackgroundSnapshot(SlaveDBRMNode::StateImage* image, std::string target, std::string base);
+  bool snapshotRunning();
+  void waitForSnapshot();
+  std::string currentSnapshot();
+  int replayJournalFile(const std::string& fName);
   bool processExists(const uint32_t pid, const std::string& pname);
 
   messageqcpp::MessageQueueServer* server;
@@ -126,6 +144,10 @@ class SlaveComm
   std::string journalName;
   idbdatafile::IDBDataFile* journalh;
   int64_t snapshotInterval, journalCount;
+  bool backgroundSnapshots;
+  boost::scoped_ptr<boost::thread> snapshotThread;
+  std::atomic<bool> snapshotDone;
+  messageqcpp::ByteStream* batchReply;  // collects the reply of a command in a batch
   struct timespec MSG_TIMEOUT;
 #ifdef _MSC_VER
   boost::mutex fPidMemLock;
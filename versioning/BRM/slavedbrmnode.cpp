@@ -28,6 +28,7 @@
 #endif
 #include <sstream>
 #include <limits>
+#include <boost/scoped_ptr.hpp>
 
 #include "brmtypes.h"
 #include "rwlock.h"
@@ -45,8 +46,11 @@
 #include "errorcodes.h"
 #include "idberrorinfo.h"
 #include "cacheutils.h"
+#include "IDBDataFile.h"
+#include "IDBPolicy.h"
 using namespace std;
 using namespace logging;
+using namespace idbdatafile;
 
 namespace BRM
 {
@@ -1054,6 +1058,72 @@ int SlaveDBRMNode::saveState(string filename) throw()
   return 0;
 }
 
+int SlaveDBRMNode::copyState(StateImage& image) throw()
+{
+  bool locked[2] = {false, false};
+
+  try
+  {
+    vbbm.lock(VBBM::READ);
+    locked[0] = true;
+    vss.lock(VSS::READ);
+    locked[1] = true;
+
+    em.saveImage(image.em);
+    vbbm.saveImage(image.vbbm);
+    vss.saveImage(image.vss);
+
+    vss.release(VSS::READ);
+    locked[1] = false;
+    vbbm.release(VBBM::READ);
+    locked[0] = false;
+  }
+  catch (exception& e)
+  {
+    if (locked[1])
+      vss.release(VSS::READ);
+
+    if (locked[0])
+      vbbm.release(VBBM::READ);
+
+    return -1;
+  }
+
+  return 0;
+}
+
+int SlaveDBRMNode::saveState(const StateImage& image, string filename) throw()
+{
+  const pair<const vector<char>*, string> files[] = {
+      {&image.em, filename + "_em"}, {&image.vbbm, filename + "_vbbm"}, {&image.vss, filename + "_vss"}};
+
+  for (const auto& file : files)
+  {
+    const char* filename_p = file.second.c_str();
+    boost::scoped_ptr<IDBDataFile> out(IDBDataFile::open(IDBPolicy::getType(filename_p, IDBPolicy::WRITEENG),
+                                                         filename_p, "wb", IDBDataFile::USE_VBUF));
+
+    if (!out)
+      return -1;
+
+    const char* buf = file.first->data();
+    size_t len = file.first->size();
+    size_t progress = 0;
+
+    while (progress < len)
+    {
+      ssize_t err = out->write(buf + progress, len - progress);
+
+      if (err < 0)
+        return -1;
+
+      progress += err;
+    }
+  }
+
+  return 0;
+}
+
 int SlaveDBRMNode::loadState(string filename) throw()
 {
   string emFilename = filename + "_em";
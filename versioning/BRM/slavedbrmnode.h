@@ -418,6 +418,15 @@ class SlaveDBRMNode
   EXPORT void confirmChanges() throw();
   EXPORT void undoChanges() throw();
 
+  /** @brief Keep the extent map locked between the commands of a batch
+   *
+   * The batch is confirmed or undone as a whole, see ExtentMap::holdWriteLocks().
+   */
+  void holdWriteLocks(bool b)
+  {
+    em.holdWriteLocks(b);
+  }
+
   EXPORT int loadExtentMap(const std::string& filename);
   EXPORT int saveExtentMap(const std::string& filename);
 
@@ -459,6 +468,21 @@ class SlaveDBRMNode
   EXPORT int loadState(std::string filename) throw();
   EXPORT int saveState(std::string filename) throw();
 
+  /** @brief An in-memory copy of the files saveState() writes */
+  struct StateImage
+  {
+    std::vector<char> em, vbbm, vss;
+  };
+
+  /** @brief Copies the state into memory
+   *
+   * Holds the BRM read locks only for as long as the copy takes.  Pass
+   * the copy to the static saveState() to write it out later, from any thread.
+   * @return 0 on success, -1 on error.
+   */
+  EXPORT int copyState(StateImage& image) throw();
+  EXPORT static int saveState(const StateImage& image, std::string filename) throw();
+
   EXPORT const bool* getEMFLLockStatus();
   EXPORT const bool* getEMLockStatus();
   EXPORT const bool* getEMIndexLockStatus();
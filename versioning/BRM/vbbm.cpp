@@ -1061,9 +1061,6 @@ void VBBM::load(string filename)
 // read lock
 void VBBM::save(string filename)
 {
-  int i;
-  int var;
-
   const char* filename_p = filename.c_str();
   scoped_ptr<IDBDataFile> out(IDBDataFile::open(IDBPolicy::getType(filename_p, IDBPolicy::WRITEENG),
                                                 filename_p, "wb", IDBDataFile::USE_VBUF));
@@ -1074,68 +1071,58 @@ void VBBM::save(string filename)
     throw runtime_error("VBBM::save(): Failed to open the file");
   }
 
-  var = VBBM_MAGIC_V2;
-  [[maybe_unused]] int bytesWritten = 0;
-  [[maybe_unused]] int bytesToWrite = 12;
-  bytesWritten += out->write((char*)&var, 4);
-  bytesWritten += out->write((char*)&vbbm->vbCurrentSize, 4);
-  bytesWritten += out->write((char*)&vbbm->nFiles, 4);
+  saveImpl(
+      [&](const char* buf, size_t len)
+      {
+        size_t progress = 0;
+
+        while (progress < len)
+        {
+          int err = out->write(buf + progress, len - progress);
+
+          if (err < 0)
+          {
+            log_errno("VBBM::save()");
+            throw runtime_error("VBBM::save(): Failed to write the file");
+          }
 
-  bytesWritten += out->write((char*)files, sizeof(VBFileMetadata) * vbbm->nFiles);
-  bytesToWrite += sizeof(VBFileMetadata) * vbbm->nFiles;
+          progress += err;
+        }
+      });
+}
+
+void VBBM::saveImage(vector<char>& image)
+{
+  image.clear();
+  saveImpl([&](const char* buf, size_t len) { image.insert(image.end(), buf, buf + len); });
+}
+
+template <typename Writer>
+void VBBM::saveImpl(const Writer& write)
+{
+  int i;
+  int var;
 
-  int first = -1, last = -1, err;
-  size_t progress, writeSize;
+  var = VBBM_MAGIC_V2;
+  write((char*)&var, 4);
+  write((char*)&vbbm->vbCurrentSize, 4);
+  write((char*)&vbbm->nFiles, 4);
+  write((char*)files, sizeof(VBFileMetadata) * vbbm->nFiles);
 
+  // write the runs of used entries
+  int first = -1;
   for (i = 0; i < vbbm->vbCapacity; i++)
   {
     if (storage[i].lbid != -1 && first == -1)
       first = i;
     else if (storage[i].lbid == -1 && first != -1)
     {
-      last = i;
-      writeSize = (last - first) * sizeof(VBBMEntry);
-      progress = 0;
-      char* writePos = (char*)&storage[first];
-      while (progress < writeSize)
-      {
-        err = out->write(writePos + progress, writeSize - progress);
-        if (err < 0)
-        {
-          log_errno("VBBM::save()");
-          throw runtime_error("VBBM::save(): Failed to write the file");
-        }
-        progress += err;
-      }
+      write((char*)&storage[first], (i - first) * sizeof(VBBMEntry));
       first = -1;
     }
   }
   if (first != -1)
-  {
-    writeSize = (vbbm->vbCapacity - first) * sizeof(VBBMEntry);
-    progress = 0;
-    char* writePos = (char*)&storage[first];
-    while (progress < writeSize)
-    {
-      err = out->write(writePos + progress, writeSize - progress);
-      if (err < 0)
-      {
-        log_errno("VBBM::save()");
-        throw runtime_error("VBBM::save(): Failed to write the file");
-      }
-      progress += err;
-    }
-  }
-
-#if 0
-    cout << "saving... nfiles=" << vbbm->nFiles << "\n";
-
-    for (i = 0; i < vbbm->nFiles; i++)
-    {
-        cout << "file " << i << " vboid=" << files[i].OID << " size=" << files[i].fileSize << endl;
-    }
-
-#endif
+    write((char*)&storage[first], (vbbm->vbCapacity - first) * sizeof(VBBMEntry));
 }
 
 uint32_t VBBM::addVBFileIfNotExists(OID_t vbOID)
@@ -210,6 +210,8 @@ class VBBM : public Undoable
   EXPORT void load(std::string filename);
   EXPORT void loadVersion2(idbdatafile::IDBDataFile* in);
   EXPORT void save(std::string filename);
+  // Copies what save() would write into memory, the caller holds the read lock
+  EXPORT void saveImage(std::vector<char>& image);
 
 #ifdef BRM_DEBUG
   EXPORT int getShmid() const;
@@ -238,6 +240,9 @@ class VBBM : public Undoable
   void copyVBBM(VBShmsegHeader* dest);
   void initShmseg(int nFiles);
 
+  template <typename Writer>
+  void saveImpl(const Writer& write);
+
   void _insert(VBBMEntry& e, VBShmsegHeader* dest, int* destTable, VBBMEntry* destStorage,
                bool loading = false);
   int getIndex(LBID_t lbid, VER_t verID, int& prev, int& bucket) const;
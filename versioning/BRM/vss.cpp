@@ -44,6 +44,7 @@
 #include "cacheutils.h"
 #include "IDBDataFile.h"
 #include "IDBPolicy.h"
+#include "atomicops.h"
 
 #define VSS_DLLEXPORT
 #include "vss.h"
@@ -68,6 +69,7 @@ VSSEntry::VSSEntry()
 
 /*static*/
 boost::mutex VSSImpl::fInstanceMutex;
+boost::shared_mutex VSSImpl::fMapMutex;
 boost::mutex VSS::mutex;
 
 /*static*/
@@ -144,7 +146,7 @@ void VSS::lock(OPS op)
         }
         catch (...)
         {
-          release(WRITE);
+          mst.releaseTable_write(MasterSegmentTable::VSSSegment);
           throw;
         }
 
@@ -158,7 +160,7 @@ void VSS::lock(OPS op)
         }
         catch (...)
         {
-          release(WRITE);
+          mst.releaseTable_write(MasterSegmentTable::VSSSegment);
           throw;
         }
       }
@@ -192,6 +194,13 @@ void VSS::lock(OPS op)
     if (op == READ)
       mutex.unlock();
   }
+
+  // lookupUnlocked() readers back off until release()
+  if (op == WRITE)
+  {
+    vss->changeSeq = writeStartSeq(vss->changeSeq);
+    atomicops::atomicMb();
+  }
 }
 
 // ported from ExtentMap
@@ -200,7 +209,11 @@ void VSS::release(OPS op)
   if (op == READ)
     mst.releaseTable_read(MasterSegmentTable::VSSSegment);
   else
+  {
+    atomicops::atomicMb();
+    vss->changeSeq = writeEndSeq(vss->changeSeq);
     mst.releaseTable_write(MasterSegmentTable::VSSSegment);
+  }
 }
 
 void VSS::initShmseg()
@@ -215,6 +228,7 @@ void VSS::initShmseg()
   vss->lockedEntryCount = 0;
   vss->LWM = 0;
   vss->numHashBuckets = VSSTABLE_INITIAL_SIZE / sizeof(int);
+  vss->changeSeq = 0;
   newshmseg = reinterpret_cast<char*>(vss);
 
   buckets = reinterpret_cast<int*>(&newshmseg[sizeof(VSSShmsegHeader)]);
@@ -318,6 +332,7 @@ void VSS::growForLoad(int elementCount)
   vss->LWM = 0;
   vss->numHashBuckets = elementCount / 4;
   vss->lockedEntryCount = 0;
+  vss->changeSeq = 1;  // the write lock is held
   undoRecords.clear();
   newshmseg = reinterpret_cast<char*>(vss);
   hashBuckets = reinterpret_cast<int*>(&newshmseg[sizeof(VSSShmsegHeader)]);
@@ -346,6 +361,7 @@ void VSS::copyVSS(VSSShmsegHeader* dest)
   // copy metadata
   dest->currentSize = vss->currentSize;
   dest->lockedEntryCount = vss->lockedEntryCount;
+  dest->changeSeq = vss->changeSeq;
 
   newHashtable = reinterpret_cast<int*>(&cDest[sizeof(VSSShmsegHeader)]);
   newStorage =
@@ -460,6 +476,8 @@ void VSS::_insert(VSSEntry& e, VSSShmsegHeader* dest, int* destHash, VSSEntry* d
 
   e.next = destHash[hashIndex];
   destStorage[insertIndex] = e;
+  // lookupUnlocked() must not see the entry linked before it's written
+  atomicops::atomicMb();
   destHash[hashIndex] = insertIndex;
 }
 
@@ -467,9 +485,6 @@ void VSS::_insert(VSSEntry& e, VSSShmsegHeader* dest, int* destHash, VSSEntry* d
 int VSS::lookup(LBID_t lbid, const QueryContext_vss& verInfo, VER_t txnID, VER_t* outVer, bool* vbFlag,
                 bool vbOnly) const
 {
-  int hashIndex, maxVersion = -1, minVersion = -1, currentIndex;
-  VSSEntry *listEntry, *maxEntry = NULL;
-
 #ifdef BRM_DEBUG
 
   if (lbid < 0)
@@ -492,13 +507,118 @@ int VSS::lookup(LBID_t lbid, const QueryContext_vss& verInfo, VER_t txnID, VER_t
 
 #endif
 
-  hashIndex = hasher((char*)&lbid, sizeof(lbid)) % vss->numHashBuckets;
+  bool consistent;
 
-  currentIndex = hashBuckets[hashIndex];
+  return _lookup(vss, hashBuckets, storage, lbid, verInfo, txnID, outVer, vbFlag, vbOnly, consistent);
+}
+
+// Readers don't block writers here, they check vss->changeSeq instead.  A writer makes it
+// odd in lock(WRITE) and even again in release(WRITE), so if it's the same even number
+// before and after the lookup, nothing was changed meanwhile.  VSSImpl::mapMutex() keeps
+// the segment from being unmapped under us when the VSS is resized.
+bool VSS::lookupUnlocked(LBID_t lbid, const QueryContext_vss& verInfo, VER_t txnID, VER_t* outVer,
+                         bool* vbFlag, bool vbOnly, int& rc) const
+{
+  boost::shared_lock<boost::shared_mutex> lk(VSSImpl::mapMutex());
+
+  if (!fPVSSImpl || !vssShminfo || fPVSSImpl->key() != (unsigned)vssShminfo->tableShmkey)
+    return false;
+
+  const VSSShmsegHeader* header = fPVSSImpl->get();
+  const char* shmseg = reinterpret_cast<const char*>(header);
+  uint32_t seq = header->changeSeq;
+
+  if (seq & 1)
+    return false;
+
+  atomicops::atomicMb();
+  const int* buckets = reinterpret_cast<const int*>(&shmseg[sizeof(VSSShmsegHeader)]);
+  const VSSEntry* stor = reinterpret_cast<const VSSEntry*>(
+      &shmseg[sizeof(VSSShmsegHeader) + header->numHashBuckets * sizeof(int)]);
+  bool consistent;
+  int ret = _lookup(header, buckets, stor, lbid, verInfo, txnID, outVer, vbFlag, vbOnly, consistent);
+  atomicops::atomicMb();
+
+  if (!consistent || header->changeSeq != seq || fPVSSImpl->key() != (unsigned)vssShminfo->tableShmkey)
+    return false;
+
+  rc = ret;
+  return true;
+}
+
+// The lookupUnlocked() protocol around all of the lookups, the shared mapMutex() and the
+// barriers are paid once per batch rather than per LBID
+bool VSS::bulkLookupUnlocked(const std::vector<LBID_t>& lbids, const QueryContext_vss& verInfo, VER_t txnID,
+                             std::vector<VSSData>& out) const
+{
+  boost::shared_lock<boost::shared_mutex> lk(VSSImpl::mapMutex());
+
+  if (!fPVSSImpl || !vssShminfo || fPVSSImpl->key() != (unsigned)vssShminfo->tableShmkey)
+    return false;
+
+  const VSSShmsegHeader* header = fPVSSImpl->get();
+  const char* shmseg = reinterpret_cast<const char*>(header);
+  uint32_t seq = header->changeSeq;
+
+  if (seq & 1)
+    return false;
+
+  atomicops::atomicMb();
+  const int* buckets = reinterpret_cast<const int*>(&shmseg[sizeof(VSSShmsegHeader)]);
+  const VSSEntry* stor = reinterpret_cast<const VSSEntry*>(
+      &shmseg[sizeof(VSSShmsegHeader) + header->numHashBuckets * sizeof(int)]);
+  bool empty = (header->currentSize == 0);
+  bool consistent = true;
+
+  out.resize(lbids.size());
+
+  for (size_t i = 0; i < lbids.size() && consistent; i++)
+  {
+    VSSData& vd = out[i];
+
+    if (empty)
+    {
+      vd.verID = 0;
+      vd.vbFlag = false;
+      vd.returnCode = -1;
+    }
+    else
+      vd.returnCode = _lookup(header, buckets, stor, lbids[i], verInfo, txnID, &vd.verID, &vd.vbFlag, false,
+                              consistent);
+  }
+
+  atomicops::atomicMb();
+
+  return consistent && header->changeSeq == seq && fPVSSImpl->key() == (unsigned)vssShminfo->tableShmkey;
+}
+
+// Can't trust anything in the segment if the caller doesn't hold the lock, so the chain is
+// bounds checked and consistent is set to false if it looks broken.
+int VSS::_lookup(const VSSShmsegHeader* header, const int* buckets, const VSSEntry* stor, LBID_t lbid,
+                 const QueryContext_vss& verInfo, VER_t txnID, VER_t* outVer, bool* vbFlag, bool vbOnly,
+                 bool& consistent) const
+{
+  int hashIndex, maxVersion = -1, minVersion = -1, currentIndex;
+  const VSSEntry *listEntry, *maxEntry = NULL;
+  int numHashBuckets = header->numHashBuckets;
+  int capacity = header->capacity;
+  int steps = 0;
+
+  consistent = false;
+
+  if (numHashBuckets <= 0)
+    return -1;
+
+  hashIndex = hasher((char*)&lbid, sizeof(lbid)) % numHashBuckets;
+
+  currentIndex = buckets[hashIndex];
 
   while (currentIndex != -1)
   {
-    listEntry = &storage[currentIndex];
+    if (currentIndex < 0 || currentIndex >= capacity || ++steps > capacity)
+      return -1;
+
+    listEntry = &stor[currentIndex];
 
     if (listEntry->lbid == lbid)
     {
@@ -515,6 +635,7 @@ int VSS::lookup(LBID_t lbid, const QueryContext_vss& verInfo, VER_t txnID, VER_t
       {
         *outVer = listEntry->verID;
         *vbFlag = listEntry->vbFlag;
+        consistent = true;
         return 0;
       }
 
@@ -534,6 +655,8 @@ int VSS::lookup(LBID_t lbid, const QueryContext_vss& verInfo, VER_t txnID, VER_t
     currentIndex = listEntry->next;
   }
 
+  consistent = true;
+
   if (maxEntry != NULL)
   {
     *outVer = maxVersion;
@@ -1257,9 +1380,6 @@ struct Header
 // read lock
 void VSS::save(string filename)
 {
-  int i;
-  struct Header header;
-
   const char* filename_p = filename.c_str();
   scoped_ptr<IDBDataFile> out(IDBDataFile::open(IDBPolicy::getType(filename_p, IDBPolicy::WRITEENG),
                                                 filename_p, "wb", IDBDataFile::USE_VBUF));
@@ -1270,56 +1390,56 @@ void VSS::save(string filename)
     throw runtime_error("VSS::save(): Failed to open the file");
   }
 
+  saveImpl(
+      [&](const char* buf, size_t len)
+      {
+        size_t progress = 0;
+
+        while (progress < len)
+        {
+          int err = out->write(buf + progress, len - progress);
+
+          if (err < 0)
+          {
+            log_errno("VSS::save()");
+            throw runtime_error("VSS::save(): Failed to write the file");
+          }
+
+          progress += err;
+        }
+      });
+}
+
+void VSS::saveImage(vector<char>& image)
+{
+  image.clear();
+  saveImpl([&](const char* buf, size_t len) { image.insert(image.end(), buf, buf + len); });
+}
+
+template <typename Writer>
+void VSS::saveImpl(const Writer& write)
+{
+  int i;
+  struct Header header;
+
   header.magic = VSS_MAGIC_V1;
   header.entries = vss->currentSize;
+  write((char*)&header, sizeof(header));
 
-  if (out->write((char*)&header, sizeof(header)) != sizeof(header))
-  {
-    log_errno("VSS::save()");
-    throw runtime_error("VSS::save(): Failed to write header to the file");
-  }
-
-  int first = -1, last = -1, err;
-  size_t progress, writeSize;
+  // write the runs of used entries
+  int first = -1;
   for (i = 0; i < vss->capacity; i++)
   {
     if (storage[i].lbid != -1 && first == -1)
       first = i;
     else if (storage[i].lbid == -1 && first != -1)
     {
-      last = i;
-      writeSize = (last - first) * sizeof(VSSEntry);
-      progress = 0;
-      char* writePos = (char*)&storage[first];
-      while (progress < writeSize)
-      {
-        err = out->write(writePos + progress, writeSize - progress);
-        if (err < 0)
-        {
-          log_errno("VSS::save()");
-          throw runtime_error("VSS::save(): Failed to write the file");
-        }
-        progress += err;
-      }
+      write((char*)&storage[first], (i - first) * sizeof(VSSEntry));
       first = -1;
     }
   }
   if (first != -1)
-  {
-    writeSize = (vss->capacity - first) * sizeof(VSSEntry);
-    progress = 0;
-    char* writePos = (char*)&storage[first];
-    while (progress < writeSize)
-    {
-      err = out->write(writePos + progress, writeSize - progress);
-      if (err < 0)
-      {
-        log_errno("VSS::save()");
-        throw runtime_error("VSS::save(): Failed to write the file");
-      }
-      progress += err;
-    }
-  }
+    write((char*)&storage[first], (vss->capacity - first) * sizeof(VSSEntry));
 }
 
 // Ideally, we;d like to get in and out of this fcn as quickly as possible.
@@ -1341,6 +1461,9 @@ bool VSS::isEmpty(bool useLock)
   // Should be race-free, but takes along time...
   bool rc;
 
+  if (useLock && isEmptyUnlocked(rc))
+    return rc;
+
   if (useLock)
     lock(READ);
 
@@ -1352,6 +1475,27 @@ bool VSS::isEmpty(bool useLock)
   return rc;
 }
 
+// The lookupUnlocked() protocol for currentSize
+bool VSS::isEmptyUnlocked(bool& empty) const
+{
+  boost::shared_lock<boost::shared_mutex> lk(VSSImpl::mapMutex());
+
+  if (!fPVSSImpl || !vssShminfo || fPVSSImpl->key() != (unsigned)vssShminfo->tableShmkey)
+    return false;
+
+  const VSSShmsegHeader* header = fPVSSImpl->get();
+  uint32_t seq = header->changeSeq;
+
+  if (seq & 1)
+    return false;
+
+  atomicops::atomicMb();
+  empty = (header->currentSize == 0);
+  atomicops::atomicMb();
+
+  return header->changeSeq == seq && fPVSSImpl->key() == (unsigned)vssShminfo->tableShmkey;
+}
+
 //#include "boost/date_time/posix_time/posix_time.hpp"
 // using namespace boost::posix_time;
 
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <set>
+#include <vector>
 //#define NDEBUG
 #include <cassert>
 #include <boost/thread.hpp>
@@ -96,6 +97,8 @@ struct VSSShmsegHeader
   int LWM;
   int numHashBuckets;
   int lockedEntryCount;
+  // Odd while a writer holds the write lock, see VSS::lookupUnlocked()
+  volatile uint32_t changeSeq;
 
   //  the rest of the overlay looks like this
   // 	int hashBuckets[numHashBuckets];
@@ -132,6 +135,7 @@ class VSSImpl
 #endif
   inline void makeReadOnly()
   {
+    boost::unique_lock<boost::shared_mutex> lk(fMapMutex);
     fVSS.setReadOnly();
   }
   inline void clear(unsigned key, off_t size)
@@ -140,8 +144,12 @@ class VSSImpl
   }
   inline void swapout(BRMShmImpl& rhs)
   {
+    // unmap the old segment here rather than when rhs goes away so that
+    // no lock-free reader can be in it
+    boost::unique_lock<boost::shared_mutex> lk(fMapMutex);
     fVSS.swap(rhs);
     rhs.destroy();
+    bi::mapped_region().swap(rhs.fMapreg);
   }
   inline unsigned key() const
   {
@@ -153,6 +161,12 @@ class VSSImpl
     return reinterpret_cast<VSSShmsegHeader*>(fVSS.fMapreg.get_address());
   }
 
+  // Held shared by lock-free readers, the segment isn't remapped meanwhile
+  static boost::shared_mutex& mapMutex()
+  {
+    return fMapMutex;
+  }
+
  private:
   VSSImpl(unsigned key, off_t size, bool readOnly = false);
   ~VSSImpl();
@@ -162,6 +176,7 @@ class VSSImpl
   BRMShmImpl fVSS;
 
   static boost::mutex fInstanceMutex;
+  static boost::shared_mutex fMapMutex;
   static VSSImpl* fInstance;
 };
 
@@ -220,6 +235,40 @@ class VSS : public Undoable
   EXPORT int lookup(LBID_t lbid, const QueryContext_vss&, VER_t txnID, VER_t* outVer, bool* vbFlag,
                     bool vbOnly = false) const;
 
+  /** @brief lookup() without taking the read lock
+   *
+   * Works only while no writer holds the write lock and the segment has been
+   * attached by an earlier lock().  Returns false if it couldn't do the lookup,
+   * the caller has to lock and use lookup() then.  Otherwise rc is what lookup()
+   * would have returned.
+   */
+  EXPORT bool lookupUnlocked(LBID_t lbid, const QueryContext_vss&, VER_t txnID, VER_t* outVer, bool* vbFlag,
+                             bool vbOnly, int& rc) const;
+
+  /** @brief lookupUnlocked() of a batch of LBIDs
+   *
+   * Checks changeSeq once for the whole batch, so either every entry of out
+   * is what lookup() would have returned or it returns false and the caller
+   * has to look them all up again under the read lock.  Takes the place of
+   * isEmpty() too.
+   */
+  EXPORT bool bulkLookupUnlocked(const std::vector<LBID_t>& lbids, const QueryContext_vss&, VER_t txnID,
+                                 std::vector<VSSData>& out) const;
+
+  /** @brief changeSeq for lock(WRITE) and release(WRITE) to set
+   *
+   * Forced odd and then to the next even value rather than bumped, so a
+   * writer that died with the lock held can't leave the parity flipped.
+   */
+  static uint32_t writeStartSeq(uint32_t seq)
+  {
+    return seq | 1;
+  }
+  static uint32_t writeEndSeq(uint32_t seq)
+  {
+    return (seq | 1) + 1;
+  }
+
   /// Returns the version in the main DB files
   EXPORT VER_t getCurrentVersion(LBID_t lbid, bool* isLocked) const;  // returns the ver in the main DB files
 
@@ -247,6 +296,8 @@ class VSS : public Undoable
   EXPORT void clear();
   EXPORT void load(std::string filename);
   EXPORT void save(std::string filename);
+  // Copies what save() would write into memory, the caller holds the read lock
+  EXPORT void saveImage(std::vector<char>& image);
 
 #ifdef BRM_DEBUG
   EXPORT int getShmid() const;
@@ -281,7 +332,14 @@ class VSS : public Undoable
   void initShmseg();
   void copyVSS(VSSShmsegHeader* dest);
 
+  template <typename Writer>
+  void saveImpl(const Writer& write);
+
   int getIndex(LBID_t lbid, VER_t verID, int& prev, int& bucket) const;
+  int _lookup(const VSSShmsegHeader* header, const int* buckets, const VSSEntry* stor, LBID_t lbid,
+              const QueryContext_vss& verInfo, VER_t txnID, VER_t* outVer, bool* vbFlag, bool vbOnly,
+              bool& consistent) const;
+  bool isEmptyUnlocked(bool& empty) const;
   void _insert(VSSEntry& e, VSSShmsegHeader* dest, int* destTable, VSSEntry* destStorage,
                bool loading = false);
   ShmKeys fShmKeys;
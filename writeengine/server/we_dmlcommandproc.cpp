@@ -19,6 +19,7 @@
 // $Id: we_dmlcommandproc.cpp 3082 2011-09-26 22:00:38Z chao $
 
 #include <unistd.h>
+#include <algorithm>
 #include "bytestream.h"
 using namespace messageqcpp;
 
@@ -768,6 +769,9 @@ uint8_t WE_DMLCommandProc::rollbackBlocks(ByteStream& bs, std::string& err)
   txnID = tmp32;
 
   // cout << "processing rollbackBlocks txnid = " << txnID << endl;
+  // the rows of a DELETE that didn't get to flush its files are rolled back with it
+  pendingDeletes.erase(txnID);
+
   try
   {
     rc = fWEWrapper.rollbackBlocks(txnID, sessionID);
@@ -790,6 +794,7 @@ uint8_t WE_DMLCommandProc::rollbackVersion(ByteStream& bs, std::string& err)
   bs >> tmp32;
   txnID = tmp32;
   // cout << "processing rollbackVersion txnid = " << txnID << endl;
+  pendingDeletes.erase(txnID);
   rc = fWEWrapper.rollbackVersion(txnID, sessionID);
 
   if (rc != 0)
@@ -3874,6 +3879,23 @@ uint8_t WE_DMLCommandProc::processFlushFiles(messageqcpp::ByteStream& bs, std::s
   fWEWrapper.setBulkFlag(false);
   vector<LBID_t> lbidList;
 
+  // finish a DELETE before its files are flushed.  If the statement failed it is rolled back,
+  // so there's no point writing its rows.
+  uint8_t deleteRc = 0;
+  string deleteErr;
+
+  if (flushCode == NO_ERROR)
+  {
+    deleteRc = applyPendingDeletes(txnId, deleteErr);
+
+    if (deleteRc != 0)
+      flushCode = deleteRc;
+  }
+  else
+  {
+    pendingDeletes.erase(txnId);
+  }
+
   if (idbdatafile::IDBPolicy::useHdfs())
   {
     // XXX THIS IS WRONG!!!
@@ -3907,6 +3929,12 @@ uint8_t WE_DMLCommandProc::processFlushFiles(messageqcpp::ByteStream& bs, std::s
     err = ec.errorString(error);
   }
 
+  if (deleteRc != 0)
+  {
+    rc = deleteRc;
+    err = deleteErr;
+  }
+
   // erase rowgroup from the rowGroup map
   if (rowGroups[txnId])
   {
@@ -4014,23 +4042,6 @@ uint8_t WE_DMLCommandProc::processDelete(messageqcpp::ByteStream& bs, std::strin
   CalpontSystemCatalog::TableName aTableName;
   aTableName.schema = schema;
   aTableName.table = tableName;
-  boost::shared_ptr<CalpontSystemCatalog> systemCatalogPtr =
-      CalpontSystemCatalog::makeCalpontSystemCatalog(sessionID);
-  CalpontSystemCatalog::ROPair roPair;
-
-  CalpontSystemCatalog::RIDList tableRidList;
-
-  try
-  {
-    roPair = systemCatalogPtr->tableRID(aTableName);
-    tableRidList = systemCatalogPtr->columnRIDs(aTableName, true);
-  }
-  catch (exception& ex)
-  {
-    err = ex.what();
-    rc = 1;
-    return rc;
-  }
 
   // querystats
   uint64_t relativeRID = 0;
@@ -4057,12 +4068,6 @@ uint8_t WE_DMLCommandProc::processDelete(messageqcpp::ByteStream& bs, std::strin
   // Get the file information from rowgroup
   dbRoot = rowGroups[txnId]->getDBRoot();
   rowGroups[txnId]->getLocation(&partition, &segment, &extentNum, &blockNum);
-  WriteEngine::ColStructList colStructList;
-  WriteEngine::CSCTypesList cscColTypeList;
-  WriteEngine::ColStruct colStruct;
-  colStruct.fColPartition = partition;
-  colStruct.fColSegment = segment;
-  colStruct.fColDbRoot = dbRoot;
 
   for (unsigned i = 0; i < rowsThisRowgroup; i++)
   {
@@ -4084,6 +4089,55 @@ uint8_t WE_DMLCommandProc::processDelete(messageqcpp::ByteStream& bs, std::strin
     }
   }
 
+  // The rows are deleted when the statement flushes its files, see applyPendingDeletes()
+  PendingDeletes& pending = pendingDeletes[txnId];
+  pending.sessionID = sessionID;
+  pending.tableName = aTableName;
+  WriteEngine::RIDList& extentRids = pending.ridLists[ExtentKey(dbRoot, partition, segment, extentNum)];
+  extentRids.insert(extentRids.end(), rowIDList.begin(), rowIDList.end());
+  pending.ridCount += rowIDList.size();
+
+  // don't let a large DELETE hold all of its rows
+  if (pending.ridCount >= MAX_PENDING_DELETE_ROWS)
+    rc = applyPendingDeletes(txnId, err);
+
+  return rc;
+}
+
+uint8_t WE_DMLCommandProc::applyPendingDeletes(uint32_t txnId, std::string& err)
+{
+  uint8_t rc = 0;
+  auto pendingIt = pendingDeletes.find(txnId);
+
+  if (pendingIt == pendingDeletes.end())
+    return rc;
+
+  PendingDeletes pending;
+  std::swap(pending, pendingIt->second);
+  pendingDeletes.erase(pendingIt);
+
+  boost::shared_ptr<CalpontSystemCatalog> systemCatalogPtr =
+      CalpontSystemCatalog::makeCalpontSystemCatalog(pending.sessionID);
+  CalpontSystemCatalog::ROPair roPair;
+
+  CalpontSystemCatalog::RIDList tableRidList;
+
+  try
+  {
+    roPair = systemCatalogPtr->tableRID(pending.tableName);
+    tableRidList = systemCatalogPtr->columnRIDs(pending.tableName, true);
+  }
+  catch (exception& ex)
+  {
+    err = ex.what();
+    rc = 1;
+    return rc;
+  }
+
+  WriteEngine::ColStructList colStructList;
+  WriteEngine::CSCTypesList cscColTypeList;
+  WriteEngine::ColStruct colStruct;
+
   try
   {
     for (unsigned i = 0; i < tableRidList.size(); i++)
@@ -4118,17 +4172,36 @@ uint8_t WE_DMLCommandProc::processDelete(messageqcpp::ByteStream& bs, std::strin
     return rc;
   }
 
-  std::vector<ColStructList> colExtentsStruct;
-  std::vector<CSCTypesList> colExtentsColType;
-  std::vector<void*> colOldValueList;
-  std::vector<RIDList> ridLists;
-  colExtentsStruct.push_back(colStructList);
-  colExtentsColType.push_back(cscColTypeList);
-  ridLists.push_back(rowIDList);
   int error = 0;
 
-  error = fWEWrapper.deleteRow(txnId, colExtentsColType, colExtentsStruct, colOldValueList, ridLists,
-                               roPair.objnum);
+  for (auto& extent : pending.ridLists)
+  {
+    // rowgroups may arrive in any order, writeRows() wants to visit each block once
+    WriteEngine::RIDList& rowIDList = extent.second;
+    std::sort(rowIDList.begin(), rowIDList.end());
+    rowIDList.erase(std::unique(rowIDList.begin(), rowIDList.end()), rowIDList.end());
+
+    for (auto& aColStruct : colStructList)
+    {
+      aColStruct.fColDbRoot = std::get<0>(extent.first);
+      aColStruct.fColPartition = std::get<1>(extent.first);
+      aColStruct.fColSegment = std::get<2>(extent.first);
+    }
+
+    std::vector<ColStructList> colExtentsStruct;
+    std::vector<CSCTypesList> colExtentsColType;
+    std::vector<void*> colOldValueList;
+    std::vector<RIDList> ridLists;
+    colExtentsStruct.push_back(colStructList);
+    colExtentsColType.push_back(cscColTypeList);
+    ridLists.push_back(rowIDList);
+
+    error = fWEWrapper.deleteRow(txnId, colExtentsColType, colExtentsStruct, colOldValueList, ridLists,
+                                 roPair.objnum);
+
+    if (error != NO_ERROR)
+      break;
+  }
 
   if (error != NO_ERROR)
   {
@@ -4521,6 +4594,8 @@ uint8_t WE_DMLCommandProc::processEndTransaction(ByteStream& bs, std::string& er
   bs >> txnid;
   bs >> tmp8;
   success = (tmp8 != 0);
+  // nothing is left to flush once the transaction ends
+  pendingDeletes.erase(txnid);
   rc = fWEWrapper.endTransaction(txnid, success);
 
   if (rc != NO_ERROR)
@@ -22,6 +22,8 @@
 #pragma once
 
 #include <unistd.h>
+#include <map>
+#include <tuple>
 #include <boost/scoped_ptr.hpp>
 #include "bytestream.h"
 #include "we_messages.h"
@@ -122,6 +124,7 @@ class WE_DMLCommandProc
     else
       return false;
   }
+  uint8_t applyPendingDeletes(uint32_t txnId, std::string& err);
   uint8_t processBatchInsertHwmFlushChunks(uint32_t tableOID, int txnID,
                                            const std::vector<BRM::FileInfo>& files,
                                            const std::vector<BRM::OID_t>& oidsToFlush, std::string& err);
@@ -129,10 +132,28 @@ class WE_DMLCommandProc
   bool fIsFirstBatchPm;
   std::map<uint32_t, rowgroup::RowGroup*> rowGroups;
   std::map<uint32_t, dmlpackage::UpdateDMLPackage> cpackages;
+
+  // The rows a DELETE statement removes are collected per extent and deleted when the statement
+  // flushes its files, so that each column file of an extent is versioned and rewritten once per
+  // statement instead of once per rowgroup.
+  typedef std::tuple<uint16_t, uint32_t, uint16_t, uint8_t> ExtentKey;  // dbroot, partition, segment, extent
+  struct PendingDeletes
+  {
+    PendingDeletes() : sessionID(0), ridCount(0)
+    {
+    }
+    uint32_t sessionID;
+    execplan::CalpontSystemCatalog::TableName tableName;
+    std::map<ExtentKey, WriteEngine::RIDList> ridLists;
+    size_t ridCount;
+  };
+  std::map<uint32_t, PendingDeletes> pendingDeletes;  // keyed by txnId
   BRM::DBRM fDbrm;
   unsigned extentsPerSegmentFile, extentRows, filesPerColumnPartition, dbrootCnt;
   Log fLog;
   static const uint32_t DEFAULT_EXTENTS_PER_SEGMENT_FILE = 2;
+  // apply the pending rows of a DELETE once it has collected this many
+  static const size_t MAX_PENDING_DELETE_ROWS = 1 << 20;
 };
 
 }  // namespace WriteEngine
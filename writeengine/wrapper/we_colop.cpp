@@ -720,6 +720,8 @@ int ColumnOp::fillColumn(const TxnID& txnid, Column& column, Column& refCol, voi
   std::vector<uint16_t> rootList;
   config.getRootIdList(rootList);
   const uint8_t* emptyVal = getEmptyRowValue(column.colDataType, column.colWidth);
+  unsigned char emptyBlock[BYTE_PER_BLOCK];
+  setEmptyBuf(emptyBlock, BYTE_PER_BLOCK, emptyVal, column.colWidth);
   // Set TypeHandler to get empty value ptr for the ref column
   findTypeHandler(refCol.colWidth, refCol.colDataType);
   const uint8_t* refEmptyVal = getEmptyRowValue(refCol.colDataType, refCol.colWidth);
@@ -954,6 +956,22 @@ int ColumnOp::fillColumn(const TxnID& txnid, Column& column, Column& refCol, voi
 
       // Compute local hwm for the new column
       colHwm = (maxRowId * column.colWidth) / BYTE_PER_BLOCK;
+
+      // The blocks aren't read back before they are written, so a block past the end of an
+      // abbreviated initial extent would go past the end of the file. Expand it first.
+      bool bCheckAbbrevExtent = (column.dataFile.fPartition == 0) && (column.dataFile.fSegment == 0) &&
+                                abbreviatedExtent(column.dataFile.pFile, column.colWidth);
+      uint64_t numBlksPerInitialExtent = INITIAL_EXTENT_ROWS_TO_DISK / BYTE_PER_BLOCK * column.colWidth;
+      auto saveColBlock = [&](uint64_t fbo)
+      {
+        if (bCheckAbbrevExtent && (fbo + 1) > numBlksPerInitialExtent)
+        {
+          RETURN_ON_ERROR(expandAbbrevExtent(column));
+          bCheckAbbrevExtent = false;
+        }
+
+        return saveBlock(column.dataFile.pFile, colBuf, fbo);
+      };
       // cout << " new col hwm is " << colHwm << endl;
       startRefColFbo = 0;
       startColFbo = 0;
@@ -988,12 +1006,12 @@ int ColumnOp::fillColumn(const TxnID& txnid, Column& column, Column& refCol, voi
             if (dirty)
             {
               // cout << " writing to new col " << endl;
-              RETURN_ON_ERROR(saveBlock(column.dataFile.pFile, colBuf, startColFbo - 1));
+              RETURN_ON_ERROR(saveColBlock(startColFbo - 1));
               dirty = false;
             }
 
-            // cout << "reading from new col " << endl;
-            RETURN_ON_ERROR(readBlock(column.dataFile.pFile, colBuf, startColFbo));
+            // nothing to read back, the new column's blocks are still empty
+            memcpy(colBuf, emptyBlock, BYTE_PER_BLOCK);
             startColFbo++;
             colBufOffset = 0;
           }
@@ -1078,11 +1096,13 @@ int ColumnOp::fillColumn(const TxnID& txnid, Column& column, Column& refCol, voi
             // Current block of the new colum is full. Write it if dirty and then get the next block
             if (dirty)
             {
-              RETURN_ON_ERROR(saveBlock(column.dataFile.pFile, colBuf, startColFbo - 1));
+              RETURN_ON_ERROR(saveColBlock(startColFbo - 1));
               dirty = false;
             }
 
-            RETURN_ON_ERROR(readBlock(column.dataFile.pFile, colBuf, startColFbo));
+            // The new column's extents were just created and hold nothing but empty values,
+            // so there is no need to read the block back.
+            memcpy(colBuf, emptyBlock, BYTE_PER_BLOCK);
             startColFbo++;
             colBufOffset = 0;
           }
@@ -1118,7 +1138,7 @@ int ColumnOp::fillColumn(const TxnID& txnid, Column& column, Column& refCol, voi
 
       if (dirty)
       {
-        RETURN_ON_ERROR(saveBlock(column.dataFile.pFile, colBuf, startColFbo - 1));
+        RETURN_ON_ERROR(saveColBlock(startColFbo - 1));
         dirty = false;
       }
 
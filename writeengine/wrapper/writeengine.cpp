@@ -1254,6 +1254,45 @@ static void setInvalidCPInfosSpecialMarks(std::vector<ExtCPInfo>& cpInfos)
   }
 }
 
+std::vector<ExtCPInfo> WriteEngineWrapper::getMaxMinsBeingSet(const ColSplitMaxMinInfoList& maxMins)
+{
+  std::vector<ExtCPInfo> cpInfos;
+
+  for (const auto& splitCPInfo : maxMins)
+  {
+    for (const ExtCPInfo* cpInfo : splitCPInfo.fSplitMaxMinInfoPtrs)
+    {
+      if (cpInfo)
+      {
+        cpInfos.push_back(*cpInfo);
+        cpInfos.back().fCPInfo.seqNum = SEQNUM_MARK_INVALID_SET_RANGE;
+      }
+    }
+  }
+
+  return cpInfos;
+}
+
+std::vector<ExtCPInfo> WriteEngineWrapper::getNewMaxMins(const ColSplitMaxMinInfoList& maxMins)
+{
+  std::vector<ExtCPInfo> cpInfos;
+
+  for (const auto& splitCPInfo : maxMins)
+  {
+    for (const ExtCPInfo* cpInfo : splitCPInfo.fSplitMaxMinInfoPtrs)
+    {
+      if (cpInfo)
+      {
+        cpInfos.push_back(*cpInfo);
+        cpInfos.back().fCPInfo.seqNum++;
+      }
+    }
+  }
+
+  setInvalidCPInfosSpecialMarks(cpInfos);
+  return cpInfos;
+}
+
 /*@insertColumnRecs -  Insert value(s) into a column
  */
 /***********************************************************
@@ -2033,19 +2072,7 @@ int WriteEngineWrapper::insertColumnRecs(
     //----------------------------------------------------------------------
     // Write row(s) to database file(s)
     //----------------------------------------------------------------------
-    std::vector<ExtCPInfo> cpinfoList;
-    for (auto& splitCPInfo : maxMins)
-    {
-      for (i = 0; i < 2; i++)
-      {
-        ExtCPInfo* cpInfo = splitCPInfo.fSplitMaxMinInfoPtrs[i];
-        if (cpInfo)
-        {
-          cpinfoList.push_back(*cpInfo);
-          cpinfoList[cpinfoList.size() - 1].fCPInfo.seqNum = SEQNUM_MARK_INVALID_SET_RANGE;
-        }
-      }
-    }
+    std::vector<ExtCPInfo> cpinfoList = getMaxMinsBeingSet(maxMins);
     rc = BRMWrapper::getInstance()->setExtentsMaxMin(cpinfoList);
     if (rc != NO_ERROR)
     {
@@ -2072,21 +2099,7 @@ int WriteEngineWrapper::insertColumnRecs(
 
       if (rc == NO_ERROR)
       {
-        int index = 0;
-        for (auto& splitCPInfo : maxMins)
-        {
-          for (i = 0; i < 2; i++)
-          {
-            ExtCPInfo* cpInfo = splitCPInfo.fSplitMaxMinInfoPtrs[i];
-            if (cpInfo)
-            {
-              cpinfoList[index] = *cpInfo;
-              cpinfoList[index].fCPInfo.seqNum++;
-              index++;
-            }
-          }
-        }
-        setInvalidCPInfosSpecialMarks(cpinfoList);
+        cpinfoList = getNewMaxMins(maxMins);
         rc = BRMWrapper::getInstance()->setExtentsMaxMin(cpinfoList);
       }
     }
@@ -4006,6 +4019,16 @@ int WriteEngineWrapper::insertColumnRec_Single(const TxnID& txnid, const CSCType
   int curFbo = 0, curBio, lastFbo = -1;
   lastRid = rowIdArray[totalRow - 1];
 
+  // When the rows stay in the current extent keep its casual partitioning range
+  // up to date like insertColumnRecs() does, so that a stream of single-row
+  // inserts doesn't leave the extent invalid until the next full scan.
+  ColSplitMaxMinInfoList maxMins;
+
+  for (unsigned i = 0; i < colStructList.size(); i++)
+  {
+    maxMins.push_back(ColSplitMaxMinInfo(colStructList[i].colDataType, colStructList[i].colWidth));
+  }
+
   for (unsigned i = 0; i < colStructList.size(); i++)
   {
     colOp = m_colOp[op(colStructList[i].fCompressionType)];
@@ -4016,14 +4039,23 @@ int WriteEngineWrapper::insertColumnRec_Single(const TxnID& txnid, const CSCType
     {
       if (curFbo != lastFbo)
       {
+        ExtCPInfo* cpInfoP = newExtent ? NULL
+                                       : getCPInfoToUpdateForUpdatableType(
+                                             colStructList[i], &maxMins[i].fSplitMaxMinInfo[0], m_opType);
         colDataTypes.push_back(colStructList[i].colDataType);
-        RETURN_ON_ERROR(AddLBIDtoList(txnid, colStructList[i], curFbo));
+        RETURN_ON_ERROR(AddLBIDtoList(txnid, colStructList[i], curFbo, cpInfoP));
+        maxMins[i].fSplitMaxMinInfoPtrs[0] = cpInfoP;
       }
     }
   }
 
   markTxnExtentsAsInvalid(txnid);
 
+  std::vector<ExtCPInfo> cpinfoList = getMaxMinsBeingSet(maxMins);
+
+  if (!cpinfoList.empty())
+    RETURN_ON_ERROR(BRMWrapper::getInstance()->setExtentsMaxMin(cpinfoList));
+
   //--------------------------------------------------------------------------
   // Write row(s) to database file(s)
   //--------------------------------------------------------------------------
@@ -4042,11 +4074,17 @@ int WriteEngineWrapper::insertColumnRec_Single(const TxnID& txnid, const CSCType
     else
     {
       rc = writeColumnRec(txnid, cscColTypeList, colStructList, colValueList, rowIdArray, newColStructList,
-                          colNewValueList, tableOid,
-                          true);  // @bug 5572 HDFS tmp file
+                          colNewValueList, tableOid, true, true,
+                          &maxMins);  // @bug 5572 HDFS tmp file
     }
   }
 
+  if (rc == NO_ERROR && !cpinfoList.empty())
+  {
+    cpinfoList = getNewMaxMins(maxMins);
+    rc = BRMWrapper::getInstance()->setExtentsMaxMin(cpinfoList);
+  }
+
 #ifdef PROFILE
   timer.stop("writeColumnRec");
 #endif
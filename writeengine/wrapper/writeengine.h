@@ -192,6 +192,18 @@ class WriteEngineWrapper : public WEObj
                                 const ColType colType, const void* valArray, const void* oldValArray,
                                 ExtCPInfo* maxMin, bool canStartWithInvalidRange);
 
+  /**
+   * @brief The ranges of the extents a DML operation changes, to be set with their sequence
+   * numbers marked before the rows are written.
+   */
+  EXPORT static std::vector<ExtCPInfo> getMaxMinsBeingSet(const ColSplitMaxMinInfoList& maxMins);
+
+  /**
+   * @brief The ranges of the extents a DML operation changed, to be set after the rows are
+   * written. Ranges that became invalid keep the mark.
+   */
+  EXPORT static std::vector<ExtCPInfo> getNewMaxMins(const ColSplitMaxMinInfoList& maxMins);
+
   /**
    * @brief Create a column, include object ids for column data and bitmap files
    * @param dataOid column datafile object id